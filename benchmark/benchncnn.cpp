@@ -32,6 +32,7 @@
 #include "datareader.h"
 #include "net.h"
 #include "gpu.h"
+#include "profiler.h"
 
 class DataReaderFromEmpty : public ncnn::DataReader
 {
@@ -50,6 +51,7 @@ public:
 static int g_warmup_loop_count = 8;
 static int g_loop_count = 4;
 static bool g_enable_cooling_down = true;
+static bool g_enable_profile = false;
 
 static ncnn::UnlockedPoolAllocator g_blob_pool_allocator;
 static ncnn::PoolAllocator g_workspace_pool_allocator;
@@ -60,6 +62,16 @@ static ncnn::VkAllocator* g_blob_vkallocator = 0;
 static ncnn::VkAllocator* g_staging_vkallocator = 0;
 #endif // NCNN_VULKAN
 
+static void print_allocator_statistics(const char* comment, const ncnn::AllocatorStatistics& stat)
+{
+    size_t pool_count = stat.hit_count + stat.miss_count;
+    float hit_ratio = pool_count ? stat.hit_count * 100.f / pool_count : 0.f;
+
+    fprintf(stderr, "%20s  peak = %8.2f MB  reserved = %8.2f MB  peak reserved = %8.2f MB  slack = %8.2f MB  malloc = %lu  hit = %5.1f%%\n",
+            comment, stat.peak_bytes / 1e6, stat.reserved_bytes / 1e6, stat.peak_reserved_bytes / 1e6, stat.slack_bytes / 1e6,
+            (unsigned long)stat.malloc_count, hit_ratio);
+}
+
 void benchmark(const char* comment, const ncnn::Mat& _in, const ncnn::Option& opt)
 {
     ncnn::Mat in = _in;
@@ -67,6 +79,8 @@ void benchmark(const char* comment, const ncnn::Mat& _in, const ncnn::Option& op
 
     g_blob_pool_allocator.clear();
     g_workspace_pool_allocator.clear();
+    g_blob_pool_allocator.reset_statistics();
+    g_workspace_pool_allocator.reset_statistics();
 
 #if NCNN_VULKAN
     if (opt.use_vulkan_compute)
@@ -153,6 +167,28 @@ void benchmark(const char* comment, const ncnn::Mat& _in, const ncnn::Option& op
     time_avg /= g_loop_count;
 
     fprintf(stderr, "%20s  min = %7.2f  max = %7.2f  avg = %7.2f\n", comment, time_min, time_max, time_avg);
+
+    if (g_enable_profile)
+    {
+        ncnn::Profiler profiler;
+
+        for (int i = 0; i < g_loop_count; i++)
+        {
+            ncnn::Extractor ex = net.create_extractor();
+            ex.set_profiler(&profiler);
+            ex.input("data", in);
+            ex.extract("output", out);
+        }
+
+        profiler.save_summary(stderr);
+
+        print_allocator_statistics("blob allocator", g_blob_pool_allocator.statistics());
+        print_allocator_statistics("workspace allocator", g_workspace_pool_allocator.statistics());
+
+        char tracepath[256];
+        sprintf(tracepath, "%s.trace.json", comment);
+        profiler.save_chrome_trace(tracepath);
+    }
 }
 
 int main(int argc, char** argv)
@@ -162,6 +198,7 @@ int main(int argc, char** argv)
     int powersave = 0;
     int gpu_device = -1;
     int cooling_down = 1;
+    int profile = 0;
 
     if (argc >= 2)
     {
@@ -183,6 +220,10 @@ int main(int argc, char** argv)
     {
         cooling_down = atoi(argv[5]);
     }
+    if (argc >= 7)
+    {
+        profile = atoi(argv[6]);
+    }
 
 #ifdef __EMSCRIPTEN__
     EM_ASM(
@@ -193,6 +234,7 @@ int main(int argc, char** argv)
     bool use_vulkan_compute = gpu_device != -1;
 
     g_enable_cooling_down = cooling_down != 0;
+    g_enable_profile = profile != 0;
 
     g_loop_count = loop_count;
 
@@ -245,6 +287,7 @@ int main(int argc, char** argv)
     fprintf(stderr, "powersave = %d\n", ncnn::get_cpu_powersave());
     fprintf(stderr, "gpu_device = %d\n", gpu_device);
     fprintf(stderr, "cooling_down = %d\n", (int)g_enable_cooling_down);
+    fprintf(stderr, "profile = %d\n", (int)g_enable_profile);
 
     // run
     benchmark("squeezenet", ncnn::Mat(227, 227, 3), opt);
@@ -0,0 +1,278 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "layer.h"
+#include "net.h"
+
+// measure how long it takes to parse network structure
+// model weights are not loaded, only param text and param binary
+
+static int g_loop_count = 20;
+
+static bool read_file(const char* path, std::string& content)
+{
+    FILE* fp = fopen(path, "rb");
+    if (!fp)
+        return false;
+
+    fseek(fp, 0, SEEK_END);
+    long len = ftell(fp);
+    rewind(fp);
+
+    content.resize(len);
+    size_t nread = fread(&content[0], 1, len, fp);
+    fclose(fp);
+
+    return nread == (size_t)len;
+}
+
+// a long chain of Crop and ReLU layers, each Crop carries three array params
+static void make_synthetic_param(int layer_count, std::string& text, std::vector<int>& bin)
+{
+    const int crop_typeindex = ncnn::layer_to_index("Crop");
+    const int relu_typeindex = ncnn::layer_to_index("ReLU");
+
+    char line[256];
+
+    text = "7767517\n";
+    sprintf(line, "%d %d\n", layer_count + 1, layer_count + 1);
+    text += line;
+    text += "Input            data             0 1 blob0 0=224 1=224 2=3\n";
+
+    bin.clear();
+    bin.push_back(7767517);
+    bin.push_back(layer_count + 1);
+    bin.push_back(layer_count + 1);
+
+    // input
+    bin.push_back(ncnn::layer_to_index("Input"));
+    bin.push_back(0);
+    bin.push_back(1);
+    bin.push_back(0);
+    bin.push_back(-233);
+
+    for (int i = 0; i < layer_count; i++)
+    {
+        if (i % 2 == 0)
+        {
+            sprintf(line, "Crop             crop%-10d 1 1 blob%d blob%d -23309=2,1,1 -23310=2,-1,-1 -23311=2,1,2\n", i, i, i + 1);
+            text += line;
+
+            bin.push_back(crop_typeindex);
+            bin.push_back(1);
+            bin.push_back(1);
+            bin.push_back(i);
+            bin.push_back(i + 1);
+            for (int j = 0; j < 3; j++)
+            {
+                bin.push_back(-23309 - j);
+                bin.push_back(2);
+                bin.push_back(j == 1 ? -1 : 1);
+                bin.push_back(j == 1 ? -1 : j + 1);
+            }
+            bin.push_back(-233);
+        }
+        else
+        {
+            sprintf(line, "ReLU             relu%-10d 1 1 blob%d blob%d 0=1.000000e-01\n", i, i, i + 1);
+            text += line;
+
+            float slope = 0.1f;
+            int slope_bits;
+            memcpy(&slope_bits, &slope, sizeof(int));
+
+            bin.push_back(relu_typeindex);
+            bin.push_back(1);
+            bin.push_back(1);
+            bin.push_back(i);
+            bin.push_back(i + 1);
+            bin.push_back(0);
+            bin.push_back(slope_bits);
+            bin.push_back(-233);
+        }
+    }
+}
+
+static void print_result(const char* comment, const char* method, double time_min, double time_max, double time_avg)
+{
+    fprintf(stderr, "%20s  %-16s  min = %7.3f  max = %7.3f  avg = %7.3f\n", comment, method, time_min, time_max, time_avg);
+}
+
+static void bench_param_file(const char* comment, const char* path)
+{
+    double time_min = DBL_MAX;
+    double time_max = -DBL_MAX;
+    double time_avg = 0;
+
+    for (int i = 0; i < g_loop_count; i++)
+    {
+        ncnn::Net net;
+
+        double start = ncnn::get_current_time();
+
+        int ret = net.load_param(path);
+
+        double end = ncnn::get_current_time();
+
+        if (ret != 0)
+        {
+            fprintf(stderr, "load_param %s failed\n", path);
+            return;
+        }
+
+        double time = end - start;
+
+        time_min = std::min(time_min, time);
+        time_max = std::max(time_max, time);
+        time_avg += time;
+    }
+
+    time_avg /= g_loop_count;
+
+    print_result(comment, "load_param", time_min, time_max, time_avg);
+}
+
+static void bench_param_mem(const char* comment, const std::string& text)
+{
+    double time_min = DBL_MAX;
+    double time_max = -DBL_MAX;
+    double time_avg = 0;
+
+    for (int i = 0; i < g_loop_count; i++)
+    {
+        ncnn::Net net;
+
+        double start = ncnn::get_current_time();
+
+        int ret = net.load_param_mem(text.c_str());
+
+        double end = ncnn::get_current_time();
+
+        if (ret != 0)
+        {
+            fprintf(stderr, "load_param_mem %s failed\n", comment);
+            return;
+        }
+
+        double time = end - start;
+
+        time_min = std::min(time_min, time);
+        time_max = std::max(time_max, time);
+        time_avg += time;
+    }
+
+    time_avg /= g_loop_count;
+
+    print_result(comment, "load_param_mem", time_min, time_max, time_avg);
+}
+
+static void bench_param_bin_mem(const char* comment, const std::vector<int>& bin)
+{
+    double time_min = DBL_MAX;
+    double time_max = -DBL_MAX;
+    double time_avg = 0;
+
+    for (int i = 0; i < g_loop_count; i++)
+    {
+        ncnn::Net net;
+
+        double start = ncnn::get_current_time();
+
+        int consumed = net.load_param((const unsigned char*)bin.data());
+
+        double end = ncnn::get_current_time();
+
+        if (consumed != (int)(bin.size() * sizeof(int)))
+        {
+            fprintf(stderr, "load_param bin %s failed\n", comment);
+            return;
+        }
+
+        double time = end - start;
+
+        time_min = std::min(time_min, time);
+        time_max = std::max(time_max, time);
+        time_avg += time;
+    }
+
+    time_avg /= g_loop_count;
+
+    print_result(comment, "load_param_bin", time_min, time_max, time_avg);
+}
+
+int main(int argc, char** argv)
+{
+    int synthetic_layer_count = 10000;
+
+    if (argc >= 2)
+    {
+        g_loop_count = atoi(argv[1]);
+    }
+    if (argc >= 3)
+    {
+        synthetic_layer_count = atoi(argv[2]);
+    }
+
+    fprintf(stderr, "loop_count = %d\n", g_loop_count);
+    fprintf(stderr, "synthetic_layer_count = %d\n", synthetic_layer_count);
+
+    static const char* models[] = {
+        "squeezenet",
+        "mobilenet",
+        "mobilenet_v2",
+        "mobilenet_v3",
+        "shufflenet_v2",
+        "efficientnet_b0",
+        "googlenet",
+        "resnet50",
+        "mobilenet_ssd",
+        "yolov4-tiny",
+    };
+
+    for (size_t i = 0; i < sizeof(models) / sizeof(models[0]); i++)
+    {
+        std::string path = std::string(models[i]) + ".param";
+
+        std::string text;
+        if (!read_file(path.c_str(), text))
+        {
+            fprintf(stderr, "%20s  skipped, %s not found\n", models[i], path.c_str());
+            continue;
+        }
+
+        bench_param_file(models[i], path.c_str());
+        bench_param_mem(models[i], text);
+    }
+
+    {
+        std::string text;
+        std::vector<int> bin;
+        make_synthetic_param(synthetic_layer_count, text, bin);
+
+        bench_param_mem("synthetic", text);
+        bench_param_bin_mem("synthetic", bin);
+    }
+
+    return 0;
+}
@@ -154,6 +154,78 @@ macro(ncnn_add_layer class)
         endif()
     endif()
 
+    if(NCNN_RUNTIME_CPU AND NCNN_AVX512 AND NCNN_TARGET_ARCH STREQUAL "x86")
+        # enable avx512
+        set(NCNN_X86_HEADER ${CMAKE_CURRENT_SOURCE_DIR}/layer/${NCNN_TARGET_ARCH}/${name}_${NCNN_TARGET_ARCH}.h)
+        set(NCNN_X86_SOURCE ${CMAKE_CURRENT_SOURCE_DIR}/layer/${NCNN_TARGET_ARCH}/${name}_${NCNN_TARGET_ARCH}.cpp)
+
+        if(WITH_LAYER_${name} AND EXISTS ${NCNN_X86_HEADER} AND EXISTS ${NCNN_X86_SOURCE})
+
+            set(NCNN_AVX512_HEADER ${CMAKE_CURRENT_BINARY_DIR}/layer/${NCNN_TARGET_ARCH}/${name}_${NCNN_TARGET_ARCH}_avx512.h)
+            set(NCNN_AVX512_SOURCE ${CMAKE_CURRENT_BINARY_DIR}/layer/${NCNN_TARGET_ARCH}/${name}_${NCNN_TARGET_ARCH}_avx512.cpp)
+
+            add_custom_command(
+                OUTPUT ${NCNN_AVX512_HEADER}
+                COMMAND ${CMAKE_COMMAND} -DSRC=${NCNN_X86_HEADER} -DDST=${NCNN_AVX512_HEADER} -DCLASS=${class} -P "${CMAKE_CURRENT_SOURCE_DIR}/../cmake/ncnn_generate_avx512_source.cmake"
+                DEPENDS ${NCNN_X86_HEADER}
+                COMMENT "Generating source ${name}_${NCNN_TARGET_ARCH}_avx512.h"
+                VERBATIM
+            )
+            set_source_files_properties(${NCNN_AVX512_HEADER} PROPERTIES GENERATED TRUE)
+
+            add_custom_command(
+                OUTPUT ${NCNN_AVX512_SOURCE}
+                COMMAND ${CMAKE_COMMAND} -DSRC=${NCNN_X86_SOURCE} -DDST=${NCNN_AVX512_SOURCE} -DCLASS=${class} -P "${CMAKE_CURRENT_SOURCE_DIR}/../cmake/ncnn_generate_avx512_source.cmake"
+                DEPENDS ${NCNN_X86_SOURCE}
+                COMMENT "Generating source ${name}_${NCNN_TARGET_ARCH}_avx512.cpp"
+                VERBATIM
+            )
+            set_source_files_properties(${NCNN_AVX512_SOURCE} PROPERTIES GENERATED TRUE)
+
+            if(CMAKE_CXX_COMPILER_ID MATCHES "MSVC" OR (CMAKE_CXX_COMPILER_ID MATCHES "Clang" AND CMAKE_CXX_SIMULATE_ID MATCHES "MSVC"))
+                set_source_files_properties(${NCNN_AVX512_SOURCE} PROPERTIES COMPILE_FLAGS "/arch:AVX512 /DAVX512 /fp:strict")
+            else()
+                set_source_files_properties(${NCNN_AVX512_SOURCE} PROPERTIES COMPILE_FLAGS "-mfma -mf16c -mavx2 -mavx512f -mavx512cd -mavx512bw -mavx512dq -mavx512vl")
+            endif()
+
+            list(APPEND ncnn_SRCS ${NCNN_AVX512_HEADER} ${NCNN_AVX512_SOURCE})
+
+            # generate layer_declaration and layer_registry_avx512 file
+            set(layer_declaration "${layer_declaration}#include \"layer/${name}.h\"\n")
+            set(layer_declaration_class "class ${class}_final_avx512 : virtual public ${class}")
+            set(create_pipeline_content "        { int ret = ${class}::create_pipeline(opt); if (ret) return ret; }\n")
+            set(destroy_pipeline_content "        { int ret = ${class}::destroy_pipeline(opt); if (ret) return ret; }\n")
+
+            set(layer_declaration "${layer_declaration}#include \"layer/${NCNN_TARGET_ARCH}/${name}_${NCNN_TARGET_ARCH}_avx512.h\"\n")
+            set(layer_declaration_class "${layer_declaration_class}, virtual public ${class}_${NCNN_TARGET_ARCH}_avx512")
+            set(create_pipeline_content "${create_pipeline_content}        { int ret = ${class}_${NCNN_TARGET_ARCH}_avx512::create_pipeline(opt); if (ret) return ret; }\n")
+            set(destroy_pipeline_content "        { int ret = ${class}_${NCNN_TARGET_ARCH}_avx512::destroy_pipeline(opt); if (ret) return ret; }\n${destroy_pipeline_content}")
+
+            if(WITH_LAYER_${name}_vulkan)
+                set(layer_declaration "${layer_declaration}#include \"layer/vulkan/${name}_vulkan.h\"\n")
+                set(layer_declaration_class "${layer_declaration_class}, virtual public ${class}_vulkan")
+                set(create_pipeline_content "${create_pipeline_content}        if (vkdev) { int ret = ${class}_vulkan::create_pipeline(opt); if (ret) return ret; }\n")
+                set(destroy_pipeline_content "        if (vkdev) { int ret = ${class}_vulkan::destroy_pipeline(opt); if (ret) return ret; }\n${destroy_pipeline_content}")
+            endif()
+
+            set(layer_declaration "${layer_declaration}namespace ncnn {\n${layer_declaration_class}\n{\n")
+            set(layer_declaration "${layer_declaration}public:\n")
+            set(layer_declaration "${layer_declaration}    virtual int create_pipeline(const Option& opt) {\n${create_pipeline_content}        return 0;\n    }\n")
+            set(layer_declaration "${layer_declaration}    virtual int destroy_pipeline(const Option& opt) {\n${destroy_pipeline_content}        return 0;\n    }\n")
+            set(layer_declaration "${layer_declaration}};\n")
+            set(layer_declaration "${layer_declaration}DEFINE_LAYER_CREATOR(${class}_final_avx512)\n} // namespace ncnn\n\n")
+
+            set(layer_registry_avx512 "${layer_registry_avx512}#if NCNN_STRING\n{\"${class}\",${class}_final_avx512_layer_creator},\n#else\n{${class}_final_avx512_layer_creator},\n#endif\n")
+        else()
+            # no x86 optimized version
+            if(WITH_LAYER_${name})
+                set(layer_registry_avx512 "${layer_registry_avx512}#if NCNN_STRING\n{\"${class}\",${class}_final_layer_creator},\n#else\n{${class}_final_layer_creator},\n#endif\n")
+            else()
+                set(layer_registry_avx512 "${layer_registry_avx512}#if NCNN_STRING\n{\"${class}\",0},\n#else\n{0},\n#endif\n")
+            endif()
+        endif()
+    endif()
+
     if(NCNN_RUNTIME_CPU AND NCNN_ARM82 AND ((IOS AND CMAKE_OSX_ARCHITECTURES MATCHES "arm64") OR (CMAKE_SYSTEM_PROCESSOR MATCHES "^(aarch64)")))
         # enable armv8.2a+fp16
         set(NCNN_ARM_HEADER ${CMAKE_CURRENT_SOURCE_DIR}/layer/${NCNN_TARGET_ARCH}/${name}_${NCNN_TARGET_ARCH}.h)
@@ -23,10 +23,83 @@
 
 namespace ncnn {
 
+AllocatorStatistics::AllocatorStatistics()
+{
+    current_bytes = 0;
+    peak_bytes = 0;
+    mark_peak_bytes = 0;
+    reserved_bytes = 0;
+    peak_reserved_bytes = 0;
+    slack_bytes = 0;
+    malloc_count = 0;
+    free_count = 0;
+    hit_count = 0;
+    miss_count = 0;
+}
+
+static void statistics_malloc(AllocatorStatistics& stat, size_t size, size_t capacity, bool hit)
+{
+    stat.malloc_count++;
+    if (hit)
+    {
+        stat.hit_count++;
+        stat.slack_bytes += capacity - size;
+    }
+    else
+    {
+        stat.miss_count++;
+    }
+
+    stat.current_bytes += capacity;
+    stat.peak_bytes = std::max(stat.peak_bytes, stat.current_bytes);
+    stat.mark_peak_bytes = std::max(stat.mark_peak_bytes, stat.current_bytes);
+}
+
+static void statistics_free(AllocatorStatistics& stat, size_t capacity)
+{
+    stat.free_count++;
+    stat.current_bytes -= std::min(stat.current_bytes, capacity);
+}
+
+static void statistics_reserve(AllocatorStatistics& stat, size_t size)
+{
+    stat.reserved_bytes += size;
+    stat.peak_reserved_bytes = std::max(stat.peak_reserved_bytes, stat.reserved_bytes);
+}
+
+static void statistics_release(AllocatorStatistics& stat, size_t size)
+{
+    stat.reserved_bytes -= std::min(stat.reserved_bytes, size);
+}
+
+static void statistics_reset(AllocatorStatistics& stat)
+{
+    AllocatorStatistics s;
+    s.current_bytes = stat.current_bytes;
+    s.peak_bytes = stat.current_bytes;
+    s.mark_peak_bytes = stat.current_bytes;
+    s.reserved_bytes = stat.reserved_bytes;
+    s.peak_reserved_bytes = stat.reserved_bytes;
+    stat = s;
+}
+
 Allocator::~Allocator()
 {
 }
 
+AllocatorStatistics Allocator::statistics() const
+{
+    return AllocatorStatistics();
+}
+
+void Allocator::reset_statistics()
+{
+}
+
+void Allocator::mark_statistics()
+{
+}
+
 PoolAllocator::PoolAllocator()
 {
     size_compare_ratio = 192; // 0.75f * 256
@@ -52,15 +125,23 @@ void PoolAllocator::clear()
 {
     budgets_lock.lock();
 
+    size_t released = 0;
     std::list<std::pair<size_t, void*> >::iterator it = budgets.begin();
     for (; it != budgets.end(); ++it)
     {
         void* ptr = it->second;
         ncnn::fastFree(ptr);
+        released += it->first;
     }
     budgets.clear();
 
     budgets_lock.unlock();
+
+    payouts_lock.lock();
+
+    statistics_release(stat, released);
+
+    payouts_lock.unlock();
 }
 
 void PoolAllocator::set_size_compare_ratio(float scr)
@@ -97,6 +178,8 @@ void* PoolAllocator::fastMalloc(size_t size)
 
             payouts.push_back(std::make_pair(bs, ptr));
 
+            statistics_malloc(stat, size, bs, true);
+
             payouts_lock.unlock();
 
             return ptr;
@@ -112,6 +195,9 @@ void* PoolAllocator::fastMalloc(size_t size)
 
     payouts.push_back(std::make_pair(size, ptr));
 
+    statistics_reserve(stat, size);
+    statistics_malloc(stat, size, size, false);
+
     payouts_lock.unlock();
 
     return ptr;
@@ -131,6 +217,8 @@ void PoolAllocator::fastFree(void* ptr)
 
             payouts.erase(it);
 
+            statistics_free(stat, size);
+
             payouts_lock.unlock();
 
             budgets_lock.lock();
@@ -149,6 +237,27 @@ void PoolAllocator::fastFree(void* ptr)
     ncnn::fastFree(ptr);
 }
 
+AllocatorStatistics PoolAllocator::statistics() const
+{
+    MutexLockGuard guard(payouts_lock);
+
+    return stat;
+}
+
+void PoolAllocator::reset_statistics()
+{
+    MutexLockGuard guard(payouts_lock);
+
+    statistics_reset(stat);
+}
+
+void PoolAllocator::mark_statistics()
+{
+    MutexLockGuard guard(payouts_lock);
+
+    stat.mark_peak_bytes = stat.current_bytes;
+}
+
 UnlockedPoolAllocator::UnlockedPoolAllocator()
 {
     size_compare_ratio = 192; // 0.75f * 256
@@ -177,6 +286,7 @@ void UnlockedPoolAllocator::clear()
     {
         void* ptr = it->second;
         ncnn::fastFree(ptr);
+        statistics_release(stat, it->first);
     }
     budgets.clear();
 }
@@ -209,6 +319,8 @@ void* UnlockedPoolAllocator::fastMalloc(size_t size)
 
             payouts.push_back(std::make_pair(bs, ptr));
 
+            statistics_malloc(stat, size, bs, true);
+
             return ptr;
         }
     }
@@ -218,6 +330,9 @@ void* UnlockedPoolAllocator::fastMalloc(size_t size)
 
     payouts.push_back(std::make_pair(size, ptr));
 
+    statistics_reserve(stat, size);
+    statistics_malloc(stat, size, size, false);
+
     return ptr;
 }
 
@@ -235,6 +350,8 @@ void UnlockedPoolAllocator::fastFree(void* ptr)
 
             budgets.push_back(std::make_pair(size, ptr));
 
+            statistics_free(stat, size);
+
             return;
         }
     }
@@ -243,6 +360,21 @@ void UnlockedPoolAllocator::fastFree(void* ptr)
     ncnn::fastFree(ptr);
 }
 
+AllocatorStatistics UnlockedPoolAllocator::statistics() const
+{
+    return stat;
+}
+
+void UnlockedPoolAllocator::reset_statistics()
+{
+    statistics_reset(stat);
+}
+
+void UnlockedPoolAllocator::mark_statistics()
+{
+    stat.mark_peak_bytes = stat.current_bytes;
+}
+
 #if NCNN_VULKAN
 VkAllocator::VkAllocator(const VulkanDevice* _vkdev)
     : vkdev(_vkdev)
@@ -253,6 +385,21 @@ VkAllocator::VkAllocator(const VulkanDevice* _vkdev)
     coherent = false;
 }
 
+AllocatorStatistics VkAllocator::statistics() const
+{
+    return stat;
+}
+
+void VkAllocator::reset_statistics()
+{
+    statistics_reset(stat);
+}
+
+void VkAllocator::mark_statistics()
+{
+    stat.mark_peak_bytes = stat.current_bytes;
+}
+
 static inline size_t round_up(size_t n, size_t multiple)
 {
     return (n + multiple - 1) / multiple * multiple;
@@ -505,6 +652,8 @@ void VkBlobAllocator::clear()
 
     buffer_budgets.clear();
 
+    statistics_release(stat, stat.reserved_bytes);
+
     for (size_t i = 0; i < image_memory_blocks.size(); i++)
     {
         VkDeviceMemory memory = image_memory_blocks[i];
@@ -564,6 +713,8 @@ VkBufferMemory* VkBlobAllocator::fastMalloc(size_t size)
                 it->second -= aligned_size;
             }
 
+            statistics_malloc(stat, aligned_size, aligned_size, true);
+
             //             NCNN_LOGE("VkBlobAllocator M %p +%lu %lu", ptr->buffer, ptr->offset, ptr->capacity);
 
             return ptr;
@@ -633,6 +784,9 @@ VkBufferMemory* VkBlobAllocator::fastMalloc(size_t size)
     }
     buffer_budgets.push_back(budget);
 
+    statistics_reserve(stat, new_block_size);
+    statistics_malloc(stat, aligned_size, aligned_size, false);
+
     //     NCNN_LOGE("VkBlobAllocator M %p +%lu %lu", ptr->buffer, ptr->offset, ptr->capacity);
 
     return ptr;
@@ -706,6 +860,8 @@ void VkBlobAllocator::fastFree(VkBufferMemory* ptr)
         }
     }
 
+    statistics_free(stat, ptr->capacity);
+
     delete ptr;
 }
 
@@ -1543,6 +1699,8 @@ void VkStagingAllocator::clear()
 
         //         NCNN_LOGE("VkStagingAllocator F %p", ptr->buffer);
 
+        statistics_release(stat, ptr->capacity);
+
         vkUnmapMemory(vkdev->vkdevice(), ptr->memory);
         vkDestroyBuffer(vkdev->vkdevice(), ptr->buffer, 0);
         vkFreeMemory(vkdev->vkdevice(), ptr->memory, 0);
@@ -1567,6 +1725,8 @@ VkBufferMemory* VkStagingAllocator::fastMalloc(size_t size)
         {
             buffer_budgets.erase(it);
 
+            statistics_malloc(stat, size, capacity, true);
+
             //             NCNN_LOGE("VkStagingAllocator M %p %lu reused %lu", ptr->buffer, size, capacity);
 
             return ptr;
@@ -1599,6 +1759,9 @@ VkBufferMemory* VkStagingAllocator::fastMalloc(size_t size)
     ptr->access_flags = 0;
     ptr->stage_flags = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
 
+    statistics_reserve(stat, size);
+    statistics_malloc(stat, size, size, false);
+
     //     NCNN_LOGE("VkStagingAllocator M %p %lu", ptr->buffer, size);
 
     return ptr;
@@ -1610,6 +1773,8 @@ void VkStagingAllocator::fastFree(VkBufferMemory* ptr)
 
     // return to buffer_budgets
     buffer_budgets.push_back(ptr);
+
+    statistics_free(stat, ptr->capacity);
 }
 
 VkImageMemory* VkStagingAllocator::fastMalloc(int dims, int w, int h, int c, size_t elemsize, int /* elempack */)
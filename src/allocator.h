@@ -139,12 +139,50 @@ static inline int NCNN_XADD(int* addr, int delta)
 }
 #endif
 
+// memory usage counters of an allocator
+class AllocatorStatistics
+{
+public:
+    AllocatorStatistics();
+
+public:
+    // bytes handed out and not returned yet
+    size_t current_bytes;
+    // high water mark of current_bytes
+    size_t peak_bytes;
+    // high water mark of current_bytes since the last mark
+    size_t mark_peak_bytes;
+
+    // bytes owned by the allocator, handed out or idle in pool
+    size_t reserved_bytes;
+    size_t peak_reserved_bytes;
+
+    // extra bytes handed out by reusing larger budgets within size_compare_ratio
+    size_t slack_bytes;
+
+    size_t malloc_count;
+    size_t free_count;
+
+    // requests served from pool budgets and from new system allocations
+    size_t hit_count;
+    size_t miss_count;
+};
+
 class Allocator
 {
 public:
     virtual ~Allocator();
     virtual void* fastMalloc(size_t size) = 0;
     virtual void fastFree(void* ptr) = 0;
+
+    // memory usage counters, all zero if the allocator does not keep them
+    virtual AllocatorStatistics statistics() const;
+
+    // reset counters, peaks restart from current usage
+    virtual void reset_statistics();
+
+    // restart mark_peak_bytes from current usage
+    virtual void mark_statistics();
 };
 
 class PoolAllocator : public Allocator
@@ -163,12 +201,17 @@ public:
     virtual void* fastMalloc(size_t size);
     virtual void fastFree(void* ptr);
 
+    virtual AllocatorStatistics statistics() const;
+    virtual void reset_statistics();
+    virtual void mark_statistics();
+
 private:
     Mutex budgets_lock;
-    Mutex payouts_lock;
+    mutable Mutex payouts_lock;
     unsigned int size_compare_ratio; // 0~256
     std::list<std::pair<size_t, void*> > budgets;
     std::list<std::pair<size_t, void*> > payouts;
+    AllocatorStatistics stat;
 };
 
 class UnlockedPoolAllocator : public Allocator
@@ -187,10 +230,15 @@ public:
     virtual void* fastMalloc(size_t size);
     virtual void fastFree(void* ptr);
 
+    virtual AllocatorStatistics statistics() const;
+    virtual void reset_statistics();
+    virtual void mark_statistics();
+
 private:
     unsigned int size_compare_ratio; // 0~256
     std::list<std::pair<size_t, void*> > budgets;
     std::list<std::pair<size_t, void*> > payouts;
+    AllocatorStatistics stat;
 };
 
 #if NCNN_VULKAN
@@ -270,6 +318,11 @@ public:
     virtual VkImageMemory* fastMalloc(int dims, int w, int h, int c, size_t elemsize, int elempack) = 0;
     virtual void fastFree(VkImageMemory* ptr) = 0;
 
+    // memory usage counters of buffer allocations
+    virtual AllocatorStatistics statistics() const;
+    virtual void reset_statistics();
+    virtual void mark_statistics();
+
 public:
     const VulkanDevice* vkdev;
     uint32_t buffer_memory_type_index;
@@ -284,6 +337,9 @@ protected:
 
     VkImage create_image(VkImageType type, int width, int height, int depth, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage);
     VkImageView create_imageview(VkImageViewType type, VkImage image, VkFormat format);
+
+protected:
+    AllocatorStatistics stat;
 };
 
 class VkBlobAllocator : public VkAllocator
@@ -0,0 +1,179 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "autotune.h"
+
+#include "cpu.h"
+
+#include <string.h>
+
+namespace ncnn {
+
+AutotuneCache::AutotuneCache()
+    : _measuring(false)
+{
+}
+
+AutotuneCache::~AutotuneCache()
+{
+}
+
+void AutotuneCache::clear()
+{
+    MutexLockGuard guard(lock);
+    keys.clear();
+    values.clear();
+}
+
+int AutotuneCache::get(const std::string& key) const
+{
+    MutexLockGuard guard(lock);
+
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        if (keys[i] == key)
+            return values[i];
+    }
+
+    return -1;
+}
+
+void AutotuneCache::set(const std::string& key, int value)
+{
+    MutexLockGuard guard(lock);
+
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        if (keys[i] == key)
+        {
+            values[i] = value;
+            return;
+        }
+    }
+
+    keys.push_back(key);
+    values.push_back(value);
+}
+
+int AutotuneCache::size() const
+{
+    MutexLockGuard guard(lock);
+    return (int)keys.size();
+}
+
+void AutotuneCache::merge(const AutotuneCache& cache)
+{
+    std::vector<std::string> _keys;
+    std::vector<int> _values;
+    {
+        MutexLockGuard guard(cache.lock);
+        _keys = cache.keys;
+        _values = cache.values;
+    }
+
+    for (size_t i = 0; i < _keys.size(); i++)
+    {
+        set(_keys[i], _values[i]);
+    }
+}
+
+bool AutotuneCache::measuring() const
+{
+    MutexLockGuard guard(lock);
+    return _measuring;
+}
+
+void AutotuneCache::set_measuring(bool measuring)
+{
+    MutexLockGuard guard(lock);
+    _measuring = measuring;
+}
+
+#if NCNN_STDIO
+// bump when the key format or the candidate kernels of any layer change
+#define AUTOTUNE_CACHE_VERSION 1
+
+// timings only hold for the same candidate kernels running on the same kind of cpu
+static void get_autotune_header(char* header, size_t len)
+{
+    snprintf(header, len, "# ncnn autotune %d cpu %x count %d\n", AUTOTUNE_CACHE_VERSION, get_cpu_isa_key(), get_cpu_count());
+}
+
+// header line, then one entry per line
+// <key> = <value>
+int AutotuneCache::load(const char* path)
+{
+    FILE* fp = fopen(path, "rb");
+    if (!fp)
+    {
+        NCNN_LOGE("fopen %s failed", path);
+        return -1;
+    }
+
+    char header[256];
+    get_autotune_header(header, sizeof(header));
+
+    char line[256];
+    if (!fgets(line, sizeof(line), fp) || strcmp(line, header) != 0)
+    {
+        NCNN_LOGE("autotune cache %s was measured on another cpu or cache version, ignored", path);
+        fclose(fp);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), fp))
+    {
+        char* eq = strrchr(line, '=');
+        if (!eq || eq == line || eq[-1] != ' ')
+            continue;
+
+        int value = -1;
+        if (sscanf(eq + 1, "%d", &value) != 1 || value < 0)
+            continue;
+
+        set(std::string(line, eq - line - 1), value);
+    }
+
+    fclose(fp);
+
+    return 0;
+}
+
+int AutotuneCache::save(const char* path) const
+{
+    FILE* fp = fopen(path, "wb");
+    if (!fp)
+    {
+        NCNN_LOGE("fopen %s failed", path);
+        return -1;
+    }
+
+    char header[256];
+    get_autotune_header(header, sizeof(header));
+    fputs(header, fp);
+
+    MutexLockGuard guard(lock);
+
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        fprintf(fp, "%s = %d\n", keys[i].c_str(), values[i]);
+    }
+
+    fclose(fp);
+
+    return 0;
+}
+#endif // NCNN_STDIO
+
+} // namespace ncnn
@@ -0,0 +1,77 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef NCNN_AUTOTUNE_H
+#define NCNN_AUTOTUNE_H
+
+#include "platform.h"
+
+#if NCNN_STDIO
+#include <stdio.h>
+#endif // NCNN_STDIO
+
+namespace ncnn {
+
+// kernel choices measured by Net::autotune
+// a key describes one layer configuration, input shape and thread count
+// the value is the index of the fastest kernel for it
+// thread-safe
+class AutotuneCache
+{
+public:
+    AutotuneCache();
+    ~AutotuneCache();
+
+    void clear();
+
+    // return -1 if not measured yet
+    int get(const std::string& key) const;
+
+    void set(const std::string& key, int value);
+
+    // number of entries
+    int size() const;
+
+    // copy all entries of another cache, overwriting the same keys
+    void merge(const AutotuneCache& cache);
+
+    // layers time their candidate kernels for keys not measured yet only when measuring
+    // otherwise they fall back to the default choice
+    bool measuring() const;
+    void set_measuring(bool measuring);
+
+#if NCNN_STDIO
+    // merge entries from cache file
+    // the file is ignored if the cache version, cpu features or cpu count mismatch
+    // return 0 if success
+    int load(const char* path);
+
+    // return 0 if success
+    int save(const char* path) const;
+#endif // NCNN_STDIO
+
+private:
+    AutotuneCache(const AutotuneCache&);
+    AutotuneCache& operator=(const AutotuneCache&);
+
+private:
+    mutable Mutex lock;
+    std::vector<std::string> keys;
+    std::vector<int> values;
+    bool _measuring;
+};
+
+} // namespace ncnn
+
+#endif // NCNN_AUTOTUNE_H
@@ -326,6 +326,75 @@ int cpu_support_x86_avx2()
 #endif
 }
 
+int cpu_support_x86_avx512()
+{
+#if (_M_AMD64 || __x86_64__) || (_M_IX86 || __i386__)
+#if defined(_MSC_VER)
+    int cpu_info[4];
+    __cpuid(cpu_info, 0);
+
+    int nIds = cpu_info[0];
+    if (nIds < 7)
+        return 0;
+
+    __cpuid(cpu_info, 1);
+    // check AVX XSAVE OSXSAVE
+    if (!(cpu_info[2] & 0x10000000) || !(cpu_info[2] & 0x04000000) || !(cpu_info[2] & 0x08000000))
+        return 0;
+
+    // check XSAVE enabled by kernel, including opmask and zmm state
+    if ((_xgetbv(0) & 0xe6) != 0xe6)
+        return 0;
+
+    __cpuidex(cpu_info, 7, 0);
+    // check AVX512F AVX512DQ AVX512CD AVX512BW AVX512VL
+    return (cpu_info[1] & 0x00010000) && (cpu_info[1] & 0x00020000) && (cpu_info[1] & 0x10000000) && (cpu_info[1] & 0x40000000) && (cpu_info[1] & 0x80000000);
+#elif defined(__clang__)
+#if __clang_major__ >= 6
+    __builtin_cpu_init();
+#endif
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl");
+#elif defined(__GNUC__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl");
+#else
+    // TODO: other x86 compilers checking avx512 here
+    NCNN_LOGE("AVX512 detection method is unknown for current compiler");
+    return 0;
+#endif
+#else
+    return 0;
+#endif
+}
+
+int cpu_support_x86_avx512_vnni()
+{
+#if (_M_AMD64 || __x86_64__) || (_M_IX86 || __i386__)
+    if (!cpu_support_x86_avx512())
+        return 0;
+
+#if defined(_MSC_VER)
+    int cpu_info[4];
+    __cpuidex(cpu_info, 7, 0);
+    return cpu_info[2] & 0x00000800;
+#elif defined(__clang__)
+#if __clang_major__ >= 8
+    return __builtin_cpu_supports("avx512vnni");
+#else
+    return 0;
+#endif
+#elif defined(__GNUC__)
+    return __builtin_cpu_supports("avx512vnni");
+#else
+    // TODO: other x86 compilers checking avx512vnni here
+    NCNN_LOGE("AVX512VNNI detection method is unknown for current compiler");
+    return 0;
+#endif
+#else
+    return 0;
+#endif
+}
+
 static int get_cpucount()
 {
     int count = 0;
@@ -378,6 +447,42 @@ int get_cpu_count()
     return g_cpucount;
 }
 
+int get_cpu_isa_key()
+{
+    int key = (int)sizeof(void*) << 24;
+#if __SSE2__
+    key |= 1 << 0;
+#endif
+#if __AVX__
+    key |= 1 << 1;
+#endif
+#if __AVX2__
+    key |= 1 << 2;
+#endif
+#if __F16C__
+    key |= 1 << 3;
+#endif
+#if __ARM_NEON
+    key |= 1 << 4;
+#endif
+#if __aarch64__
+    key |= 1 << 5;
+#endif
+#if NCNN_AVX2
+    if (cpu_support_x86_avx2()) key |= 1 << 6;
+#endif
+#if NCNN_ARM82
+    if (cpu_support_arm_asimdhp()) key |= 1 << 7;
+#endif
+#if NCNN_AVX512
+    if (cpu_support_x86_avx512()) key |= 1 << 8;
+#endif
+#if NCNN_AVX512VNNI
+    if (cpu_support_x86_avx512_vnni()) key |= 1 << 9;
+#endif
+    return key;
+}
+
 #if defined __ANDROID__ || defined __linux__
 static int get_max_freq_khz(int cpuid)
 {
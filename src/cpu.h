@@ -49,10 +49,18 @@ int cpu_support_arm_asimdhp();
 
 // avx2 = x86_64 avx2 + fma + f16c
 int cpu_support_x86_avx2();
+// avx512 = x86_64 avx512f + avx512cd + avx512bw + avx512dq + avx512vl
+int cpu_support_x86_avx512();
+// avx512vnni = x86_64 avx512 + avx512vnni
+int cpu_support_x86_avx512_vnni();
 
 // cpu info
 int get_cpu_count();
 
+// compiled and detected isa bits with the pointer size in the top byte
+// data tied to the kernels one build picks on one kind of cpu is keyed by it
+int get_cpu_isa_key();
+
 // bind all threads on little clusters if powersave enabled
 // affacts HMP arch cpu like ARM big.LITTLE
 // only implemented on android at the moment
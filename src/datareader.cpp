@@ -14,8 +14,21 @@
 
 #include "datareader.h"
 
+#include <stdio.h>
 #include <string.h>
 
+#if NCNN_STDIO
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+#endif // NCNN_STDIO
+
 namespace ncnn {
 
 DataReader::~DataReader()
@@ -27,6 +40,163 @@ int DataReader::scan(const char* /*format*/, void* /*p*/) const
 {
     return 0;
 }
+
+// the plain param loader only asks for a handful of formats
+// they are parsed by hand below, without format string interpretation,
+// temporary allocation or strlen over the whole remaining text
+enum
+{
+    SCAN_FORMAT_UNKNOWN = 0,
+    SCAN_FORMAT_INT = 1,          // %d
+    SCAN_FORMAT_INT_ASSIGN = 2,   // %d=
+    SCAN_FORMAT_STRING = 3,       // %Ns
+    SCAN_FORMAT_ARRAY_ELEMENT = 4 // ,%15[^,\n ]
+};
+
+// scan_memory result for formats left to sscanf
+#define SCAN_NOT_HANDLED -2
+
+static int resolve_scan_format(const char* format, int* width)
+{
+    if (format[0] == '%' && format[1] == 'd')
+    {
+        if (format[2] == '\0')
+            return SCAN_FORMAT_INT;
+
+        if (format[2] == '=' && format[3] == '\0')
+            return SCAN_FORMAT_INT_ASSIGN;
+
+        return SCAN_FORMAT_UNKNOWN;
+    }
+
+    if (format[0] == '%' && format[1] >= '1' && format[1] <= '9')
+    {
+        int n = 0;
+        const char* f = format + 1;
+        while (*f >= '0' && *f <= '9')
+        {
+            n = n * 10 + (*f - '0');
+            f++;
+        }
+
+        if (f[0] == 's' && f[1] == '\0')
+        {
+            *width = n;
+            return SCAN_FORMAT_STRING;
+        }
+
+        return SCAN_FORMAT_UNKNOWN;
+    }
+
+    if (strcmp(format, ",%15[^,\n ]") == 0)
+    {
+        *width = 15;
+        return SCAN_FORMAT_ARRAY_ELEMENT;
+    }
+
+    return SCAN_FORMAT_UNKNOWN;
+}
+
+static inline bool is_scan_space(int c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline bool is_scan_digit(int c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// scan null-terminated text, advance mem only on success like sscanf with %n
+// except that %d= consumes the digits even if = does not follow
+// results match scan_stdio over the same text
+// return 1 if scan success, EOF at end of text, SCAN_NOT_HANDLED if format not handled
+static int scan_memory(const char* format, void* p, const unsigned char*& mem)
+{
+    int width = 0;
+    int type = resolve_scan_format(format, &width);
+    if (type == SCAN_FORMAT_UNKNOWN)
+        return SCAN_NOT_HANDLED;
+
+    const char* s = (const char*)mem;
+
+    if (type == SCAN_FORMAT_INT || type == SCAN_FORMAT_INT_ASSIGN)
+    {
+        while (is_scan_space(*s))
+            s++;
+
+        if (*s == '\0')
+            return EOF;
+
+        bool negative = *s == '-';
+        if (*s == '+' || *s == '-')
+            s++;
+
+        if (!is_scan_digit(*s))
+            return 0;
+
+        unsigned int v = 0;
+        while (is_scan_digit(*s))
+        {
+            v = v * 10 + (*s - '0');
+            s++;
+        }
+
+        *(int*)p = negative ? -(int)v : (int)v;
+
+        if (type == SCAN_FORMAT_INT_ASSIGN)
+        {
+            // digits without = are consumed and reported as no match, the same as scan_stdio
+            if (*s != '=')
+            {
+                mem = (const unsigned char*)s;
+                return 0;
+            }
+            s++;
+        }
+    }
+    else if (type == SCAN_FORMAT_STRING)
+    {
+        while (is_scan_space(*s))
+            s++;
+
+        if (*s == '\0')
+            return EOF;
+
+        char* outptr = (char*)p;
+        int len = 0;
+        while (len < width && *s != '\0' && !is_scan_space(*s))
+        {
+            outptr[len++] = *s++;
+        }
+
+        if (len == 0)
+            return 0;
+
+        outptr[len] = '\0';
+    }
+    else // if (type == SCAN_FORMAT_ARRAY_ELEMENT)
+    {
+        if (*s != ',')
+            return *s == '\0' ? EOF : 0;
+        s++;
+
+        char* outptr = (char*)p;
+        int len = 0;
+        while (len < width && *s != '\0' && *s != ',' && *s != '\n' && *s != ' ')
+        {
+            outptr[len++] = *s++;
+        }
+
+        if (len == 0)
+            return 0;
+
+        outptr[len] = '\0';
+    }
+
+    mem = (const unsigned char*)s;
+    return 1;
+}
 #endif // NCNN_STRING
 
 size_t DataReader::read(void* /*buf*/, size_t /*size*/) const
@@ -34,6 +204,11 @@ size_t DataReader::read(void* /*buf*/, size_t /*size*/) const
     return 0;
 }
 
+size_t DataReader::reference(size_t /*size*/, const void** /*buf*/) const
+{
+    return 0;
+}
+
 #if NCNN_STDIO
 DataReaderFromStdio::DataReaderFromStdio(FILE* _fp)
     : fp(_fp)
@@ -41,9 +216,120 @@ DataReaderFromStdio::DataReaderFromStdio(FILE* _fp)
 }
 
 #if NCNN_STRING
+#if defined _WIN32 || defined __EMSCRIPTEN__
+#define NCNN_LOCKFILE(fp)
+#define NCNN_UNLOCKFILE(fp)
+#define NCNN_GETC(fp) getc(fp)
+#else
+#define NCNN_LOCKFILE(fp)   flockfile(fp)
+#define NCNN_UNLOCKFILE(fp) funlockfile(fp)
+#define NCNN_GETC(fp)       getc_unlocked(fp)
+#endif
+
+// scan stream like fscanf, at most one char is pushed back
+static int scan_stdio(int type, int width, void* p, FILE* fp)
+{
+    int c = NCNN_GETC(fp);
+
+    if (type == SCAN_FORMAT_INT || type == SCAN_FORMAT_INT_ASSIGN)
+    {
+        while (is_scan_space(c))
+            c = NCNN_GETC(fp);
+
+        bool negative = c == '-';
+        if (c == '+' || c == '-')
+            c = NCNN_GETC(fp);
+
+        if (!is_scan_digit(c))
+        {
+            if (c != EOF)
+                ungetc(c, fp);
+            return c == EOF ? EOF : 0;
+        }
+
+        unsigned int v = 0;
+        while (is_scan_digit(c))
+        {
+            v = v * 10 + (c - '0');
+            c = NCNN_GETC(fp);
+        }
+
+        // the value is assigned even if the literal does not match
+        *(int*)p = negative ? -(int)v : (int)v;
+
+        if (c != EOF && !(type == SCAN_FORMAT_INT_ASSIGN && c == '='))
+            ungetc(c, fp);
+
+        // digits without = are consumed and reported as no match, the same as scan_memory
+        if (type == SCAN_FORMAT_INT_ASSIGN && c != '=')
+            return 0;
+
+        return 1;
+    }
+
+    if (type == SCAN_FORMAT_STRING)
+    {
+        while (is_scan_space(c))
+            c = NCNN_GETC(fp);
+
+        if (c == EOF)
+            return EOF;
+
+        char* outptr = (char*)p;
+        int len = 0;
+        while (len < width && c != EOF && !is_scan_space(c))
+        {
+            outptr[len++] = (char)c;
+            c = NCNN_GETC(fp);
+        }
+
+        if (c != EOF)
+            ungetc(c, fp);
+
+        outptr[len] = '\0';
+        return 1;
+    }
+
+    // if (type == SCAN_FORMAT_ARRAY_ELEMENT)
+    if (c != ',')
+    {
+        if (c != EOF)
+            ungetc(c, fp);
+        return c == EOF ? EOF : 0;
+    }
+
+    c = NCNN_GETC(fp);
+
+    char* outptr = (char*)p;
+    int len = 0;
+    while (len < width && c != EOF && c != ',' && c != '\n' && c != ' ')
+    {
+        outptr[len++] = (char)c;
+        c = NCNN_GETC(fp);
+    }
+
+    if (c != EOF)
+        ungetc(c, fp);
+
+    if (len == 0)
+        return 0;
+
+    outptr[len] = '\0';
+    return 1;
+}
+
 int DataReaderFromStdio::scan(const char* format, void* p) const
 {
-    return fscanf(fp, format, p);
+    int width = 0;
+    int type = resolve_scan_format(format, &width);
+    if (type == SCAN_FORMAT_UNKNOWN)
+        return fscanf(fp, format, p);
+
+    NCNN_LOCKFILE(fp);
+    int nscan = scan_stdio(type, width, p, fp);
+    NCNN_UNLOCKFILE(fp);
+
+    return nscan;
 }
 #endif // NCNN_STRING
 
@@ -61,6 +347,10 @@ DataReaderFromMemory::DataReaderFromMemory(const unsigned char*& _mem)
 #if NCNN_STRING
 int DataReaderFromMemory::scan(const char* format, void* p) const
 {
+    int nscan0 = scan_memory(format, p, mem);
+    if (nscan0 != SCAN_NOT_HANDLED)
+        return nscan0;
+
     size_t fmtlen = strlen(format);
 
     char* format_with_n = new char[fmtlen + 4];
@@ -83,6 +373,153 @@ size_t DataReaderFromMemory::read(void* buf, size_t size) const
     return size;
 }
 
+size_t DataReaderFromMemory::reference(size_t size, const void** buf) const
+{
+    *buf = mem;
+    mem += size;
+    return size;
+}
+
+#if NCNN_STDIO
+DataReaderFromMmap::DataReaderFromMmap(const char* path)
+    : addr(0), size(0), offset(0), modify_time(0)
+{
+#ifdef _WIN32
+    file = INVALID_HANDLE_VALUE;
+    mapping = 0;
+
+    HANDLE hfile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hfile == INVALID_HANDLE_VALUE)
+    {
+        NCNN_LOGE("CreateFile %s failed", path);
+        return;
+    }
+
+    LARGE_INTEGER filesize;
+    if (!GetFileSizeEx(hfile, &filesize) || filesize.QuadPart == 0)
+    {
+        NCNN_LOGE("GetFileSizeEx %s failed", path);
+        CloseHandle(hfile);
+        return;
+    }
+
+    FILETIME filetime;
+    if (GetFileTime(hfile, NULL, NULL, &filetime))
+    {
+        modify_time = ((long long)filetime.dwHighDateTime << 32) | filetime.dwLowDateTime;
+    }
+
+    HANDLE hmapping = CreateFileMappingA(hfile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (!hmapping)
+    {
+        NCNN_LOGE("CreateFileMapping %s failed", path);
+        CloseHandle(hfile);
+        return;
+    }
+
+    void* p = MapViewOfFile(hmapping, FILE_MAP_COPY, 0, 0, 0);
+    if (!p)
+    {
+        NCNN_LOGE("MapViewOfFile %s failed", path);
+        CloseHandle(hmapping);
+        CloseHandle(hfile);
+        return;
+    }
+
+    file = hfile;
+    mapping = hmapping;
+    addr = (unsigned char*)p;
+    size = (size_t)filesize.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        NCNN_LOGE("open %s failed", path);
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        NCNN_LOGE("fstat %s failed", path);
+        close(fd);
+        return;
+    }
+
+    modify_time = (long long)st.st_mtime;
+
+    // private writable mapping, pages stay shared across processes
+    // until some layer writes to its weight data in place
+    void* p = mmap(0, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+    // the mapping holds its own reference to the file
+    close(fd);
+
+    if (p == MAP_FAILED)
+    {
+        NCNN_LOGE("mmap %s failed", path);
+        return;
+    }
+
+    addr = (unsigned char*)p;
+    size = (size_t)st.st_size;
+#endif // _WIN32
+}
+
+DataReaderFromMmap::~DataReaderFromMmap()
+{
+#ifdef _WIN32
+    if (addr)
+        UnmapViewOfFile(addr);
+    if (mapping)
+        CloseHandle((HANDLE)mapping);
+    if (file != INVALID_HANDLE_VALUE)
+        CloseHandle((HANDLE)file);
+#else
+    if (addr)
+        munmap(addr, size);
+#endif // _WIN32
+}
+
+bool DataReaderFromMmap::empty() const
+{
+    return addr == 0;
+}
+
+long long DataReaderFromMmap::mtime() const
+{
+    return modify_time;
+}
+
+const unsigned char* DataReaderFromMmap::mapped_data() const
+{
+    return addr;
+}
+
+size_t DataReaderFromMmap::read(void* buf, size_t _size) const
+{
+    size_t nread = offset + _size > size ? size - offset : _size;
+    memcpy(buf, addr + offset, nread);
+    offset += nread;
+    return nread;
+}
+
+size_t DataReaderFromMmap::reference(size_t _size, const void** buf) const
+{
+    if (offset + _size > size)
+        return 0;
+
+    // weight data is referenced at its file offset, which the model format keeps 4 byte aligned
+    // layers load untransformed weight data unaligned, anything below float alignment is copied by the caller
+    if ((offset & 3) != 0)
+        return 0;
+
+    *buf = addr + offset;
+    offset += _size;
+    return _size;
+}
+#endif // NCNN_STDIO
+
 #if __ANDROID_API__ >= 9
 DataReaderFromAndroidAsset::DataReaderFromAndroidAsset(AAsset* _asset)
     : asset(_asset), mem(0)
@@ -99,6 +536,16 @@ int DataReaderFromAndroidAsset::scan(const char* format, void* p) const
         mem += pos;
     }
 
+    const unsigned char* mem0 = mem;
+    int nscan0 = scan_memory(format, p, mem);
+    if (nscan0 != SCAN_NOT_HANDLED)
+    {
+        if (mem != mem0)
+            AAsset_seek(asset, (off_t)(mem - mem0), SEEK_CUR);
+
+        return nscan0;
+    }
+
     int fmtlen = strlen(format);
 
     char* format_with_n = new char[fmtlen + 3];
@@ -41,6 +41,11 @@ public:
     // read binary param and model data
     // return bytes read
     virtual size_t read(void* buf, size_t size) const;
+
+    // get model data reference without copy
+    // the referenced memory must outlive the loaded net
+    // return bytes referenced, 0 if not supported
+    virtual size_t reference(size_t size, const void** buf) const;
 };
 
 #if NCNN_STDIO
@@ -68,11 +73,48 @@ public:
     virtual int scan(const char* format, void* p) const;
 #endif // NCNN_STRING
     virtual size_t read(void* buf, size_t size) const;
+    virtual size_t reference(size_t size, const void** buf) const;
 
 protected:
     const unsigned char*& mem;
 };
 
+#if NCNN_STDIO
+class DataReaderFromMmap : public DataReader
+{
+public:
+    // map the whole file into memory with copy-on-write pages
+    // check empty() for mapping failure
+    DataReaderFromMmap(const char* path);
+    virtual ~DataReaderFromMmap();
+
+    bool empty() const;
+
+    // last modification time of the mapped file
+    long long mtime() const;
+
+    // the whole mapped file
+    const unsigned char* mapped_data() const;
+
+    virtual size_t read(void* buf, size_t size) const;
+    virtual size_t reference(size_t size, const void** buf) const;
+
+protected:
+    unsigned char* addr;
+    size_t size;
+    mutable size_t offset;
+    long long modify_time;
+#ifdef _WIN32
+    void* file;
+    void* mapping;
+#endif
+
+private:
+    DataReaderFromMmap(const DataReaderFromMmap&);
+    DataReaderFromMmap& operator=(const DataReaderFromMmap&);
+};
+#endif // NCNN_STDIO
+
 #if __ANDROID_API__ >= 9
 class DataReaderFromAndroidAsset : public DataReader
 {
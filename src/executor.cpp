@@ -0,0 +1,893 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "executor.h"
+
+#include "net.h"
+
+#include <algorithm>
+#include <limits.h>
+
+namespace ncnn {
+
+// shared by the executor and all futures of one request
+class ExtractTask
+{
+public:
+    ExtractTask()
+        : refcount(1), finished(false), ret(0), callback(0), userdata(0)
+    {
+    }
+
+    int refcount;
+
+    Mutex lock;
+    ConditionVariable condition;
+    bool finished;
+    int ret;
+
+    std::vector<int> input_blob_indexes;
+    std::vector<Mat> inputs;
+    std::vector<int> output_blob_indexes;
+    std::vector<Mat> outputs;
+
+    extract_callback callback;
+    void* userdata;
+};
+
+static void task_addref(ExtractTask* task)
+{
+    if (task)
+        NCNN_XADD(&task->refcount, 1);
+}
+
+static void task_release(ExtractTask* task)
+{
+    if (task && NCNN_XADD(&task->refcount, -1) == 1)
+        delete task;
+}
+
+static void task_finish(ExtractTask* task, int ret)
+{
+    // inputs are no longer needed
+    task->inputs.clear();
+
+    if (task->callback)
+        task->callback(ret, task->outputs, task->userdata);
+
+    MutexLockGuard guard(task->lock);
+    task->ret = ret;
+    task->finished = true;
+    task->condition.broadcast();
+}
+
+ExtractFuture::ExtractFuture()
+    : task(0)
+{
+}
+
+ExtractFuture::ExtractFuture(ExtractTask* _task)
+    : task(_task)
+{
+    task_addref(task);
+}
+
+ExtractFuture::ExtractFuture(const ExtractFuture& f)
+    : task(f.task)
+{
+    task_addref(task);
+}
+
+ExtractFuture& ExtractFuture::operator=(const ExtractFuture& f)
+{
+    if (this == &f)
+        return *this;
+
+    task_addref(f.task);
+    task_release(task);
+    task = f.task;
+
+    return *this;
+}
+
+ExtractFuture::~ExtractFuture()
+{
+    task_release(task);
+}
+
+bool ExtractFuture::valid() const
+{
+    return task != 0;
+}
+
+bool ExtractFuture::ready() const
+{
+    if (!task)
+        return false;
+
+    MutexLockGuard guard(task->lock);
+    return task->finished;
+}
+
+int ExtractFuture::wait() const
+{
+    if (!task)
+        return -1;
+
+    MutexLockGuard guard(task->lock);
+    while (!task->finished)
+    {
+        task->condition.wait(task->lock);
+    }
+
+    return task->ret;
+}
+
+int ExtractFuture::get(std::vector<Mat>& outputs) const
+{
+    int ret = wait();
+    if (ret != 0)
+        return ret;
+
+    outputs = task->outputs;
+
+    return 0;
+}
+
+Executor::Executor(const Net* _net, int worker_count, int _max_pending)
+    : net(_net), max_pending(_max_pending), num_threads(_net->opt.num_threads), stop(false)
+{
+    if (max_pending < 1)
+        max_pending = 1;
+
+    // no worker would ever take a request
+    if (worker_count < 1)
+        worker_count = 1;
+
+#if NCNN_THREADS
+    for (int i = 0; i < worker_count; i++)
+    {
+        workers.push_back(new Thread(worker_entry, (void*)this));
+    }
+#else
+    (void)worker_count;
+#endif // NCNN_THREADS
+}
+
+Executor::~Executor()
+{
+    {
+        MutexLockGuard guard(lock);
+        stop = true;
+        not_empty.broadcast();
+        not_full.broadcast();
+    }
+
+    cancel_all();
+
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i]->join();
+        delete workers[i];
+    }
+    workers.clear();
+}
+
+void Executor::set_num_threads(int _num_threads)
+{
+    MutexLockGuard guard(lock);
+    num_threads = _num_threads;
+}
+
+ExtractFuture Executor::extract_async(const std::vector<int>& input_blob_indexes, const std::vector<Mat>& inputs, const std::vector<int>& output_blob_indexes, extract_callback callback, void* userdata)
+{
+    return submit(input_blob_indexes, inputs, output_blob_indexes, callback, userdata, true);
+}
+
+ExtractFuture Executor::try_extract_async(const std::vector<int>& input_blob_indexes, const std::vector<Mat>& inputs, const std::vector<int>& output_blob_indexes, extract_callback callback, void* userdata)
+{
+    return submit(input_blob_indexes, inputs, output_blob_indexes, callback, userdata, false);
+}
+
+#if NCNN_STRING
+int Executor::find_blob_indexes(const std::vector<const char*>& names, std::vector<int>& indexes) const
+{
+    indexes.resize(names.size());
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        indexes[i] = net->find_blob_index_by_name(names[i]);
+        if (indexes[i] == -1)
+        {
+            NCNN_LOGE("Executor blob %s not exists", names[i]);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+ExtractFuture Executor::extract_async(const std::vector<const char*>& input_blob_names, const std::vector<Mat>& inputs, const std::vector<const char*>& output_blob_names, extract_callback callback, void* userdata)
+{
+    std::vector<int> input_blob_indexes;
+    std::vector<int> output_blob_indexes;
+    if (find_blob_indexes(input_blob_names, input_blob_indexes) != 0 || find_blob_indexes(output_blob_names, output_blob_indexes) != 0)
+        return ExtractFuture();
+
+    return submit(input_blob_indexes, inputs, output_blob_indexes, callback, userdata, true);
+}
+
+ExtractFuture Executor::try_extract_async(const std::vector<const char*>& input_blob_names, const std::vector<Mat>& inputs, const std::vector<const char*>& output_blob_names, extract_callback callback, void* userdata)
+{
+    std::vector<int> input_blob_indexes;
+    std::vector<int> output_blob_indexes;
+    if (find_blob_indexes(input_blob_names, input_blob_indexes) != 0 || find_blob_indexes(output_blob_names, output_blob_indexes) != 0)
+        return ExtractFuture();
+
+    return submit(input_blob_indexes, inputs, output_blob_indexes, callback, userdata, false);
+}
+#endif // NCNN_STRING
+
+int Executor::cancel(const ExtractFuture& future)
+{
+    ExtractTask* task = future.task;
+    if (!task)
+        return -1;
+
+    {
+        MutexLockGuard guard(lock);
+
+        size_t i = 0;
+        for (; i < queue.size(); i++)
+        {
+            if (queue[i] == task)
+                break;
+        }
+
+        if (i == queue.size())
+            return -1;
+
+        queue.erase(queue.begin() + i);
+        not_full.signal();
+    }
+
+    task_finish(task, -2);
+    task_release(task);
+
+    return 0;
+}
+
+void Executor::cancel_all()
+{
+    std::vector<ExtractTask*> cancelled;
+    {
+        MutexLockGuard guard(lock);
+        cancelled.swap(queue);
+        not_full.broadcast();
+    }
+
+    for (size_t i = 0; i < cancelled.size(); i++)
+    {
+        task_finish(cancelled[i], -2);
+        task_release(cancelled[i]);
+    }
+}
+
+int Executor::pending() const
+{
+    MutexLockGuard guard(lock);
+    return (int)queue.size();
+}
+
+ExtractFuture Executor::submit(const std::vector<int>& input_blob_indexes, const std::vector<Mat>& inputs, const std::vector<int>& output_blob_indexes, extract_callback callback, void* userdata, bool blocking)
+{
+    if (input_blob_indexes.size() != inputs.size())
+    {
+        NCNN_LOGE("input blob count %d and input count %d mismatch", (int)input_blob_indexes.size(), (int)inputs.size());
+        return ExtractFuture();
+    }
+
+    ExtractTask* task = new ExtractTask;
+    task->input_blob_indexes = input_blob_indexes;
+    task->inputs = inputs;
+    task->output_blob_indexes = output_blob_indexes;
+    task->outputs.resize(output_blob_indexes.size());
+    task->callback = callback;
+    task->userdata = userdata;
+
+    // the future takes its own reference, the executor keeps the initial one until the task is done
+    ExtractFuture future(task);
+
+#if NCNN_THREADS
+    {
+        MutexLockGuard guard(lock);
+
+        // back-pressure
+        while (!stop && blocking && (int)queue.size() >= max_pending)
+        {
+            not_full.wait(lock);
+        }
+
+        if (stop || (int)queue.size() >= max_pending)
+        {
+            task_release(task);
+            return ExtractFuture();
+        }
+
+        queue.push_back(task);
+        not_empty.signal();
+    }
+#else
+    (void)blocking;
+
+    // no worker thread, run on the caller
+    run(task);
+    task_release(task);
+#endif // NCNN_THREADS
+
+    return future;
+}
+
+void Executor::run(ExtractTask* task) const
+{
+    int _num_threads;
+    {
+        MutexLockGuard guard(lock);
+        _num_threads = num_threads;
+    }
+
+    Extractor* ex = net->acquire_extractor();
+    ex->set_num_threads(_num_threads);
+
+    int ret = 0;
+    for (size_t i = 0; i < task->inputs.size(); i++)
+    {
+        ret = ex->input(task->input_blob_indexes[i], task->inputs[i]);
+        if (ret != 0)
+            break;
+    }
+
+    for (size_t i = 0; ret == 0 && i < task->output_blob_indexes.size(); i++)
+    {
+        ret = ex->extract(task->output_blob_indexes[i], task->outputs[i]);
+    }
+
+    net->release_extractor(ex);
+
+    task_finish(task, ret);
+}
+
+void* Executor::worker_entry(void* args)
+{
+    ((Executor*)args)->worker();
+    return 0;
+}
+
+void Executor::worker()
+{
+    for (;;)
+    {
+        ExtractTask* task = 0;
+        {
+            MutexLockGuard guard(lock);
+
+            while (!stop && queue.empty())
+            {
+                not_empty.wait(lock);
+            }
+
+            if (queue.empty())
+                break;
+
+            task = queue.front();
+            queue.erase(queue.begin());
+            not_full.signal();
+        }
+
+        run(task);
+        task_release(task);
+    }
+}
+
+// blobs of one frame in flight, indexed by blob index
+class PipelineFrame
+{
+public:
+    PipelineFrame()
+        : ret(0)
+    {
+    }
+
+    std::vector<Mat> blobs;
+    int ret;
+};
+
+// bounded fifo between two stages, a null frame marks the end of stream
+class PipelineQueue
+{
+public:
+    PipelineQueue(int _capacity)
+        : capacity(_capacity), closed(false), aborted(false)
+    {
+    }
+
+    ~PipelineQueue()
+    {
+        for (size_t i = 0; i < frames.size(); i++)
+        {
+            delete frames[i];
+        }
+    }
+
+    // the end of stream never waits for room
+    // return -1 if aborted, or if closed before the frame got in
+    int push(PipelineFrame* frame)
+    {
+        MutexLockGuard guard(lock);
+
+        while (!aborted && !closed && frame && (int)frames.size() >= capacity)
+        {
+            not_full.wait(lock);
+        }
+
+        if (aborted || (closed && frame))
+            return -1;
+
+        frames.push_back(frame);
+        not_empty.signal();
+
+        return 0;
+    }
+
+    // append the end of stream and refuse further frames, never waits for room
+    // return -1 if already closed or aborted
+    int close()
+    {
+        MutexLockGuard guard(lock);
+
+        if (aborted || closed)
+            return -1;
+
+        closed = true;
+        frames.push_back(0);
+        not_empty.signal();
+        not_full.broadcast();
+
+        return 0;
+    }
+
+    // return -1 if aborted
+    int pop(PipelineFrame*& frame)
+    {
+        MutexLockGuard guard(lock);
+
+        while (!aborted && frames.empty())
+        {
+            not_empty.wait(lock);
+        }
+
+        if (aborted)
+            return -1;
+
+        frame = frames.front();
+        frames.erase(frames.begin());
+        not_full.signal();
+
+        return 0;
+    }
+
+    // wake up and fail all waiters
+    void abort()
+    {
+        MutexLockGuard guard(lock);
+        aborted = true;
+        not_empty.broadcast();
+        not_full.broadcast();
+    }
+
+private:
+    int capacity;
+    bool closed;
+    bool aborted;
+
+    Mutex lock;
+    ConditionVariable not_empty;
+    ConditionVariable not_full;
+    std::vector<PipelineFrame*> frames;
+};
+
+PipelineExecutor::PipelineExecutor(const Net* _net, const std::vector<int>& _input_blob_indexes, const std::vector<int>& _output_blob_indexes, const std::vector<int>& stage_layer_begins, int max_pending)
+    : net(_net), input_blob_indexes(_input_blob_indexes), output_blob_indexes(_output_blob_indexes), drained(false)
+{
+    init(stage_layer_begins, max_pending);
+}
+
+#if NCNN_STRING
+PipelineExecutor::PipelineExecutor(const Net* _net, const std::vector<const char*>& input_blob_names, const std::vector<const char*>& output_blob_names, const std::vector<const char*>& stage_first_layer_names, int max_pending)
+    : net(_net), drained(false)
+{
+    input_blob_indexes.resize(input_blob_names.size());
+    for (size_t i = 0; i < input_blob_names.size(); i++)
+    {
+        input_blob_indexes[i] = net->find_blob_index_by_name(input_blob_names[i]);
+        if (input_blob_indexes[i] == -1)
+            return;
+    }
+
+    output_blob_indexes.resize(output_blob_names.size());
+    for (size_t i = 0; i < output_blob_names.size(); i++)
+    {
+        output_blob_indexes[i] = net->find_blob_index_by_name(output_blob_names[i]);
+        if (output_blob_indexes[i] == -1)
+            return;
+    }
+
+    std::vector<int> stage_layer_begins(stage_first_layer_names.size());
+    for (size_t i = 0; i < stage_first_layer_names.size(); i++)
+    {
+        stage_layer_begins[i] = net->find_layer_index_by_name(stage_first_layer_names[i]);
+        if (stage_layer_begins[i] == -1)
+            return;
+    }
+
+    init(stage_layer_begins, max_pending);
+}
+#endif // NCNN_STRING
+
+void PipelineExecutor::init(const std::vector<int>& stage_layer_begins, int max_pending)
+{
+    const int layer_count = (int)net->layers.size();
+    const int blob_count = (int)net->blobs.size();
+
+    for (size_t i = 0; i < input_blob_indexes.size() + output_blob_indexes.size(); i++)
+    {
+        int blob_index = i < input_blob_indexes.size() ? input_blob_indexes[i] : output_blob_indexes[i - input_blob_indexes.size()];
+        if (blob_index < 0 || blob_index >= blob_count)
+        {
+            NCNN_LOGE("PipelineExecutor invalid blob index %d", blob_index);
+            return;
+        }
+    }
+
+    std::vector<int> cuts(1, 0);
+    for (size_t i = 0; i < stage_layer_begins.size(); i++)
+    {
+        int begin = stage_layer_begins[i];
+        if (begin <= cuts.back() || begin >= layer_count)
+        {
+            NCNN_LOGE("PipelineExecutor invalid stage begin %d", begin);
+            return;
+        }
+
+        cuts.push_back(begin);
+    }
+    cuts.push_back(layer_count);
+
+    const int stage_count = (int)cuts.size() - 1;
+
+    // where each blob becomes available and where it is needed for the last time
+    // user inputs are available before the first layer, user outputs are needed after the last one
+    std::vector<int> produced(blob_count);
+    std::vector<int> last_use(blob_count, -1);
+    for (int i = 0; i < blob_count; i++)
+    {
+        const Blob& blob = net->blobs[i];
+
+        produced[i] = blob.producer;
+        for (size_t j = 0; j < blob.consumers.size(); j++)
+        {
+            last_use[i] = std::max(last_use[i], blob.consumers[j]);
+        }
+    }
+    for (size_t i = 0; i < input_blob_indexes.size(); i++)
+    {
+        produced[input_blob_indexes[i]] = -1;
+    }
+    for (size_t i = 0; i < output_blob_indexes.size(); i++)
+    {
+        last_use[output_blob_indexes[i]] = layer_count;
+    }
+
+    stage_extract_blobs.resize(stage_count);
+    stage_keep_blobs.resize(stage_count);
+    for (int s = 0; s < stage_count; s++)
+    {
+        const int begin = cuts[s];
+        const int end = cuts[s + 1];
+
+        for (int i = 0; i < blob_count; i++)
+        {
+            // alive across the cut at the stage end
+            if (produced[i] < end && last_use[i] >= end)
+            {
+                stage_keep_blobs[s].push_back(i);
+
+                if (produced[i] >= begin)
+                    stage_extract_blobs[s].push_back(i);
+            }
+        }
+
+        // extract in producer order, so that no blob is consumed before it is taken
+        for (size_t i = 1; i < stage_extract_blobs[s].size(); i++)
+        {
+            for (size_t j = i; j > 0 && produced[stage_extract_blobs[s][j - 1]] > produced[stage_extract_blobs[s][j]]; j--)
+            {
+                std::swap(stage_extract_blobs[s][j - 1], stage_extract_blobs[s][j]);
+            }
+        }
+    }
+
+    stage_num_threads.resize(stage_count, net->opt.num_threads);
+    stage_affinity.resize(stage_count);
+    stage_affinity_dirty.resize(stage_count, 0);
+
+    if (max_pending < 1)
+        max_pending = 1;
+
+    for (int s = 0; s < stage_count; s++)
+    {
+        queues.push_back(new PipelineQueue(max_pending));
+    }
+
+#if NCNN_THREADS
+    queues.push_back(new PipelineQueue(max_pending));
+
+    stage_args.resize(stage_count);
+    for (int s = 0; s < stage_count; s++)
+    {
+        stage_args[s].executor = this;
+        stage_args[s].stage = s;
+        stage_threads.push_back(new Thread(stage_entry, (void*)&stage_args[s]));
+    }
+#else
+    // no stage thread, frames run on push and wait for pop
+    queues.push_back(new PipelineQueue(INT_MAX));
+#endif // NCNN_THREADS
+}
+
+PipelineExecutor::~PipelineExecutor()
+{
+    for (size_t i = 0; i < queues.size(); i++)
+    {
+        queues[i]->abort();
+    }
+
+    for (size_t i = 0; i < stage_threads.size(); i++)
+    {
+        stage_threads[i]->join();
+        delete stage_threads[i];
+    }
+    stage_threads.clear();
+
+    for (size_t i = 0; i < queues.size(); i++)
+    {
+        delete queues[i];
+    }
+    queues.clear();
+}
+
+int PipelineExecutor::stage_count() const
+{
+    return (int)stage_extract_blobs.size();
+}
+
+void PipelineExecutor::set_num_threads(int stage, int num_threads)
+{
+    if (stage < 0 || stage >= stage_count())
+        return;
+
+    MutexLockGuard guard(lock);
+    stage_num_threads[stage] = num_threads;
+}
+
+void PipelineExecutor::set_cpu_affinity(int stage, const CpuSet& thread_affinity_mask)
+{
+    if (stage < 0 || stage >= stage_count())
+        return;
+
+    MutexLockGuard guard(lock);
+    stage_num_threads[stage] = thread_affinity_mask.num_enabled();
+    stage_affinity[stage] = thread_affinity_mask;
+    stage_affinity_dirty[stage] = 1;
+}
+
+int PipelineExecutor::push(const std::vector<Mat>& inputs)
+{
+    if (stage_count() == 0)
+        return -1;
+
+    if (inputs.size() != input_blob_indexes.size())
+    {
+        NCNN_LOGE("input blob count %d and input count %d mismatch", (int)input_blob_indexes.size(), (int)inputs.size());
+        return -1;
+    }
+
+    PipelineFrame* frame = new PipelineFrame;
+    frame->blobs.resize(net->blobs.size());
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        frame->blobs[input_blob_indexes[i]] = inputs[i];
+    }
+
+#if NCNN_THREADS
+    if (queues[0]->push(frame) != 0)
+    {
+        delete frame;
+        return -1;
+    }
+#else
+    for (int s = 0; s < stage_count() && frame->ret == 0; s++)
+    {
+        frame->ret = run_stage(s, frame);
+    }
+
+    if (queues.back()->push(frame) != 0)
+    {
+        delete frame;
+        return -1;
+    }
+#endif // NCNN_THREADS
+
+    return 0;
+}
+
+void PipelineExecutor::close()
+{
+    if (stage_count() == 0)
+        return;
+
+    // the first queue owns the closed state, so close may race with push from another thread
+#if NCNN_THREADS
+    queues[0]->close();
+#else
+    queues.back()->close();
+#endif // NCNN_THREADS
+}
+
+int PipelineExecutor::pop(std::vector<Mat>& outputs)
+{
+    if (stage_count() == 0)
+        return -1;
+
+    {
+        MutexLockGuard guard(lock);
+        if (drained)
+            return -1;
+    }
+
+    PipelineFrame* frame = 0;
+    if (queues.back()->pop(frame) != 0)
+        return -1;
+
+    if (!frame)
+    {
+        MutexLockGuard guard(lock);
+        drained = true;
+        return -1;
+    }
+
+    int ret = frame->ret;
+    if (ret == 0)
+    {
+        outputs.resize(output_blob_indexes.size());
+        for (size_t i = 0; i < output_blob_indexes.size(); i++)
+        {
+            outputs[i] = frame->blobs[output_blob_indexes[i]];
+        }
+    }
+
+    delete frame;
+
+    return ret;
+}
+
+int PipelineExecutor::run_stage(int stage, PipelineFrame* frame) const
+{
+    int num_threads;
+    {
+        MutexLockGuard guard(lock);
+        num_threads = stage_num_threads[stage];
+    }
+
+    Extractor* ex = net->acquire_extractor();
+    ex->set_num_threads(num_threads);
+
+    // feed every blob produced by earlier stages
+    int ret = 0;
+    for (size_t i = 0; i < frame->blobs.size(); i++)
+    {
+        if (frame->blobs[i].dims == 0)
+            continue;
+
+        ret = ex->input((int)i, frame->blobs[i]);
+        if (ret != 0)
+            break;
+    }
+
+    // blobs handed to later stages keep the packed layout and storage type, only user outputs are unpacked
+    const std::vector<int>& extract_blobs = stage_extract_blobs[stage];
+    for (size_t i = 0; ret == 0 && i < extract_blobs.size(); i++)
+    {
+        const int blob_index = extract_blobs[i];
+        const bool is_output = std::find(output_blob_indexes.begin(), output_blob_indexes.end(), blob_index) != output_blob_indexes.end();
+        ret = ex->extract(blob_index, frame->blobs[blob_index], is_output ? 0 : 1);
+    }
+
+    net->release_extractor(ex);
+
+    if (ret != 0)
+        return ret;
+
+    // drop blobs no later stage needs
+    const std::vector<int>& keep_blobs = stage_keep_blobs[stage];
+    std::vector<Mat> blobs(frame->blobs.size());
+    for (size_t i = 0; i < keep_blobs.size(); i++)
+    {
+        blobs[keep_blobs[i]] = frame->blobs[keep_blobs[i]];
+    }
+    frame->blobs.swap(blobs);
+
+    return 0;
+}
+
+void* PipelineExecutor::stage_entry(void* args)
+{
+    StageArgs* stage_args = (StageArgs*)args;
+    stage_args->executor->stage_worker(stage_args->stage);
+    return 0;
+}
+
+void PipelineExecutor::stage_worker(int stage)
+{
+    PipelineQueue* in_queue = queues[stage];
+    PipelineQueue* out_queue = queues[stage + 1];
+
+    for (;;)
+    {
+        PipelineFrame* frame = 0;
+        if (in_queue->pop(frame) != 0)
+            break;
+
+        if (frame && frame->ret == 0)
+        {
+            CpuSet affinity;
+            bool affinity_dirty = false;
+            {
+                MutexLockGuard guard(lock);
+                if (stage_affinity_dirty[stage])
+                {
+                    affinity = stage_affinity[stage];
+                    affinity_dirty = true;
+                    stage_affinity_dirty[stage] = 0;
+                }
+            }
+
+            if (affinity_dirty)
+                set_cpu_thread_affinity(affinity);
+
+            frame->ret = run_stage(stage, frame);
+        }
+
+        if (out_queue->push(frame) != 0)
+        {
+            delete frame;
+            break;
+        }
+
+        // end of stream
+        if (!frame)
+            break;
+    }
+}
+
+} // namespace ncnn
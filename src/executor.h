@@ -0,0 +1,217 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef NCNN_EXECUTOR_H
+#define NCNN_EXECUTOR_H
+
+#include "cpu.h"
+#include "mat.h"
+#include "platform.h"
+
+namespace ncnn {
+
+class Net;
+class ExtractTask;
+class PipelineQueue;
+class PipelineFrame;
+
+// invoked when a request finishes or is cancelled
+// a finished request calls it on the worker thread that ran it
+// a cancelled request calls it on the thread that cancelled it, inside cancel, cancel_all or the executor destructor
+// without thread support every request finishes inside extract_async on the caller thread
+// ret is the extract return value, -2 if cancelled
+typedef void (*extract_callback)(int ret, const std::vector<Mat>& outputs, void* userdata);
+
+// handle to the result of one asynchronous extract
+class ExtractFuture
+{
+public:
+    ExtractFuture();
+    ExtractFuture(const ExtractFuture& f);
+    ExtractFuture& operator=(const ExtractFuture& f);
+    ~ExtractFuture();
+
+    // false if the request was rejected
+    bool valid() const;
+
+    // true if finished or cancelled
+    bool ready() const;
+
+    // block until finished
+    // return 0 if success, -2 if cancelled
+    int wait() const;
+
+    // block until finished and take the output blobs in request order
+    // return 0 if success, -2 if cancelled
+    int get(std::vector<Mat>& outputs) const;
+
+protected:
+    friend class Executor;
+    ExtractFuture(ExtractTask* task);
+
+    ExtractTask* task;
+};
+
+// fixed pool of inference threads fed by a bounded request queue
+// each request runs on its own extractor taken from the net extractor pool
+class Executor
+{
+public:
+    // worker_count inference threads, at most max_pending requests waiting for a worker
+    // both are clamped to at least 1
+    // the net must stay loaded until the executor is destroyed
+    Executor(const Net* net, int worker_count = 1, int max_pending = 16);
+    // cancel pending requests and join workers
+    ~Executor();
+
+    // set thread count for the extractor of each request
+    void set_num_threads(int num_threads);
+
+    // submit one inference, inputs and outputs addressed by blob index
+    // block the caller while the queue is full
+    ExtractFuture extract_async(const std::vector<int>& input_blob_indexes, const std::vector<Mat>& inputs, const std::vector<int>& output_blob_indexes, extract_callback callback = 0, void* userdata = 0);
+
+    // same as extract_async, but never blocks
+    // return an invalid future if the queue is full
+    ExtractFuture try_extract_async(const std::vector<int>& input_blob_indexes, const std::vector<Mat>& inputs, const std::vector<int>& output_blob_indexes, extract_callback callback = 0, void* userdata = 0);
+
+#if NCNN_STRING
+    // submit one inference, inputs and outputs addressed by blob name
+    ExtractFuture extract_async(const std::vector<const char*>& input_blob_names, const std::vector<Mat>& inputs, const std::vector<const char*>& output_blob_names, extract_callback callback = 0, void* userdata = 0);
+
+    ExtractFuture try_extract_async(const std::vector<const char*>& input_blob_names, const std::vector<Mat>& inputs, const std::vector<const char*>& output_blob_names, extract_callback callback = 0, void* userdata = 0);
+#endif // NCNN_STRING
+
+    // drop a request that has not started yet
+    // return 0 if cancelled, -1 if already running or finished
+    int cancel(const ExtractFuture& future);
+
+    // drop all requests that have not started yet
+    void cancel_all();
+
+    // number of requests waiting for a worker
+    int pending() const;
+
+private:
+    Executor(const Executor&);
+    Executor& operator=(const Executor&);
+
+    ExtractFuture submit(const std::vector<int>& input_blob_indexes, const std::vector<Mat>& inputs, const std::vector<int>& output_blob_indexes, extract_callback callback, void* userdata, bool blocking);
+
+    void run(ExtractTask* task) const;
+
+#if NCNN_STRING
+    int find_blob_indexes(const std::vector<const char*>& names, std::vector<int>& indexes) const;
+#endif // NCNN_STRING
+
+    static void* worker_entry(void* args);
+    void worker();
+
+private:
+    const Net* net;
+    int max_pending;
+    int num_threads;
+
+    mutable Mutex lock;
+    ConditionVariable not_empty;
+    ConditionVariable not_full;
+    std::vector<ExtractTask*> queue;
+    bool stop;
+
+    std::vector<Thread*> workers;
+};
+
+// pipelined multi-frame execution
+// the layer schedule is cut into stages, each stage runs on its own thread
+// frames move between stages through bounded queues, so frame k+1 enters the first stage while frame k is still in a later one
+// frames leave the pipeline in submission order
+class PipelineExecutor
+{
+public:
+    // stage_layer_begins holds the index of the first layer of every stage but the first, in increasing order
+    // layers of a stage are the layers between two cuts in net order
+    // at most max_pending frames wait in front of each stage and in front of the output
+    // the net must stay loaded until the executor is destroyed
+    PipelineExecutor(const Net* net, const std::vector<int>& input_blob_indexes, const std::vector<int>& output_blob_indexes, const std::vector<int>& stage_layer_begins, int max_pending = 2);
+#if NCNN_STRING
+    // stages start at the named layers
+    PipelineExecutor(const Net* net, const std::vector<const char*>& input_blob_names, const std::vector<const char*>& output_blob_names, const std::vector<const char*>& stage_first_layer_names, int max_pending = 2);
+#endif // NCNN_STRING
+    // drop frames in flight and join stage threads
+    ~PipelineExecutor();
+
+    // 0 if the stage cuts are invalid
+    int stage_count() const;
+
+    // set thread count for the extractor of one stage
+    void set_num_threads(int stage, int num_threads);
+
+    // pin the threads of one stage, thread count follows the number of enabled cpus
+    void set_cpu_affinity(int stage, const CpuSet& thread_affinity_mask);
+
+    // feed one frame, block while the first stage is full
+    // return 0 if success
+    int push(const std::vector<Mat>& inputs);
+
+    // no more frames will be pushed, never blocks
+    void close();
+
+    // take the outputs of the oldest frame in request order, block until ready
+    // return 0 if success, the extract return value if the frame failed, -1 after the last frame of a closed pipeline
+    int pop(std::vector<Mat>& outputs);
+
+private:
+    PipelineExecutor(const PipelineExecutor&);
+    PipelineExecutor& operator=(const PipelineExecutor&);
+
+    void init(const std::vector<int>& stage_layer_begins, int max_pending);
+
+    int run_stage(int stage, PipelineFrame* frame) const;
+
+    static void* stage_entry(void* args);
+    void stage_worker(int stage);
+
+private:
+    const Net* net;
+    std::vector<int> input_blob_indexes;
+    std::vector<int> output_blob_indexes;
+
+    // blobs to extract in each stage, ordered by producer
+    std::vector<std::vector<int> > stage_extract_blobs;
+    // blobs still needed after each stage
+    std::vector<std::vector<int> > stage_keep_blobs;
+
+    mutable Mutex lock;
+    std::vector<int> stage_num_threads;
+    std::vector<CpuSet> stage_affinity;
+    std::vector<char> stage_affinity_dirty;
+
+    // queues[i] feeds stage i, the last queue holds finished frames
+    // the first queue also tracks close, guarded by its own lock
+    std::vector<PipelineQueue*> queues;
+    // guarded by lock
+    bool drained;
+
+    struct StageArgs
+    {
+        PipelineExecutor* executor;
+        int stage;
+    };
+    std::vector<StageArgs> stage_args;
+    std::vector<Thread*> stage_threads;
+};
+
+} // namespace ncnn
+
+#endif // NCNN_EXECUTOR_H
@@ -36,11 +36,14 @@ Layer::Layer()
     support_inplace = false;
     support_vulkan = false;
     support_packing = false;
+    support_packing16 = false;
 
     support_bf16_storage = false;
     support_fp16_storage = false;
     support_image_storage = false;
 
+    support_batch = false;
+
     use_int8_inference = false;
     support_weight_fp16_storage = false;
 
@@ -73,6 +76,16 @@ int Layer::destroy_pipeline(const Option& /*opt*/)
     return 0;
 }
 
+int Layer::get_prepacked_weights(std::vector<Mat>& /*weights*/) const
+{
+    return -1;
+}
+
+int Layer::create_pipeline_prepacked(const std::vector<Mat>& /*weights*/, const Option& /*opt*/)
+{
+    return -1;
+}
+
 int Layer::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
 {
     if (!support_inplace)
@@ -111,6 +124,34 @@ int Layer::forward_inplace(Mat& /*bottom_top_blob*/, const Option& /*opt*/) cons
     return -1;
 }
 
+int Layer::forward_batch(const std::vector<std::vector<Mat> >& bottom_blobs_batch, std::vector<std::vector<Mat> >& top_blobs_batch, const Option& opt) const
+{
+    top_blobs_batch.resize(bottom_blobs_batch.size());
+    for (size_t b = 0; b < bottom_blobs_batch.size(); b++)
+    {
+        top_blobs_batch[b].resize(tops.size());
+
+        int ret = forward(bottom_blobs_batch[b], top_blobs_batch[b], opt);
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+int Layer::forward_batch(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    top_blobs.resize(bottom_blobs.size());
+    for (size_t b = 0; b < bottom_blobs.size(); b++)
+    {
+        int ret = forward(bottom_blobs[b], top_blobs[b], opt);
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
 
 #if NCNN_CNNCACHE
 int Layer::forward_roi(std::vector<MRect>& bottom_padrois, std::vector<MRect>& top_rois, std::vector<MRect>& top_padrois) const
@@ -225,6 +266,12 @@ static const layer_registry_entry layer_registry[] = {
 #include "layer_registry.h"
 };
 
+#if NCNN_RUNTIME_CPU && NCNN_AVX512
+static const layer_registry_entry layer_registry_avx512[] = {
+#include "layer_registry_avx512.h"
+};
+#endif // NCNN_RUNTIME_CPU && NCNN_AVX512
+
 #if NCNN_RUNTIME_CPU && NCNN_AVX2
 static const layer_registry_entry layer_registry_avx2[] = {
 #include "layer_registry_avx2.h"
@@ -269,6 +316,13 @@ Layer* create_layer(int index)
     // clang-format off
     // *INDENT-OFF*
     layer_creator_func layer_creator = 0;
+#if NCNN_RUNTIME_CPU && NCNN_AVX512
+    if (ncnn::cpu_support_x86_avx512())
+    {
+        layer_creator = layer_registry_avx512[index].creator;
+    }
+    else
+#endif // NCNN_RUNTIME_CPU && NCNN_AVX512
 #if NCNN_RUNTIME_CPU && NCNN_AVX2
     if (ncnn::cpu_support_x86_avx2())
     {
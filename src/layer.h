@@ -56,6 +56,14 @@ public:
     // return 0 if success
     virtual int destroy_pipeline(const Option& opt);
 
+    // export weight data transformed in create_pipeline for prepacked cache
+    // return 0 if success
+    virtual int get_prepacked_weights(std::vector<Mat>& weights) const;
+
+    // layer implementation specific setup with weight data from prepacked cache
+    // return 0 if success, otherwise create_pipeline will be used instead
+    virtual int create_pipeline_prepacked(const std::vector<Mat>& weights, const Option& opt);
+
 public:
     // one input and one output blob
     bool one_blob_only;
@@ -69,6 +77,9 @@ public:
     // accept input blob with packed storage
     bool support_packing;
 
+    // accept input blob with elempack 16 on avx512
+    bool support_packing16;
+
     // accept bf16
     bool support_bf16_storage;
 
@@ -78,6 +89,9 @@ public:
     // shader image storage
     bool support_image_storage;
 
+    // forward batch items of the same shape together
+    bool support_batch;
+
     // TODO drop these fields
     bool use_int8_inference;
     bool support_weight_fp16_storage;
@@ -92,6 +106,13 @@ public:
     // return 0 if success
     virtual int forward_inplace(std::vector<Mat>& bottom_top_blobs, const Option& opt) const;
     virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
+
+    // implement batched inference
+    // one entry per batch item, all batch items are of the same shape
+    // the default implementation forwards batch items one by one
+    // return 0 if success
+    virtual int forward_batch(const std::vector<std::vector<Mat> >& bottom_blobs_batch, std::vector<std::vector<Mat> >& top_blobs_batch, const Option& opt) const;
+    virtual int forward_batch(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
 #if NCNN_CNNCACHE
     virtual int forward_roi(std::vector<MRect>& bottom_padrois, std::vector<MRect>& top_rois, std::vector<MRect>& top_padrois) const;
     virtual int forward_roi(MRect& bottom_padroi, MRect& top_roi, MRect& top_padroi) const;
@@ -276,6 +276,17 @@ int Convolution::forward(const Mat& bottom_blob, Mat& top_blob, const Option& op
                         y = logf(expf(x) + 1);
                     sum = static_cast<float>(x * tanh(y));
                 }
+                else if (activation_type == 6)
+                {
+                    float alpha = activation_params[0];
+                    float beta = activation_params[1];
+                    float lower = -beta / alpha;
+                    float upper = (1.f / alpha) + lower;
+                    if (sum < lower)
+                        sum = 0.f;
+                    else if (sum <= upper)
+                        sum = sum * (sum * alpha + beta);
+                }
 
                 outptr[j] = sum;
             }
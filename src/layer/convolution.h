@@ -65,7 +65,7 @@ public:
 
     int int8_scale_term;
 
-    // 0=none 1=relu 2=leakyrelu 3=clip 4=sigmoid
+    // 0=none 1=relu 2=leakyrelu 3=clip 4=sigmoid 5=mish 6=hardswish
     int activation_type;
     Mat activation_params;
 
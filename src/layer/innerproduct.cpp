@@ -153,6 +153,17 @@ int InnerProduct::forward(const Mat& bottom_blob, Mat& top_blob, const Option& o
         {
             sum = static_cast<float>(sum * tanh(log(exp(sum) + 1.f)));
         }
+        else if (activation_type == 6)
+        {
+            float alpha = activation_params[0];
+            float beta = activation_params[1];
+            float lower = -beta / alpha;
+            float upper = (1.f / alpha) + lower;
+            if (sum < lower)
+                sum = 0.f;
+            else if (sum <= upper)
+                sum = sum * (sum * alpha + beta);
+        }
 
         top_blob[p] = sum;
     }
@@ -19,6 +19,9 @@
 #ifdef __AVX__
 #include "avx_mathfun.h"
 #endif
+#ifdef __AVX512F__
+#include "avx512_mathfun.h"
+#endif
 
 #include <math.h>
 #include "mat.h"
@@ -93,10 +96,86 @@ static inline __m256 activation_ps(__m256 _v, int activation_type,
     {
         return mish_avx(_v);
     }
+    else if (activation_type == 6)
+    {
+        // hardswish, x * clip(alpha * x + beta, 0, 1)
+        __m256 alpha = _mm256_set1_ps(activation_params[0]);
+        __m256 beta = _mm256_set1_ps(activation_params[1]);
+        __m256 gate = _mm256_add_ps(_mm256_mul_ps(_v, alpha), beta);
+        gate = _mm256_min_ps(_mm256_max_ps(gate, _mm256_setzero_ps()), _mm256_set1_ps(1.f));
+        return _mm256_mul_ps(_v, gate);
+    }
 
     return _v;
 }
 #endif
+#ifdef __AVX512F__
+static inline __m512 sigmoid_avx512(__m512 inputs)
+{
+    const __m512 one = _mm512_set1_ps(1.0f);
+    return _mm512_div_ps(one, _mm512_add_ps(one, exp512_ps(_mm512_sub_ps(_mm512_setzero_ps(), inputs))));
+}
+
+static inline __m512 tanh_avx512(__m512 inputs)
+{
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512 two = _mm512_set1_ps(2.0f);
+    return _mm512_fmsub_ps(sigmoid_avx512(_mm512_mul_ps(inputs, two)), two, one);
+}
+
+static inline __m512 mish_avx512(__m512 inputs)
+{
+    return _mm512_mul_ps(inputs, tanh_avx512(log512_ps(_mm512_add_ps(exp512_ps(inputs), _mm512_set1_ps(1.f)))));
+}
+
+static inline __m512 lrelu_avx512(__m512 inputs, float slope)
+{
+    __m512 pos = _mm512_max_ps(_mm512_setzero_ps(), inputs);
+    __m512 neg = _mm512_min_ps(_mm512_setzero_ps(), inputs);
+    return _mm512_fmadd_ps(_mm512_set1_ps(slope), neg, pos);
+}
+
+static inline __m512 hardswish_avx512(__m512 inputs, float alpha, float beta)
+{
+    __m512 gate = _mm512_fmadd_ps(inputs, _mm512_set1_ps(alpha), _mm512_set1_ps(beta));
+    gate = _mm512_min_ps(_mm512_max_ps(gate, _mm512_setzero_ps()), _mm512_set1_ps(1.f));
+    return _mm512_mul_ps(inputs, gate);
+}
+
+static inline __m512 activation_ps(__m512 _v, int activation_type,
+                                   const ncnn::Mat& activation_params)
+{
+    if (activation_type == 1)
+    {
+        return _mm512_max_ps(_v, _mm512_setzero_ps());
+    }
+    else if (activation_type == 2)
+    {
+        return lrelu_avx512(_v, activation_params[0]);
+    }
+    else if (activation_type == 3)
+    {
+        __m512 min = _mm512_set1_ps(activation_params[0]);
+        __m512 max = _mm512_set1_ps(activation_params[1]);
+        return _mm512_min_ps(_mm512_max_ps(_v, min), max);
+    }
+    else if (activation_type == 4)
+    {
+        return sigmoid_avx512(_v);
+    }
+    else if (activation_type == 5)
+    {
+        return mish_avx512(_v);
+    }
+    else if (activation_type == 6)
+    {
+        return hardswish_avx512(_v, activation_params[0], activation_params[1]);
+    }
+
+    return _v;
+}
+#endif // __AVX512F__
+
 static inline float activation_ss(float v, int activation_type,
                                   const ncnn::Mat& activation_params)
 {
@@ -126,6 +205,17 @@ static inline float activation_ss(float v, int activation_type,
     {
         v = v * tanh(log(exp(v) + 1.f));
     }
+    else if (activation_type == 6)
+    {
+        float alpha = activation_params[0];
+        float beta = activation_params[1];
+        float lower = -beta / alpha;
+        float upper = (1.f / alpha) + lower;
+        if (v < lower)
+            v = 0.f;
+        else if (v <= upper)
+            v = v * (v * alpha + beta);
+    }
 
     return v;
 }
@@ -22,6 +22,18 @@ static inline __m256 loadfp16(const unsigned short* ptr)
 {
     return _mm256_cvtph_ps(_mm_lddqu_si128((__m128i*)(ptr)));
 }
+
+// weights of kernels templated on fp32 or fp16 weight storage
+static inline __m256 loadweight(const float* ptr)
+{
+    return _mm256_loadu_ps(ptr);
+}
+
+static inline __m256 loadweight(const unsigned short* ptr)
+{
+    return loadfp16(ptr);
+}
+
 static inline __m256 _mm256_fmadd_1_ps(__m256 a, __m256 b, float c)
 {
     return _mm256_fmadd_ps(b, _mm256_set1_ps(c), a);
@@ -62,6 +74,36 @@ static inline void transpose8_ps(__m256& row0, __m256& row1, __m256& row2, __m25
     row7 = _mm256_permute2f128_ps(__tt3, __tt7, 0x31);
 }
 
+static inline void transpose8_epi16(__m128i& _r0, __m128i& _r1, __m128i& _r2, __m128i& _r3, __m128i& _r4, __m128i& _r5, __m128i& _r6, __m128i& _r7)
+{
+    __m128i _tmp0 = _mm_unpacklo_epi16(_r0, _r1);
+    __m128i _tmp1 = _mm_unpackhi_epi16(_r0, _r1);
+    __m128i _tmp2 = _mm_unpacklo_epi16(_r2, _r3);
+    __m128i _tmp3 = _mm_unpackhi_epi16(_r2, _r3);
+    __m128i _tmp4 = _mm_unpacklo_epi16(_r4, _r5);
+    __m128i _tmp5 = _mm_unpackhi_epi16(_r4, _r5);
+    __m128i _tmp6 = _mm_unpacklo_epi16(_r6, _r7);
+    __m128i _tmp7 = _mm_unpackhi_epi16(_r6, _r7);
+
+    __m128i _tmp8 = _mm_unpacklo_epi32(_tmp0, _tmp2);
+    __m128i _tmp9 = _mm_unpackhi_epi32(_tmp0, _tmp2);
+    __m128i _tmpa = _mm_unpacklo_epi32(_tmp1, _tmp3);
+    __m128i _tmpb = _mm_unpackhi_epi32(_tmp1, _tmp3);
+    __m128i _tmpc = _mm_unpacklo_epi32(_tmp4, _tmp6);
+    __m128i _tmpd = _mm_unpackhi_epi32(_tmp4, _tmp6);
+    __m128i _tmpe = _mm_unpacklo_epi32(_tmp5, _tmp7);
+    __m128i _tmpf = _mm_unpackhi_epi32(_tmp5, _tmp7);
+
+    _r0 = _mm_unpacklo_epi64(_tmp8, _tmpc);
+    _r1 = _mm_unpackhi_epi64(_tmp8, _tmpc);
+    _r2 = _mm_unpacklo_epi64(_tmp9, _tmpd);
+    _r3 = _mm_unpackhi_epi64(_tmp9, _tmpd);
+    _r4 = _mm_unpacklo_epi64(_tmpa, _tmpe);
+    _r5 = _mm_unpackhi_epi64(_tmpa, _tmpe);
+    _r6 = _mm_unpacklo_epi64(_tmpb, _tmpf);
+    _r7 = _mm_unpackhi_epi64(_tmpb, _tmpf);
+}
+
 static inline __m256 HorizontalSums(__m256 v0, __m256 v1, __m256 v2, __m256 v3, __m256 v4,
                                     __m256 v5, __m256 v6, __m256 v7)
 {
@@ -118,4 +160,222 @@ static inline float _mm_reduce_add_ps(__m128 x128)
     const __m128 x32 = _mm_add_ss(x64, _mm_shuffle_ps(x64, x64, 0x55));
     return _mm_cvtss_f32(x32);
 }
+
+static inline float _mm256_reduce_max_ps(__m256 x)
+{
+    const __m128 x128 = _mm_max_ps(_mm256_extractf128_ps(x, 1), _mm256_castps256_ps128(x));
+    const __m128 x64 = _mm_max_ps(x128, _mm_movehl_ps(x128, x128));
+    const __m128 x32 = _mm_max_ss(x64, _mm_shuffle_ps(x64, x64, 0x55));
+    return _mm_cvtss_f32(x32);
+}
+
+// bfloat16 is the upper half of float32, widen by shift and narrow by truncation
+static inline __m256 bfloat2float_avx(__m128i v0)
+{
+    __m128i zero = _mm_set1_epi32(0);
+    __m128i a = _mm_slli_epi32(_mm_unpacklo_epi16(v0, zero), 16);
+    __m128i b = _mm_slli_epi32(_mm_unpackhi_epi16(v0, zero), 16);
+    __m256i ab = _mm256_set1_epi32(0);
+    ab = _mm256_insertf128_si256(ab, a, 0); // insert in low 128-bit lane
+    ab = _mm256_insertf128_si256(ab, b, 1); // insert in high 128-bit lane
+    return _mm256_castsi256_ps(ab);
+}
+
+static inline __m256i float2bfloat_avx(__m256 v0, __m256 v1)
+{
+    __m256i a = _mm256_castps_si256(v0);
+    a = _mm256_srli_epi32(a, 16);
+    __m256i b = _mm256_castps_si256(v1);
+    b = _mm256_srli_epi32(b, 16);
+    __m256i abab = _mm256_packus_epi32(a, b);
+    return _mm256_permutevar8x32_epi32(abab, _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7));
+}
+
+static inline __m128i float2bfloat_avx(__m256 v0)
+{
+    __m256i a = _mm256_castps_si256(v0);
+    a = _mm256_srli_epi32(a, 16);
+    __m256i aaaa = _mm256_packus_epi32(a, a);
+    return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(aaaa, _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7)));
+}
+
+static inline __m256 loadbf16(const unsigned short* ptr)
+{
+    return bfloat2float_avx(_mm_loadu_si128((const __m128i*)ptr));
+}
+
+static inline void cast_bfloat16_to_float32_avx(const unsigned short* ptr, float* outptr, int size)
+{
+    int i = 0;
+    for (; i + 7 < size; i += 8)
+    {
+        _mm256_storeu_ps(outptr + i, loadbf16(ptr + i));
+    }
+    for (; i < size; i++)
+    {
+        union
+        {
+            unsigned int u;
+            float f;
+        } tmp;
+        tmp.u = (unsigned int)ptr[i] << 16;
+        outptr[i] = tmp.f;
+    }
+}
+
+static inline void cast_float32_to_bfloat16_avx(const float* ptr, unsigned short* outptr, int size)
+{
+    int i = 0;
+    for (; i + 7 < size; i += 8)
+    {
+        _mm_storeu_si128((__m128i*)(outptr + i), float2bfloat_avx(_mm256_loadu_ps(ptr + i)));
+    }
+    for (; i < size; i++)
+    {
+        union
+        {
+            unsigned int u;
+            float f;
+        } tmp;
+        tmp.f = ptr[i];
+        outptr[i] = (unsigned short)(tmp.u >> 16);
+    }
+}
+
+#if __AVX2__
+// round half away from zero and saturate to [-127, 127] like float2int8
+// the 4 int8 are in the low 32 bits
+static inline __m128i float2int8_sse(__m128 _v)
+{
+    __m128 _t = _mm_round_ps(_v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    __m128 _r = _mm_sub_ps(_v, _t);
+    __m128 _one = _mm_or_ps(_mm_set1_ps(1.f), _mm_and_ps(_v, _mm_set1_ps(-0.f)));
+    __m128 _absr = _mm_andnot_ps(_mm_set1_ps(-0.f), _r);
+    _t = _mm_add_ps(_t, _mm_and_ps(_mm_cmpge_ps(_absr, _mm_set1_ps(0.5f)), _one));
+    __m128i _v32 = _mm_cvttps_epi32(_t);
+    _v32 = _mm_max_epi32(_mm_min_epi32(_v32, _mm_set1_epi32(127)), _mm_set1_epi32(-127));
+    __m128i _v16 = _mm_packs_epi32(_v32, _v32);
+    return _mm_packs_epi16(_v16, _v16);
+}
+
+// the 8 int8 are in the low 64 bits
+static inline __m128i float2int8_avx(__m256 _v)
+{
+    __m256 _t = _mm256_round_ps(_v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    __m256 _r = _mm256_sub_ps(_v, _t);
+    __m256 _one = _mm256_or_ps(_mm256_set1_ps(1.f), _mm256_and_ps(_v, _mm256_set1_ps(-0.f)));
+    __m256 _absr = _mm256_andnot_ps(_mm256_set1_ps(-0.f), _r);
+    _t = _mm256_add_ps(_t, _mm256_and_ps(_mm256_cmp_ps(_absr, _mm256_set1_ps(0.5f), _CMP_GE_OQ), _one));
+    __m256i _v32 = _mm256_cvttps_epi32(_t);
+    _v32 = _mm256_max_epi32(_mm256_min_epi32(_v32, _mm256_set1_epi32(127)), _mm256_set1_epi32(-127));
+    __m128i _v16 = _mm_packs_epi32(_mm256_castsi256_si128(_v32), _mm256_extracti128_si256(_v32, 1));
+    return _mm_packs_epi16(_v16, _v16);
+}
+#endif // __AVX2__
+
+#if __AVX512F__
+static inline __m512 loadfp16_avx512(const unsigned short* ptr)
+{
+    return _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)ptr));
+}
+
+static inline __m512 loadweight_avx512(const float* ptr)
+{
+    return _mm512_loadu_ps(ptr);
+}
+
+static inline __m512 loadweight_avx512(const unsigned short* ptr)
+{
+    return loadfp16_avx512(ptr);
+}
+
+static inline __m512 _mm512_fmadd_1_ps(__m512 a, __m512 b, float c)
+{
+    return _mm512_fmadd_ps(b, _mm512_set1_ps(c), a);
+}
+
+static inline __m512 _mm512_fmrsub_1_ps(__m512 a, __m512 b, float c)
+{
+    return _mm512_sub_ps(a, _mm512_mul_ps(b, _mm512_set1_ps(c)));
+}
+
+static inline __m256 _mm512_fold_ps(__m512 x)
+{
+    return _mm256_add_ps(_mm512_castps512_ps256(x), _mm512_extractf32x8_ps(x, 1));
+}
+
+static inline void transpose16_ps(__m512& _r0, __m512& _r1, __m512& _r2, __m512& _r3, __m512& _r4, __m512& _r5, __m512& _r6, __m512& _r7,
+                                  __m512& _r8, __m512& _r9, __m512& _ra, __m512& _rb, __m512& _rc, __m512& _rd, __m512& _re, __m512& _rf)
+{
+    __m512 _tmp0 = _mm512_unpacklo_ps(_r0, _r1);
+    __m512 _tmp1 = _mm512_unpackhi_ps(_r0, _r1);
+    __m512 _tmp2 = _mm512_unpacklo_ps(_r2, _r3);
+    __m512 _tmp3 = _mm512_unpackhi_ps(_r2, _r3);
+    __m512 _tmp4 = _mm512_unpacklo_ps(_r4, _r5);
+    __m512 _tmp5 = _mm512_unpackhi_ps(_r4, _r5);
+    __m512 _tmp6 = _mm512_unpacklo_ps(_r6, _r7);
+    __m512 _tmp7 = _mm512_unpackhi_ps(_r6, _r7);
+    __m512 _tmp8 = _mm512_unpacklo_ps(_r8, _r9);
+    __m512 _tmp9 = _mm512_unpackhi_ps(_r8, _r9);
+    __m512 _tmpa = _mm512_unpacklo_ps(_ra, _rb);
+    __m512 _tmpb = _mm512_unpackhi_ps(_ra, _rb);
+    __m512 _tmpc = _mm512_unpacklo_ps(_rc, _rd);
+    __m512 _tmpd = _mm512_unpackhi_ps(_rc, _rd);
+    __m512 _tmpe = _mm512_unpacklo_ps(_re, _rf);
+    __m512 _tmpf = _mm512_unpackhi_ps(_re, _rf);
+
+    // each 128bit lane now holds 4 rows of one column
+    _r0 = _mm512_shuffle_ps(_tmp0, _tmp2, _MM_SHUFFLE(1, 0, 1, 0));
+    _r1 = _mm512_shuffle_ps(_tmp0, _tmp2, _MM_SHUFFLE(3, 2, 3, 2));
+    _r2 = _mm512_shuffle_ps(_tmp1, _tmp3, _MM_SHUFFLE(1, 0, 1, 0));
+    _r3 = _mm512_shuffle_ps(_tmp1, _tmp3, _MM_SHUFFLE(3, 2, 3, 2));
+    _r4 = _mm512_shuffle_ps(_tmp4, _tmp6, _MM_SHUFFLE(1, 0, 1, 0));
+    _r5 = _mm512_shuffle_ps(_tmp4, _tmp6, _MM_SHUFFLE(3, 2, 3, 2));
+    _r6 = _mm512_shuffle_ps(_tmp5, _tmp7, _MM_SHUFFLE(1, 0, 1, 0));
+    _r7 = _mm512_shuffle_ps(_tmp5, _tmp7, _MM_SHUFFLE(3, 2, 3, 2));
+    _r8 = _mm512_shuffle_ps(_tmp8, _tmpa, _MM_SHUFFLE(1, 0, 1, 0));
+    _r9 = _mm512_shuffle_ps(_tmp8, _tmpa, _MM_SHUFFLE(3, 2, 3, 2));
+    _ra = _mm512_shuffle_ps(_tmp9, _tmpb, _MM_SHUFFLE(1, 0, 1, 0));
+    _rb = _mm512_shuffle_ps(_tmp9, _tmpb, _MM_SHUFFLE(3, 2, 3, 2));
+    _rc = _mm512_shuffle_ps(_tmpc, _tmpe, _MM_SHUFFLE(1, 0, 1, 0));
+    _rd = _mm512_shuffle_ps(_tmpc, _tmpe, _MM_SHUFFLE(3, 2, 3, 2));
+    _re = _mm512_shuffle_ps(_tmpd, _tmpf, _MM_SHUFFLE(1, 0, 1, 0));
+    _rf = _mm512_shuffle_ps(_tmpd, _tmpf, _MM_SHUFFLE(3, 2, 3, 2));
+
+    // gather the 128bit lanes of each column
+    _tmp0 = _mm512_shuffle_f32x4(_r0, _r4, _MM_SHUFFLE(2, 0, 2, 0));
+    _tmp1 = _mm512_shuffle_f32x4(_r1, _r5, _MM_SHUFFLE(2, 0, 2, 0));
+    _tmp2 = _mm512_shuffle_f32x4(_r2, _r6, _MM_SHUFFLE(2, 0, 2, 0));
+    _tmp3 = _mm512_shuffle_f32x4(_r3, _r7, _MM_SHUFFLE(2, 0, 2, 0));
+    _tmp4 = _mm512_shuffle_f32x4(_r0, _r4, _MM_SHUFFLE(3, 1, 3, 1));
+    _tmp5 = _mm512_shuffle_f32x4(_r1, _r5, _MM_SHUFFLE(3, 1, 3, 1));
+    _tmp6 = _mm512_shuffle_f32x4(_r2, _r6, _MM_SHUFFLE(3, 1, 3, 1));
+    _tmp7 = _mm512_shuffle_f32x4(_r3, _r7, _MM_SHUFFLE(3, 1, 3, 1));
+    _tmp8 = _mm512_shuffle_f32x4(_r8, _rc, _MM_SHUFFLE(2, 0, 2, 0));
+    _tmp9 = _mm512_shuffle_f32x4(_r9, _rd, _MM_SHUFFLE(2, 0, 2, 0));
+    _tmpa = _mm512_shuffle_f32x4(_ra, _re, _MM_SHUFFLE(2, 0, 2, 0));
+    _tmpb = _mm512_shuffle_f32x4(_rb, _rf, _MM_SHUFFLE(2, 0, 2, 0));
+    _tmpc = _mm512_shuffle_f32x4(_r8, _rc, _MM_SHUFFLE(3, 1, 3, 1));
+    _tmpd = _mm512_shuffle_f32x4(_r9, _rd, _MM_SHUFFLE(3, 1, 3, 1));
+    _tmpe = _mm512_shuffle_f32x4(_ra, _re, _MM_SHUFFLE(3, 1, 3, 1));
+    _tmpf = _mm512_shuffle_f32x4(_rb, _rf, _MM_SHUFFLE(3, 1, 3, 1));
+
+    _r0 = _mm512_shuffle_f32x4(_tmp0, _tmp8, _MM_SHUFFLE(2, 0, 2, 0));
+    _r1 = _mm512_shuffle_f32x4(_tmp1, _tmp9, _MM_SHUFFLE(2, 0, 2, 0));
+    _r2 = _mm512_shuffle_f32x4(_tmp2, _tmpa, _MM_SHUFFLE(2, 0, 2, 0));
+    _r3 = _mm512_shuffle_f32x4(_tmp3, _tmpb, _MM_SHUFFLE(2, 0, 2, 0));
+    _r4 = _mm512_shuffle_f32x4(_tmp4, _tmpc, _MM_SHUFFLE(2, 0, 2, 0));
+    _r5 = _mm512_shuffle_f32x4(_tmp5, _tmpd, _MM_SHUFFLE(2, 0, 2, 0));
+    _r6 = _mm512_shuffle_f32x4(_tmp6, _tmpe, _MM_SHUFFLE(2, 0, 2, 0));
+    _r7 = _mm512_shuffle_f32x4(_tmp7, _tmpf, _MM_SHUFFLE(2, 0, 2, 0));
+    _r8 = _mm512_shuffle_f32x4(_tmp0, _tmp8, _MM_SHUFFLE(3, 1, 3, 1));
+    _r9 = _mm512_shuffle_f32x4(_tmp1, _tmp9, _MM_SHUFFLE(3, 1, 3, 1));
+    _ra = _mm512_shuffle_f32x4(_tmp2, _tmpa, _MM_SHUFFLE(3, 1, 3, 1));
+    _rb = _mm512_shuffle_f32x4(_tmp3, _tmpb, _MM_SHUFFLE(3, 1, 3, 1));
+    _rc = _mm512_shuffle_f32x4(_tmp4, _tmpc, _MM_SHUFFLE(3, 1, 3, 1));
+    _rd = _mm512_shuffle_f32x4(_tmp5, _tmpd, _MM_SHUFFLE(3, 1, 3, 1));
+    _re = _mm512_shuffle_f32x4(_tmp6, _tmpe, _MM_SHUFFLE(3, 1, 3, 1));
+    _rf = _mm512_shuffle_f32x4(_tmp7, _tmpf, _MM_SHUFFLE(3, 1, 3, 1));
+}
+#endif // __AVX512F__
 #endif
\ No newline at end of file
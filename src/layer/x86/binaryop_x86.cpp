@@ -14,7 +14,11 @@
 
 #if __AVX__
 #include "avx_mathfun.h"
+#include "avx_usability.h"
 #endif // __AVX__
+#if __AVX512F__
+#include "avx512_mathfun.h"
+#endif // __AVX512F__
 
 #include "binaryop_x86.h"
 
@@ -26,7 +30,11 @@ BinaryOp_x86::BinaryOp_x86()
 {
 #if __AVX__
     support_packing = true;
+    support_bf16_storage = true;
 #endif // __AVX__
+#if __AVX512F__
+    support_packing16 = true;
+#endif // __AVX512F__
 }
 
 #if __AVX__
@@ -583,82 +591,748 @@ static int binary_op_scalar_inplace_pack8(Mat& a, float b, const Option& opt)
     return 0;
 }
 
+template<typename Op>
+static int binary_op_scalar_inplace_bf16s(Mat& a, float b, const Option& opt)
+{
+    Op op;
+
+    int channels = a.c;
+    int size = a.w * a.h * a.elempack;
+
+    __m256 _b = _mm256_set1_ps(b);
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int q = 0; q < channels; q++)
+    {
+        unsigned short* ptr = a.channel(q);
+
+        int i = 0;
+        for (; i + 7 < size; i += 8)
+        {
+            __m256 _p = loadbf16(ptr);
+            _p = op(_p, _b);
+            _mm_storeu_si128((__m128i*)ptr, float2bfloat_avx(_p));
+            ptr += 8;
+        }
+        if (i < size)
+        {
+            // pad the remainder to one vector
+            unsigned short tmp[8] = {0};
+            memcpy(tmp, ptr, (size - i) * sizeof(unsigned short));
+
+            __m256 _p = loadbf16(tmp);
+            _p = op(_p, _b);
+            _mm_storeu_si128((__m128i*)tmp, float2bfloat_avx(_p));
+
+            memcpy(ptr, tmp, (size - i) * sizeof(unsigned short));
+        }
+    }
+
+    return 0;
+}
+
 struct binary_op_add_pack8
 {
-    __m256 operator()(const __m256& x, const __m256& y) const
+    __m256 operator()(const __m256& x, const __m256& y) const
+    {
+        return _mm256_add_ps(x, y);
+    }
+};
+
+struct binary_op_sub_pack8
+{
+    __m256 operator()(const __m256& x, const __m256& y) const
+    {
+        return _mm256_sub_ps(x, y);
+    }
+};
+
+struct binary_op_mul_pack8
+{
+    __m256 operator()(const __m256& x, const __m256& y) const
+    {
+        return _mm256_mul_ps(x, y);
+    }
+};
+
+struct binary_op_div_pack8
+{
+    __m256 operator()(const __m256& x, const __m256& y) const
+    {
+        return _mm256_div_ps(x, y);
+    }
+};
+
+struct binary_op_max_pack8
+{
+    __m256 operator()(const __m256& x, const __m256& y) const
+    {
+        return _mm256_max_ps(x, y);
+    }
+};
+
+struct binary_op_min_pack8
+{
+    __m256 operator()(const __m256& x, const __m256& y) const
+    {
+        return _mm256_min_ps(x, y);
+    }
+};
+
+struct binary_op_pow_pack8
+{
+    __m256 operator()(const __m256& x, const __m256& y) const
+    {
+        return exp256_ps(_mm256_mul_ps(y, log256_ps(x)));
+    }
+};
+
+struct binary_op_rsub_pack8
+{
+    __m256 operator()(const __m256& x, const __m256& y) const
+    {
+        return _mm256_sub_ps(y, x);
+    }
+};
+
+struct binary_op_rdiv_pack8
+{
+    __m256 operator()(const __m256& x, const __m256& y) const
+    {
+        return _mm256_div_ps(y, x);
+    }
+};
+#if __AVX512F__
+template<typename Op>
+static int binary_op_pack16(const Mat& a, const Mat& b, Mat& c, const Option& opt)
+{
+    Op op;
+
+    int w = a.w;
+    int h = a.h;
+    int channels = a.c;
+    int size = w * h;
+    size_t elemsize = a.elemsize;
+    int elempack = a.elempack;
+
+    int w1 = b.w;
+    int h1 = b.h;
+    int channels1 = b.c;
+    int size1 = w1 * h1;
+    size_t elemsize1 = b.elemsize;
+    int elempack1 = b.elempack;
+
+    if (a.dims == 3)
+    {
+        if (b.dims == 3)
+        {
+            if (w1 == 1 && h1 == 1 && channels1 == channels)
+            {
+                // special type 1
+                c.create(w, h, channels, elemsize, elempack, opt.blob_allocator);
+                if (c.empty())
+                    return -100;
+
+                #pragma omp parallel for num_threads(opt.num_threads)
+                for (int q = 0; q < channels; q++)
+                {
+                    const float* ptr = a.channel(q);
+                    const float* b0 = b.channel(q);
+                    float* outptr = c.channel(q);
+                    __m512 _b0 = _mm512_loadu_ps(b0);
+                    for (int i = 0; i < size; i++)
+                    {
+                        __m512 _p = _mm512_loadu_ps(ptr);
+                        __m512 _outp = op(_p, _b0);
+                        _mm512_storeu_ps(outptr, _outp);
+                        ptr += 16;
+                        outptr += 16;
+                    }
+                }
+
+                return 0;
+            }
+
+            if (w1 == w && h1 == h && channels1 == 1 && elempack1 == 1)
+            {
+                // special type 2
+                c.create(w, h, channels, elemsize, elempack, opt.blob_allocator);
+                if (c.empty())
+                    return -100;
+
+                #pragma omp parallel for num_threads(opt.num_threads)
+                for (int q = 0; q < channels; q++)
+                {
+                    const float* ptr = a.channel(q);
+                    const float* ptr1 = b;
+                    float* outptr = c.channel(q);
+                    for (int i = 0; i < size; i++)
+                    {
+                        __m512 _p = _mm512_loadu_ps(ptr);
+                        __m512 _p1 = _mm512_set1_ps(*ptr1);
+                        __m512 _outp = op(_p, _p1);
+                        _mm512_storeu_ps(outptr, _outp);
+                        ptr += 16;
+                        ptr1 += 1;
+                        outptr += 16;
+                    }
+                }
+
+                return 0;
+            }
+
+            if (w == 1 && h == 1 && channels1 == channels)
+            {
+                // special type 3
+                c.create(w1, h1, channels1, elemsize1, elempack1, opt.blob_allocator);
+                if (c.empty())
+                    return -100;
+
+                #pragma omp parallel for num_threads(opt.num_threads)
+                for (int q = 0; q < channels1; q++)
+                {
+                    const float* a0 = a.channel(q);
+                    const float* ptr1 = b.channel(q);
+                    float* outptr = c.channel(q);
+                    __m512 _a0 = _mm512_loadu_ps(a0);
+                    for (int i = 0; i < size1; i++)
+                    {
+                        __m512 _p1 = _mm512_loadu_ps(ptr1);
+                        __m512 _outp = op(_a0, _p1);
+                        _mm512_storeu_ps(outptr, _outp);
+                        ptr1 += 16;
+                        outptr += 16;
+                    }
+                }
+
+                return 0;
+            }
+
+            if (w1 == w && h1 == h && channels == 1 && elempack == 1)
+            {
+                // special type 4
+                c.create(w1, h1, channels1, elemsize1, elempack1, opt.blob_allocator);
+                if (c.empty())
+                    return -100;
+
+                #pragma omp parallel for num_threads(opt.num_threads)
+                for (int q = 0; q < channels1; q++)
+                {
+                    const float* ptr = a;
+                    const float* ptr1 = b.channel(q);
+                    float* outptr = c.channel(q);
+                    for (int i = 0; i < size1; i++)
+                    {
+                        __m512 _p = _mm512_set1_ps(*ptr);
+                        __m512 _p1 = _mm512_loadu_ps(ptr1);
+                        __m512 _outp = op(_p, _p1);
+                        _mm512_storeu_ps(outptr, _outp);
+                        ptr += 1;
+                        ptr1 += 16;
+                        outptr += 16;
+                    }
+                }
+
+                return 0;
+            }
+
+            // type 19
+            c.create(w, h, channels, elemsize, elempack, opt.blob_allocator);
+            if (c.empty())
+                return -100;
+
+            #pragma omp parallel for num_threads(opt.num_threads)
+            for (int q = 0; q < channels; q++)
+            {
+                const float* ptr = a.channel(q);
+                const float* ptr1 = b.channel(q);
+                float* outptr = c.channel(q);
+
+                for (int i = 0; i < size; i++)
+                {
+                    __m512 _p = _mm512_loadu_ps(ptr);
+                    __m512 _p1 = _mm512_loadu_ps(ptr1);
+                    __m512 _outp = op(_p, _p1);
+                    _mm512_storeu_ps(outptr, _outp);
+                    ptr += 16;
+                    ptr1 += 16;
+                    outptr += 16;
+                }
+            }
+
+            return 0;
+        }
+
+        c.create(w, h, channels, elemsize, elempack, opt.blob_allocator);
+        if (c.empty())
+            return -100;
+
+        if (b.dims == 2)
+        {
+            // type 18
+            #pragma omp parallel for num_threads(opt.num_threads)
+            for (int q = 0; q < channels; q++)
+            {
+                const float* ptr = a.channel(q);
+                const float* ptr1 = b.row(q);
+                float* outptr = c.channel(q);
+
+                for (int y = 0; y < h; y++)
+                {
+                    __m512 _b0 = _mm512_loadu_ps(ptr1);
+                    for (int x = 0; x < w; x++)
+                    {
+                        __m512 _p = _mm512_loadu_ps(ptr);
+                        __m512 _outp = op(_p, _b0);
+                        _mm512_storeu_ps(outptr, _outp);
+                        ptr += 16;
+                        outptr += 16;
+                    }
+
+                    ptr1 += 16;
+                }
+            }
+
+            return 0;
+        }
+
+        if (b.dims == 1)
+        {
+            if (b.w == 1 && elempack1 == 1)
+            {
+                // type 16
+                __m512 _b0 = _mm512_set1_ps(b[0]);
+                #pragma omp parallel for num_threads(opt.num_threads)
+                for (int q = 0; q < channels; q++)
+                {
+                    const float* ptr = a.channel(q);
+                    float* outptr = c.channel(q);
+
+                    for (int i = 0; i < size; i++)
+                    {
+                        __m512 _p = _mm512_loadu_ps(ptr);
+                        __m512 _outp = op(_p, _b0);
+                        _mm512_storeu_ps(outptr, _outp);
+                        ptr += 16;
+                        outptr += 16;
+                    }
+                }
+
+                return 0;
+            }
+
+            // type 17
+            #pragma omp parallel for num_threads(opt.num_threads)
+            for (int q = 0; q < channels; q++)
+            {
+                const float* ptr = a.channel(q);
+                __m512 _b0 = _mm512_loadu_ps((const float*)b + q * 16);
+                float* outptr = c.channel(q);
+
+                for (int i = 0; i < size; i++)
+                {
+                    __m512 _p = _mm512_loadu_ps(ptr);
+                    __m512 _outp = op(_p, _b0);
+                    _mm512_storeu_ps(outptr, _outp);
+                    ptr += 16;
+                    outptr += 16;
+                }
+            }
+
+            return 0;
+        }
+    }
+    else if (a.dims == 2)
+    {
+        if (b.dims == 3)
+        {
+            // type 14
+            c.create(w1, h1, channels1, elemsize1, elempack1, opt.blob_allocator);
+            if (c.empty())
+                return -100;
+
+            #pragma omp parallel for num_threads(opt.num_threads)
+            for (int q = 0; q < channels1; q++)
+            {
+                const float* ptr = a.row(q);
+                const float* ptr1 = b.channel(q);
+                float* outptr = c.channel(q);
+
+                for (int y = 0; y < h1; y++)
+                {
+                    __m512 _a0 = _mm512_loadu_ps(ptr);
+                    for (int x = 0; x < w1; x++)
+                    {
+                        __m512 _p1 = _mm512_loadu_ps(ptr1);
+                        __m512 _outp = op(_a0, _p1);
+                        _mm512_storeu_ps(outptr, _outp);
+                        ptr1 += 16;
+                        outptr += 16;
+                    }
+
+                    ptr += 16;
+                }
+            }
+
+            return 0;
+        }
+
+        c.create(w, h, elemsize, elempack, opt.blob_allocator);
+        if (c.empty())
+            return -100;
+
+        if (b.dims == 2)
+        {
+            // type 13
+            const float* ptr = a;
+            const float* ptr1 = b;
+            float* outptr = c;
+            for (int i = 0; i < size; i++)
+            {
+                __m512 _p = _mm512_loadu_ps(ptr);
+                __m512 _p1 = _mm512_loadu_ps(ptr1);
+                __m512 _outp = op(_p, _p1);
+                _mm512_storeu_ps(outptr, _outp);
+                ptr += 16;
+                ptr1 += 16;
+                outptr += 16;
+            }
+
+            return 0;
+        }
+
+        if (b.dims == 1)
+        {
+            c.create(w, h, elemsize, elempack, opt.blob_allocator);
+            if (c.empty())
+                return -100;
+
+            if (b.w == 1 && elempack1 == 1)
+            {
+                // type 11
+                __m512 _b0 = _mm512_set1_ps(b[0]);
+                const float* ptr = a;
+                float* outptr = c;
+                for (int i = 0; i < size; i++)
+                {
+                    __m512 _p = _mm512_loadu_ps(ptr);
+                    __m512 _outp = op(_p, _b0);
+                    _mm512_storeu_ps(outptr, _outp);
+                    ptr += 16;
+                    outptr += 16;
+                }
+
+                return 0;
+            }
+
+            // type 12
+            const float* ptr = a;
+            const float* ptr1 = b;
+            float* outptr = c;
+
+            for (int y = 0; y < h; y++)
+            {
+                __m512 _b0 = _mm512_loadu_ps(ptr1);
+                for (int x = 0; x < w; x++)
+                {
+                    __m512 _p = _mm512_loadu_ps(ptr);
+                    __m512 _outp = op(_p, _b0);
+                    _mm512_storeu_ps(outptr, _outp);
+                    ptr += 16;
+                    outptr += 16;
+                }
+
+                ptr1 += 16;
+            }
+
+            return 0;
+        }
+    }
+    else if (a.dims == 1)
+    {
+        if (a.w == 1 && elempack == 1)
+        {
+            if (b.dims == 3)
+            {
+                // type 4
+                c.create(w1, h1, channels1, elemsize1, elempack1, opt.blob_allocator);
+                if (c.empty())
+                    return -100;
+
+                __m512 _a0 = _mm512_set1_ps(a[0]);
+                #pragma omp parallel for num_threads(opt.num_threads)
+                for (int q = 0; q < channels1; q++)
+                {
+                    const float* ptr1 = b.channel(q);
+                    float* outptr = c.channel(q);
+
+                    for (int i = 0; i < size1; i++)
+                    {
+                        __m512 _p1 = _mm512_loadu_ps(ptr1);
+                        __m512 _outp = op(_a0, _p1);
+                        _mm512_storeu_ps(outptr, _outp);
+                        ptr1 += 16;
+                        outptr += 16;
+                    }
+                }
+
+                return 0;
+            }
+
+            if (b.dims == 2)
+            {
+                // type 3
+                c.create(w1, h1, elemsize1, elempack1, opt.blob_allocator);
+                if (c.empty())
+                    return -100;
+
+                __m512 _a0 = _mm512_set1_ps(a[0]);
+                const float* ptr1 = b;
+                float* outptr = c;
+                for (int i = 0; i < size1; i++)
+                {
+                    __m512 _p1 = _mm512_loadu_ps(ptr1);
+                    __m512 _outp = op(_a0, _p1);
+                    _mm512_storeu_ps(outptr, _outp);
+                    ptr1 += 16;
+                    outptr += 16;
+                }
+
+                return 0;
+            }
+
+            if (b.dims == 1)
+            {
+                // type 2
+                c.create(w1, elemsize1, elempack1, opt.blob_allocator);
+                if (c.empty())
+                    return -100;
+
+                __m512 _a0 = _mm512_set1_ps(a[0]);
+                const float* ptr1 = b;
+                float* outptr = c;
+                for (int i = 0; i < w1; i++)
+                {
+                    __m512 _p1 = _mm512_loadu_ps(ptr1);
+                    __m512 _outp = op(_a0, _p1);
+                    _mm512_storeu_ps(outptr, _outp);
+                    ptr1 += 16;
+                    outptr += 16;
+                }
+
+                return 0;
+            }
+        }
+
+        if (b.dims == 3)
+        {
+            // type 9
+            c.create(w1, h1, channels1, elemsize1, elempack1, opt.blob_allocator);
+            if (c.empty())
+                return -100;
+
+            #pragma omp parallel for num_threads(opt.num_threads)
+            for (int q = 0; q < channels1; q++)
+            {
+                __m512 _a0 = _mm512_loadu_ps((const float*)a + q * 16);
+                const float* ptr1 = b.channel(q);
+                float* outptr = c.channel(q);
+
+                for (int i = 0; i < size1; i++)
+                {
+                    __m512 _p1 = _mm512_loadu_ps(ptr1);
+                    __m512 _outp = op(_a0, _p1);
+                    _mm512_storeu_ps(outptr, _outp);
+                    ptr1 += 16;
+                    outptr += 16;
+                }
+            }
+
+            return 0;
+        }
+
+        if (b.dims == 2)
+        {
+            // type 8
+            c.create(w1, h1, elemsize1, elempack1, opt.blob_allocator);
+            if (c.empty())
+                return -100;
+
+            const float* ptr = a;
+            const float* ptr1 = b;
+            float* outptr = c;
+
+            for (int y = 0; y < h1; y++)
+            {
+                __m512 _a0 = _mm512_loadu_ps(ptr);
+                for (int x = 0; x < w1; x++)
+                {
+                    __m512 _p1 = _mm512_loadu_ps(ptr1);
+                    __m512 _outp = op(_a0, _p1);
+                    _mm512_storeu_ps(outptr, _outp);
+                    ptr1 += 16;
+                    outptr += 16;
+                }
+
+                ptr += 16;
+            }
+
+            return 0;
+        }
+
+        if (b.dims == 1)
+        {
+            c.create(w, elemsize, elempack, opt.blob_allocator);
+            if (c.empty())
+                return -100;
+
+            if (b.w == 1 && elempack1 == 1)
+            {
+                // type 6
+                __m512 _b0 = _mm512_set1_ps(b[0]);
+                const float* ptr = a;
+                float* outptr = c;
+                for (int i = 0; i < w; i++)
+                {
+                    __m512 _p = _mm512_loadu_ps(ptr);
+                    __m512 _outp = op(_p, _b0);
+                    _mm512_storeu_ps(outptr, _outp);
+                    ptr += 16;
+                    outptr += 16;
+                }
+
+                return 0;
+            }
+
+            // type 7
+            const float* ptr = a;
+            const float* ptr1 = b;
+            float* outptr = c;
+            for (int i = 0; i < w; i++)
+            {
+                __m512 _p = _mm512_loadu_ps(ptr);
+                __m512 _p1 = _mm512_loadu_ps(ptr1);
+                __m512 _outp = op(_p, _p1);
+                _mm512_storeu_ps(outptr, _outp);
+                ptr += 16;
+                ptr1 += 16;
+                outptr += 16;
+            }
+        }
+    }
+
+    return 0;
+}
+
+template<typename Op>
+static int binary_op_scalar_inplace_pack16(Mat& a, float b, const Option& opt)
+{
+    Op op;
+
+    int w = a.w;
+    int h = a.h;
+    int channels = a.c;
+    int size = w * h;
+
+    __m512 _b = _mm512_set1_ps(b);
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int q = 0; q < channels; q++)
     {
-        return _mm256_add_ps(x, y);
+        float* ptr = a.channel(q);
+
+        for (int i = 0; i < size; i++)
+        {
+            __m512 _p = _mm512_loadu_ps(ptr);
+            _p = op(_p, _b);
+            _mm512_storeu_ps(ptr, _p);
+            ptr += 16;
+        }
+    }
+
+    return 0;
+}
+
+struct binary_op_add_pack16
+{
+    __m512 operator()(const __m512& x, const __m512& y) const
+    {
+        return _mm512_add_ps(x, y);
     }
 };
 
-struct binary_op_sub_pack8
+struct binary_op_sub_pack16
 {
-    __m256 operator()(const __m256& x, const __m256& y) const
+    __m512 operator()(const __m512& x, const __m512& y) const
     {
-        return _mm256_sub_ps(x, y);
+        return _mm512_sub_ps(x, y);
     }
 };
 
-struct binary_op_mul_pack8
+struct binary_op_mul_pack16
 {
-    __m256 operator()(const __m256& x, const __m256& y) const
+    __m512 operator()(const __m512& x, const __m512& y) const
     {
-        return _mm256_mul_ps(x, y);
+        return _mm512_mul_ps(x, y);
     }
 };
 
-struct binary_op_div_pack8
+struct binary_op_div_pack16
 {
-    __m256 operator()(const __m256& x, const __m256& y) const
+    __m512 operator()(const __m512& x, const __m512& y) const
     {
-        return _mm256_div_ps(x, y);
+        return _mm512_div_ps(x, y);
     }
 };
 
-struct binary_op_max_pack8
+struct binary_op_max_pack16
 {
-    __m256 operator()(const __m256& x, const __m256& y) const
+    __m512 operator()(const __m512& x, const __m512& y) const
     {
-        return _mm256_max_ps(x, y);
+        return _mm512_max_ps(x, y);
     }
 };
 
-struct binary_op_min_pack8
+struct binary_op_min_pack16
 {
-    __m256 operator()(const __m256& x, const __m256& y) const
+    __m512 operator()(const __m512& x, const __m512& y) const
     {
-        return _mm256_min_ps(x, y);
+        return _mm512_min_ps(x, y);
     }
 };
 
-struct binary_op_pow_pack8
+struct binary_op_pow_pack16
 {
-    __m256 operator()(const __m256& x, const __m256& y) const
+    __m512 operator()(const __m512& x, const __m512& y) const
     {
-        return exp256_ps(_mm256_mul_ps(y, log256_ps(x)));
+        return exp512_ps(_mm512_mul_ps(y, log512_ps(x)));
     }
 };
 
-struct binary_op_rsub_pack8
+struct binary_op_rsub_pack16
 {
-    __m256 operator()(const __m256& x, const __m256& y) const
+    __m512 operator()(const __m512& x, const __m512& y) const
     {
-        return _mm256_sub_ps(y, x);
+        return _mm512_sub_ps(y, x);
     }
 };
 
-struct binary_op_rdiv_pack8
+struct binary_op_rdiv_pack16
 {
-    __m256 operator()(const __m256& x, const __m256& y) const
+    __m512 operator()(const __m512& x, const __m512& y) const
     {
-        return _mm256_div_ps(y, x);
+        return _mm512_div_ps(y, x);
     }
 };
+#endif // __AVX512F__
 #endif // __AVX__
 
 int BinaryOp_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
 {
 #if __AVX__
+    if (opt.use_bf16_storage && bottom_blobs[0].elembits() == 16)
+        return forward_bf16s(bottom_blobs, top_blobs, opt);
+
     const Mat& bottom_blob = bottom_blobs[0];
     const Mat& bottom_blob1 = bottom_blobs[1];
 
@@ -667,6 +1341,51 @@ int BinaryOp_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>
     int elempack = bottom_blob.elempack;
     int elempack1 = bottom_blob1.elempack;
 
+#if __AVX512F__
+    if (elempack == 16 || elempack1 == 16)
+    {
+        if (elempack == 8 || elempack1 == 8)
+        {
+            // mixed pack16 and pack8 operands, broadcast on pack8
+            Option opt_pack8 = opt;
+            opt_pack8.blob_allocator = opt.workspace_allocator;
+
+            std::vector<Mat> bottom_blobs_pack8(2);
+            convert_packing(bottom_blob, bottom_blobs_pack8[0], elempack == 16 ? 8 : elempack, opt_pack8);
+            convert_packing(bottom_blob1, bottom_blobs_pack8[1], elempack1 == 16 ? 8 : elempack1, opt_pack8);
+
+            return forward(bottom_blobs_pack8, top_blobs, opt);
+        }
+
+        if (op_type == Operation_ADD)
+            return binary_op_pack16<binary_op_add_pack16>(bottom_blob, bottom_blob1, top_blob, opt);
+
+        if (op_type == Operation_SUB)
+            return binary_op_pack16<binary_op_sub_pack16>(bottom_blob, bottom_blob1, top_blob, opt);
+
+        if (op_type == Operation_MUL)
+            return binary_op_pack16<binary_op_mul_pack16>(bottom_blob, bottom_blob1, top_blob, opt);
+
+        if (op_type == Operation_DIV)
+            return binary_op_pack16<binary_op_div_pack16>(bottom_blob, bottom_blob1, top_blob, opt);
+
+        if (op_type == Operation_MAX)
+            return binary_op_pack16<binary_op_max_pack16>(bottom_blob, bottom_blob1, top_blob, opt);
+
+        if (op_type == Operation_MIN)
+            return binary_op_pack16<binary_op_min_pack16>(bottom_blob, bottom_blob1, top_blob, opt);
+
+        if (op_type == Operation_POW)
+            return binary_op_pack16<binary_op_pow_pack16>(bottom_blob, bottom_blob1, top_blob, opt);
+
+        if (op_type == Operation_RSUB)
+            return binary_op_pack16<binary_op_rsub_pack16>(bottom_blob, bottom_blob1, top_blob, opt);
+
+        if (op_type == Operation_RDIV)
+            return binary_op_pack16<binary_op_rdiv_pack16>(bottom_blob, bottom_blob1, top_blob, opt);
+    }
+#endif // __AVX512F__
+
     if (elempack == 8 || elempack1 == 8)
     {
         if (op_type == Operation_ADD)
@@ -704,8 +1423,43 @@ int BinaryOp_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>
 int BinaryOp_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
 {
 #if __AVX__
+    if (opt.use_bf16_storage && bottom_top_blob.elembits() == 16)
+        return forward_inplace_bf16s(bottom_top_blob, opt);
+
     int elempack = bottom_top_blob.elempack;
 
+#if __AVX512F__
+    if (elempack == 16)
+    {
+        if (op_type == Operation_ADD)
+            return binary_op_scalar_inplace_pack16<binary_op_add_pack16>(bottom_top_blob, b, opt);
+
+        if (op_type == Operation_SUB)
+            return binary_op_scalar_inplace_pack16<binary_op_sub_pack16>(bottom_top_blob, b, opt);
+
+        if (op_type == Operation_MUL)
+            return binary_op_scalar_inplace_pack16<binary_op_mul_pack16>(bottom_top_blob, b, opt);
+
+        if (op_type == Operation_DIV)
+            return binary_op_scalar_inplace_pack16<binary_op_div_pack16>(bottom_top_blob, b, opt);
+
+        if (op_type == Operation_MAX)
+            return binary_op_scalar_inplace_pack16<binary_op_max_pack16>(bottom_top_blob, b, opt);
+
+        if (op_type == Operation_MIN)
+            return binary_op_scalar_inplace_pack16<binary_op_min_pack16>(bottom_top_blob, b, opt);
+
+        if (op_type == Operation_POW)
+            return binary_op_scalar_inplace_pack16<binary_op_pow_pack16>(bottom_top_blob, b, opt);
+
+        if (op_type == Operation_RSUB)
+            return binary_op_scalar_inplace_pack16<binary_op_rsub_pack16>(bottom_top_blob, b, opt);
+
+        if (op_type == Operation_RDIV)
+            return binary_op_scalar_inplace_pack16<binary_op_rdiv_pack16>(bottom_top_blob, b, opt);
+    }
+#endif // __AVX512F__
+
     if (elempack == 8)
     {
         if (op_type == Operation_ADD)
@@ -740,4 +1494,71 @@ int BinaryOp_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
     return BinaryOp::forward_inplace(bottom_top_blob, opt);
 }
 
+#if __AVX__
+int BinaryOp_x86::forward_bf16s(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    // broadcast on fp32, bf16 only narrows the blobs between layers
+    Option opt_fp32 = opt;
+    opt_fp32.blob_allocator = opt.workspace_allocator;
+    opt_fp32.use_bf16_storage = false;
+
+    std::vector<Mat> bottom_blobs_fp32(bottom_blobs.size());
+    for (size_t i = 0; i < bottom_blobs.size(); i++)
+    {
+        if (bottom_blobs[i].elembits() != 16)
+        {
+            bottom_blobs_fp32[i] = bottom_blobs[i];
+            continue;
+        }
+
+        cast_bfloat16_to_float32(bottom_blobs[i], bottom_blobs_fp32[i], opt_fp32);
+        if (bottom_blobs_fp32[i].empty())
+            return -100;
+    }
+
+    std::vector<Mat> top_blobs_fp32(1);
+    int ret = forward(bottom_blobs_fp32, top_blobs_fp32, opt_fp32);
+    if (ret != 0)
+        return ret;
+
+    cast_float32_to_bfloat16(top_blobs_fp32[0], top_blobs[0], opt);
+    if (top_blobs[0].empty())
+        return -100;
+
+    return 0;
+}
+
+int BinaryOp_x86::forward_inplace_bf16s(Mat& bottom_top_blob, const Option& opt) const
+{
+    if (op_type == Operation_ADD)
+        return binary_op_scalar_inplace_bf16s<binary_op_add_pack8>(bottom_top_blob, b, opt);
+
+    if (op_type == Operation_SUB)
+        return binary_op_scalar_inplace_bf16s<binary_op_sub_pack8>(bottom_top_blob, b, opt);
+
+    if (op_type == Operation_MUL)
+        return binary_op_scalar_inplace_bf16s<binary_op_mul_pack8>(bottom_top_blob, b, opt);
+
+    if (op_type == Operation_DIV)
+        return binary_op_scalar_inplace_bf16s<binary_op_div_pack8>(bottom_top_blob, b, opt);
+
+    if (op_type == Operation_MAX)
+        return binary_op_scalar_inplace_bf16s<binary_op_max_pack8>(bottom_top_blob, b, opt);
+
+    if (op_type == Operation_MIN)
+        return binary_op_scalar_inplace_bf16s<binary_op_min_pack8>(bottom_top_blob, b, opt);
+
+    if (op_type == Operation_POW)
+        return binary_op_scalar_inplace_bf16s<binary_op_pow_pack8>(bottom_top_blob, b, opt);
+
+    if (op_type == Operation_RSUB)
+        return binary_op_scalar_inplace_bf16s<binary_op_rsub_pack8>(bottom_top_blob, b, opt);
+
+    if (op_type == Operation_RDIV)
+        return binary_op_scalar_inplace_bf16s<binary_op_rdiv_pack8>(bottom_top_blob, b, opt);
+
+    return 0;
+}
+#endif // __AVX__
+
 } // namespace ncnn
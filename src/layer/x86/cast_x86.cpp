@@ -18,7 +18,7 @@
 #include <emmintrin.h>
 #endif // __SSE2__
 #if __AVX__
-#include <immintrin.h>
+#include "avx_usability.h"
 #endif // __AVX__
 
 #if __AVX__
@@ -34,32 +34,6 @@ typedef union m256i
     __m256i vec;
     uint32_t m256i_u32[8];
 } m256;
-static inline __m256 bfloat2float_avx(__m128i v0)
-{
-    __m128i zero = _mm_set1_epi32(0);
-    __m128i a = _mm_slli_epi32(_mm_unpacklo_epi16(v0, zero), 16);
-    __m128i b = _mm_slli_epi32(_mm_unpackhi_epi16(v0, zero), 16);
-    __m256i ab = _mm256_set1_epi32(0);
-    ab = _mm256_insertf128_si256(ab, a, 0); // insert in low 128-bit lane
-    ab = _mm256_insertf128_si256(ab, b, 1); // insert in high 128-bit lane
-    return _mm256_castsi256_ps(ab);
-}
-static inline __m256i float2bfloat_avx(__m256 v0, __m256 v1)
-{
-    __m256i a = _mm256_castps_si256(v0);
-    a = _mm256_srli_epi32(a, 16);
-    __m256i b = _mm256_castps_si256(v1);
-    b = _mm256_srli_epi32(b, 16);
-    __m256i abab = _mm256_packus_epi32(a, b);
-    return _mm256_permutevar8x32_epi32(abab, _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7));
-}
-static inline __m128i float2bfloat_avx(__m256 v0)
-{
-    __m256i a = _mm256_castps_si256(v0);
-    a = _mm256_srli_epi32(a, 16);
-    __m256i aaaa = _mm256_packus_epi32(a, a);
-    return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(aaaa, _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7)));
-}
 #endif // __AVX__
 
 namespace ncnn {
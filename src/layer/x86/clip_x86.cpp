@@ -24,24 +24,51 @@ Clip_x86::Clip_x86()
 #if __AVX__
     support_packing = true;
 #endif // __AVX__
+#if __AVX512F__
+    support_packing16 = true;
+#endif // __AVX512F__
 }
 
-int Clip_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+// bottom_blob and top_blob may be the same mat
+static void clip_x86(const Mat& bottom_blob, Mat& top_blob, float min, float max, const Option& opt)
 {
-    int w = bottom_top_blob.w;
-    int h = bottom_top_blob.h;
-    int channels = bottom_top_blob.c;
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int channels = bottom_blob.c;
     int size = w * h;
 
 #if __AVX__
-    int elempack = bottom_top_blob.elempack;
+    int elempack = bottom_blob.elempack;
+
+#if __AVX512F__
+    if (elempack == 16)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < channels; q++)
+        {
+            const float* ptr = bottom_blob.channel(q);
+            float* outptr = top_blob.channel(q);
+
+            for (int i = 0; i < size; i++)
+            {
+                __m512 _p = _mm512_loadu_ps(ptr);
+                _mm512_storeu_ps(outptr, _mm512_min_ps(_mm512_max_ps(_p, _mm512_set1_ps(min)), _mm512_set1_ps(max)));
+                ptr += 16;
+                outptr += 16;
+            }
+        }
+
+        return;
+    }
+#endif // __AVX512F__
 
     if (elempack == 8)
     {
         #pragma omp parallel for num_threads(opt.num_threads)
         for (int q = 0; q < channels; q++)
         {
-            float* ptr = bottom_top_blob.channel(q);
+            const float* ptr = bottom_blob.channel(q);
+            float* outptr = top_blob.channel(q);
 
             __m256 _max = _mm256_set1_ps(max);
             __m256 _min = _mm256_set1_ps(min);
@@ -51,33 +78,55 @@ int Clip_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
                 __m256 _ptr = _mm256_loadu_ps(ptr);
                 _ptr = _mm256_max_ps(_ptr, _min);
                 _ptr = _mm256_min_ps(_ptr, _max);
-                _mm256_storeu_ps(ptr, _ptr);
+                _mm256_storeu_ps(outptr, _ptr);
 
                 ptr += 8;
+                outptr += 8;
             }
         }
 
-        return 0;
+        return;
     }
 #endif // __AVX__
 
     #pragma omp parallel for num_threads(opt.num_threads)
     for (int q = 0; q < channels; q++)
     {
-        float* ptr = bottom_top_blob.channel(q);
+        const float* ptr = bottom_blob.channel(q);
+        float* outptr = top_blob.channel(q);
 
         int remain = size;
         for (; remain > 0; remain--)
         {
-            if (*ptr < min)
-                *ptr = min;
+            float v = *ptr;
+            if (v < min)
+                v = min;
+
+            if (v > max)
+                v = max;
 
-            if (*ptr > max)
-                *ptr = max;
+            *outptr = v;
 
             ptr++;
+            outptr++;
         }
     }
+}
+
+int Clip_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    top_blob.create_like(bottom_blob, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    clip_x86(bottom_blob, top_blob, min, max, opt);
+
+    return 0;
+}
+
+int Clip_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    clip_x86(bottom_top_blob, bottom_top_blob, min, max, opt);
 
     return 0;
 }
@@ -126,8 +126,46 @@ static void conv3x3s1_winograd23_transform_kernel_int8_sse(const Mat& kernel, Ma
     }
 }
 
+#if __AVX2__
+// accumulate 16 products of two input channels, _rl and _rh hold the channels interleaved by unpacklo and unpackhi
+// k points to the kernel row of the first channel, the second one follows
+static inline void conv3x3s1_winograd23_int8_dot_avx2(__m256i _rl, __m256i _rh, const short* k, bool pair, __m256i& _suml, __m256i& _sumh)
+{
+    __m256i _k0 = _mm256_loadu_si256((const __m256i*)k);
+    __m256i _k1 = pair ? _mm256_loadu_si256((const __m256i*)(k + 16)) : _mm256_setzero_si256();
+
+#if __AVX512VNNI__
+    _suml = _mm256_dpwssd_epi32(_suml, _rl, _mm256_unpacklo_epi16(_k0, _k1));
+    _sumh = _mm256_dpwssd_epi32(_sumh, _rh, _mm256_unpackhi_epi16(_k0, _k1));
+#else
+    _suml = _mm256_add_epi32(_suml, _mm256_madd_epi16(_rl, _mm256_unpacklo_epi16(_k0, _k1)));
+    _sumh = _mm256_add_epi32(_sumh, _mm256_madd_epi16(_rh, _mm256_unpackhi_epi16(_k0, _k1)));
+#endif // __AVX512VNNI__
+}
+
+// _suml holds elements 0-3 8-11, _sumh holds 4-7 12-15
+static inline void conv3x3s1_winograd23_int8_store_avx2(int* output_tm, __m256i _suml, __m256i _sumh)
+{
+    _mm256_storeu_si256((__m256i*)output_tm, _mm256_permute2x128_si256(_suml, _sumh, 0x20));
+    _mm256_storeu_si256((__m256i*)(output_tm + 8), _mm256_permute2x128_si256(_suml, _sumh, 0x31));
+}
+#endif // __AVX2__
+
+#if NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+// compiled with vnni in convolution_x86_avx512vnni.cpp
+void conv3x3s1_winograd23_int8_sse_avx512vnni(const Mat& bottom_blob, Mat& top_blob, const Mat& kernel_tm, const Option& opt);
+#endif // NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+
 static void conv3x3s1_winograd23_int8_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& kernel_tm, const Option& opt)
 {
+#if NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx512_vnni())
+    {
+        conv3x3s1_winograd23_int8_sse_avx512vnni(bottom_blob, top_blob, kernel_tm, opt);
+        return;
+    }
+#endif
+
     int w = bottom_blob.w;
     int h = bottom_blob.h;
     int inch = bottom_blob.c;
@@ -289,6 +327,37 @@ static void conv3x3s1_winograd23_int8_sse(const Mat& bottom_blob, Mat& top_blob,
                 int* output2_tm = out2_tm.row<int>(i);
                 int* output3_tm = out3_tm.row<int>(i);
 
+#if __AVX2__
+                // two input channels per vpmaddwd, the unpack order is undone at store
+                __m256i _sum0l = _mm256_setzero_si256();
+                __m256i _sum0h = _mm256_setzero_si256();
+                __m256i _sum1l = _mm256_setzero_si256();
+                __m256i _sum1h = _mm256_setzero_si256();
+                __m256i _sum2l = _mm256_setzero_si256();
+                __m256i _sum2h = _mm256_setzero_si256();
+                __m256i _sum3l = _mm256_setzero_si256();
+                __m256i _sum3h = _mm256_setzero_si256();
+
+                for (int q = 0; q < inch; q += 2)
+                {
+                    const bool pair = q + 1 < inch;
+
+                    __m256i _r0 = _mm256_loadu_si256((const __m256i*)bottom_blob_tm.channel(q).row<short>(i));
+                    __m256i _r1 = pair ? _mm256_loadu_si256((const __m256i*)bottom_blob_tm.channel(q + 1).row<short>(i)) : _mm256_setzero_si256();
+                    __m256i _rl = _mm256_unpacklo_epi16(_r0, _r1);
+                    __m256i _rh = _mm256_unpackhi_epi16(_r0, _r1);
+
+                    conv3x3s1_winograd23_int8_dot_avx2(_rl, _rh, kernel0_tm.row<short>(q), pair, _sum0l, _sum0h);
+                    conv3x3s1_winograd23_int8_dot_avx2(_rl, _rh, kernel1_tm.row<short>(q), pair, _sum1l, _sum1h);
+                    conv3x3s1_winograd23_int8_dot_avx2(_rl, _rh, kernel2_tm.row<short>(q), pair, _sum2l, _sum2h);
+                    conv3x3s1_winograd23_int8_dot_avx2(_rl, _rh, kernel3_tm.row<short>(q), pair, _sum3l, _sum3h);
+                }
+
+                conv3x3s1_winograd23_int8_store_avx2(output0_tm, _sum0l, _sum0h);
+                conv3x3s1_winograd23_int8_store_avx2(output1_tm, _sum1l, _sum1h);
+                conv3x3s1_winograd23_int8_store_avx2(output2_tm, _sum2l, _sum2h);
+                conv3x3s1_winograd23_int8_store_avx2(output3_tm, _sum3l, _sum3h);
+#else
                 int sum0[16] = {0};
                 int sum1[16] = {0};
                 int sum2[16] = {0};
@@ -372,6 +441,7 @@ static void conv3x3s1_winograd23_int8_sse(const Mat& bottom_blob, Mat& top_blob,
                     output2_tm[n] = sum2[n];
                     output3_tm[n] = sum3[n];
                 }
+#endif // __AVX2__
             }
         }
 
@@ -385,6 +455,24 @@ static void conv3x3s1_winograd23_int8_sse(const Mat& bottom_blob, Mat& top_blob,
             {
                 int* output0_tm = out0_tm.row<int>(i);
 
+#if __AVX2__
+                __m256i _sum0l = _mm256_setzero_si256();
+                __m256i _sum0h = _mm256_setzero_si256();
+
+                for (int q = 0; q < inch; q += 2)
+                {
+                    const bool pair = q + 1 < inch;
+
+                    __m256i _r0 = _mm256_loadu_si256((const __m256i*)bottom_blob_tm.channel(q).row<short>(i));
+                    __m256i _r1 = pair ? _mm256_loadu_si256((const __m256i*)bottom_blob_tm.channel(q + 1).row<short>(i)) : _mm256_setzero_si256();
+                    __m256i _rl = _mm256_unpacklo_epi16(_r0, _r1);
+                    __m256i _rh = _mm256_unpackhi_epi16(_r0, _r1);
+
+                    conv3x3s1_winograd23_int8_dot_avx2(_rl, _rh, kernel0_tm.row<short>(q), pair, _sum0l, _sum0h);
+                }
+
+                conv3x3s1_winograd23_int8_store_avx2(output0_tm, _sum0l, _sum0h);
+#else
                 int sum0[16] = {0};
 
                 int q = 0;
@@ -424,6 +512,7 @@ static void conv3x3s1_winograd23_int8_sse(const Mat& bottom_blob, Mat& top_blob,
                 {
                     output0_tm[n] = sum0[n];
                 }
+#endif // __AVX2__
             }
         }
     }
@@ -12,6 +12,7 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 
+template<typename T>
 static void conv3x3s1_pack1to8_avx(const Mat& bottom_blob, Mat& top_blob, const Mat& kernel, const Mat& _bias, const Option& opt)
 {
     int inch = bottom_blob.c;
@@ -36,8 +37,8 @@ static void conv3x3s1_pack1to8_avx(const Mat& bottom_blob, Mat& top_blob, const
         out0.fill(_bias0);
         out1.fill(_bias1);
 
-        const float* k0 = kernel.channel(p);
-        const float* k1 = kernel.channel(p + 1);
+        const T* k0 = kernel.channel(p);
+        const T* k1 = kernel.channel(p + 1);
 
         for (int q = 0; q < inch; q++)
         {
@@ -50,25 +51,25 @@ static void conv3x3s1_pack1to8_avx(const Mat& bottom_blob, Mat& top_blob, const
             const float* r1 = img0.row(1);
             const float* r2 = img0.row(2);
 
-            __m256 _k00_0 = _mm256_loadu_ps(k0);
-            __m256 _k01_0 = _mm256_loadu_ps(k0 + 8);
-            __m256 _k02_0 = _mm256_loadu_ps(k0 + 16);
-            __m256 _k10_0 = _mm256_loadu_ps(k0 + 24);
-            __m256 _k11_0 = _mm256_loadu_ps(k0 + 32);
-            __m256 _k12_0 = _mm256_loadu_ps(k0 + 40);
-            __m256 _k20_0 = _mm256_loadu_ps(k0 + 48);
-            __m256 _k21_0 = _mm256_loadu_ps(k0 + 56);
-            __m256 _k22_0 = _mm256_loadu_ps(k0 + 64);
-
-            __m256 _k00_1 = _mm256_loadu_ps(k1);
-            __m256 _k01_1 = _mm256_loadu_ps(k1 + 8);
-            __m256 _k02_1 = _mm256_loadu_ps(k1 + 16);
-            __m256 _k10_1 = _mm256_loadu_ps(k1 + 24);
-            __m256 _k11_1 = _mm256_loadu_ps(k1 + 32);
-            __m256 _k12_1 = _mm256_loadu_ps(k1 + 40);
-            __m256 _k20_1 = _mm256_loadu_ps(k1 + 48);
-            __m256 _k21_1 = _mm256_loadu_ps(k1 + 56);
-            __m256 _k22_1 = _mm256_loadu_ps(k1 + 64);
+            __m256 _k00_0 = loadweight(k0);
+            __m256 _k01_0 = loadweight(k0 + 8);
+            __m256 _k02_0 = loadweight(k0 + 16);
+            __m256 _k10_0 = loadweight(k0 + 24);
+            __m256 _k11_0 = loadweight(k0 + 32);
+            __m256 _k12_0 = loadweight(k0 + 40);
+            __m256 _k20_0 = loadweight(k0 + 48);
+            __m256 _k21_0 = loadweight(k0 + 56);
+            __m256 _k22_0 = loadweight(k0 + 64);
+
+            __m256 _k00_1 = loadweight(k1);
+            __m256 _k01_1 = loadweight(k1 + 8);
+            __m256 _k02_1 = loadweight(k1 + 16);
+            __m256 _k10_1 = loadweight(k1 + 24);
+            __m256 _k11_1 = loadweight(k1 + 32);
+            __m256 _k12_1 = loadweight(k1 + 40);
+            __m256 _k20_1 = loadweight(k1 + 48);
+            __m256 _k21_1 = loadweight(k1 + 56);
+            __m256 _k22_1 = loadweight(k1 + 64);
 
             int i = 0;
 
@@ -348,7 +349,7 @@ static void conv3x3s1_pack1to8_avx(const Mat& bottom_blob, Mat& top_blob, const
         __m256 _bias0 = bias ? _mm256_loadu_ps((const float*)bias + p * 8) : _mm256_set1_ps(0.f);
         out0.fill(_bias0);
 
-        const float* k0 = kernel.channel(p);
+        const T* k0 = kernel.channel(p);
 
         for (int q = 0; q < inch; q++)
         {
@@ -360,15 +361,15 @@ static void conv3x3s1_pack1to8_avx(const Mat& bottom_blob, Mat& top_blob, const
             const float* r1 = img0.row(1);
             const float* r2 = img0.row(2);
 
-            __m256 _k00 = _mm256_loadu_ps(k0);
-            __m256 _k01 = _mm256_loadu_ps(k0 + 8);
-            __m256 _k02 = _mm256_loadu_ps(k0 + 16);
-            __m256 _k10 = _mm256_loadu_ps(k0 + 24);
-            __m256 _k11 = _mm256_loadu_ps(k0 + 32);
-            __m256 _k12 = _mm256_loadu_ps(k0 + 40);
-            __m256 _k20 = _mm256_loadu_ps(k0 + 48);
-            __m256 _k21 = _mm256_loadu_ps(k0 + 56);
-            __m256 _k22 = _mm256_loadu_ps(k0 + 64);
+            __m256 _k00 = loadweight(k0);
+            __m256 _k01 = loadweight(k0 + 8);
+            __m256 _k02 = loadweight(k0 + 16);
+            __m256 _k10 = loadweight(k0 + 24);
+            __m256 _k11 = loadweight(k0 + 32);
+            __m256 _k12 = loadweight(k0 + 40);
+            __m256 _k20 = loadweight(k0 + 48);
+            __m256 _k21 = loadweight(k0 + 56);
+            __m256 _k22 = loadweight(k0 + 64);
 
             int i = 0;
 
@@ -542,6 +543,7 @@ static void conv3x3s1_pack1to8_avx(const Mat& bottom_blob, Mat& top_blob, const
     }
 }
 
+template<typename T>
 static void conv3x3s2_pack1to8_avx(const Mat& bottom_blob, Mat& top_blob, const Mat& kernel, const Mat& _bias, const Option& opt)
 {
     int w = bottom_blob.w;
@@ -570,8 +572,8 @@ static void conv3x3s2_pack1to8_avx(const Mat& bottom_blob, Mat& top_blob, const
         out0.fill(_bias0);
         out1.fill(_bias1);
 
-        const float* k0 = kernel.channel(p);
-        const float* k1 = kernel.channel(p + 1);
+        const T* k0 = kernel.channel(p);
+        const T* k1 = kernel.channel(p + 1);
 
         for (int q = 0; q < inch; q++)
         {
@@ -584,25 +586,25 @@ static void conv3x3s2_pack1to8_avx(const Mat& bottom_blob, Mat& top_blob, const
             const float* r1 = img0.row(1);
             const float* r2 = img0.row(2);
 
-            __m256 _k00_0 = _mm256_loadu_ps(k0);
-            __m256 _k01_0 = _mm256_loadu_ps(k0 + 8);
-            __m256 _k02_0 = _mm256_loadu_ps(k0 + 16);
-            __m256 _k10_0 = _mm256_loadu_ps(k0 + 24);
-            __m256 _k11_0 = _mm256_loadu_ps(k0 + 32);
-            __m256 _k12_0 = _mm256_loadu_ps(k0 + 40);
-            __m256 _k20_0 = _mm256_loadu_ps(k0 + 48);
-            __m256 _k21_0 = _mm256_loadu_ps(k0 + 56);
-            __m256 _k22_0 = _mm256_loadu_ps(k0 + 64);
-
-            __m256 _k00_1 = _mm256_loadu_ps(k1);
-            __m256 _k01_1 = _mm256_loadu_ps(k1 + 8);
-            __m256 _k02_1 = _mm256_loadu_ps(k1 + 16);
-            __m256 _k10_1 = _mm256_loadu_ps(k1 + 24);
-            __m256 _k11_1 = _mm256_loadu_ps(k1 + 32);
-            __m256 _k12_1 = _mm256_loadu_ps(k1 + 40);
-            __m256 _k20_1 = _mm256_loadu_ps(k1 + 48);
-            __m256 _k21_1 = _mm256_loadu_ps(k1 + 56);
-            __m256 _k22_1 = _mm256_loadu_ps(k1 + 64);
+            __m256 _k00_0 = loadweight(k0);
+            __m256 _k01_0 = loadweight(k0 + 8);
+            __m256 _k02_0 = loadweight(k0 + 16);
+            __m256 _k10_0 = loadweight(k0 + 24);
+            __m256 _k11_0 = loadweight(k0 + 32);
+            __m256 _k12_0 = loadweight(k0 + 40);
+            __m256 _k20_0 = loadweight(k0 + 48);
+            __m256 _k21_0 = loadweight(k0 + 56);
+            __m256 _k22_0 = loadweight(k0 + 64);
+
+            __m256 _k00_1 = loadweight(k1);
+            __m256 _k01_1 = loadweight(k1 + 8);
+            __m256 _k02_1 = loadweight(k1 + 16);
+            __m256 _k10_1 = loadweight(k1 + 24);
+            __m256 _k11_1 = loadweight(k1 + 32);
+            __m256 _k12_1 = loadweight(k1 + 40);
+            __m256 _k20_1 = loadweight(k1 + 48);
+            __m256 _k21_1 = loadweight(k1 + 56);
+            __m256 _k22_1 = loadweight(k1 + 64);
 
             int i = 0;
 
@@ -1164,7 +1166,7 @@ static void conv3x3s2_pack1to8_avx(const Mat& bottom_blob, Mat& top_blob, const
         __m256 _bias0 = bias ? _mm256_loadu_ps((const float*)bias + p * 8) : _mm256_set1_ps(0.f);
         out0.fill(_bias0);
 
-        const float* k0 = kernel.channel(p);
+        const T* k0 = kernel.channel(p);
 
         for (int q = 0; q < inch; q++)
         {
@@ -1176,15 +1178,15 @@ static void conv3x3s2_pack1to8_avx(const Mat& bottom_blob, Mat& top_blob, const
             const float* r1 = img0.row(1);
             const float* r2 = img0.row(2);
 
-            __m256 _k00_0 = _mm256_loadu_ps(k0);
-            __m256 _k01_0 = _mm256_loadu_ps(k0 + 8);
-            __m256 _k02_0 = _mm256_loadu_ps(k0 + 16);
-            __m256 _k10_0 = _mm256_loadu_ps(k0 + 24);
-            __m256 _k11_0 = _mm256_loadu_ps(k0 + 32);
-            __m256 _k12_0 = _mm256_loadu_ps(k0 + 40);
-            __m256 _k20_0 = _mm256_loadu_ps(k0 + 48);
-            __m256 _k21_0 = _mm256_loadu_ps(k0 + 56);
-            __m256 _k22_0 = _mm256_loadu_ps(k0 + 64);
+            __m256 _k00_0 = loadweight(k0);
+            __m256 _k01_0 = loadweight(k0 + 8);
+            __m256 _k02_0 = loadweight(k0 + 16);
+            __m256 _k10_0 = loadweight(k0 + 24);
+            __m256 _k11_0 = loadweight(k0 + 32);
+            __m256 _k12_0 = loadweight(k0 + 40);
+            __m256 _k20_0 = loadweight(k0 + 48);
+            __m256 _k21_0 = loadweight(k0 + 56);
+            __m256 _k22_0 = loadweight(k0 + 64);
 
             int i = 0;
 
@@ -12,6 +12,7 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 
+template<typename T>
 static void conv3x3s1_pack8to1_avx(const Mat& bottom_blob, Mat& top_blob, const Mat& kernel, const Mat& _bias, const Option& opt)
 {
     int inch = bottom_blob.c;
@@ -31,7 +32,7 @@ static void conv3x3s1_pack8to1_avx(const Mat& bottom_blob, Mat& top_blob, const
         const float bias0 = bias ? bias[p] : 0.f;
         out0.fill(bias0);
 
-        const float* k0 = kernel.channel(p);
+        const T* k0 = kernel.channel(p);
 
         for (int q = 0; q < inch; q++)
         {
@@ -39,15 +40,15 @@ static void conv3x3s1_pack8to1_avx(const Mat& bottom_blob, Mat& top_blob, const
 
             const Mat img0 = bottom_blob.channel(q);
 
-            __m256 _k00 = _mm256_loadu_ps(k0);
-            __m256 _k01 = _mm256_loadu_ps(k0 + 8);
-            __m256 _k02 = _mm256_loadu_ps(k0 + 16);
-            __m256 _k10 = _mm256_loadu_ps(k0 + 24);
-            __m256 _k11 = _mm256_loadu_ps(k0 + 32);
-            __m256 _k12 = _mm256_loadu_ps(k0 + 40);
-            __m256 _k20 = _mm256_loadu_ps(k0 + 48);
-            __m256 _k21 = _mm256_loadu_ps(k0 + 56);
-            __m256 _k22 = _mm256_loadu_ps(k0 + 64);
+            __m256 _k00 = loadweight(k0);
+            __m256 _k01 = loadweight(k0 + 8);
+            __m256 _k02 = loadweight(k0 + 16);
+            __m256 _k10 = loadweight(k0 + 24);
+            __m256 _k11 = loadweight(k0 + 32);
+            __m256 _k12 = loadweight(k0 + 40);
+            __m256 _k20 = loadweight(k0 + 48);
+            __m256 _k21 = loadweight(k0 + 56);
+            __m256 _k22 = loadweight(k0 + 64);
 
             int i = 0;
 
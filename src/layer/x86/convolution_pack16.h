@@ -0,0 +1,274 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+static void convolution_transform_kernel_pack16_avx512(const Mat& weight_data, Mat& weight_data_pack16, int num_input, int num_output, int kernel_w, int kernel_h)
+{
+    const int maxk = kernel_w * kernel_h;
+
+    // src = kw-kh-inch-outch
+    // dst = 16b-16a-kw-kh-inch/16a-outch/16b
+    Mat weight_data_r2 = weight_data.reshape(maxk, num_input, num_output);
+
+    weight_data_pack16.create(maxk, num_input / 16, num_output / 16, (size_t)4 * 256, 256);
+
+    for (int q = 0; q + 15 < num_output; q += 16)
+    {
+        Mat g0 = weight_data_pack16.channel(q / 16);
+
+        for (int p = 0; p + 15 < num_input; p += 16)
+        {
+            float* g00 = g0.row(p / 16);
+
+            for (int k = 0; k < maxk; k++)
+            {
+                for (int i = 0; i < 16; i++)
+                {
+                    for (int j = 0; j < 16; j++)
+                    {
+                        const float* k00 = weight_data_r2.channel(q + j).row(p + i);
+
+                        g00[0] = k00[k];
+
+                        g00++;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// 8 output pixels share every weight load
+template<typename T>
+static void convolution_pack16_avx512(const Mat& bottom_blob, Mat& top_blob, const Mat& weight_data_pack16, const Mat& bias_data, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h, int activation_type, const Mat& activation_params, const Option& opt)
+{
+    int w = bottom_blob.w;
+    int channels = bottom_blob.c;
+
+    int outw = top_blob.w;
+    int outh = top_blob.h;
+    int outch = top_blob.c;
+
+    const int maxk = kernel_w * kernel_h;
+
+    // kernel offsets
+    std::vector<int> _space_ofs(maxk);
+    int* space_ofs = &_space_ofs[0];
+    {
+        int p1 = 0;
+        int p2 = 0;
+        int gap = w * dilation_h - kernel_w * dilation_w;
+        for (int i = 0; i < kernel_h; i++)
+        {
+            for (int j = 0; j < kernel_w; j++)
+            {
+                space_ofs[p1] = p2;
+                p1++;
+                p2 += dilation_w;
+            }
+            p2 += gap;
+        }
+    }
+
+    const float* bias_data_ptr = bias_data;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int p = 0; p < outch; p++)
+    {
+        float* outptr = top_blob.channel(p);
+
+        const __m512 _bias0 = bias_data_ptr ? _mm512_loadu_ps(bias_data_ptr + p * 16) : _mm512_setzero_ps();
+
+        for (int i = 0; i < outh; i++)
+        {
+            int j = 0;
+            for (; j + 7 < outw; j += 8)
+            {
+                __m512 _sum0 = _bias0;
+                __m512 _sum1 = _bias0;
+                __m512 _sum2 = _bias0;
+                __m512 _sum3 = _bias0;
+                __m512 _sum4 = _bias0;
+                __m512 _sum5 = _bias0;
+                __m512 _sum6 = _bias0;
+                __m512 _sum7 = _bias0;
+
+                const T* kptr = weight_data_pack16.channel(p);
+
+                for (int q = 0; q < channels; q++)
+                {
+                    const Mat m = bottom_blob.channel(q);
+                    const float* sptr = m.row(i * stride_h) + j * stride_w * 16;
+
+                    for (int k = 0; k < maxk; k++)
+                    {
+                        const float* s0 = sptr + space_ofs[k] * 16;
+                        const float* s1 = s0 + stride_w * 16;
+                        const float* s2 = s1 + stride_w * 16;
+                        const float* s3 = s2 + stride_w * 16;
+                        const float* s4 = s3 + stride_w * 16;
+                        const float* s5 = s4 + stride_w * 16;
+                        const float* s6 = s5 + stride_w * 16;
+                        const float* s7 = s6 + stride_w * 16;
+
+                        for (int l = 0; l < 16; l++)
+                        {
+                            __m512 _w = loadweight_avx512(kptr + l * 16);
+
+                            _sum0 = _mm512_fmadd_ps(_mm512_set1_ps(s0[l]), _w, _sum0);
+                            _sum1 = _mm512_fmadd_ps(_mm512_set1_ps(s1[l]), _w, _sum1);
+                            _sum2 = _mm512_fmadd_ps(_mm512_set1_ps(s2[l]), _w, _sum2);
+                            _sum3 = _mm512_fmadd_ps(_mm512_set1_ps(s3[l]), _w, _sum3);
+                            _sum4 = _mm512_fmadd_ps(_mm512_set1_ps(s4[l]), _w, _sum4);
+                            _sum5 = _mm512_fmadd_ps(_mm512_set1_ps(s5[l]), _w, _sum5);
+                            _sum6 = _mm512_fmadd_ps(_mm512_set1_ps(s6[l]), _w, _sum6);
+                            _sum7 = _mm512_fmadd_ps(_mm512_set1_ps(s7[l]), _w, _sum7);
+                        }
+
+                        kptr += 256;
+                    }
+                }
+
+                _mm512_storeu_ps(outptr, activation_ps(_sum0, activation_type, activation_params));
+                _mm512_storeu_ps(outptr + 16, activation_ps(_sum1, activation_type, activation_params));
+                _mm512_storeu_ps(outptr + 16 * 2, activation_ps(_sum2, activation_type, activation_params));
+                _mm512_storeu_ps(outptr + 16 * 3, activation_ps(_sum3, activation_type, activation_params));
+                _mm512_storeu_ps(outptr + 16 * 4, activation_ps(_sum4, activation_type, activation_params));
+                _mm512_storeu_ps(outptr + 16 * 5, activation_ps(_sum5, activation_type, activation_params));
+                _mm512_storeu_ps(outptr + 16 * 6, activation_ps(_sum6, activation_type, activation_params));
+                _mm512_storeu_ps(outptr + 16 * 7, activation_ps(_sum7, activation_type, activation_params));
+
+                outptr += 16 * 8;
+            }
+            for (; j < outw; j++)
+            {
+                __m512 _sum = _bias0;
+
+                const T* kptr = weight_data_pack16.channel(p);
+
+                for (int q = 0; q < channels; q++)
+                {
+                    const Mat m = bottom_blob.channel(q);
+                    const float* sptr = m.row(i * stride_h) + j * stride_w * 16;
+
+                    for (int k = 0; k < maxk; k++)
+                    {
+                        const float* s0 = sptr + space_ofs[k] * 16;
+
+                        for (int l = 0; l < 16; l++)
+                        {
+                            __m512 _w = loadweight_avx512(kptr + l * 16);
+                            _sum = _mm512_fmadd_ps(_mm512_set1_ps(s0[l]), _w, _sum);
+                        }
+
+                        kptr += 256;
+                    }
+                }
+
+                _mm512_storeu_ps(outptr, activation_ps(_sum, activation_type, activation_params));
+
+                outptr += 16;
+            }
+        }
+    }
+}
+
+template<typename T>
+static void conv1x1s1_sgemm_pack16_avx512(const Mat& bottom_blob, Mat& top_blob, const Mat& weight_data_pack16, const Mat& bias_data, int activation_type, const Mat& activation_params, const Option& opt)
+{
+    int channels = bottom_blob.c;
+    int outch = top_blob.c;
+
+    // pixels of a channel are contiguous, run them as one row
+    const int size = top_blob.w * top_blob.h;
+
+    const float* bias_data_ptr = bias_data;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int p = 0; p < outch; p++)
+    {
+        float* outptr = top_blob.channel(p);
+
+        const __m512 _bias0 = bias_data_ptr ? _mm512_loadu_ps(bias_data_ptr + p * 16) : _mm512_setzero_ps();
+
+        int i = 0;
+        for (; i + 7 < size; i += 8)
+        {
+            __m512 _sum0 = _bias0;
+            __m512 _sum1 = _bias0;
+            __m512 _sum2 = _bias0;
+            __m512 _sum3 = _bias0;
+            __m512 _sum4 = _bias0;
+            __m512 _sum5 = _bias0;
+            __m512 _sum6 = _bias0;
+            __m512 _sum7 = _bias0;
+
+            const T* kptr = weight_data_pack16.channel(p);
+
+            for (int q = 0; q < channels; q++)
+            {
+                const float* r0 = (const float*)bottom_blob.channel(q) + i * 16;
+
+                for (int l = 0; l < 16; l++)
+                {
+                    __m512 _w = loadweight_avx512(kptr + l * 16);
+
+                    _sum0 = _mm512_fmadd_ps(_mm512_set1_ps(r0[l]), _w, _sum0);
+                    _sum1 = _mm512_fmadd_ps(_mm512_set1_ps(r0[16 + l]), _w, _sum1);
+                    _sum2 = _mm512_fmadd_ps(_mm512_set1_ps(r0[16 * 2 + l]), _w, _sum2);
+                    _sum3 = _mm512_fmadd_ps(_mm512_set1_ps(r0[16 * 3 + l]), _w, _sum3);
+                    _sum4 = _mm512_fmadd_ps(_mm512_set1_ps(r0[16 * 4 + l]), _w, _sum4);
+                    _sum5 = _mm512_fmadd_ps(_mm512_set1_ps(r0[16 * 5 + l]), _w, _sum5);
+                    _sum6 = _mm512_fmadd_ps(_mm512_set1_ps(r0[16 * 6 + l]), _w, _sum6);
+                    _sum7 = _mm512_fmadd_ps(_mm512_set1_ps(r0[16 * 7 + l]), _w, _sum7);
+                }
+
+                kptr += 256;
+            }
+
+            _mm512_storeu_ps(outptr, activation_ps(_sum0, activation_type, activation_params));
+            _mm512_storeu_ps(outptr + 16, activation_ps(_sum1, activation_type, activation_params));
+            _mm512_storeu_ps(outptr + 16 * 2, activation_ps(_sum2, activation_type, activation_params));
+            _mm512_storeu_ps(outptr + 16 * 3, activation_ps(_sum3, activation_type, activation_params));
+            _mm512_storeu_ps(outptr + 16 * 4, activation_ps(_sum4, activation_type, activation_params));
+            _mm512_storeu_ps(outptr + 16 * 5, activation_ps(_sum5, activation_type, activation_params));
+            _mm512_storeu_ps(outptr + 16 * 6, activation_ps(_sum6, activation_type, activation_params));
+            _mm512_storeu_ps(outptr + 16 * 7, activation_ps(_sum7, activation_type, activation_params));
+
+            outptr += 16 * 8;
+        }
+        for (; i < size; i++)
+        {
+            __m512 _sum = _bias0;
+
+            const T* kptr = weight_data_pack16.channel(p);
+
+            for (int q = 0; q < channels; q++)
+            {
+                const float* r0 = (const float*)bottom_blob.channel(q) + i * 16;
+
+                for (int l = 0; l < 16; l++)
+                {
+                    __m512 _w = loadweight_avx512(kptr + l * 16);
+                    _sum = _mm512_fmadd_ps(_mm512_set1_ps(r0[l]), _w, _sum);
+                }
+
+                kptr += 256;
+            }
+
+            _mm512_storeu_ps(outptr, activation_ps(_sum, activation_type, activation_params));
+
+            outptr += 16;
+        }
+    }
+}
@@ -20,9 +20,277 @@ static inline signed char float2int8(float v)
     return (signed char)int32;
 }
 
+#if __AVX2__
+// 4 outch x 4 outsize, k interleaved in pairs as in kernel_tm and bottom_tm
+// int8 is widened to int16 so that vpmaddwd yields exact int32 sums of k pairs
+static void conv_im2col_sgemm_int8_4x4_avx2(const signed char* va, const signed char* vb, int K, int* sum0, int* sum1, int* sum2, int* sum3)
+{
+    __m256i _sum0 = _mm256_setzero_si256();
+    __m256i _sum1 = _mm256_setzero_si256();
+    __m256i _sum2 = _mm256_setzero_si256();
+    __m256i _sum3 = _mm256_setzero_si256();
+
+    int k = 0;
+#if __AVX512VNNI__
+    // vpdpbusd takes unsigned x signed bytes, so vb is biased by 128 and 128 * sum(va) is taken back afterwards
+    __m128i _vs0 = _mm_setzero_si128();
+    __m128i _vs1 = _mm_setzero_si128();
+    __m128i _vs2 = _mm_setzero_si128();
+    __m128i _vs3 = _mm_setzero_si128();
+    if (K >= 8)
+    {
+        // regroup the k pairs into 4 consecutive k per dword, low lane k0-k3, high lane k4-k7
+        const __m256i _shuf = _mm256_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15, 0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
+        const __m256i _v128 = _mm256_set1_epi8((char)0x80);
+        const __m256i _ones = _mm256_set1_epi8(1);
+
+        __m256i _vsum0 = _mm256_setzero_si256();
+        __m256i _vsum1 = _mm256_setzero_si256();
+        __m256i _vsum2 = _mm256_setzero_si256();
+        __m256i _vsum3 = _mm256_setzero_si256();
+        __m256i _asum = _mm256_setzero_si256();
+        for (; k + 7 < K; k += 8)
+        {
+            __m256i _va = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)va), _shuf);
+            __m256i _vb = _mm256_xor_si256(_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)vb), _shuf), _v128);
+
+            _vsum0 = _mm256_dpbusd_epi32(_vsum0, _vb, _mm256_shuffle_epi32(_va, _MM_SHUFFLE(0, 0, 0, 0)));
+            _vsum1 = _mm256_dpbusd_epi32(_vsum1, _vb, _mm256_shuffle_epi32(_va, _MM_SHUFFLE(1, 1, 1, 1)));
+            _vsum2 = _mm256_dpbusd_epi32(_vsum2, _vb, _mm256_shuffle_epi32(_va, _MM_SHUFFLE(2, 2, 2, 2)));
+            _vsum3 = _mm256_dpbusd_epi32(_vsum3, _vb, _mm256_shuffle_epi32(_va, _MM_SHUFFLE(3, 3, 3, 3)));
+            _asum = _mm256_dpbusd_epi32(_asum, _ones, _va);
+
+            va += 32;
+            vb += 32;
+        }
+
+        __m128i _as = _mm_add_epi32(_mm256_castsi256_si128(_asum), _mm256_extracti128_si256(_asum, 1));
+        _as = _mm_slli_epi32(_as, 7);
+
+        _vs0 = _mm_add_epi32(_mm256_castsi256_si128(_vsum0), _mm256_extracti128_si256(_vsum0, 1));
+        _vs1 = _mm_add_epi32(_mm256_castsi256_si128(_vsum1), _mm256_extracti128_si256(_vsum1, 1));
+        _vs2 = _mm_add_epi32(_mm256_castsi256_si128(_vsum2), _mm256_extracti128_si256(_vsum2, 1));
+        _vs3 = _mm_add_epi32(_mm256_castsi256_si128(_vsum3), _mm256_extracti128_si256(_vsum3, 1));
+        _vs0 = _mm_sub_epi32(_vs0, _mm_shuffle_epi32(_as, _MM_SHUFFLE(0, 0, 0, 0)));
+        _vs1 = _mm_sub_epi32(_vs1, _mm_shuffle_epi32(_as, _MM_SHUFFLE(1, 1, 1, 1)));
+        _vs2 = _mm_sub_epi32(_vs2, _mm_shuffle_epi32(_as, _MM_SHUFFLE(2, 2, 2, 2)));
+        _vs3 = _mm_sub_epi32(_vs3, _mm_shuffle_epi32(_as, _MM_SHUFFLE(3, 3, 3, 3)));
+    }
+#endif // __AVX512VNNI__
+    for (; k + 3 < K; k += 4)
+    {
+        // low lane k0k1, high lane k2k3
+        __m256i _va = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)va));
+        __m256i _vb = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)vb));
+
+        _sum0 = _mm256_add_epi32(_sum0, _mm256_madd_epi16(_mm256_shuffle_epi32(_va, _MM_SHUFFLE(0, 0, 0, 0)), _vb));
+        _sum1 = _mm256_add_epi32(_sum1, _mm256_madd_epi16(_mm256_shuffle_epi32(_va, _MM_SHUFFLE(1, 1, 1, 1)), _vb));
+        _sum2 = _mm256_add_epi32(_sum2, _mm256_madd_epi16(_mm256_shuffle_epi32(_va, _MM_SHUFFLE(2, 2, 2, 2)), _vb));
+        _sum3 = _mm256_add_epi32(_sum3, _mm256_madd_epi16(_mm256_shuffle_epi32(_va, _MM_SHUFFLE(3, 3, 3, 3)), _vb));
+
+        va += 16;
+        vb += 16;
+    }
+
+    __m128i _s0 = _mm_add_epi32(_mm256_castsi256_si128(_sum0), _mm256_extracti128_si256(_sum0, 1));
+    __m128i _s1 = _mm_add_epi32(_mm256_castsi256_si128(_sum1), _mm256_extracti128_si256(_sum1, 1));
+    __m128i _s2 = _mm_add_epi32(_mm256_castsi256_si128(_sum2), _mm256_extracti128_si256(_sum2, 1));
+    __m128i _s3 = _mm_add_epi32(_mm256_castsi256_si128(_sum3), _mm256_extracti128_si256(_sum3, 1));
+#if __AVX512VNNI__
+    _s0 = _mm_add_epi32(_s0, _vs0);
+    _s1 = _mm_add_epi32(_s1, _vs1);
+    _s2 = _mm_add_epi32(_s2, _vs2);
+    _s3 = _mm_add_epi32(_s3, _vs3);
+#endif // __AVX512VNNI__
+
+    for (; k + 1 < K; k += 2)
+    {
+        __m128i _va = _mm_cvtepi8_epi16(_mm_loadl_epi64((const __m128i*)va));
+        __m128i _vb = _mm_cvtepi8_epi16(_mm_loadl_epi64((const __m128i*)vb));
+
+        _s0 = _mm_add_epi32(_s0, _mm_madd_epi16(_mm_shuffle_epi32(_va, _MM_SHUFFLE(0, 0, 0, 0)), _vb));
+        _s1 = _mm_add_epi32(_s1, _mm_madd_epi16(_mm_shuffle_epi32(_va, _MM_SHUFFLE(1, 1, 1, 1)), _vb));
+        _s2 = _mm_add_epi32(_s2, _mm_madd_epi16(_mm_shuffle_epi32(_va, _MM_SHUFFLE(2, 2, 2, 2)), _vb));
+        _s3 = _mm_add_epi32(_s3, _mm_madd_epi16(_mm_shuffle_epi32(_va, _MM_SHUFFLE(3, 3, 3, 3)), _vb));
+
+        va += 8;
+        vb += 8;
+    }
+
+    for (; k < K; k++)
+    {
+        __m128i _vb = _mm_setr_epi32(vb[0], vb[1], vb[2], vb[3]);
+
+        _s0 = _mm_add_epi32(_s0, _mm_mullo_epi32(_mm_set1_epi32(va[0]), _vb));
+        _s1 = _mm_add_epi32(_s1, _mm_mullo_epi32(_mm_set1_epi32(va[1]), _vb));
+        _s2 = _mm_add_epi32(_s2, _mm_mullo_epi32(_mm_set1_epi32(va[2]), _vb));
+        _s3 = _mm_add_epi32(_s3, _mm_mullo_epi32(_mm_set1_epi32(va[3]), _vb));
+
+        va += 4;
+        vb += 4;
+    }
+
+    _mm_storeu_si128((__m128i*)sum0, _s0);
+    _mm_storeu_si128((__m128i*)sum1, _s1);
+    _mm_storeu_si128((__m128i*)sum2, _s2);
+    _mm_storeu_si128((__m128i*)sum3, _s3);
+}
+
+// 4 rows of v4 against the single row of v1, k interleaved in pairs
+// serves both 4 outch x 1 outsize and 1 outch x 4 outsize
+static void conv_im2col_sgemm_int8_4x1_avx2(const signed char* v4, const signed char* v1, int K, int* sum)
+{
+    __m256i _sum = _mm256_setzero_si256();
+
+    int k = 0;
+#if __AVX512VNNI__
+    // v4 is biased by 128 to feed the unsigned operand of vpdpbusd, 128 * sum(v1) is taken back afterwards
+    __m128i _vs = _mm_setzero_si128();
+    if (K >= 8)
+    {
+        const __m256i _shuf = _mm256_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15, 0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
+        const __m256i _v128 = _mm256_set1_epi8((char)0x80);
+        const __m256i _ones = _mm256_set1_epi8(1);
+        const __m256i _bidx = _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1);
+
+        __m256i _vsum = _mm256_setzero_si256();
+        __m256i _csum = _mm256_setzero_si256();
+        for (; k + 7 < K; k += 8)
+        {
+            __m256i _v4 = _mm256_xor_si256(_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)v4), _shuf), _v128);
+            // k0-k3 broadcast to low lane, k4-k7 to high lane
+            __m256i _v1 = _mm256_permutevar8x32_epi32(_mm256_castsi128_si256(_mm_loadl_epi64((const __m128i*)v1)), _bidx);
+
+            _vsum = _mm256_dpbusd_epi32(_vsum, _v4, _v1);
+            _csum = _mm256_dpbusd_epi32(_csum, _ones, _v1);
+
+            v4 += 32;
+            v1 += 8;
+        }
+
+        __m128i _cs = _mm_add_epi32(_mm256_castsi256_si128(_csum), _mm256_extracti128_si256(_csum, 1));
+        _vs = _mm_add_epi32(_mm256_castsi256_si128(_vsum), _mm256_extracti128_si256(_vsum, 1));
+        _vs = _mm_sub_epi32(_vs, _mm_slli_epi32(_cs, 7));
+    }
+#endif // __AVX512VNNI__
+    for (; k + 3 < K; k += 4)
+    {
+        __m256i _v4 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)v4));
+        // k0k1 broadcast to low lane, k2k3 to high lane
+        __m128i _v1 = _mm_cvtepi8_epi16(_mm_cvtsi32_si128(*(const int*)v1));
+        __m256i _v1p = _mm256_permutevar8x32_epi32(_mm256_castsi128_si256(_v1), _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1));
+
+        _sum = _mm256_add_epi32(_sum, _mm256_madd_epi16(_v4, _v1p));
+
+        v4 += 16;
+        v1 += 4;
+    }
+
+    __m128i _s = _mm_add_epi32(_mm256_castsi256_si128(_sum), _mm256_extracti128_si256(_sum, 1));
+#if __AVX512VNNI__
+    _s = _mm_add_epi32(_s, _vs);
+#endif // __AVX512VNNI__
+
+    for (; k + 1 < K; k += 2)
+    {
+        __m128i _v4 = _mm_cvtepi8_epi16(_mm_loadl_epi64((const __m128i*)v4));
+        __m128i _v1 = _mm_set1_epi32((int)((unsigned short)v1[0] | ((unsigned int)(unsigned short)v1[1] << 16)));
+
+        _s = _mm_add_epi32(_s, _mm_madd_epi16(_v4, _v1));
+
+        v4 += 8;
+        v1 += 2;
+    }
+
+    for (; k < K; k++)
+    {
+        __m128i _v4 = _mm_setr_epi32(v4[0], v4[1], v4[2], v4[3]);
+
+        _s = _mm_add_epi32(_s, _mm_mullo_epi32(_v4, _mm_set1_epi32(v1[0])));
+
+        v4 += 4;
+        v1 += 1;
+    }
+
+    _mm_storeu_si128((__m128i*)sum, _s);
+}
+
+static int conv_im2col_sgemm_int8_dot_avx2(const signed char* va, const signed char* vb, int K)
+{
+    __m256i _sum = _mm256_setzero_si256();
+
+    int k = 0;
+#if __AVX512VNNI__
+    {
+        // vb is biased by 128 for vpdpbusd, 128 * sum(va) is taken back at the end
+        const __m256i _v128 = _mm256_set1_epi8((char)0x80);
+        const __m256i _ones = _mm256_set1_epi8(1);
+
+        __m256i _csum = _mm256_setzero_si256();
+        for (; k + 31 < K; k += 32)
+        {
+            __m256i _va = _mm256_loadu_si256((const __m256i*)va);
+            __m256i _vb = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)vb), _v128);
+
+            _sum = _mm256_dpbusd_epi32(_sum, _vb, _va);
+            _csum = _mm256_dpbusd_epi32(_csum, _ones, _va);
+
+            va += 32;
+            vb += 32;
+        }
+        _sum = _mm256_sub_epi32(_sum, _mm256_slli_epi32(_csum, 7));
+    }
+#endif // __AVX512VNNI__
+    for (; k + 15 < K; k += 16)
+    {
+        __m256i _va = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)va));
+        __m256i _vb = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)vb));
+
+        _sum = _mm256_add_epi32(_sum, _mm256_madd_epi16(_va, _vb));
+
+        va += 16;
+        vb += 16;
+    }
+
+    __m128i _s = _mm_add_epi32(_mm256_castsi256_si128(_sum), _mm256_extracti128_si256(_sum, 1));
+    _s = _mm_add_epi32(_s, _mm_shuffle_epi32(_s, _MM_SHUFFLE(1, 0, 3, 2)));
+    _s = _mm_add_epi32(_s, _mm_shuffle_epi32(_s, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    int sum = _mm_cvtsi128_si32(_s);
+
+    for (; k < K; k++)
+    {
+        sum += (int)va[0] * vb[0];
+
+        va += 1;
+        vb += 1;
+    }
+
+    return sum;
+}
+#endif // __AVX2__
+
+#if NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+// compiled with vnni in convolution_x86_avx512vnni.cpp
+void conv_im2col_sgemm_int8_sse_avx512vnni(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel,
+        const int kernel_w, const int kernel_h, const int stride_w, const int stride_h, const Option& opt);
+void conv_im2col_sgemm_int8_dequant_sse_avx512vnni(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel,
+        const int kernel_w, const int kernel_h, const int stride_w, const int stride_h, const Mat& _bias, std::vector<float> scale_dequant, const Option& opt);
+void conv_im2col_sgemm_int8_requant_sse_avx512vnni(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel,
+        const int kernel_w, const int kernel_h, const int stride_w, const int stride_h, const Mat& _bias, std::vector<float> scale_requant, const Option& opt);
+#endif // NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+
 static void conv_im2col_sgemm_int8_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel,
                                        const int kernel_w, const int kernel_h, const int stride_w, const int stride_h, const Option& opt)
 {
+#if NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx512_vnni())
+    {
+        conv_im2col_sgemm_int8_sse_avx512vnni(bottom_blob, top_blob, _kernel, kernel_w, kernel_h, stride_w, stride_h, opt);
+        return;
+    }
+#endif
+
     int w = bottom_blob.w;
     int inch = bottom_blob.c;
 
@@ -262,6 +530,9 @@ static void conv_im2col_sgemm_int8_sse(const Mat& bottom_blob, Mat& top_blob, co
                 int sum2[4] = {0};
                 int sum3[4] = {0};
 
+#if __AVX2__
+                conv_im2col_sgemm_int8_4x4_avx2(va, vb, K, sum0, sum1, sum2, sum3);
+#else
                 int k = 0;
 
                 for (; k + 1 < K; k = k + 2)
@@ -298,6 +569,7 @@ static void conv_im2col_sgemm_int8_sse(const Mat& bottom_blob, Mat& top_blob, co
                     va += 4;
                     vb += 4;
                 }
+#endif // __AVX2__
 
                 for (int n = 0; n < 4; n++)
                 {
@@ -322,6 +594,16 @@ static void conv_im2col_sgemm_int8_sse(const Mat& bottom_blob, Mat& top_blob, co
                 signed char* vb = bottom_tm.channel(j / 4 + j % 4);
                 signed char* va = kernel_tm.channel(i / 4);
 
+#if __AVX2__
+                {
+                    int sum[4];
+                    conv_im2col_sgemm_int8_4x1_avx2(va, vb, K, sum);
+                    sum0 = sum[0];
+                    sum1 = sum[1];
+                    sum2 = sum[2];
+                    sum3 = sum[3];
+                }
+#else
                 int k = 0;
 
                 for (; k + 1 < K; k = k + 2)
@@ -352,6 +634,7 @@ static void conv_im2col_sgemm_int8_sse(const Mat& bottom_blob, Mat& top_blob, co
                     va += 4;
                     vb += 1;
                 }
+#endif // __AVX2__
 
                 output0[0] = sum0;
                 output1[0] = sum1;
@@ -377,6 +660,9 @@ static void conv_im2col_sgemm_int8_sse(const Mat& bottom_blob, Mat& top_blob, co
                 signed char* va = kernel_tm.channel(i / 4 + i % 4);
                 int sum[4] = {0};
 
+#if __AVX2__
+                conv_im2col_sgemm_int8_4x1_avx2(vb, va, K, sum);
+#else
                 int k = 0;
                 for (; k + 1 < K; k = k + 2)
                 {
@@ -398,6 +684,7 @@ static void conv_im2col_sgemm_int8_sse(const Mat& bottom_blob, Mat& top_blob, co
                     va += 1;
                     vb += 4;
                 }
+#endif // __AVX2__
 
                 for (int n = 0; n < 4; n++)
                 {
@@ -413,6 +700,9 @@ static void conv_im2col_sgemm_int8_sse(const Mat& bottom_blob, Mat& top_blob, co
                 signed char* vb = bottom_tm.channel(j / 4 + j % 4);
                 signed char* va = kernel_tm.channel(i / 4 + i % 4);
 
+#if __AVX2__
+                sum = conv_im2col_sgemm_int8_dot_avx2(va, vb, K);
+#else
                 for (int k = 0; k < K; k++)
                 {
                     sum += (int)va[0] * vb[0];
@@ -420,6 +710,7 @@ static void conv_im2col_sgemm_int8_sse(const Mat& bottom_blob, Mat& top_blob, co
                     va += 1;
                     vb += 1;
                 }
+#endif // __AVX2__
                 output[0] = sum;
 
                 output++;
@@ -458,6 +749,14 @@ static void conv_im2col_sgemm_int8_sse(const Mat& bottom_blob, Mat& top_blob, co
 static void conv_im2col_sgemm_int8_dequant_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel,
         const int kernel_w, const int kernel_h, const int stride_w, const int stride_h, const Mat& _bias, std::vector<float> scale_dequant, const Option& opt)
 {
+#if NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx512_vnni())
+    {
+        conv_im2col_sgemm_int8_dequant_sse_avx512vnni(bottom_blob, top_blob, _kernel, kernel_w, kernel_h, stride_w, stride_h, _bias, scale_dequant, opt);
+        return;
+    }
+#endif
+
     int w = bottom_blob.w;
     int inch = bottom_blob.c;
 
@@ -708,6 +1007,9 @@ static void conv_im2col_sgemm_int8_dequant_sse(const Mat& bottom_blob, Mat& top_
                 int sum2[4] = {0};
                 int sum3[4] = {0};
 
+#if __AVX2__
+                conv_im2col_sgemm_int8_4x4_avx2(va, vb, K, sum0, sum1, sum2, sum3);
+#else
                 int k = 0;
 
                 for (; k + 1 < K; k = k + 2)
@@ -744,7 +1046,14 @@ static void conv_im2col_sgemm_int8_dequant_sse(const Mat& bottom_blob, Mat& top_
                     va += 4;
                     vb += 4;
                 }
-
+#endif // __AVX2__
+
+#if __AVX2__
+                _mm_storeu_ps(output0, _mm_fmadd_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)sum0)), _mm_set1_ps(scale_dequant0), _mm_set1_ps(bias0)));
+                _mm_storeu_ps(output1, _mm_fmadd_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)sum1)), _mm_set1_ps(scale_dequant1), _mm_set1_ps(bias1)));
+                _mm_storeu_ps(output2, _mm_fmadd_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)sum2)), _mm_set1_ps(scale_dequant2), _mm_set1_ps(bias2)));
+                _mm_storeu_ps(output3, _mm_fmadd_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)sum3)), _mm_set1_ps(scale_dequant3), _mm_set1_ps(bias3)));
+#else
                 for (int n = 0; n < 4; n++)
                 {
                     output0[n] = (float)sum0[n] * scale_dequant0 + bias0;
@@ -752,6 +1061,7 @@ static void conv_im2col_sgemm_int8_dequant_sse(const Mat& bottom_blob, Mat& top_
                     output2[n] = (float)sum2[n] * scale_dequant2 + bias2;
                     output3[n] = (float)sum3[n] * scale_dequant3 + bias3;
                 }
+#endif // __AVX2__
                 output0 += 4;
                 output1 += 4;
                 output2 += 4;
@@ -768,6 +1078,16 @@ static void conv_im2col_sgemm_int8_dequant_sse(const Mat& bottom_blob, Mat& top_
                 signed char* vb = bottom_tm.channel(j / 4 + j % 4);
                 signed char* va = kernel_tm.channel(i / 4);
 
+#if __AVX2__
+                {
+                    int sum[4];
+                    conv_im2col_sgemm_int8_4x1_avx2(va, vb, K, sum);
+                    sum0 = sum[0];
+                    sum1 = sum[1];
+                    sum2 = sum[2];
+                    sum3 = sum[3];
+                }
+#else
                 int k = 0;
 
                 for (; k + 1 < K; k = k + 2)
@@ -798,6 +1118,7 @@ static void conv_im2col_sgemm_int8_dequant_sse(const Mat& bottom_blob, Mat& top_
                     va += 4;
                     vb += 1;
                 }
+#endif // __AVX2__
 
                 output0[0] = (float)sum0 * scale_dequant0 + bias0;
                 output1[0] = (float)sum1 * scale_dequant1 + bias1;
@@ -826,6 +1147,9 @@ static void conv_im2col_sgemm_int8_dequant_sse(const Mat& bottom_blob, Mat& top_
                 signed char* va = kernel_tm.channel(i / 4 + i % 4);
                 int sum[4] = {0};
 
+#if __AVX2__
+                conv_im2col_sgemm_int8_4x1_avx2(vb, va, K, sum);
+#else
                 int k = 0;
                 for (; k + 1 < K; k = k + 2)
                 {
@@ -847,6 +1171,7 @@ static void conv_im2col_sgemm_int8_dequant_sse(const Mat& bottom_blob, Mat& top_
                     va += 1;
                     vb += 4;
                 }
+#endif // __AVX2__
 
                 for (int n = 0; n < 4; n++)
                 {
@@ -862,6 +1187,9 @@ static void conv_im2col_sgemm_int8_dequant_sse(const Mat& bottom_blob, Mat& top_
                 signed char* vb = bottom_tm.channel(j / 4 + j % 4);
                 signed char* va = kernel_tm.channel(i / 4 + i % 4);
 
+#if __AVX2__
+                sum = conv_im2col_sgemm_int8_dot_avx2(va, vb, K);
+#else
                 for (int k = 0; k < K; k++)
                 {
                     sum += (int)va[0] * vb[0];
@@ -869,6 +1197,7 @@ static void conv_im2col_sgemm_int8_dequant_sse(const Mat& bottom_blob, Mat& top_
                     va += 1;
                     vb += 1;
                 }
+#endif // __AVX2__
                 output[0] = (float)sum * scale_dequant0 + bias0;
 
                 output++;
@@ -907,6 +1236,14 @@ static void conv_im2col_sgemm_int8_dequant_sse(const Mat& bottom_blob, Mat& top_
 static void conv_im2col_sgemm_int8_requant_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel,
         const int kernel_w, const int kernel_h, const int stride_w, const int stride_h, const Mat& _bias, std::vector<float> scale_requant, const Option& opt)
 {
+#if NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx512_vnni())
+    {
+        conv_im2col_sgemm_int8_requant_sse_avx512vnni(bottom_blob, top_blob, _kernel, kernel_w, kernel_h, stride_w, stride_h, _bias, scale_requant, opt);
+        return;
+    }
+#endif
+
     int w = bottom_blob.w;
     int inch = bottom_blob.c;
 
@@ -1161,6 +1498,9 @@ static void conv_im2col_sgemm_int8_requant_sse(const Mat& bottom_blob, Mat& top_
                 int sum2[4] = {0};
                 int sum3[4] = {0};
 
+#if __AVX2__
+                conv_im2col_sgemm_int8_4x4_avx2(va, vb, K, sum0, sum1, sum2, sum3);
+#else
                 int k = 0;
 
                 for (; k + 1 < K; k = k + 2)
@@ -1197,7 +1537,18 @@ static void conv_im2col_sgemm_int8_requant_sse(const Mat& bottom_blob, Mat& top_
                     va += 4;
                     vb += 4;
                 }
-
+#endif // __AVX2__
+
+#if __AVX2__
+                __m128 _out0 = _mm_fmadd_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)sum0)), _mm_set1_ps(scale_requant_in0), _mm_set1_ps(bias0));
+                __m128 _out1 = _mm_fmadd_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)sum1)), _mm_set1_ps(scale_requant_in1), _mm_set1_ps(bias1));
+                __m128 _out2 = _mm_fmadd_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)sum2)), _mm_set1_ps(scale_requant_in2), _mm_set1_ps(bias2));
+                __m128 _out3 = _mm_fmadd_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)sum3)), _mm_set1_ps(scale_requant_in3), _mm_set1_ps(bias3));
+                *(int*)output0 = _mm_cvtsi128_si32(float2int8_sse(_mm_mul_ps(_out0, _mm_set1_ps(scale_requant_out0))));
+                *(int*)output1 = _mm_cvtsi128_si32(float2int8_sse(_mm_mul_ps(_out1, _mm_set1_ps(scale_requant_out1))));
+                *(int*)output2 = _mm_cvtsi128_si32(float2int8_sse(_mm_mul_ps(_out2, _mm_set1_ps(scale_requant_out2))));
+                *(int*)output3 = _mm_cvtsi128_si32(float2int8_sse(_mm_mul_ps(_out3, _mm_set1_ps(scale_requant_out3))));
+#else
                 for (int n = 0; n < 4; n++)
                 {
                     output0[n] = float2int8(((float)sum0[n] * scale_requant_in0 + bias0) * scale_requant_out0);
@@ -1205,6 +1556,7 @@ static void conv_im2col_sgemm_int8_requant_sse(const Mat& bottom_blob, Mat& top_
                     output2[n] = float2int8(((float)sum2[n] * scale_requant_in2 + bias2) * scale_requant_out2);
                     output3[n] = float2int8(((float)sum3[n] * scale_requant_in3 + bias3) * scale_requant_out3);
                 }
+#endif // __AVX2__
                 output0 += 4;
                 output1 += 4;
                 output2 += 4;
@@ -1221,6 +1573,16 @@ static void conv_im2col_sgemm_int8_requant_sse(const Mat& bottom_blob, Mat& top_
                 signed char* vb = bottom_tm.channel(j / 4 + j % 4);
                 signed char* va = kernel_tm.channel(i / 4);
 
+#if __AVX2__
+                {
+                    int sum[4];
+                    conv_im2col_sgemm_int8_4x1_avx2(va, vb, K, sum);
+                    sum0 = sum[0];
+                    sum1 = sum[1];
+                    sum2 = sum[2];
+                    sum3 = sum[3];
+                }
+#else
                 int k = 0;
 
                 for (; k + 1 < K; k = k + 2)
@@ -1251,6 +1613,7 @@ static void conv_im2col_sgemm_int8_requant_sse(const Mat& bottom_blob, Mat& top_
                     va += 4;
                     vb += 1;
                 }
+#endif // __AVX2__
 
                 output0[0] = float2int8(((float)sum0 * scale_requant_in0 + bias0) * scale_requant_out0);
                 output1[0] = float2int8(((float)sum1 * scale_requant_in1 + bias1) * scale_requant_out1);
@@ -1281,6 +1644,9 @@ static void conv_im2col_sgemm_int8_requant_sse(const Mat& bottom_blob, Mat& top_
                 signed char* va = kernel_tm.channel(i / 4 + i % 4);
                 int sum[4] = {0};
 
+#if __AVX2__
+                conv_im2col_sgemm_int8_4x1_avx2(vb, va, K, sum);
+#else
                 int k = 0;
                 for (; k + 1 < K; k = k + 2)
                 {
@@ -1302,6 +1668,7 @@ static void conv_im2col_sgemm_int8_requant_sse(const Mat& bottom_blob, Mat& top_
                     va += 1;
                     vb += 4;
                 }
+#endif // __AVX2__
 
                 for (int n = 0; n < 4; n++)
                 {
@@ -1317,6 +1684,9 @@ static void conv_im2col_sgemm_int8_requant_sse(const Mat& bottom_blob, Mat& top_
                 signed char* vb = bottom_tm.channel(j / 4 + j % 4);
                 signed char* va = kernel_tm.channel(i / 4 + i % 4);
 
+#if __AVX2__
+                sum = conv_im2col_sgemm_int8_dot_avx2(va, vb, K);
+#else
                 for (int k = 0; k < K; k++)
                 {
                     sum += (int)va[0] * vb[0];
@@ -1324,6 +1694,7 @@ static void conv_im2col_sgemm_int8_requant_sse(const Mat& bottom_blob, Mat& top_
                     va += 1;
                     vb += 1;
                 }
+#endif // __AVX2__
                 output[0] = float2int8(((float)sum * scale_requant_in0 + bias0) * scale_requant_out0);
 
                 output++;
@@ -26,9 +26,14 @@
 
 #include "convolution_x86.h"
 
+#include "autotune.h"
 #include "benchmark.h"
+#include "cpu.h"
 #include "layer_type.h"
 
+#include <algorithm>
+#include <stdio.h>
+
 namespace ncnn {
 
 #include "convolution_sgemm.h"
@@ -41,6 +46,13 @@ namespace ncnn {
 #include "convolution_2x2_pack8_fp16.h"
 #include "convolution_1x1_pack8.h"
 #include "convolution_1x1_pack8_fp16.h"
+#include "convolution_pack8.h"
+#include "convolution_pack1to8.h"
+#include "convolution_pack8to1.h"
+#endif
+#if __AVX512F__
+#include "convolution_3x3_pack16.h"
+#include "convolution_pack16.h"
 #endif
 
 #include "convolution_1x1.h"
@@ -50,17 +62,43 @@ namespace ncnn {
 #include "convolution_5x5.h"
 #include "convolution_7x7.h"
 
+#if __AVX__
+// same layout, each transformed weight rounded to fp16
+static void convolution_transform_kernel_fp16(Mat& kernel_tm)
+{
+    Mat kernel_tm_fp32 = kernel_tm;
+
+    kernel_tm.create(kernel_tm_fp32.w, kernel_tm_fp32.h, kernel_tm_fp32.c, kernel_tm_fp32.elemsize / 2, kernel_tm_fp32.elempack);
+
+    const int size = kernel_tm_fp32.w * kernel_tm_fp32.h * kernel_tm_fp32.elempack;
+
+    for (int q = 0; q < kernel_tm_fp32.c; q++)
+    {
+        const float* ptr = kernel_tm_fp32.channel(q);
+        unsigned short* outptr = kernel_tm.channel(q);
+
+        for (int i = 0; i < size; i++)
+        {
+            outptr[i] = float32_to_float16(ptr[i]);
+        }
+    }
+}
+#endif // __AVX__
+
 Convolution_x86::Convolution_x86()
 {
 #ifdef __AVX__
     support_packing = true;
     support_weight_fp16_storage = true;
+    support_bf16_storage = true;
 #endif
+    support_batch = true;
+
     activation = 0;
     convolution_dilation1 = 0;
 }
 
-int Convolution_x86::create_pipeline(const Option& opt)
+void Convolution_x86::create_activation_x86(const Option& opt)
 {
     if (activation_type == 1)
     {
@@ -109,15 +147,31 @@ int Convolution_x86::create_pipeline(const Option& opt)
         ncnn::ParamDict pd;
         activation->load_param(pd);
     }
+    else if (activation_type == 6)
+    {
+        activation = ncnn::create_layer(ncnn::LayerType::HardSwish);
+
+        ncnn::ParamDict pd;
+        pd.set(0, activation_params[0]); // alpha
+        pd.set(1, activation_params[1]); // beta
+        activation->load_param(pd);
+    }
 
     if (activation)
     {
         activation->create_pipeline(opt);
     }
+}
+
+int Convolution_x86::create_pipeline(const Option& opt)
+{
+    create_activation_x86(opt);
 
     if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
     {
         support_packing = false;
+        support_packing16 = false;
+        support_bf16_storage = false;
         return create_pipeline_int8_x86(opt);
     }
 
@@ -168,6 +222,30 @@ int Convolution_x86::create_pipeline(const Option& opt)
         return 0;
     }
 
+#if __AVX512F__
+    support_packing16 = support_packing && opt.use_packing_layout && num_input % 16 == 0 && num_output % 16 == 0;
+
+    if (support_packing16 && opt.use_winograd_convolution && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
+    {
+        // winograd63 weights stay fp32, as in the pack8 path
+        conv3x3s1_winograd64_transform_kernel_pack16_avx512(weight_data, weight_data_pack16, num_input, num_output);
+
+        return 0;
+    }
+
+    if (support_packing16)
+    {
+        convolution_transform_kernel_pack16_avx512(weight_data, weight_data_pack16, num_input, num_output, kernel_w, kernel_h);
+
+        if (opt.use_weight_fp16_storage)
+        {
+            convolution_transform_kernel_fp16(weight_data_pack16);
+        }
+
+        return 0;
+    }
+#endif
+
     int elempack = (support_packing && opt.use_packing_layout && num_input % 8 == 0) ? 8 : 1;
     int out_elempack = (support_packing && opt.use_packing_layout && num_output % 8 == 0) ? 8 : 1;
 
@@ -189,15 +267,18 @@ int Convolution_x86::create_pipeline(const Option& opt)
         {
             conv2x2s1_weight_fp16_pack8_avx(weight_data, weight_data_pack8, num_input, num_output);
         }
-        else if (kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
+        else if (opt.use_winograd_convolution && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
         {
-            conv3x3s1_winograd64_transform_kernel_pack8_avx(weight_data, weight_data_pack8, num_input, num_output);
+            // winograd63 weights stay fp32, fp16 rounding of the transformed kernel is amplified by the output transform
+            conv3x3s1_winograd64_transform_kernel_pack8_avx(weight_data, weight_3x3_winograd64_data_pack8, num_input, num_output);
         }
         else if (kernel_w == 1 && kernel_h == 1 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
         {
             conv1x1s1_sgemm_transform_kernel_pack8_avx(weight_data, weight_data_pack8, num_input, num_output);
         }
-        else
+
+        // direct convolution, next to winograd63 only as the candidate Net::autotune measures
+        if (weight_data_pack8.empty() && (weight_3x3_winograd64_data_pack8.empty() || opt.use_conv_autotune))
         {
             // src = kw-kh-inch-outch
             // dst = 8b-8a-kw-kh-inch/8a-outch/8b
@@ -378,6 +459,11 @@ int Convolution_x86::create_pipeline(const Option& opt)
                     }
                 }
             }
+
+            if (opt.use_weight_fp16_storage)
+            {
+                convolution_transform_kernel_fp16(weight_data_pack8);
+            }
         }
     }
     // pack1to8
@@ -432,6 +518,11 @@ int Convolution_x86::create_pipeline(const Option& opt)
                 }
             }
         }
+
+        if (opt.use_weight_fp16_storage)
+        {
+            convolution_transform_kernel_fp16(weight_data_pack1to8);
+        }
     }
     // pack8to1
     if (elempack == 8 && out_elempack == 1)
@@ -475,15 +566,20 @@ int Convolution_x86::create_pipeline(const Option& opt)
                 }
             }
         }
+
+        if (opt.use_weight_fp16_storage)
+        {
+            convolution_transform_kernel_fp16(weight_data_pack8to1);
+        }
     }
 #endif
 
     // pack1
     if (elempack == 1 && out_elempack == 1)
     {
-        if (opt.use_winograd_convolution && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1 && num_input >= 16 && num_output >= 16)
+        // winograd is slow on small channel count, Net::autotune may still measure it faster
+        if (opt.use_winograd_convolution && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1 && (opt.use_conv_autotune || (num_input >= 16 && num_output >= 16)))
         {
-            // winograd is slow on small channel count
             use_winograd3x3 = true;
 
             conv3x3s1_winograd23_transform_kernel_sse(weight_data, weight_3x3_winograd23_data, num_input, num_output);
@@ -501,6 +597,61 @@ int Convolution_x86::create_pipeline(const Option& opt)
     return 0;
 }
 
+int Convolution_x86::get_prepacked_weights(std::vector<Mat>& weights) const
+{
+    // forwardDilation keeps its weight in the inner convolution
+    if (convolution_dilation1)
+        return -1;
+
+    weights.resize(8);
+    weights[0] = weight_sgemm_data;
+    weights[1] = weight_3x3_winograd23_data;
+    weights[2] = weight_data_pack8;
+    weights[3] = weight_data_pack1to8;
+    weights[4] = weight_data_pack8to1;
+    weights[5] = weight_3x3_winograd23_data_int8;
+    weights[6] = weight_data_pack16;
+    weights[7] = weight_3x3_winograd64_data_pack8;
+
+    return 0;
+}
+
+int Convolution_x86::create_pipeline_prepacked(const std::vector<Mat>& weights, const Option& opt)
+{
+    if (weights.size() != 8)
+        return -1;
+
+    const bool use_int8 = opt.use_int8_inference && weight_data.elemsize == (size_t)1u;
+
+    if (!use_int8 && (!support_packing || !opt.use_packing_layout) && kernel_w == kernel_h && dilation_w != 1 && dilation_h == dilation_w && stride_w == 1 && stride_h == 1)
+        return -1;
+
+    create_activation_x86(opt);
+
+    if (use_int8)
+    {
+        support_packing = false;
+        support_bf16_storage = false;
+    }
+
+    weight_sgemm_data = weights[0];
+    weight_3x3_winograd23_data = weights[1];
+    weight_data_pack8 = weights[2];
+    weight_data_pack1to8 = weights[3];
+    weight_data_pack8to1 = weights[4];
+    weight_3x3_winograd23_data_int8 = weights[5];
+    weight_data_pack16 = weights[6];
+    weight_3x3_winograd64_data_pack8 = weights[7];
+
+    // the same build on the same cpu prepacked these
+    support_packing16 = !weight_data_pack16.empty();
+
+    use_winograd3x3 = !weight_3x3_winograd23_data.empty();
+    use_winograd3x3_int8 = !weight_3x3_winograd23_data_int8.empty();
+
+    return 0;
+}
+
 int Convolution_x86::destroy_pipeline(const Option& opt)
 {
     if (activation)
@@ -517,6 +668,16 @@ int Convolution_x86::destroy_pipeline(const Option& opt)
         convolution_dilation1 = 0;
     }
 
+    // weight_data is kept for the next create_pipeline
+    weight_sgemm_data.release();
+    weight_3x3_winograd23_data.release();
+    weight_data_pack8.release();
+    weight_data_pack1to8.release();
+    weight_data_pack8to1.release();
+    weight_3x3_winograd23_data_int8.release();
+    weight_data_pack16.release();
+    weight_3x3_winograd64_data_pack8.release();
+
     return 0;
 }
 
@@ -530,6 +691,13 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
         return forward_int8_x86(bottom_blob, top_blob, opt);
     }
 
+#if __AVX__
+    if (opt.use_bf16_storage && bottom_blob.elembits() == 16)
+    {
+        return forward_bf16s(bottom_blob, top_blob, opt);
+    }
+#endif // __AVX__
+
     if (bottom_blob.dims != 3)
     {
         return Convolution::forward(bottom_blob, top_blob, opt);
@@ -545,26 +713,32 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
         return Convolution::forward(bottom_blob, top_blob, opt);
     }
 
-    int w = bottom_blob.w;
-    int h = bottom_blob.h;
-    int channels = bottom_blob.c;
-    size_t elemsize = bottom_blob.elemsize;
-    int elempack = bottom_blob.elempack;
-
-    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
-    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
-
     Mat bottom_blob_bordered;
     make_padding(bottom_blob, bottom_blob_bordered, opt);
     if (bottom_blob_bordered.empty())
         return -100;
 
-    w = bottom_blob_bordered.w;
-    h = bottom_blob_bordered.h;
+    return forward_bordered(bottom_blob_bordered, top_blob, opt);
+}
+
+int Convolution_x86::forward_bordered(const Mat& bottom_blob_bordered, Mat& top_blob, const Option& opt) const
+{
+    int w = bottom_blob_bordered.w;
+    int h = bottom_blob_bordered.h;
+    int channels = bottom_blob_bordered.c;
+    size_t elemsize = bottom_blob_bordered.elemsize;
+    int elempack = bottom_blob_bordered.elempack;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
 
     int outw = (w - kernel_extent_w) / stride_w + 1;
     int outh = (h - kernel_extent_h) / stride_h + 1;
     int out_elempack = (support_packing && opt.use_packing_layout && num_output % 8 == 0) ? 8 : 1;
+#if __AVX512F__
+    if (elempack == 16)
+        out_elempack = 16;
+#endif
     size_t out_elemsize = elemsize / elempack * out_elempack;
 
     top_blob.create(outw, outh, num_output / out_elempack, out_elemsize, out_elempack, opt.blob_allocator);
@@ -599,6 +773,36 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
             p2 += gap;
         }
     }
+#if __AVX512F__
+    if (elempack == 16 && out_elempack == 16)
+    {
+        if (opt.use_winograd_convolution && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
+        {
+            conv3x3s1_winograd64_pack16_avx512(bottom_blob_bordered, top_blob, weight_data_pack16, bias_data, activation_type, activation_params, opt);
+        }
+        else if (opt.use_weight_fp16_storage)
+        {
+            if (kernel_w == 1 && kernel_h == 1 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
+            {
+                conv1x1s1_sgemm_pack16_avx512<unsigned short>(bottom_blob_bordered, top_blob, weight_data_pack16, bias_data, activation_type, activation_params, opt);
+            }
+            else
+            {
+                convolution_pack16_avx512<unsigned short>(bottom_blob_bordered, top_blob, weight_data_pack16, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
+            }
+        }
+        else if (kernel_w == 1 && kernel_h == 1 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
+        {
+            conv1x1s1_sgemm_pack16_avx512<float>(bottom_blob_bordered, top_blob, weight_data_pack16, bias_data, activation_type, activation_params, opt);
+        }
+        else
+        {
+            convolution_pack16_avx512<float>(bottom_blob_bordered, top_blob, weight_data_pack16, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
+        }
+
+        return 0;
+    }
+#endif // __AVX512F__
 #if __AVX__
     if (elempack == 8 && out_elempack == 8)
     {
@@ -634,14 +838,17 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
             }
         }
 
-        else if (kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
+        else if (opt.use_winograd_convolution && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
         {
-            conv3x3s1_winograd64_pack8_avx(bottom_blob_bordered, top_blob, weight_data_pack8, bias_data, opt);
-
-            if (activation)
+            int algo = 1;
+            if (!weight_data_pack8.empty() && opt.use_conv_autotune && opt.autotune_cache)
             {
-                activation->forward_inplace(top_blob, opt);
+                int a = autotune_conv3x3s1(bottom_blob_bordered, top_blob, opt);
+                if (a != -1)
+                    algo = a;
             }
+
+            forward_conv3x3s1(algo, bottom_blob_bordered, top_blob, opt);
         }
         else if (kernel_w == 2 && kernel_h == 2 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
         {
@@ -659,72 +866,13 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
                 activation->forward_inplace(top_blob, opt);
             }
         }
+        else if (opt.use_weight_fp16_storage)
+        {
+            convolution_pack8_avx<unsigned short>(bottom_blob_bordered, top_blob, weight_data_pack8, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
+        }
         else
         {
-            // num_output
-            #pragma omp parallel for num_threads(opt.num_threads)
-            for (int p = 0; p < num_output / out_elempack; p++)
-            {
-                float* outptr = top_blob.channel(p);
-
-                for (int i = 0; i < outh; i++)
-                {
-                    for (int j = 0; j < outw; j++)
-                    {
-                        __m256 _sum = _mm256_set1_ps(0.f);
-
-                        if (bias_term)
-                        {
-                            _sum = _mm256_loadu_ps(((const float*)bias_data) + p * 8);
-                        }
-
-                        const float* kptr = (const float*)weight_data_pack8 + maxk * channels * p * 64;
-
-                        // channels
-                        for (int q = 0; q < channels; q++)
-                        {
-                            const Mat m = bottom_blob_bordered.channel(q);
-                            const float* sptr = m.row(i * stride_h) + j * stride_w * 8;
-
-                            for (int k = 0; k < maxk; k++)
-                            {
-                                __m256 _val0 = _mm256_broadcast_ss((sptr + space_ofs[k] * 8));
-                                __m256 _val1 = _mm256_broadcast_ss((sptr + space_ofs[k] * 8) + 1);
-                                __m256 _val2 = _mm256_broadcast_ss((sptr + space_ofs[k] * 8) + 2);
-                                __m256 _val3 = _mm256_broadcast_ss((sptr + space_ofs[k] * 8) + 3);
-                                __m256 _val4 = _mm256_broadcast_ss((sptr + space_ofs[k] * 8) + 4);
-                                __m256 _val5 = _mm256_broadcast_ss((sptr + space_ofs[k] * 8) + 5);
-                                __m256 _val6 = _mm256_broadcast_ss((sptr + space_ofs[k] * 8) + 6);
-                                __m256 _val7 = _mm256_broadcast_ss((sptr + space_ofs[k] * 8) + 7);
-
-                                __m256 _w0 = _mm256_loadu_ps(kptr);
-                                _sum = _mm256_fmadd_ps(_val0, _w0, _sum);
-                                __m256 _w1 = _mm256_loadu_ps(kptr + 8);
-                                _sum = _mm256_fmadd_ps(_val1, _w1, _sum);
-                                __m256 _w2 = _mm256_loadu_ps(kptr + 16);
-                                _sum = _mm256_fmadd_ps(_val2, _w2, _sum);
-                                __m256 _w3 = _mm256_loadu_ps(kptr + 24);
-                                _sum = _mm256_fmadd_ps(_val3, _w3, _sum);
-                                __m256 _w4 = _mm256_loadu_ps(kptr + 32);
-                                _sum = _mm256_fmadd_ps(_val4, _w4, _sum);
-                                __m256 _w5 = _mm256_loadu_ps(kptr + 40);
-                                _sum = _mm256_fmadd_ps(_val5, _w5, _sum);
-                                __m256 _w6 = _mm256_loadu_ps(kptr + 48);
-                                _sum = _mm256_fmadd_ps(_val6, _w6, _sum);
-                                __m256 _w7 = _mm256_loadu_ps(kptr + 56);
-                                _sum = _mm256_fmadd_ps(_val7, _w7, _sum);
-                                kptr += 64;
-                            }
-                        }
-
-                        _sum = activation_ps(_sum, activation_type, activation_params);
-
-                        _mm256_storeu_ps(outptr + j * 8, _sum);
-                    }
-
-                    outptr += outw * 8;
-                }
-            }
+            convolution_pack8_avx<float>(bottom_blob_bordered, top_blob, weight_data_pack8, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
         }
     }
 
@@ -732,7 +880,14 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
     {
         if (kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
         {
-            conv3x3s1_pack1to8_avx(bottom_blob_bordered, top_blob, weight_data_pack1to8, bias_data, opt);
+            if (opt.use_weight_fp16_storage)
+            {
+                conv3x3s1_pack1to8_avx<unsigned short>(bottom_blob_bordered, top_blob, weight_data_pack1to8, bias_data, opt);
+            }
+            else
+            {
+                conv3x3s1_pack1to8_avx<float>(bottom_blob_bordered, top_blob, weight_data_pack1to8, bias_data, opt);
+            }
 
             if (activation)
             {
@@ -741,116 +896,54 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
         }
         else if (kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 2 && stride_h == 2)
         {
-            conv3x3s2_pack1to8_avx(bottom_blob_bordered, top_blob, weight_data_pack1to8, bias_data, opt);
+            if (opt.use_weight_fp16_storage)
+            {
+                conv3x3s2_pack1to8_avx<unsigned short>(bottom_blob_bordered, top_blob, weight_data_pack1to8, bias_data, opt);
+            }
+            else
+            {
+                conv3x3s2_pack1to8_avx<float>(bottom_blob_bordered, top_blob, weight_data_pack1to8, bias_data, opt);
+            }
 
             if (activation)
             {
                 activation->forward_inplace(top_blob, opt);
             }
         }
+        else if (opt.use_weight_fp16_storage)
+        {
+            convolution_pack1to8_avx<unsigned short>(bottom_blob_bordered, top_blob, weight_data_pack1to8, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
+        }
         else
         {
-            // num_output
-            #pragma omp parallel for num_threads(opt.num_threads)
-            for (int p = 0; p < num_output / out_elempack; p++)
-            {
-                float* outptr = top_blob.channel(p);
-
-                for (int i = 0; i < outh; i++)
-                {
-                    for (int j = 0; j < outw; j++)
-                    {
-                        __m256 _sum = _mm256_set1_ps(0.f);
-
-                        if (bias_term)
-                        {
-                            _sum = _mm256_loadu_ps(((const float*)bias_data) + p * 8);
-                        }
-
-                        const float* kptr = (const float*)weight_data_pack1to8 + maxk * channels * p * 8;
-
-                        // channels
-                        for (int q = 0; q < channels; q++)
-                        {
-                            const Mat m = bottom_blob_bordered.channel(q);
-                            const float* sptr = m.row(i * stride_h) + j * stride_w;
-
-                            for (int k = 0; k < maxk; k++) // 29.23
-                            {
-                                __m256 _val = _mm256_set1_ps(sptr[space_ofs[k]]);
-                                __m256 _w = _mm256_loadu_ps(kptr);
-                                _sum = _mm256_fmadd_ps(_val, _w, _sum);
-
-                                kptr += 8;
-                            }
-                        }
-
-                        _sum = activation_ps(_sum, activation_type, activation_params);
-
-                        _mm256_storeu_ps(outptr + j * 8, _sum);
-                    }
-
-                    outptr += outw * 8;
-                }
-            }
+            convolution_pack1to8_avx<float>(bottom_blob_bordered, top_blob, weight_data_pack1to8, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
         }
     }
     if (elempack == 8 && out_elempack == 1)
     {
         if (kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
         {
-            conv3x3s1_pack8to1_avx(bottom_blob_bordered, top_blob, weight_data_pack8to1, bias_data, opt);
+            if (opt.use_weight_fp16_storage)
+            {
+                conv3x3s1_pack8to1_avx<unsigned short>(bottom_blob_bordered, top_blob, weight_data_pack8to1, bias_data, opt);
+            }
+            else
+            {
+                conv3x3s1_pack8to1_avx<float>(bottom_blob_bordered, top_blob, weight_data_pack8to1, bias_data, opt);
+            }
 
             if (activation)
             {
                 activation->forward_inplace(top_blob, opt);
             }
         }
+        else if (opt.use_weight_fp16_storage)
+        {
+            convolution_pack8to1_avx<unsigned short>(bottom_blob_bordered, top_blob, weight_data_pack8to1, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
+        }
         else
         {
-            // num_output
-            #pragma omp parallel for num_threads(opt.num_threads)
-            for (int p = 0; p < num_output; p++)
-            {
-                float* outptr = top_blob.channel(p);
-
-                for (int i = 0; i < outh; i++)
-                {
-                    for (int j = 0; j < outw; j++)
-                    {
-                        float sum = 0.f;
-
-                        if (bias_term)
-                        {
-                            sum = bias_data[p];
-                        }
-
-                        const float* kptr = (const float*)weight_data_pack8to1 + maxk * channels * p * 8;
-
-                        // channels
-                        for (int q = 0; q < channels; q++)
-                        {
-                            const Mat m = bottom_blob_bordered.channel(q);
-                            const float* sptr = m.row(i * stride_h) + j * stride_w * 8;
-
-                            for (int k = 0; k < maxk; k++) // 29.23
-                            {
-                                __m256 _val = _mm256_loadu_ps(sptr + (space_ofs[k] * 8));
-                                __m256 _w = _mm256_loadu_ps(kptr);
-                                __m256 _s8 = _mm256_mul_ps(_val, _w);
-                                sum += _mm256_reduce_add_ps(_s8); // dot
-                                kptr += 8;
-                            }
-                        }
-
-                        sum = activation_ss(sum, activation_type, activation_params);
-
-                        outptr[j] = sum;
-                    }
-
-                    outptr += outw;
-                }
-            }
+            convolution_pack8to1_avx<float>(bottom_blob_bordered, top_blob, weight_data_pack8to1, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
         }
     }
 #endif
@@ -859,20 +952,16 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
     {
         if (kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1)
         {
-            if (use_winograd3x3 && outw >= 8 && outh >= 8)
-            {
-                conv3x3s1_winograd23_sse(bottom_blob_bordered, top_blob, weight_3x3_winograd23_data, bias_data, opt);
-                //             conv3x3s1_winograd43_sse(bottom_blob_bordered, top_blob, weight_3x3_winograd43_data, bias_data, opt);
-            }
-            else
+            // winograd is slow on small channel count
+            int algo = use_winograd3x3 && outw >= 8 && outh >= 8 && channels >= 16 && num_output >= 16 ? 1 : 0;
+            if (use_winograd3x3 && opt.use_conv_autotune && opt.autotune_cache)
             {
-                conv_im2col_sgemm_sse(bottom_blob_bordered, top_blob, weight_sgemm_data, bias_data, kernel_w, kernel_h, stride_w, stride_h, opt);
+                int a = autotune_conv3x3s1(bottom_blob_bordered, top_blob, opt);
+                if (a != -1)
+                    algo = a;
             }
 
-            if (activation)
-            {
-                activation->forward_inplace(top_blob, opt);
-            }
+            forward_conv3x3s1(algo, bottom_blob_bordered, top_blob, opt);
         }
         else if (dilation_w == 1 && dilation_h == 1)
         {
@@ -945,6 +1034,17 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
                         {
                             sum = static_cast<float>(sum * tanh(log(exp(sum) + 1.f)));
                         }
+                        else if (activation_type == 6)
+                        {
+                            float alpha = activation_params[0];
+                            float beta = activation_params[1];
+                            float lower = -beta / alpha;
+                            float upper = (1.f / alpha) + lower;
+                            if (sum < lower)
+                                sum = 0.f;
+                            else if (sum <= upper)
+                                sum = sum * (sum * alpha + beta);
+                        }
 
                         outptr[j] = sum;
                     }
@@ -958,6 +1058,311 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
     return 0;
 }
 
+#if __AVX__
+int Convolution_x86::forward_bf16s(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    // the kernels run on fp32, bf16 only narrows the blobs between layers
+    Option opt_fp32 = opt;
+    opt_fp32.blob_allocator = opt.workspace_allocator;
+    opt_fp32.use_bf16_storage = false;
+
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int channels = bottom_blob.c;
+    int elempack = bottom_blob.elempack;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    // the border make_padding would add
+    int pad_t = 0;
+    int pad_b = 0;
+    int pad_l = 0;
+    int pad_r = 0;
+    if (pad_left > 0 || pad_right > 0 || pad_top > 0 || pad_bottom > 0)
+    {
+        pad_t = pad_top;
+        pad_b = pad_bottom;
+        pad_l = pad_left;
+        pad_r = pad_right;
+    }
+    else if ((pad_left == -233 && pad_right == -233 && pad_top == -233 && pad_bottom == -233) || (pad_left == -234 && pad_right == -234 && pad_top == -234 && pad_bottom == -234))
+    {
+        int wpad = kernel_extent_w + (w - 1) / stride_w * stride_w - w;
+        int hpad = kernel_extent_h + (h - 1) / stride_h * stride_h - h;
+        if (wpad > 0 || hpad > 0)
+        {
+            // tensorflow padding=SAME or onnx padding=SAME_UPPER puts the odd pixel at the end
+            bool upper = pad_left == -233;
+            pad_t = upper ? hpad / 2 : hpad - hpad / 2;
+            pad_b = hpad - pad_t;
+            pad_l = upper ? wpad / 2 : wpad - wpad / 2;
+            pad_r = wpad - pad_l;
+        }
+    }
+
+    if (bottom_blob.dims != 3 || ((!support_packing || !opt.use_packing_layout) && (dilation_w > 1 || dilation_h > 1)) || pad_t < 0 || pad_b < 0 || pad_l < 0 || pad_r < 0)
+    {
+        // the reference and dilation fallbacks of forward take the whole blob
+        Mat bottom_blob_fp32;
+        cast_bfloat16_to_float32(bottom_blob, bottom_blob_fp32, opt_fp32);
+        if (bottom_blob_fp32.empty())
+            return -100;
+
+        Mat top_blob_fp32;
+        int ret = forward(bottom_blob_fp32, top_blob_fp32, opt_fp32);
+        if (ret != 0)
+            return ret;
+
+        cast_float32_to_bfloat16(top_blob_fp32, top_blob, opt);
+        if (top_blob.empty())
+            return -100;
+
+        return 0;
+    }
+
+    const int outw = (w + pad_l + pad_r - kernel_extent_w) / stride_w + 1;
+    const int outh = (h + pad_t + pad_b - kernel_extent_h) / stride_h + 1;
+
+    // widen one band of output rows at a time, the fp32 input band stays around 256KB
+    // every band streams the weights again, so it is never smaller than them
+    const int row_size = (w + pad_l + pad_r) * channels * elempack * (int)sizeof(float);
+    const int band_size = std::max(256 * 1024, weight_data_size * (int)sizeof(float));
+    const int band_inh = std::max(band_size / row_size, kernel_extent_h);
+    int band_outh = (band_inh - kernel_extent_h) / stride_h + 1;
+    if (band_outh < 6)
+    {
+        // less than one winograd output tile per band, widen the whole blob
+        band_outh = outh;
+    }
+    else
+    {
+        // whole winograd output tiles
+        band_outh = band_outh / 6 * 6;
+    }
+
+    for (int y0 = 0; y0 < outh; y0 += band_outh)
+    {
+        const int bh = std::min(band_outh, outh - y0);
+        const int bh_in = (bh - 1) * stride_h + kernel_extent_h;
+
+        // the border is added while widening
+        Mat bottom_band(w + pad_l + pad_r, bh_in, channels, 4u * elempack, elempack, opt.workspace_allocator);
+        if (bottom_band.empty())
+            return -100;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < channels; q++)
+        {
+            const Mat m = bottom_blob.channel(q);
+            Mat mb = bottom_band.channel(q);
+
+            for (int i = 0; i < bh_in; i++)
+            {
+                float* outptr = mb.row(i);
+
+                const int sy = y0 * stride_h + i - pad_t;
+                if (sy < 0 || sy >= h)
+                {
+                    for (int j = 0; j < mb.w * elempack; j++)
+                    {
+                        outptr[j] = pad_value;
+                    }
+                    continue;
+                }
+
+                for (int j = 0; j < pad_l * elempack; j++)
+                {
+                    outptr[j] = pad_value;
+                }
+                cast_bfloat16_to_float32_avx(m.row<unsigned short>(sy), outptr + pad_l * elempack, w * elempack);
+                for (int j = (pad_l + w) * elempack; j < mb.w * elempack; j++)
+                {
+                    outptr[j] = pad_value;
+                }
+            }
+        }
+
+        Mat top_band;
+        int ret = forward_bordered(bottom_band, top_band, opt_fp32);
+        if (ret != 0)
+            return ret;
+
+        if (y0 == 0)
+        {
+            top_blob.create(outw, outh, top_band.c, 2u * top_band.elempack, top_band.elempack, opt.blob_allocator);
+            if (top_blob.empty())
+                return -100;
+        }
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < top_band.c; q++)
+        {
+            cast_float32_to_bfloat16_avx(top_band.channel(q), top_blob.channel(q).row<unsigned short>(y0), outw * bh * top_band.elempack);
+        }
+    }
+
+    return 0;
+}
+#endif // __AVX__
+
+int Convolution_x86::forward_conv3x3s1(int algo, const Mat& bottom_blob_bordered, Mat& top_blob, const Option& opt) const
+{
+#if __AVX__
+    if (bottom_blob_bordered.elempack == 8)
+    {
+        if (algo == 1)
+        {
+            conv3x3s1_winograd64_pack8_avx(bottom_blob_bordered, top_blob, weight_3x3_winograd64_data_pack8, bias_data, opt);
+
+            if (activation)
+            {
+                activation->forward_inplace(top_blob, opt);
+            }
+        }
+        else if (opt.use_weight_fp16_storage)
+        {
+            convolution_pack8_avx<unsigned short>(bottom_blob_bordered, top_blob, weight_data_pack8, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
+        }
+        else
+        {
+            convolution_pack8_avx<float>(bottom_blob_bordered, top_blob, weight_data_pack8, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, opt);
+        }
+
+        return 0;
+    }
+#endif // __AVX__
+
+    if (algo == 1)
+    {
+        conv3x3s1_winograd23_sse(bottom_blob_bordered, top_blob, weight_3x3_winograd23_data, bias_data, opt);
+        //             conv3x3s1_winograd43_sse(bottom_blob_bordered, top_blob, weight_3x3_winograd43_data, bias_data, opt);
+    }
+    else
+    {
+        conv_im2col_sgemm_sse(bottom_blob_bordered, top_blob, weight_sgemm_data, bias_data, kernel_w, kernel_h, stride_w, stride_h, opt);
+    }
+
+    if (activation)
+    {
+        activation->forward_inplace(top_blob, opt);
+    }
+
+    return 0;
+}
+
+int Convolution_x86::autotune_conv3x3s1(const Mat& bottom_blob_bordered, Mat& top_blob, const Option& opt) const
+{
+    const int elempack = bottom_blob_bordered.elempack;
+
+    // layer config, packing, weight storage, input shape and thread count
+    char key[128];
+    sprintf(key, "conv3x3s1 %s pack%d %d %d %d %d %d", elempack == 8 && opt.use_weight_fp16_storage ? "fp16w" : "fp32", elempack, bottom_blob_bordered.c * elempack, num_output, bottom_blob_bordered.w, bottom_blob_bordered.h, opt.num_threads);
+
+    int algo = opt.autotune_cache->get(key);
+    if (algo != -1 || !opt.autotune_cache->measuring())
+        return algo;
+
+    // 0 = im2col sgemm or pack8 direct  1 = winograd23 or pack8 winograd63
+    double best = 0;
+    for (int a = 0; a < 2; a++)
+    {
+        double mintime = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            double start = get_current_time();
+
+            forward_conv3x3s1(a, bottom_blob_bordered, top_blob, opt);
+
+            double time = get_current_time() - start;
+
+            // first run warms up caches and allocator
+            if (i == 1 || (i > 1 && time < mintime))
+                mintime = time;
+        }
+
+        if (a == 0 || mintime < best)
+        {
+            algo = a;
+            best = mintime;
+        }
+    }
+
+    opt.autotune_cache->set(key, algo);
+
+    return algo;
+}
+
+int Convolution_x86::forward_batch(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    const int batch = (int)bottom_blobs.size();
+
+    // 1x1 stride 1 convolution is a plain gemm over pixels
+    // concat batch items along pixels so that the sgemm kernel sees wider input and reuses weight
+    const bool is_conv1x1s1 = kernel_w == 1 && kernel_h == 1 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1
+                              && pad_left <= 0 && pad_right <= 0 && pad_top <= 0 && pad_bottom <= 0;
+
+    if (batch == 1 || !is_conv1x1s1 || bottom_blobs[0].dims != 3)
+    {
+        return Layer::forward_batch(bottom_blobs, top_blobs, opt);
+    }
+
+    const int w = bottom_blobs[0].w;
+    const int h = bottom_blobs[0].h;
+    const int channels = bottom_blobs[0].c;
+    const size_t elemsize = bottom_blobs[0].elemsize;
+    const int elempack = bottom_blobs[0].elempack;
+    const int size = w * h;
+
+    Mat bottom_blob_batch(size * batch, 1, channels, elemsize, elempack, opt.workspace_allocator);
+    if (bottom_blob_batch.empty())
+        return -100;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int q = 0; q < channels; q++)
+    {
+        unsigned char* outptr = bottom_blob_batch.channel(q);
+
+        for (int b = 0; b < batch; b++)
+        {
+            memcpy(outptr + size * elemsize * b, (const unsigned char*)bottom_blobs[b].channel(q), size * elemsize);
+        }
+    }
+
+    Option opt_batch = opt;
+    opt_batch.blob_allocator = opt.workspace_allocator;
+
+    Mat top_blob_batch;
+    int ret = forward(bottom_blob_batch, top_blob_batch, opt_batch);
+    if (ret != 0)
+        return ret;
+
+    const int out_channels = top_blob_batch.c;
+    const size_t out_elemsize = top_blob_batch.elemsize;
+    const int out_elempack = top_blob_batch.elempack;
+
+    top_blobs.resize(batch);
+    for (int b = 0; b < batch; b++)
+    {
+        top_blobs[b].create(w, h, out_channels, out_elemsize, out_elempack, opt.blob_allocator);
+        if (top_blobs[b].empty())
+            return -100;
+    }
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int q = 0; q < out_channels; q++)
+    {
+        const unsigned char* ptr = top_blob_batch.channel(q);
+
+        for (int b = 0; b < batch; b++)
+        {
+            memcpy((unsigned char*)top_blobs[b].channel(q), ptr + size * out_elemsize * b, size * out_elemsize);
+        }
+    }
+
+    return 0;
+}
+
 int Convolution_x86::create_pipeline_int8_x86(const Option& opt)
 {
     int kernel_size = kernel_w * kernel_h;
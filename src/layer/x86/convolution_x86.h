@@ -27,12 +27,29 @@ public:
     virtual int create_pipeline(const Option& opt);
     virtual int destroy_pipeline(const Option& opt);
 
+    virtual int get_prepacked_weights(std::vector<Mat>& weights) const;
+    virtual int create_pipeline_prepacked(const std::vector<Mat>& weights, const Option& opt);
+
     virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
 
+    virtual int forward_batch(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
+
 protected:
+    void create_activation_x86(const Option& opt);
     int create_pipeline_int8_x86(const Option& opt);
     int forward_int8_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
     int forwardDilation_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+    int forward_bordered(const Mat& bottom_blob_bordered, Mat& top_blob, const Option& opt) const;
+#if __AVX__
+    int forward_bf16s(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+#endif // __AVX__
+
+    // 3x3s1 kernel for pack1 or pack8 input, 0 = im2col sgemm or pack8 direct 1 = winograd23 or pack8 winograd63
+    int forward_conv3x3s1(int algo, const Mat& bottom_blob_bordered, Mat& top_blob, const Option& opt) const;
+
+    // measured 3x3s1 kernel for this input shape, -1 if not measured
+    // kernels are timed here only while the cache is measuring
+    int autotune_conv3x3s1(const Mat& bottom_blob_bordered, Mat& top_blob, const Option& opt) const;
 
 public:
     Layer* activation;
@@ -51,6 +68,9 @@ public:
 
     Mat weight_3x3_winograd64_data_pack8;
 
+    // pack16
+    Mat weight_data_pack16;
+
     // int8
     bool use_winograd3x3_int8;
     Mat weight_3x3_winograd23_data_int8;
@@ -0,0 +1,57 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// built with -mavx512vnni on top of the avx512 flags
+// the int8 sgemm kernels below take their vpdpbusd path, winograd23 int8 takes vpdpwssd
+// Convolution_x86 calls in here when cpu_support_x86_avx512_vnni() holds
+
+#include "avx_usability.h"
+
+#include <immintrin.h>
+
+#include "mat.h"
+#include "option.h"
+
+#include <math.h>
+#include <vector>
+
+namespace ncnn {
+
+#include "convolution_sgemm_int8.h"
+#include "convolution_3x3_int8.h"
+
+void conv_im2col_sgemm_int8_sse_avx512vnni(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel,
+        const int kernel_w, const int kernel_h, const int stride_w, const int stride_h, const Option& opt)
+{
+    conv_im2col_sgemm_int8_sse(bottom_blob, top_blob, _kernel, kernel_w, kernel_h, stride_w, stride_h, opt);
+}
+
+void conv_im2col_sgemm_int8_dequant_sse_avx512vnni(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel,
+        const int kernel_w, const int kernel_h, const int stride_w, const int stride_h, const Mat& _bias, std::vector<float> scale_dequant, const Option& opt)
+{
+    conv_im2col_sgemm_int8_dequant_sse(bottom_blob, top_blob, _kernel, kernel_w, kernel_h, stride_w, stride_h, _bias, scale_dequant, opt);
+}
+
+void conv_im2col_sgemm_int8_requant_sse_avx512vnni(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel,
+        const int kernel_w, const int kernel_h, const int stride_w, const int stride_h, const Mat& _bias, std::vector<float> scale_requant, const Option& opt)
+{
+    conv_im2col_sgemm_int8_requant_sse(bottom_blob, top_blob, _kernel, kernel_w, kernel_h, stride_w, stride_h, _bias, scale_requant, opt);
+}
+
+void conv3x3s1_winograd23_int8_sse_avx512vnni(const Mat& bottom_blob, Mat& top_blob, const Mat& kernel_tm, const Option& opt)
+{
+    conv3x3s1_winograd23_int8_sse(bottom_blob, top_blob, kernel_tm, opt);
+}
+
+} // namespace ncnn
@@ -20,8 +20,107 @@ static inline signed char float2int8(float v)
     return (signed char)int32;
 }
 
+#if __AVX2__
+// _sum plus the int32 sums of int16 pairs, a single vpdpwssd with vnni
+static inline __m256i convdw3x3_int8_dot_avx2(__m256i _sum, __m256i _a, __m256i _k)
+{
+#if __AVX512VNNI__
+    return _mm256_dpwssd_epi32(_sum, _a, _k);
+#else
+    return _mm256_add_epi32(_sum, _mm256_madd_epi16(_a, _k));
+#endif // __AVX512VNNI__
+}
+
+static inline int convdw3x3_int8_pair(signed char a, signed char b)
+{
+    return (int)((unsigned short)a | ((unsigned int)(unsigned short)b << 16));
+}
+
+// taps paired as k0k1 k2k3 k4k5 k6k7 k8
+static inline void convdw3x3s1_int8_kernel_avx2(const signed char* kernel0, __m256i* _k)
+{
+    _k[0] = _mm256_set1_epi32(convdw3x3_int8_pair(kernel0[0], kernel0[1]));
+    _k[1] = _mm256_set1_epi32(convdw3x3_int8_pair(kernel0[2], kernel0[3]));
+    _k[2] = _mm256_set1_epi32(convdw3x3_int8_pair(kernel0[4], kernel0[5]));
+    _k[3] = _mm256_set1_epi32(convdw3x3_int8_pair(kernel0[6], kernel0[7]));
+    _k[4] = _mm256_set1_epi32(convdw3x3_int8_pair(kernel0[8], 0));
+}
+
+// 8 neighbouring outputs, two taps summed per vpmaddwd on int8 widened to int16
+static inline __m256i convdw3x3s1_int8_avx2(const signed char* r0, const signed char* r1, const signed char* r2, const __m256i* _k)
+{
+    __m128i _r00 = _mm_loadl_epi64((const __m128i*)r0);
+    __m128i _r01 = _mm_loadl_epi64((const __m128i*)(r0 + 1));
+    __m128i _r02 = _mm_loadl_epi64((const __m128i*)(r0 + 2));
+    __m128i _r10 = _mm_loadl_epi64((const __m128i*)r1);
+    __m128i _r11 = _mm_loadl_epi64((const __m128i*)(r1 + 1));
+    __m128i _r12 = _mm_loadl_epi64((const __m128i*)(r1 + 2));
+    __m128i _r20 = _mm_loadl_epi64((const __m128i*)r2);
+    __m128i _r21 = _mm_loadl_epi64((const __m128i*)(r2 + 1));
+    __m128i _r22 = _mm_loadl_epi64((const __m128i*)(r2 + 2));
+
+    __m256i _sum = _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_unpacklo_epi8(_r00, _r01)), _k[0]);
+    _sum = convdw3x3_int8_dot_avx2(_sum, _mm256_cvtepi8_epi16(_mm_unpacklo_epi8(_r02, _r10)), _k[1]);
+    _sum = convdw3x3_int8_dot_avx2(_sum, _mm256_cvtepi8_epi16(_mm_unpacklo_epi8(_r11, _r12)), _k[2]);
+    _sum = convdw3x3_int8_dot_avx2(_sum, _mm256_cvtepi8_epi16(_mm_unpacklo_epi8(_r20, _r21)), _k[3]);
+    _sum = convdw3x3_int8_dot_avx2(_sum, _mm256_cvtepi8_epi16(_mm_unpacklo_epi8(_r22, _mm_setzero_si128())), _k[4]);
+
+    return _sum;
+}
+
+// taps paired as k0k1 k2 k3k4 k5 k6k7 k8
+static inline void convdw3x3s2_int8_kernel_avx2(const signed char* kernel0, __m256i* _k)
+{
+    _k[0] = _mm256_set1_epi32(convdw3x3_int8_pair(kernel0[0], kernel0[1]));
+    _k[1] = _mm256_set1_epi32(convdw3x3_int8_pair(kernel0[2], 0));
+    _k[2] = _mm256_set1_epi32(convdw3x3_int8_pair(kernel0[3], kernel0[4]));
+    _k[3] = _mm256_set1_epi32(convdw3x3_int8_pair(kernel0[5], 0));
+    _k[4] = _mm256_set1_epi32(convdw3x3_int8_pair(kernel0[6], kernel0[7]));
+    _k[5] = _mm256_set1_epi32(convdw3x3_int8_pair(kernel0[8], 0));
+}
+
+// 8 neighbouring outputs, stride 2 leaves the first two taps of each output adjacent in memory
+// reads one byte past the 8th output window, so the caller keeps at least one more output in the row
+static inline __m256i convdw3x3s2_int8_avx2(const signed char* r0, const signed char* r1, const signed char* r2, const __m256i* _k)
+{
+    __m256i _r00 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)r0));
+    __m256i _r02 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(r0 + 2)));
+    __m256i _r10 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)r1));
+    __m256i _r12 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(r1 + 2)));
+    __m256i _r20 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)r2));
+    __m256i _r22 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(r2 + 2)));
+
+    __m256i _sum = _mm256_madd_epi16(_r00, _k[0]);
+    _sum = convdw3x3_int8_dot_avx2(_sum, _r02, _k[1]);
+    _sum = convdw3x3_int8_dot_avx2(_sum, _r10, _k[2]);
+    _sum = convdw3x3_int8_dot_avx2(_sum, _r12, _k[3]);
+    _sum = convdw3x3_int8_dot_avx2(_sum, _r20, _k[4]);
+    _sum = convdw3x3_int8_dot_avx2(_sum, _r22, _k[5]);
+
+    return _sum;
+}
+#endif // __AVX2__
+
+#if NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+// compiled with vnni in convolutiondepthwise_x86_avx512vnni.cpp
+void convdw3x3s1_int8_sse_avx512vnni(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Option& opt);
+void convdw3x3s2_int8_sse_avx512vnni(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Option& opt);
+void convdw3x3s1_int8_dequant_sse_avx512vnni(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Mat& _bias, std::vector<float> scales_dequant, const Option& opt);
+void convdw3x3s2_int8_dequant_sse_avx512vnni(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Mat& _bias, std::vector<float> scales_dequant, const Option& opt);
+void convdw3x3s1_int8_requant_sse_avx512vnni(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Mat& _bias, std::vector<float> scales_requant, const Option& opt);
+void convdw3x3s2_int8_requant_sse_avx512vnni(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Mat& _bias, std::vector<float> scales_requant, const Option& opt);
+#endif // NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+
 static void convdw3x3s1_int8_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Option& opt)
 {
+#if NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx512_vnni())
+    {
+        convdw3x3s1_int8_sse_avx512vnni(bottom_blob, top_blob, _kernel, opt);
+        return;
+    }
+#endif
+
     int w = bottom_blob.w;
     //int h = bottom_blob.h;
     //int inch = bottom_blob.c;
@@ -40,6 +139,10 @@ static void convdw3x3s1_int8_sse(const Mat& bottom_blob, Mat& top_blob, const Ma
         out.fill(0);
 
         const signed char* kernel0 = (const signed char*)kernel + p * 9;
+#if __AVX2__
+        __m256i _k[5];
+        convdw3x3s1_int8_kernel_avx2(kernel0, _k);
+#endif // __AVX2__
 
         int* outptr = out;
 
@@ -54,6 +157,19 @@ static void convdw3x3s1_int8_sse(const Mat& bottom_blob, Mat& top_blob, const Ma
         {
             int remain = outw;
 
+#if __AVX2__
+            for (; remain >= 8; remain -= 8)
+            {
+                __m256i _sum = convdw3x3s1_int8_avx2(r0, r1, r2, _k);
+                _mm256_storeu_si256((__m256i*)outptr, _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)outptr), _sum));
+
+                r0 += 8;
+                r1 += 8;
+                r2 += 8;
+                outptr += 8;
+            }
+#endif // __AVX2__
+
             for (; remain > 0; remain--)
             {
                 int sum = 0;
@@ -85,6 +201,14 @@ static void convdw3x3s1_int8_sse(const Mat& bottom_blob, Mat& top_blob, const Ma
 
 static void convdw3x3s2_int8_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Option& opt)
 {
+#if NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx512_vnni())
+    {
+        convdw3x3s2_int8_sse_avx512vnni(bottom_blob, top_blob, _kernel, opt);
+        return;
+    }
+#endif
+
     int w = bottom_blob.w;
     //int h = bottom_blob.h;
     //int inch = bottom_blob.c;
@@ -104,6 +228,10 @@ static void convdw3x3s2_int8_sse(const Mat& bottom_blob, Mat& top_blob, const Ma
         out.fill(0);
 
         const signed char* kernel0 = (const signed char*)kernel + p * 9;
+#if __AVX2__
+        __m256i _k[6];
+        convdw3x3s2_int8_kernel_avx2(kernel0, _k);
+#endif // __AVX2__
 
         int* outptr = out;
 
@@ -119,6 +247,19 @@ static void convdw3x3s2_int8_sse(const Mat& bottom_blob, Mat& top_blob, const Ma
         {
             int remain = outw;
 
+#if __AVX2__
+            for (; remain > 8; remain -= 8)
+            {
+                __m256i _sum = convdw3x3s2_int8_avx2(r0, r1, r2, _k);
+                _mm256_storeu_si256((__m256i*)outptr, _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)outptr), _sum));
+
+                r0 += 16;
+                r1 += 16;
+                r2 += 16;
+                outptr += 8;
+            }
+#endif // __AVX2__
+
             for (; remain > 0; remain--)
             {
                 int sum = 0;
@@ -150,6 +291,14 @@ static void convdw3x3s2_int8_sse(const Mat& bottom_blob, Mat& top_blob, const Ma
 
 static void convdw3x3s1_int8_dequant_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Mat& _bias, std::vector<float> scales_dequant, const Option& opt)
 {
+#if NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx512_vnni())
+    {
+        convdw3x3s1_int8_dequant_sse_avx512vnni(bottom_blob, top_blob, _kernel, _bias, scales_dequant, opt);
+        return;
+    }
+#endif
+
     int w = bottom_blob.w;
     //int h = bottom_blob.h;
     //int inch = bottom_blob.c;
@@ -173,6 +322,10 @@ static void convdw3x3s1_int8_dequant_sse(const Mat& bottom_blob, Mat& top_blob,
         out.fill(bias0);
 
         const signed char* kernel0 = (const signed char*)kernel + p * 9;
+#if __AVX2__
+        __m256i _k[5];
+        convdw3x3s1_int8_kernel_avx2(kernel0, _k);
+#endif // __AVX2__
 
         const signed char* img0 = bottom_blob.channel(p);
         const signed char* r0 = img0;
@@ -184,6 +337,19 @@ static void convdw3x3s1_int8_dequant_sse(const Mat& bottom_blob, Mat& top_blob,
         {
             int remain = outw;
 
+#if __AVX2__
+            for (; remain >= 8; remain -= 8)
+            {
+                __m256i _sum = convdw3x3s1_int8_avx2(r0, r1, r2, _k);
+                _mm256_storeu_ps(outptr, _mm256_fmadd_ps(_mm256_cvtepi32_ps(_sum), _mm256_set1_ps(scale_dequant), _mm256_loadu_ps(outptr)));
+
+                r0 += 8;
+                r1 += 8;
+                r2 += 8;
+                outptr += 8;
+            }
+#endif // __AVX2__
+
             for (; remain > 0; remain--)
             {
                 int sum = 0;
@@ -215,6 +381,14 @@ static void convdw3x3s1_int8_dequant_sse(const Mat& bottom_blob, Mat& top_blob,
 
 static void convdw3x3s2_int8_dequant_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Mat& _bias, std::vector<float> scales_dequant, const Option& opt)
 {
+#if NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx512_vnni())
+    {
+        convdw3x3s2_int8_dequant_sse_avx512vnni(bottom_blob, top_blob, _kernel, _bias, scales_dequant, opt);
+        return;
+    }
+#endif
+
     int w = bottom_blob.w;
     //int h = bottom_blob.h;
     //int inch = bottom_blob.c;
@@ -240,6 +414,10 @@ static void convdw3x3s2_int8_dequant_sse(const Mat& bottom_blob, Mat& top_blob,
         out.fill(bias0);
 
         const signed char* kernel0 = (const signed char*)kernel + p * 9;
+#if __AVX2__
+        __m256i _k[6];
+        convdw3x3s2_int8_kernel_avx2(kernel0, _k);
+#endif // __AVX2__
 
         const signed char* img0 = bottom_blob.channel(p);
         const signed char* r0 = img0;
@@ -252,6 +430,19 @@ static void convdw3x3s2_int8_dequant_sse(const Mat& bottom_blob, Mat& top_blob,
         {
             int remain = outw;
 
+#if __AVX2__
+            for (; remain > 8; remain -= 8)
+            {
+                __m256i _sum = convdw3x3s2_int8_avx2(r0, r1, r2, _k);
+                _mm256_storeu_ps(outptr, _mm256_fmadd_ps(_mm256_cvtepi32_ps(_sum), _mm256_set1_ps(scale_dequant), _mm256_loadu_ps(outptr)));
+
+                r0 += 16;
+                r1 += 16;
+                r2 += 16;
+                outptr += 8;
+            }
+#endif // __AVX2__
+
             for (; remain > 0; remain--)
             {
                 int sum = 0;
@@ -283,6 +474,14 @@ static void convdw3x3s2_int8_dequant_sse(const Mat& bottom_blob, Mat& top_blob,
 
 static void convdw3x3s1_int8_requant_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Mat& _bias, std::vector<float> scales_requant, const Option& opt)
 {
+#if NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx512_vnni())
+    {
+        convdw3x3s1_int8_requant_sse_avx512vnni(bottom_blob, top_blob, _kernel, _bias, scales_requant, opt);
+        return;
+    }
+#endif
+
     int w = bottom_blob.w;
     //int h = bottom_blob.h;
     //int inch = bottom_blob.c;
@@ -305,6 +504,10 @@ static void convdw3x3s1_int8_requant_sse(const Mat& bottom_blob, Mat& top_blob,
         const float scale_requant_out = scales_requant[2 * p + 1];
 
         const signed char* kernel0 = (const signed char*)kernel + p * 9;
+#if __AVX2__
+        __m256i _k[5];
+        convdw3x3s1_int8_kernel_avx2(kernel0, _k);
+#endif // __AVX2__
 
         const signed char* img0 = bottom_blob.channel(p);
         const signed char* r0 = img0;
@@ -316,6 +519,20 @@ static void convdw3x3s1_int8_requant_sse(const Mat& bottom_blob, Mat& top_blob,
         {
             int remain = outw;
 
+#if __AVX2__
+            for (; remain >= 8; remain -= 8)
+            {
+                __m256i _sum = convdw3x3s1_int8_avx2(r0, r1, r2, _k);
+                __m256 _out = _mm256_fmadd_ps(_mm256_cvtepi32_ps(_sum), _mm256_set1_ps(scale_requant_in), _mm256_set1_ps(bias0));
+                _mm_storel_epi64((__m128i*)outptr, float2int8_avx(_mm256_mul_ps(_out, _mm256_set1_ps(scale_requant_out))));
+
+                r0 += 8;
+                r1 += 8;
+                r2 += 8;
+                outptr += 8;
+            }
+#endif // __AVX2__
+
             for (; remain > 0; remain--)
             {
                 int sum = 0;
@@ -347,6 +564,14 @@ static void convdw3x3s1_int8_requant_sse(const Mat& bottom_blob, Mat& top_blob,
 
 static void convdw3x3s2_int8_requant_sse(const Mat& bottom_blob, Mat& top_blob, const Mat& _kernel, const Mat& _bias, std::vector<float> scales_requant, const Option& opt)
 {
+#if NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
+    if (ncnn::cpu_support_x86_avx512_vnni())
+    {
+        convdw3x3s2_int8_requant_sse_avx512vnni(bottom_blob, top_blob, _kernel, _bias, scales_requant, opt);
+        return;
+    }
+#endif
+
     int w = bottom_blob.w;
     //int h = bottom_blob.h;
     //int inch = bottom_blob.c;
@@ -371,6 +596,10 @@ static void convdw3x3s2_int8_requant_sse(const Mat& bottom_blob, Mat& top_blob,
         const float scale_requant_out = scales_requant[2 * p + 1];
 
         const signed char* kernel0 = (const signed char*)kernel + p * 9;
+#if __AVX2__
+        __m256i _k[6];
+        convdw3x3s2_int8_kernel_avx2(kernel0, _k);
+#endif // __AVX2__
 
         const signed char* img0 = bottom_blob.channel(p);
         const signed char* r0 = img0;
@@ -383,6 +612,20 @@ static void convdw3x3s2_int8_requant_sse(const Mat& bottom_blob, Mat& top_blob,
         {
             int remain = outw;
 
+#if __AVX2__
+            for (; remain > 8; remain -= 8)
+            {
+                __m256i _sum = convdw3x3s2_int8_avx2(r0, r1, r2, _k);
+                __m256 _out = _mm256_fmadd_ps(_mm256_cvtepi32_ps(_sum), _mm256_set1_ps(scale_requant_in), _mm256_set1_ps(bias0));
+                _mm_storel_epi64((__m128i*)outptr, float2int8_avx(_mm256_mul_ps(_out, _mm256_set1_ps(scale_requant_out))));
+
+                r0 += 16;
+                r1 += 16;
+                r2 += 16;
+                outptr += 8;
+            }
+#endif // __AVX2__
+
             for (; remain > 0; remain--)
             {
                 int sum = 0;
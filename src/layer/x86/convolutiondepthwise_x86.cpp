@@ -17,8 +17,11 @@
 #endif
 #include "convolutiondepthwise_x86.h"
 
+#include "cpu.h"
 #include "layer_type.h"
 
+#include <algorithm>
+
 namespace ncnn {
 #ifdef __AVX__
 #include "convolutiondepthwise_3x3_pack8_fp16.h"
@@ -33,11 +36,12 @@ ConvolutionDepthWise_x86::ConvolutionDepthWise_x86()
 #ifdef __AVX__
     support_packing = true;
     support_weight_fp16_storage = true;
+    support_bf16_storage = true;
 #endif
     activation = 0;
 }
 
-int ConvolutionDepthWise_x86::create_pipeline(const Option& opt)
+void ConvolutionDepthWise_x86::create_activation_x86(const Option& opt)
 {
     if (activation_type == 1)
     {
@@ -86,20 +90,30 @@ int ConvolutionDepthWise_x86::create_pipeline(const Option& opt)
         ncnn::ParamDict pd;
         activation->load_param(pd);
     }
-    else if (activation_type == 5)
+    else if (activation_type == 6)
     {
-        activation = ncnn::create_layer(ncnn::LayerType::Mish);
+        activation = ncnn::create_layer(ncnn::LayerType::HardSwish);
 
         ncnn::ParamDict pd;
+        pd.set(0, activation_params[0]); // alpha
+        pd.set(1, activation_params[1]); // beta
         activation->load_param(pd);
     }
+
     if (activation)
     {
         activation->create_pipeline(opt);
     }
+}
+
+int ConvolutionDepthWise_x86::create_pipeline(const Option& opt)
+{
+    create_activation_x86(opt);
+
     if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
     {
         support_packing = false;
+        support_bf16_storage = false;
     }
 
     // create Convolution op for each group
@@ -110,8 +124,22 @@ int ConvolutionDepthWise_x86::create_pipeline(const Option& opt)
         delete group_ops[i];
 
     group_ops.clear();
+
+    // only the depth-wise path takes pack16
+    support_packing16 = false;
+
     if (channels == group && group == num_output)
     {
+#if __AVX512F__
+        if (support_packing && opt.use_packing_layout && channels % 16 == 0)
+        {
+            support_packing16 = true;
+
+            Mat weight_data_r2 = weight_data.reshape(maxk, group);
+            convert_packing(weight_data_r2, weight_data_pack16, 16);
+            return 0;
+        }
+#endif // __AVX512F__
 #if __AVX__
         int elempack = (support_packing && opt.use_packing_layout && channels % 8 == 0) ? 8 : 1;
 
@@ -245,6 +273,50 @@ int ConvolutionDepthWise_x86::destroy_pipeline(const Option& opt)
     }
     group_ops.clear();
 
+    weight_data_pack8.release();
+    weight_data_pack16.release();
+
+    return 0;
+}
+
+int ConvolutionDepthWise_x86::get_prepacked_weights(std::vector<Mat>& weights) const
+{
+    // group convolution keeps its weight in the inner convolutions
+    if (!group_ops.empty())
+        return -1;
+
+    weights.resize(2);
+    weights[0] = weight_data_pack8;
+    weights[1] = weight_data_pack16;
+
+    return 0;
+}
+
+int ConvolutionDepthWise_x86::create_pipeline_prepacked(const std::vector<Mat>& weights, const Option& opt)
+{
+    if (weights.size() != 2)
+        return -1;
+
+    const int maxk = kernel_w * kernel_h;
+    int channels = (weight_data_size / group) / maxk / (num_output / group) * group;
+
+    if (channels != group || group != num_output)
+        return -1;
+
+    create_activation_x86(opt);
+
+    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
+    {
+        support_packing = false;
+        support_bf16_storage = false;
+    }
+
+    weight_data_pack8 = weights[0];
+    weight_data_pack16 = weights[1];
+
+    // the same build on the same cpu prepacked these
+    support_packing16 = !weight_data_pack16.empty();
+
     return 0;
 }
 
@@ -258,26 +330,39 @@ int ConvolutionDepthWise_x86::forward(const Mat& bottom_blob, Mat& top_blob, con
         return forward_int8_x86(bottom_blob, top_blob, opt);
     }
 
-    int w = bottom_blob.w;
-    int h = bottom_blob.h;
-    int channels = bottom_blob.c;
-    size_t elemsize = bottom_blob.elemsize;
-    int elempack = bottom_blob.elempack;
-
-    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
-    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+#if __AVX__
+    if (opt.use_bf16_storage && bottom_blob.elembits() == 16)
+    {
+        return forward_bf16s(bottom_blob, top_blob, opt);
+    }
+#endif // __AVX__
 
     Mat bottom_blob_bordered;
     make_padding(bottom_blob, bottom_blob_bordered, opt);
     if (bottom_blob_bordered.empty())
         return -100;
 
-    w = bottom_blob_bordered.w;
-    h = bottom_blob_bordered.h;
+    return forward_bordered(bottom_blob_bordered, top_blob, opt);
+}
+
+int ConvolutionDepthWise_x86::forward_bordered(const Mat& bottom_blob_bordered, Mat& top_blob, const Option& opt) const
+{
+    int w = bottom_blob_bordered.w;
+    int h = bottom_blob_bordered.h;
+    int channels = bottom_blob_bordered.c;
+    size_t elemsize = bottom_blob_bordered.elemsize;
+    int elempack = bottom_blob_bordered.elempack;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
 
     int outw = (w - kernel_extent_w) / stride_w + 1;
     int outh = (h - kernel_extent_h) / stride_h + 1;
     int out_elempack = (support_packing && opt.use_packing_layout && num_output % 8 == 0) ? 8 : 1;
+#if __AVX512F__
+    if (elempack == 16)
+        out_elempack = 16;
+#endif
     size_t out_elemsize = elemsize / elempack * out_elempack;
 
     top_blob.create(outw, outh, num_output / out_elempack, out_elemsize, out_elempack, opt.blob_allocator);
@@ -289,6 +374,66 @@ int ConvolutionDepthWise_x86::forward(const Mat& bottom_blob, Mat& top_blob, con
     // depth-wise
     if (channels * elempack == group && group == num_output)
     {
+#if __AVX512F__
+        if (elempack == 16)
+        {
+            const int maxk = kernel_w * kernel_h;
+
+            // kernel offsets
+            std::vector<int> _space_ofs(maxk);
+            int* space_ofs = &_space_ofs[0];
+            {
+                int p1 = 0;
+                int p2 = 0;
+                int gap = w * dilation_h - kernel_w * dilation_w;
+                for (int i = 0; i < kernel_h; i++)
+                {
+                    for (int j = 0; j < kernel_w; j++)
+                    {
+                        space_ofs[p1] = p2;
+                        p1++;
+                        p2 += dilation_w;
+                    }
+                    p2 += gap;
+                }
+            }
+
+            #pragma omp parallel for num_threads(opt.num_threads)
+            for (int g = 0; g < channels; g++)
+            {
+                float* outptr = top_blob.channel(g);
+                const float* kptr = (const float*)weight_data_pack16 + maxk * g * 16;
+                const Mat m = bottom_blob_bordered.channel(g);
+
+                const __m512 _bias0 = bias_term ? _mm512_loadu_ps((const float*)bias_data + g * 16) : _mm512_setzero_ps();
+
+                for (int i = 0; i < outh; i++)
+                {
+                    for (int j = 0; j < outw; j++)
+                    {
+                        __m512 _sum = _bias0;
+
+                        const float* sptr = m.row(i * stride_h) + j * stride_w * 16;
+
+                        for (int k = 0; k < maxk; k++)
+                        {
+                            __m512 _val = _mm512_loadu_ps(sptr + space_ofs[k] * 16);
+                            __m512 _w = _mm512_loadu_ps(kptr + k * 16);
+                            _sum = _mm512_fmadd_ps(_val, _w, _sum);
+                        }
+
+                        _sum = activation_ps(_sum, activation_type, activation_params);
+
+                        _mm512_storeu_ps(outptr + j * 16, _sum);
+                    }
+
+                    outptr += outw * 16;
+                }
+            }
+
+            return 0;
+        }
+#endif // __AVX512F__
 #if __AVX__
         if (elempack == 8)
         {
@@ -491,6 +636,147 @@ int ConvolutionDepthWise_x86::forward(const Mat& bottom_blob, Mat& top_blob, con
     return 0;
 }
 
+#if __AVX__
+int ConvolutionDepthWise_x86::forward_bf16s(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    // the kernels run on fp32, bf16 only narrows the blobs between layers
+    Option opt_fp32 = opt;
+    opt_fp32.blob_allocator = opt.workspace_allocator;
+    opt_fp32.use_bf16_storage = false;
+
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int channels = bottom_blob.c;
+    int elempack = bottom_blob.elempack;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    // the border make_padding would add
+    int pad_t = 0;
+    int pad_b = 0;
+    int pad_l = 0;
+    int pad_r = 0;
+    if (pad_left > 0 || pad_right > 0 || pad_top > 0 || pad_bottom > 0)
+    {
+        pad_t = pad_top;
+        pad_b = pad_bottom;
+        pad_l = pad_left;
+        pad_r = pad_right;
+    }
+    else if ((pad_left == -233 && pad_right == -233 && pad_top == -233 && pad_bottom == -233) || (pad_left == -234 && pad_right == -234 && pad_top == -234 && pad_bottom == -234))
+    {
+        int wpad = kernel_extent_w + (w - 1) / stride_w * stride_w - w;
+        int hpad = kernel_extent_h + (h - 1) / stride_h * stride_h - h;
+        if (wpad > 0 || hpad > 0)
+        {
+            // tensorflow padding=SAME or onnx padding=SAME_UPPER puts the odd pixel at the end
+            bool upper = pad_left == -233;
+            pad_t = upper ? hpad / 2 : hpad - hpad / 2;
+            pad_b = hpad - pad_t;
+            pad_l = upper ? wpad / 2 : wpad - wpad / 2;
+            pad_r = wpad - pad_l;
+        }
+    }
+
+    if (bottom_blob.dims != 3 || pad_t < 0 || pad_b < 0 || pad_l < 0 || pad_r < 0)
+    {
+        // no band split for these shapes
+        Mat bottom_blob_fp32;
+        cast_bfloat16_to_float32(bottom_blob, bottom_blob_fp32, opt_fp32);
+        if (bottom_blob_fp32.empty())
+            return -100;
+
+        Mat top_blob_fp32;
+        int ret = forward(bottom_blob_fp32, top_blob_fp32, opt_fp32);
+        if (ret != 0)
+            return ret;
+
+        cast_float32_to_bfloat16(top_blob_fp32, top_blob, opt);
+        if (top_blob.empty())
+            return -100;
+
+        return 0;
+    }
+
+    const int outw = (w + pad_l + pad_r - kernel_extent_w) / stride_w + 1;
+    const int outh = (h + pad_t + pad_b - kernel_extent_h) / stride_h + 1;
+
+    // widen one band of output rows at a time, the fp32 input band stays around 256KB
+    const int row_size = (w + pad_l + pad_r) * channels * elempack * (int)sizeof(float);
+    const int band_inh = std::max(256 * 1024 / row_size, kernel_extent_h);
+    int band_outh = (band_inh - kernel_extent_h) / stride_h + 1;
+    if (band_outh < 6)
+    {
+        // thin bands cost more in per band setup than they save, widen the whole blob
+        band_outh = outh;
+    }
+
+    for (int y0 = 0; y0 < outh; y0 += band_outh)
+    {
+        const int bh = std::min(band_outh, outh - y0);
+        const int bh_in = (bh - 1) * stride_h + kernel_extent_h;
+
+        // the border is added while widening
+        Mat bottom_band(w + pad_l + pad_r, bh_in, channels, 4u * elempack, elempack, opt.workspace_allocator);
+        if (bottom_band.empty())
+            return -100;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < channels; q++)
+        {
+            const Mat m = bottom_blob.channel(q);
+            Mat mb = bottom_band.channel(q);
+
+            for (int i = 0; i < bh_in; i++)
+            {
+                float* outptr = mb.row(i);
+
+                const int sy = y0 * stride_h + i - pad_t;
+                if (sy < 0 || sy >= h)
+                {
+                    for (int j = 0; j < mb.w * elempack; j++)
+                    {
+                        outptr[j] = pad_value;
+                    }
+                    continue;
+                }
+
+                for (int j = 0; j < pad_l * elempack; j++)
+                {
+                    outptr[j] = pad_value;
+                }
+                cast_bfloat16_to_float32_avx(m.row<unsigned short>(sy), outptr + pad_l * elempack, w * elempack);
+                for (int j = (pad_l + w) * elempack; j < mb.w * elempack; j++)
+                {
+                    outptr[j] = pad_value;
+                }
+            }
+        }
+
+        Mat top_band;
+        int ret = forward_bordered(bottom_band, top_band, opt_fp32);
+        if (ret != 0)
+            return ret;
+
+        if (y0 == 0)
+        {
+            top_blob.create(outw, outh, top_band.c, 2u * top_band.elempack, top_band.elempack, opt.blob_allocator);
+            if (top_blob.empty())
+                return -100;
+        }
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < top_band.c; q++)
+        {
+            cast_float32_to_bfloat16_avx(top_band.channel(q), top_blob.channel(q).row<unsigned short>(y0), outw * bh * top_band.elempack);
+        }
+    }
+
+    return 0;
+}
+#endif // __AVX__
+
 int ConvolutionDepthWise_x86::forward_int8_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
     int w = bottom_blob.w;
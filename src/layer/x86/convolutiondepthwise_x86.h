@@ -27,10 +27,18 @@ public:
     virtual int create_pipeline(const Option& opt);
     virtual int destroy_pipeline(const Option& opt);
 
+    virtual int get_prepacked_weights(std::vector<Mat>& weights) const;
+    virtual int create_pipeline_prepacked(const std::vector<Mat>& weights, const Option& opt);
+
     virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
 
 protected:
+    void create_activation_x86(const Option& opt);
     int forward_int8_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+    int forward_bordered(const Mat& bottom_blob_bordered, Mat& top_blob, const Option& opt) const;
+#if __AVX__
+    int forward_bf16s(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+#endif // __AVX__
 
 public:
     Layer* activation;
@@ -38,6 +46,7 @@ public:
 
     // packing
     Mat weight_data_pack8;
+    Mat weight_data_pack16;
 };
 
 } // namespace ncnn
@@ -0,0 +1,77 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+static void deconv3x3s2_pack8_avx(const Mat& bottom_blob, Mat& top_blob, const Mat& weight_data_pack8, const Mat& bias_data, const Option& opt)
+{
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int inch = bottom_blob.c;
+
+    int outch = top_blob.c;
+
+    const float* bias_data_ptr = bias_data;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int p = 0; p < outch; p++)
+    {
+        Mat out = top_blob.channel(p);
+
+        __m256 _bias = bias_data_ptr ? _mm256_loadu_ps(bias_data_ptr + p * 8) : _mm256_setzero_ps();
+        out.fill(_bias);
+
+        const Mat kernel = weight_data_pack8.channel(p);
+
+        for (int i = 0; i < h; i++)
+        {
+            for (int j = 0; j < w; j++)
+            {
+                // one kernel row at a time, the three taps share each input broadcast
+                for (int y = 0; y < 3; y++)
+                {
+                    const float* k0 = kernel.row(y * 3);
+                    const float* k1 = kernel.row(y * 3 + 1);
+                    const float* k2 = kernel.row(y * 3 + 2);
+
+                    __m256 _sum0 = _mm256_setzero_ps();
+                    __m256 _sum1 = _mm256_setzero_ps();
+                    __m256 _sum2 = _mm256_setzero_ps();
+
+                    for (int q = 0; q < inch; q++)
+                    {
+                        const float* r0 = bottom_blob.channel(q).row(i) + j * 8;
+
+                        for (int l = 0; l < 8; l++)
+                        {
+                            __m256 _val = _mm256_broadcast_ss(r0 + l);
+
+                            _sum0 = _mm256_fmadd_ps(_val, _mm256_loadu_ps(k0 + l * 8), _sum0);
+                            _sum1 = _mm256_fmadd_ps(_val, _mm256_loadu_ps(k1 + l * 8), _sum1);
+                            _sum2 = _mm256_fmadd_ps(_val, _mm256_loadu_ps(k2 + l * 8), _sum2);
+                        }
+
+                        k0 += 64;
+                        k1 += 64;
+                        k2 += 64;
+                    }
+
+                    float* outptr = out.row(i * 2 + y) + j * 2 * 8;
+
+                    _mm256_storeu_ps(outptr, _mm256_add_ps(_mm256_loadu_ps(outptr), _sum0));
+                    _mm256_storeu_ps(outptr + 8, _mm256_add_ps(_mm256_loadu_ps(outptr + 8), _sum1));
+                    _mm256_storeu_ps(outptr + 16, _mm256_add_ps(_mm256_loadu_ps(outptr + 16), _sum2));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,173 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+static void deconvolution_transform_kernel_avx(const Mat& weight_data, Mat& weight_data_pack1, int num_input, int num_output, int kernel_w, int kernel_h)
+{
+    const int maxk = kernel_w * kernel_h;
+
+    // src = kw-kh-inch-outch
+    // dst = inch-kw-kh-outch
+    Mat weight_data_r2 = weight_data.reshape(maxk, num_input, num_output);
+
+    weight_data_pack1.create(num_input, maxk, num_output);
+
+    for (int q = 0; q < num_output; q++)
+    {
+        const Mat k0 = weight_data_r2.channel(q);
+        Mat g0 = weight_data_pack1.channel(q);
+
+        for (int k = 0; k < maxk; k++)
+        {
+            float* g00 = g0.row(k);
+
+            for (int p = 0; p < num_input; p++)
+            {
+                g00[p] = k0.row(p)[k];
+            }
+        }
+    }
+}
+
+// col2im, scatter-add each tap into its output position
+static void deconvolution_col2im_avx(const Mat& top_col, Mat& top_blob, const Mat& bias_data, int w, int h, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h, const Option& opt)
+{
+    int outch = top_blob.c;
+
+    const float* bias_data_ptr = bias_data;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int p = 0; p < outch; p++)
+    {
+        Mat out = top_blob.channel(p);
+
+        out.fill(bias_data_ptr ? bias_data_ptr[p] : 0.f);
+
+        const Mat col = top_col.channel(p);
+
+        for (int y = 0; y < kernel_h; y++)
+        {
+            for (int x = 0; x < kernel_w; x++)
+            {
+                const float* colptr = col.row(y * kernel_w + x);
+
+                for (int i = 0; i < h; i++)
+                {
+                    float* outptr = out.row(i * stride_h + y * dilation_h) + x * dilation_w;
+
+                    for (int j = 0; j < w; j++)
+                    {
+                        outptr[0] += colptr[0];
+
+                        colptr += 1;
+                        outptr += stride_w;
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void deconvolution_sgemm_avx(const Mat& bottom_blob, Mat& top_blob, const Mat& weight_data_pack1, const Mat& bias_data, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h, const Option& opt)
+{
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int inch = bottom_blob.c;
+
+    int outch = top_blob.c;
+
+    const int size = w * h;
+    const int maxk = kernel_w * kernel_h;
+
+    // gemm, every input pixel times every kernel tap
+    Mat top_col(size, maxk, outch, (size_t)4u, 1, opt.workspace_allocator);
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int p = 0; p < outch; p++)
+        {
+            const Mat kernel = weight_data_pack1.channel(p);
+            Mat out = top_col.channel(p);
+
+            for (int k = 0; k < maxk; k++)
+            {
+                float* outptr = out.row(k);
+
+                int i = 0;
+                for (; i + 15 < size; i += 16)
+                {
+                    const float* kptr = kernel.row(k);
+
+                    __m256 _sum0 = _mm256_setzero_ps();
+                    __m256 _sum1 = _mm256_setzero_ps();
+
+                    for (int q = 0; q < inch; q++)
+                    {
+                        const float* r0 = (const float*)bottom_blob.channel(q) + i;
+
+                        __m256 _w = _mm256_broadcast_ss(kptr);
+                        _sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(r0), _w, _sum0);
+                        _sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(r0 + 8), _w, _sum1);
+
+                        kptr += 1;
+                    }
+
+                    _mm256_storeu_ps(outptr, _sum0);
+                    _mm256_storeu_ps(outptr + 8, _sum1);
+
+                    outptr += 16;
+                }
+                for (; i + 7 < size; i += 8)
+                {
+                    const float* kptr = kernel.row(k);
+
+                    __m256 _sum = _mm256_setzero_ps();
+
+                    for (int q = 0; q < inch; q++)
+                    {
+                        const float* r0 = (const float*)bottom_blob.channel(q) + i;
+
+                        _sum = _mm256_fmadd_ps(_mm256_loadu_ps(r0), _mm256_broadcast_ss(kptr), _sum);
+
+                        kptr += 1;
+                    }
+
+                    _mm256_storeu_ps(outptr, _sum);
+
+                    outptr += 8;
+                }
+                for (; i < size; i++)
+                {
+                    const float* kptr = kernel.row(k);
+
+                    float sum = 0.f;
+
+                    for (int q = 0; q < inch; q++)
+                    {
+                        const float* r0 = (const float*)bottom_blob.channel(q) + i;
+
+                        sum += r0[0] * kptr[0];
+
+                        kptr += 1;
+                    }
+
+                    outptr[0] = sum;
+
+                    outptr += 1;
+                }
+            }
+        }
+    }
+
+    deconvolution_col2im_avx(top_col, top_blob, bias_data, w, h, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, opt);
+}
@@ -0,0 +1,179 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+static void deconvolution_transform_kernel_pack8_avx(const Mat& weight_data, Mat& weight_data_pack8, int num_input, int num_output, int kernel_w, int kernel_h)
+{
+    const int maxk = kernel_w * kernel_h;
+
+    // src = kw-kh-inch-outch
+    // dst = 8b-8a-inch/8a-kw-kh-outch/8b
+    Mat weight_data_r2 = weight_data.reshape(maxk, num_input, num_output);
+
+    weight_data_pack8.create(num_input / 8, maxk, num_output / 8, (size_t)4 * 64, 64);
+
+    for (int q = 0; q + 7 < num_output; q += 8)
+    {
+        Mat g0 = weight_data_pack8.channel(q / 8);
+
+        for (int k = 0; k < maxk; k++)
+        {
+            float* g00 = g0.row(k);
+
+            for (int p = 0; p + 7 < num_input; p += 8)
+            {
+                for (int i = 0; i < 8; i++)
+                {
+                    for (int j = 0; j < 8; j++)
+                    {
+                        const float* k00 = weight_data_r2.channel(q + j).row(p + i);
+
+                        g00[0] = k00[k];
+
+                        g00++;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// col2im, scatter-add each tap into its output position
+static void deconvolution_col2im_pack8_avx(const Mat& top_col, Mat& top_blob, const Mat& bias_data, int w, int h, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h, const Option& opt)
+{
+    int outch = top_blob.c;
+
+    const float* bias_data_ptr = bias_data;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int p = 0; p < outch; p++)
+    {
+        Mat out = top_blob.channel(p);
+
+        __m256 _bias = bias_data_ptr ? _mm256_loadu_ps(bias_data_ptr + p * 8) : _mm256_setzero_ps();
+        out.fill(_bias);
+
+        const Mat col = top_col.channel(p);
+
+        for (int y = 0; y < kernel_h; y++)
+        {
+            for (int x = 0; x < kernel_w; x++)
+            {
+                const float* colptr = col.row(y * kernel_w + x);
+
+                for (int i = 0; i < h; i++)
+                {
+                    float* outptr = out.row(i * stride_h + y * dilation_h) + x * dilation_w * 8;
+
+                    for (int j = 0; j < w; j++)
+                    {
+                        __m256 _val = _mm256_loadu_ps(colptr);
+                        __m256 _out = _mm256_loadu_ps(outptr);
+                        _mm256_storeu_ps(outptr, _mm256_add_ps(_out, _val));
+
+                        colptr += 8;
+                        outptr += stride_w * 8;
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void deconvolution_sgemm_pack8_avx(const Mat& bottom_blob, Mat& top_blob, const Mat& weight_data_pack8, const Mat& bias_data, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h, const Option& opt)
+{
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int inch = bottom_blob.c;
+
+    int outch = top_blob.c;
+
+    const int size = w * h;
+    const int maxk = kernel_w * kernel_h;
+
+    // gemm, every input pixel times every kernel tap
+    Mat top_col(size, maxk, outch, (size_t)4 * 8, 8, opt.workspace_allocator);
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int p = 0; p < outch; p++)
+        {
+            const Mat kernel = weight_data_pack8.channel(p);
+            Mat out = top_col.channel(p);
+
+            for (int k = 0; k < maxk; k++)
+            {
+                float* outptr = out.row(k);
+
+                int i = 0;
+                for (; i + 3 < size; i += 4)
+                {
+                    const float* kptr = kernel.row(k);
+
+                    __m256 _sum0 = _mm256_setzero_ps();
+                    __m256 _sum1 = _mm256_setzero_ps();
+                    __m256 _sum2 = _mm256_setzero_ps();
+                    __m256 _sum3 = _mm256_setzero_ps();
+
+                    for (int q = 0; q < inch; q++)
+                    {
+                        const float* r0 = (const float*)bottom_blob.channel(q) + i * 8;
+
+                        for (int l = 0; l < 8; l++)
+                        {
+                            __m256 _w = _mm256_loadu_ps(kptr + l * 8);
+
+                            _sum0 = _mm256_fmadd_ps(_mm256_broadcast_ss(r0 + l), _w, _sum0);
+                            _sum1 = _mm256_fmadd_ps(_mm256_broadcast_ss(r0 + 8 + l), _w, _sum1);
+                            _sum2 = _mm256_fmadd_ps(_mm256_broadcast_ss(r0 + 16 + l), _w, _sum2);
+                            _sum3 = _mm256_fmadd_ps(_mm256_broadcast_ss(r0 + 24 + l), _w, _sum3);
+                        }
+
+                        kptr += 64;
+                    }
+
+                    _mm256_storeu_ps(outptr, _sum0);
+                    _mm256_storeu_ps(outptr + 8, _sum1);
+                    _mm256_storeu_ps(outptr + 16, _sum2);
+                    _mm256_storeu_ps(outptr + 24, _sum3);
+
+                    outptr += 32;
+                }
+                for (; i < size; i++)
+                {
+                    const float* kptr = kernel.row(k);
+
+                    __m256 _sum = _mm256_setzero_ps();
+
+                    for (int q = 0; q < inch; q++)
+                    {
+                        const float* r0 = (const float*)bottom_blob.channel(q) + i * 8;
+
+                        for (int l = 0; l < 8; l++)
+                        {
+                            __m256 _w = _mm256_loadu_ps(kptr + l * 8);
+                            _sum = _mm256_fmadd_ps(_mm256_broadcast_ss(r0 + l), _w, _sum);
+                        }
+
+                        kptr += 64;
+                    }
+
+                    _mm256_storeu_ps(outptr, _sum);
+
+                    outptr += 8;
+                }
+            }
+        }
+    }
+
+    deconvolution_col2im_pack8_avx(top_col, top_blob, bias_data, w, h, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, opt);
+}
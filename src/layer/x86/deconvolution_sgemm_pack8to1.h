@@ -0,0 +1,127 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+static void deconvolution_transform_kernel_pack8to1_avx(const Mat& weight_data, Mat& weight_data_pack8to1, int num_input, int num_output, int kernel_w, int kernel_h)
+{
+    const int maxk = kernel_w * kernel_h;
+
+    // src = kw-kh-inch-outch
+    // dst = 8a-inch/8a-kw-kh-outch
+    Mat weight_data_r2 = weight_data.reshape(maxk, num_input, num_output);
+
+    weight_data_pack8to1.create(num_input / 8, maxk, num_output, (size_t)4 * 8, 8);
+
+    for (int q = 0; q < num_output; q++)
+    {
+        const Mat k0 = weight_data_r2.channel(q);
+        Mat g0 = weight_data_pack8to1.channel(q);
+
+        for (int k = 0; k < maxk; k++)
+        {
+            float* g00 = g0.row(k);
+
+            for (int p = 0; p + 7 < num_input; p += 8)
+            {
+                for (int i = 0; i < 8; i++)
+                {
+                    g00[0] = k0.row(p + i)[k];
+
+                    g00++;
+                }
+            }
+        }
+    }
+}
+
+static void deconvolution_sgemm_pack8to1_avx(const Mat& bottom_blob, Mat& top_blob, const Mat& weight_data_pack8to1, const Mat& bias_data, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h, const Option& opt)
+{
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int inch = bottom_blob.c;
+
+    int outch = top_blob.c;
+
+    const int size = w * h;
+    const int maxk = kernel_w * kernel_h;
+
+    // gemm, every input pixel times every kernel tap
+    Mat top_col(size, maxk, outch, (size_t)4u, 1, opt.workspace_allocator);
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int p = 0; p < outch; p++)
+        {
+            const Mat kernel = weight_data_pack8to1.channel(p);
+            Mat out = top_col.channel(p);
+
+            for (int k = 0; k < maxk; k++)
+            {
+                float* outptr = out.row(k);
+
+                int i = 0;
+                for (; i + 3 < size; i += 4)
+                {
+                    const float* kptr = kernel.row(k);
+
+                    __m256 _sum0 = _mm256_setzero_ps();
+                    __m256 _sum1 = _mm256_setzero_ps();
+                    __m256 _sum2 = _mm256_setzero_ps();
+                    __m256 _sum3 = _mm256_setzero_ps();
+
+                    for (int q = 0; q < inch; q++)
+                    {
+                        const float* r0 = (const float*)bottom_blob.channel(q) + i * 8;
+
+                        __m256 _w = _mm256_loadu_ps(kptr);
+
+                        _sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(r0), _w, _sum0);
+                        _sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(r0 + 8), _w, _sum1);
+                        _sum2 = _mm256_fmadd_ps(_mm256_loadu_ps(r0 + 16), _w, _sum2);
+                        _sum3 = _mm256_fmadd_ps(_mm256_loadu_ps(r0 + 24), _w, _sum3);
+
+                        kptr += 8;
+                    }
+
+                    outptr[0] = _mm256_reduce_add_ps(_sum0);
+                    outptr[1] = _mm256_reduce_add_ps(_sum1);
+                    outptr[2] = _mm256_reduce_add_ps(_sum2);
+                    outptr[3] = _mm256_reduce_add_ps(_sum3);
+
+                    outptr += 4;
+                }
+                for (; i < size; i++)
+                {
+                    const float* kptr = kernel.row(k);
+
+                    __m256 _sum = _mm256_setzero_ps();
+
+                    for (int q = 0; q < inch; q++)
+                    {
+                        const float* r0 = (const float*)bottom_blob.channel(q) + i * 8;
+
+                        _sum = _mm256_fmadd_ps(_mm256_loadu_ps(r0), _mm256_loadu_ps(kptr), _sum);
+
+                        kptr += 8;
+                    }
+
+                    outptr[0] = _mm256_reduce_add_ps(_sum);
+
+                    outptr += 1;
+                }
+            }
+        }
+    }
+
+    deconvolution_col2im_avx(top_col, top_blob, bias_data, w, h, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, opt);
+}
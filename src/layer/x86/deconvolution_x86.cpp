@@ -0,0 +1,245 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#if __AVX__
+#include "avx_activation.h"
+#include "avx_usability.h"
+#endif
+
+#include "deconvolution_x86.h"
+
+#include "layer_type.h"
+
+namespace ncnn {
+
+#if __AVX__
+#include "deconvolution_sgemm.h"
+#include "deconvolution_sgemm_pack8.h"
+#include "deconvolution_sgemm_pack1to8.h"
+#include "deconvolution_sgemm_pack8to1.h"
+#include "deconvolution_3x3_pack8.h"
+#include "deconvolution_4x4_pack8.h"
+#endif // __AVX__
+
+Deconvolution_x86::Deconvolution_x86()
+{
+#if __AVX__
+    support_packing = true;
+#endif // __AVX__
+
+    activation = 0;
+}
+
+void Deconvolution_x86::create_activation_x86(const Option& opt)
+{
+    if (activation_type == 1)
+    {
+        activation = ncnn::create_layer(ncnn::LayerType::ReLU);
+
+        ncnn::ParamDict pd;
+        activation->load_param(pd);
+    }
+    else if (activation_type == 2)
+    {
+        activation = ncnn::create_layer(ncnn::LayerType::ReLU);
+
+        ncnn::ParamDict pd;
+        pd.set(0, activation_params[0]); // slope
+        activation->load_param(pd);
+    }
+    else if (activation_type == 3)
+    {
+        activation = ncnn::create_layer(ncnn::LayerType::Clip);
+
+        ncnn::ParamDict pd;
+        pd.set(0, activation_params[0]); // min
+        pd.set(1, activation_params[1]); // max
+        activation->load_param(pd);
+    }
+    else if (activation_type == 4)
+    {
+        activation = ncnn::create_layer(ncnn::LayerType::Sigmoid);
+
+        ncnn::ParamDict pd;
+        activation->load_param(pd);
+    }
+
+    if (activation)
+    {
+        activation->create_pipeline(opt);
+    }
+}
+
+int Deconvolution_x86::create_pipeline(const Option& opt)
+{
+    create_activation_x86(opt);
+
+#if __AVX__
+    const int maxk = kernel_w * kernel_h;
+    int num_input = weight_data_size / maxk / num_output;
+
+    int elempack = (support_packing && opt.use_packing_layout && num_input % 8 == 0) ? 8 : 1;
+    int out_elempack = (support_packing && opt.use_packing_layout && num_output % 8 == 0) ? 8 : 1;
+
+    // pack8
+    if (elempack == 8 && out_elempack == 8)
+    {
+        deconvolution_transform_kernel_pack8_avx(weight_data, weight_data_pack8, num_input, num_output, kernel_w, kernel_h);
+    }
+
+    // pack1to8
+    if (elempack == 1 && out_elempack == 8)
+    {
+        deconvolution_transform_kernel_pack1to8_avx(weight_data, weight_data_pack1to8, num_input, num_output, kernel_w, kernel_h);
+    }
+
+    // pack8to1
+    if (elempack == 8 && out_elempack == 1)
+    {
+        deconvolution_transform_kernel_pack8to1_avx(weight_data, weight_data_pack8to1, num_input, num_output, kernel_w, kernel_h);
+    }
+
+    // pack1
+    if (elempack == 1 && out_elempack == 1)
+    {
+        deconvolution_transform_kernel_avx(weight_data, weight_data_pack1, num_input, num_output, kernel_w, kernel_h);
+    }
+#endif // __AVX__
+
+    return 0;
+}
+
+int Deconvolution_x86::destroy_pipeline(const Option& opt)
+{
+    if (activation)
+    {
+        activation->destroy_pipeline(opt);
+        delete activation;
+        activation = 0;
+    }
+
+    weight_data_pack1.release();
+    weight_data_pack8.release();
+    weight_data_pack1to8.release();
+    weight_data_pack8to1.release();
+
+    return 0;
+}
+
+int Deconvolution_x86::get_prepacked_weights(std::vector<Mat>& weights) const
+{
+    weights.resize(4);
+    weights[0] = weight_data_pack1;
+    weights[1] = weight_data_pack8;
+    weights[2] = weight_data_pack1to8;
+    weights[3] = weight_data_pack8to1;
+
+    return 0;
+}
+
+int Deconvolution_x86::create_pipeline_prepacked(const std::vector<Mat>& weights, const Option& opt)
+{
+    if (weights.size() != 4)
+        return -1;
+
+    create_activation_x86(opt);
+
+    weight_data_pack1 = weights[0];
+    weight_data_pack8 = weights[1];
+    weight_data_pack1to8 = weights[2];
+    weight_data_pack8to1 = weights[3];
+
+    return 0;
+}
+
+int Deconvolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    // deconvolv with NxN kernel
+    // value = value + bias
+
+#if !__AVX__
+    return Deconvolution::forward(bottom_blob, top_blob, opt);
+#else
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    size_t elemsize = bottom_blob.elemsize;
+    int elempack = bottom_blob.elempack;
+
+    int out_elempack = (support_packing && opt.use_packing_layout && num_output % 8 == 0) ? 8 : 1;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    int outw = (w - 1) * stride_w + kernel_extent_w;
+    int outh = (h - 1) * stride_h + kernel_extent_h;
+    size_t out_elemsize = elemsize / elempack * out_elempack;
+
+    Mat top_blob_bordered;
+    if (pad_left > 0 || pad_right > 0 || pad_top > 0 || pad_bottom > 0 || output_pad_right > 0 || output_pad_bottom > 0 || (output_w > 0 && output_h > 0))
+    {
+        top_blob_bordered.create(outw, outh, num_output / out_elempack, out_elemsize, out_elempack, opt.workspace_allocator);
+    }
+    else
+    {
+        top_blob_bordered = top_blob;
+        top_blob_bordered.create(outw, outh, num_output / out_elempack, out_elemsize, out_elempack, opt.blob_allocator);
+    }
+    if (top_blob_bordered.empty())
+        return -100;
+
+    if (elempack == 8 && out_elempack == 8)
+    {
+        if (kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 2 && stride_h == 2)
+        {
+            deconv3x3s2_pack8_avx(bottom_blob, top_blob_bordered, weight_data_pack8, bias_data, opt);
+        }
+        else if (kernel_w == 4 && kernel_h == 4 && dilation_w == 1 && dilation_h == 1 && stride_w == 2 && stride_h == 2)
+        {
+            deconv4x4s2_pack8_avx(bottom_blob, top_blob_bordered, weight_data_pack8, bias_data, opt);
+        }
+        else
+        {
+            deconvolution_sgemm_pack8_avx(bottom_blob, top_blob_bordered, weight_data_pack8, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, opt);
+        }
+    }
+
+    if (elempack == 1 && out_elempack == 8)
+    {
+        deconvolution_sgemm_pack1to8_avx(bottom_blob, top_blob_bordered, weight_data_pack1to8, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, opt);
+    }
+
+    if (elempack == 8 && out_elempack == 1)
+    {
+        deconvolution_sgemm_pack8to1_avx(bottom_blob, top_blob_bordered, weight_data_pack8to1, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, opt);
+    }
+
+    if (elempack == 1 && out_elempack == 1)
+    {
+        deconvolution_sgemm_avx(bottom_blob, top_blob_bordered, weight_data_pack1, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, opt);
+    }
+
+    if (activation)
+    {
+        activation->forward_inplace(top_blob_bordered, opt);
+    }
+
+    cut_padding(top_blob_bordered, top_blob, opt);
+    if (top_blob.empty())
+        return -100;
+
+    return 0;
+#endif // __AVX__
+}
+
+} // namespace ncnn
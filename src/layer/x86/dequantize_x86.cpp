@@ -0,0 +1,130 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#if __AVX2__
+#include <immintrin.h>
+#endif // __AVX2__
+
+#include "dequantize_x86.h"
+
+namespace ncnn {
+
+Dequantize_x86::Dequantize_x86()
+{
+#if __AVX2__
+    support_packing = true;
+#endif // __AVX2__
+}
+
+#if __AVX2__
+// _bias repeats every 8 values, bias is for the pack1 tail
+static void dequantize_avx(const int* intptr, float* ptr, int size, float scale, __m256 _bias, float bias)
+{
+    __m256 _scale = _mm256_set1_ps(scale);
+
+    int i = 0;
+    for (; i + 7 < size; i += 8)
+    {
+        __m256 _v = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(intptr + i)));
+        _v = _mm256_fmadd_ps(_v, _scale, _bias);
+        _mm256_storeu_ps(ptr + i, _v);
+    }
+    for (; i < size; i++)
+    {
+        ptr[i] = intptr[i] * scale + bias;
+    }
+}
+#endif // __AVX2__
+
+int Dequantize_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+#if __AVX2__
+    int dims = bottom_top_blob.dims;
+    int elempack = bottom_top_blob.elempack;
+
+    const float bias0 = bias_term ? bias_data[0] : 0.f;
+
+    if (dims == 1)
+    {
+        int w = bottom_top_blob.w;
+        int size = w * elempack;
+
+        const int* intptr = bottom_top_blob;
+        float* ptr = bottom_top_blob;
+
+        const int nn_size = (size + 63) / 64;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int ii = 0; ii < nn_size; ii++)
+        {
+            const int i = ii * 64;
+            const int len = std::min(64, size - i);
+
+            if (bias_term && bias_data_size > 1)
+            {
+                // bias follows every element
+                __m256 _scale = _mm256_set1_ps(scale);
+
+                int j = 0;
+                for (; j + 7 < len; j += 8)
+                {
+                    __m256 _v = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(intptr + i + j)));
+                    _v = _mm256_fmadd_ps(_v, _scale, _mm256_loadu_ps((const float*)bias_data + i + j));
+                    _mm256_storeu_ps(ptr + i + j, _v);
+                }
+                for (; j < len; j++)
+                {
+                    ptr[i + j] = intptr[i + j] * scale + bias_data[i + j];
+                }
+            }
+            else
+            {
+                dequantize_avx(intptr + i, ptr + i, len, scale, _mm256_set1_ps(bias0), bias0);
+            }
+        }
+    }
+
+    if (dims == 2 || dims == 3)
+    {
+        // one bias per row of a 2-dim blob or per channel of a 3-dim blob
+        int w = bottom_top_blob.w;
+        int h = bottom_top_blob.h;
+        int channels = dims == 2 ? h : bottom_top_blob.c;
+        int size = dims == 2 ? w * elempack : w * h * elempack;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < channels; q++)
+        {
+            const int* intptr = dims == 2 ? bottom_top_blob.row<const int>(q) : (const int*)bottom_top_blob.channel(q);
+            float* ptr = dims == 2 ? bottom_top_blob.row(q) : (float*)bottom_top_blob.channel(q);
+
+            float bias = bias_term && bias_data_size > 1 ? bias_data[q * elempack] : bias0;
+
+            __m256 _bias = _mm256_set1_ps(bias);
+            if (elempack == 8 && bias_term && bias_data_size > 1)
+            {
+                _bias = _mm256_loadu_ps((const float*)bias_data + q * 8);
+            }
+
+            dequantize_avx(intptr, ptr, size, scale, _bias, bias);
+        }
+    }
+
+    return 0;
+#else
+    return Dequantize::forward_inplace(bottom_top_blob, opt);
+#endif // __AVX2__
+}
+
+} // namespace ncnn
@@ -13,22 +13,33 @@
 // specific language governing permissions and limitations under the License.
 
 #if __AVX__
-#include <immintrin.h>
+#include "avx_usability.h"
 #endif // __AVX__
 
 #include "eltwise_x86.h"
 
+#include <algorithm>
+
 namespace ncnn {
 
 Eltwise_x86::Eltwise_x86()
 {
 #if __AVX__
     support_packing = true;
+    support_bf16_storage = true;
 #endif // __AVX__
+#if __AVX512F__
+    support_packing16 = true;
+#endif // __AVX512F__
 }
 
 int Eltwise_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
 {
+#if __AVX__
+    if (opt.use_bf16_storage && bottom_blobs[0].elembits() == 16)
+        return forward_bf16s(bottom_blobs, top_blobs, opt);
+#endif // __AVX__
+
     const Mat& bottom_blob = bottom_blobs[0];
     int w = bottom_blob.w;
     int h = bottom_blob.h;
@@ -43,6 +54,205 @@ int Eltwise_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
         return -100;
 
 #if __AVX__
+#if __AVX512F__
+    if (elempack == 16)
+    {
+        if (op_type == Operation_PROD)
+        {
+            // first blob
+            const Mat& bottom_blob1 = bottom_blobs[1];
+            #pragma omp parallel for num_threads(opt.num_threads)
+            for (int q = 0; q < channels; q++)
+            {
+                const float* ptr = bottom_blob.channel(q);
+                const float* ptr1 = bottom_blob1.channel(q);
+                float* outptr = top_blob.channel(q);
+
+                for (int i = 0; i < size; i++)
+                {
+                    __m512 _p = _mm512_loadu_ps(ptr);
+                    __m512 _p1 = _mm512_loadu_ps(ptr1);
+                    _p = _mm512_mul_ps(_p, _p1);
+                    _mm512_storeu_ps(outptr, _p);
+
+                    ptr += 16;
+                    ptr1 += 16;
+                    outptr += 16;
+                }
+            }
+
+            for (size_t b = 2; b < bottom_blobs.size(); b++)
+            {
+                const Mat& bottom_blob1 = bottom_blobs[b];
+                #pragma omp parallel for num_threads(opt.num_threads)
+                for (int q = 0; q < channels; q++)
+                {
+                    const float* ptr = bottom_blob1.channel(q);
+                    float* outptr = top_blob.channel(q);
+
+                    for (int i = 0; i < size; i++)
+                    {
+                        __m512 _p = _mm512_loadu_ps(outptr);
+                        __m512 _p1 = _mm512_loadu_ps(ptr);
+                        _p = _mm512_mul_ps(_p, _p1);
+                        _mm512_storeu_ps(outptr, _p);
+
+                        ptr += 16;
+                        outptr += 16;
+                    }
+                }
+            }
+        }
+        if (op_type == Operation_SUM)
+        {
+            if (coeffs.w == 0)
+            {
+                // first blob
+                const Mat& bottom_blob1 = bottom_blobs[1];
+                #pragma omp parallel for num_threads(opt.num_threads)
+                for (int q = 0; q < channels; q++)
+                {
+                    const float* ptr = bottom_blob.channel(q);
+                    const float* ptr1 = bottom_blob1.channel(q);
+                    float* outptr = top_blob.channel(q);
+
+                    for (int i = 0; i < size; i++)
+                    {
+                        __m512 _p = _mm512_loadu_ps(ptr);
+                        __m512 _p1 = _mm512_loadu_ps(ptr1);
+                        _p = _mm512_add_ps(_p, _p1);
+                        _mm512_storeu_ps(outptr, _p);
+
+                        ptr += 16;
+                        ptr1 += 16;
+                        outptr += 16;
+                    }
+                }
+
+                for (size_t b = 2; b < bottom_blobs.size(); b++)
+                {
+                    const Mat& bottom_blob1 = bottom_blobs[b];
+                    #pragma omp parallel for num_threads(opt.num_threads)
+                    for (int q = 0; q < channels; q++)
+                    {
+                        const float* ptr = bottom_blob1.channel(q);
+                        float* outptr = top_blob.channel(q);
+
+                        for (int i = 0; i < size; i++)
+                        {
+                            __m512 _p = _mm512_loadu_ps(outptr);
+                            __m512 _p1 = _mm512_loadu_ps(ptr);
+                            _p = _mm512_add_ps(_p, _p1);
+                            _mm512_storeu_ps(outptr, _p);
+
+                            ptr += 16;
+                            outptr += 16;
+                        }
+                    }
+                }
+            }
+            else
+            {
+                // first blob
+                const Mat& bottom_blob1 = bottom_blobs[1];
+                __m512 _coeff0 = _mm512_set1_ps(coeffs[0]);
+                __m512 _coeff1 = _mm512_set1_ps(coeffs[1]);
+                #pragma omp parallel for num_threads(opt.num_threads)
+                for (int q = 0; q < channels; q++)
+                {
+                    const float* ptr = bottom_blob.channel(q);
+                    const float* ptr1 = bottom_blob1.channel(q);
+                    float* outptr = top_blob.channel(q);
+
+                    for (int i = 0; i < size; i++)
+                    {
+                        __m512 _p = _mm512_loadu_ps(ptr);
+                        __m512 _p1 = _mm512_loadu_ps(ptr1);
+                        _p = _mm512_mul_ps(_p, _coeff0);
+                        _p = _mm512_fmadd_ps(_p1, _coeff1, _p);
+                        _mm512_storeu_ps(outptr, _p);
+
+                        ptr += 16;
+                        ptr1 += 16;
+                        outptr += 16;
+                    }
+                }
+
+                for (size_t b = 2; b < bottom_blobs.size(); b++)
+                {
+                    const Mat& bottom_blob1 = bottom_blobs[b];
+                    __m512 _coeff = _mm512_set1_ps(coeffs[b]);
+                    #pragma omp parallel for num_threads(opt.num_threads)
+                    for (int q = 0; q < channels; q++)
+                    {
+                        const float* ptr = bottom_blob1.channel(q);
+                        float* outptr = top_blob.channel(q);
+
+                        for (int i = 0; i < size; i++)
+                        {
+                            __m512 _p = _mm512_loadu_ps(outptr);
+                            __m512 _p1 = _mm512_loadu_ps(ptr);
+                            _p = _mm512_fmadd_ps(_p1, _coeff, _p);
+                            _mm512_storeu_ps(outptr, _p);
+
+                            ptr += 16;
+                            outptr += 16;
+                        }
+                    }
+                }
+            }
+        }
+        if (op_type == Operation_MAX)
+        {
+            // first blob
+            const Mat& bottom_blob1 = bottom_blobs[1];
+            #pragma omp parallel for num_threads(opt.num_threads)
+            for (int q = 0; q < channels; q++)
+            {
+                const float* ptr = bottom_blob.channel(q);
+                const float* ptr1 = bottom_blob1.channel(q);
+                float* outptr = top_blob.channel(q);
+
+                for (int i = 0; i < size; i++)
+                {
+                    __m512 _p = _mm512_loadu_ps(ptr);
+                    __m512 _p1 = _mm512_loadu_ps(ptr1);
+                    _p = _mm512_max_ps(_p, _p1);
+                    _mm512_storeu_ps(outptr, _p);
+
+                    ptr += 16;
+                    ptr1 += 16;
+                    outptr += 16;
+                }
+            }
+
+            for (size_t b = 2; b < bottom_blobs.size(); b++)
+            {
+                const Mat& bottom_blob1 = bottom_blobs[b];
+                #pragma omp parallel for num_threads(opt.num_threads)
+                for (int q = 0; q < channels; q++)
+                {
+                    const float* ptr = bottom_blob1.channel(q);
+                    float* outptr = top_blob.channel(q);
+
+                    for (int i = 0; i < size; i++)
+                    {
+                        __m512 _p = _mm512_loadu_ps(outptr);
+                        __m512 _p1 = _mm512_loadu_ps(ptr);
+                        _p = _mm512_max_ps(_p, _p1);
+                        _mm512_storeu_ps(outptr, _p);
+
+                        ptr += 16;
+                        outptr += 16;
+                    }
+                }
+            }
+        }
+
+        return 0;
+    }
+#endif // __AVX512F__
+
     if (elempack == 8)
     {
         if (op_type == Operation_PROD)
@@ -417,4 +627,109 @@ int Eltwise_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>&
     return 0;
 }
 
+#if __AVX__
+int Eltwise_x86::forward_bf16s(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    const Mat& bottom_blob = bottom_blobs[0];
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int channels = bottom_blob.c;
+    size_t elemsize = bottom_blob.elemsize;
+    int elempack = bottom_blob.elempack;
+    int size = w * h * elempack;
+
+    Mat& top_blob = top_blobs[0];
+    top_blob.create(w, h, channels, elemsize, elempack, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    const int blob_count = (int)bottom_blobs.size();
+
+    // widen a tile of every input in turn and accumulate in fp32
+    // so that the bf16 output is rounded once instead of per input
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int q = 0; q < channels; q++)
+    {
+        unsigned short* outptr = top_blob.channel(q);
+
+        float tmp[256];
+
+        for (int i = 0; i < size; i += 256)
+        {
+            const int len = std::min(size - i, 256);
+
+            for (int b = 0; b < blob_count; b++)
+            {
+                const unsigned short* ptr = (const unsigned short*)bottom_blobs[b].channel(q) + i;
+
+                const float coeff = op_type == Operation_SUM && coeffs.w != 0 ? coeffs[b] : 1.f;
+                __m256 _coeff = _mm256_set1_ps(coeff);
+
+                int j = 0;
+                if (b == 0)
+                {
+                    for (; j + 7 < len; j += 8)
+                    {
+                        __m256 _p = loadbf16(ptr + j);
+                        _mm256_storeu_ps(tmp + j, _mm256_mul_ps(_p, _coeff));
+                    }
+                    for (; j < len; j++)
+                    {
+                        tmp[j] = bfloat16_to_float32(ptr[j]) * coeff;
+                    }
+                }
+                else if (op_type == Operation_PROD)
+                {
+                    for (; j + 7 < len; j += 8)
+                    {
+                        __m256 _p = loadbf16(ptr + j);
+                        _mm256_storeu_ps(tmp + j, _mm256_mul_ps(_mm256_loadu_ps(tmp + j), _p));
+                    }
+                    for (; j < len; j++)
+                    {
+                        tmp[j] *= bfloat16_to_float32(ptr[j]);
+                    }
+                }
+                else if (op_type == Operation_SUM)
+                {
+                    for (; j + 7 < len; j += 8)
+                    {
+                        __m256 _p = loadbf16(ptr + j);
+                        _mm256_storeu_ps(tmp + j, _mm256_fmadd_ps(_p, _coeff, _mm256_loadu_ps(tmp + j)));
+                    }
+                    for (; j < len; j++)
+                    {
+                        tmp[j] += bfloat16_to_float32(ptr[j]) * coeff;
+                    }
+                }
+                else if (op_type == Operation_MAX)
+                {
+                    for (; j + 7 < len; j += 8)
+                    {
+                        __m256 _p = loadbf16(ptr + j);
+                        _mm256_storeu_ps(tmp + j, _mm256_max_ps(_mm256_loadu_ps(tmp + j), _p));
+                    }
+                    for (; j < len; j++)
+                    {
+                        tmp[j] = std::max(tmp[j], bfloat16_to_float32(ptr[j]));
+                    }
+                }
+            }
+
+            int j = 0;
+            for (; j + 7 < len; j += 8)
+            {
+                _mm_storeu_si128((__m128i*)(outptr + i + j), float2bfloat_avx(_mm256_loadu_ps(tmp + j)));
+            }
+            for (; j < len; j++)
+            {
+                outptr[i + j] = float32_to_bfloat16(tmp[j]);
+            }
+        }
+    }
+
+    return 0;
+}
+#endif // __AVX__
+
 } // namespace ncnn
@@ -0,0 +1,150 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#if __AVX__
+#include "avx_usability.h"
+#endif // __AVX__
+
+#include "gemm_x86.h"
+
+#include <string.h>
+
+namespace ncnn {
+
+#if __AVX__
+#include "sgemm_avx.h"
+#endif // __AVX__
+
+int Gemm_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+#if __AVX__
+    const Mat& A0 = bottom_blobs[0];
+    const Mat& B0 = bottom_blobs[1];
+
+    size_t elemsize = A0.elemsize;
+
+    // read the transposed operands in place through strides
+    const int M = transA ? A0.w : A0.h;
+    const int K = transA ? A0.h : A0.w;
+    const int N = transB ? B0.h : B0.w;
+
+    const int lda_row = transA ? 1 : A0.w;
+    const int lda_col = transA ? A0.w : 1;
+    const int ldb_row = transB ? 1 : B0.w;
+    const int ldb_col = transB ? B0.w : 1;
+
+    Mat& top_blob = top_blobs[0];
+    top_blob.create(N, M, elemsize, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    int ret = sgemm_avx(M, N, K, (const float*)A0, lda_row, lda_col, (const float*)B0, ldb_row, ldb_col, (float*)top_blob, N, opt);
+    if (ret != 0)
+        return ret;
+
+    const bool has_C = bottom_blobs.size() == 3;
+
+    const float* ptrC = 0;
+    int broadcast_type_C = 0;
+    if (has_C)
+    {
+        const Mat& C = bottom_blobs[2];
+
+        ptrC = C;
+
+        if (C.dims == 1 && C.w == 1)
+        {
+            // scalar
+            broadcast_type_C = 0;
+        }
+        if (C.dims == 1 && C.w == M)
+        {
+            // M
+            broadcast_type_C = 1;
+        }
+        if (C.dims == 2 && C.w == 1 && C.h == M)
+        {
+            // Mx1
+            broadcast_type_C = 2;
+        }
+        if (C.dims == 2 && C.w == N && C.h == M)
+        {
+            // MxN
+            broadcast_type_C = 3;
+        }
+        if (C.dims == 2 && C.w == N && C.h == 1)
+        {
+            // 1xN
+            broadcast_type_C = 4;
+        }
+    }
+
+    // out = (A * B + C * beta) * alpha
+    const __m256 _alpha = _mm256_set1_ps(alpha);
+    const __m256 _beta = _mm256_set1_ps(beta);
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int i = 0; i < M; i++)
+    {
+        float* outptr = top_blob.row(i);
+
+        int j = 0;
+        if (!has_C)
+        {
+            for (; j + 7 < N; j += 8)
+            {
+                _mm256_storeu_ps(outptr + j, _mm256_mul_ps(_mm256_loadu_ps(outptr + j), _alpha));
+            }
+            for (; j < N; j++)
+            {
+                outptr[j] *= alpha;
+            }
+        }
+        else if (broadcast_type_C == 3 || broadcast_type_C == 4)
+        {
+            const float* ptr = broadcast_type_C == 3 ? ptrC + (size_t)i * N : ptrC;
+
+            for (; j + 7 < N; j += 8)
+            {
+                __m256 _c = _mm256_mul_ps(_mm256_loadu_ps(ptr + j), _beta);
+                _mm256_storeu_ps(outptr + j, _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(outptr + j), _c), _alpha));
+            }
+            for (; j < N; j++)
+            {
+                outptr[j] = (outptr[j] + ptr[j] * beta) * alpha;
+            }
+        }
+        else
+        {
+            const float c = (broadcast_type_C == 0 ? ptrC[0] : ptrC[i]) * beta;
+            const __m256 _c = _mm256_set1_ps(c);
+
+            for (; j + 7 < N; j += 8)
+            {
+                _mm256_storeu_ps(outptr + j, _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(outptr + j), _c), _alpha));
+            }
+            for (; j < N; j++)
+            {
+                outptr[j] = (outptr[j] + c) * alpha;
+            }
+        }
+    }
+
+    return 0;
+#else
+    return Gemm::forward(bottom_blobs, top_blobs, opt);
+#endif // __AVX__
+}
+
+} // namespace ncnn
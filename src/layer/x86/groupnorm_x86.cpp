@@ -0,0 +1,180 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#if __AVX__
+#include "avx_usability.h"
+#endif // __AVX__
+
+#include "groupnorm_x86.h"
+
+#include <math.h>
+
+namespace ncnn {
+
+GroupNorm_x86::GroupNorm_x86()
+{
+#if __AVX__
+    support_packing = true;
+#endif // __AVX__
+}
+
+int GroupNorm_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+#if __AVX__
+    int dims = bottom_top_blob.dims;
+    int elempack = bottom_top_blob.elempack;
+
+    int channels_per_group = channels / group;
+
+    if (elempack == 8 && (dims != 3 || channels_per_group % 8 != 0))
+    {
+        // groups split pack8 lanes, normalize unpacked
+        Option opt_unpack = opt;
+        opt_unpack.blob_allocator = opt.workspace_allocator;
+
+        Mat bottom_top_blob_unpacked;
+        convert_packing(bottom_top_blob, bottom_top_blob_unpacked, 1, opt_unpack);
+
+        int ret = forward_inplace(bottom_top_blob_unpacked, opt);
+        if (ret != 0)
+            return ret;
+
+        convert_packing(bottom_top_blob_unpacked, bottom_top_blob, elempack, opt);
+        if (bottom_top_blob.empty())
+            return -100;
+
+        return 0;
+    }
+
+    if (dims != 3)
+        return GroupNorm::forward_inplace(bottom_top_blob, opt);
+
+    // x = (x - mean) / sqrt(var + eps) * gamma + beta
+
+    int w = bottom_top_blob.w;
+    int h = bottom_top_blob.h;
+    int size = w * h * elempack;
+
+    const int channels_per_group_packed = channels_per_group / elempack;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int g = 0; g < group; g++)
+    {
+        Mat bottom_top_blob_g = bottom_top_blob.channel_range(g * channels_per_group_packed, channels_per_group_packed);
+
+        // mean and var in one sweep, shifted by the first element of the group
+        const float pivot = ((const float*)bottom_top_blob_g.channel(0))[0];
+        __m256 _pivot = _mm256_set1_ps(pivot);
+        __m256 _sum = _mm256_setzero_ps();
+        __m256 _sqsum = _mm256_setzero_ps();
+        float sum = 0.f;
+        float sqsum = 0.f;
+        for (int q = 0; q < channels_per_group_packed; q++)
+        {
+            const float* ptr = bottom_top_blob_g.channel(q);
+
+            int i = 0;
+            for (; i + 7 < size; i += 8)
+            {
+                __m256 _p = _mm256_sub_ps(_mm256_loadu_ps(ptr + i), _pivot);
+                _sum = _mm256_add_ps(_sum, _p);
+                _sqsum = _mm256_fmadd_ps(_p, _p, _sqsum);
+            }
+            for (; i < size; i++)
+            {
+                float v = ptr[i] - pivot;
+                sum += v;
+                sqsum += v * v;
+            }
+        }
+        sum += _mm256_reduce_add_ps(_sum);
+        sqsum += _mm256_reduce_add_ps(_sqsum);
+
+        float mean_shifted = sum / (channels_per_group * w * h);
+        float mean = pivot + mean_shifted;
+        // the var maybe minus due to accuracy
+        float var = std::max(sqsum / (channels_per_group * w * h) - mean_shifted * mean_shifted, 0.f);
+        float inv_std = static_cast<float>(1.f / sqrt(var + eps));
+
+        for (int q = 0; q < channels_per_group_packed; q++)
+        {
+            float* ptr = bottom_top_blob_g.channel(q);
+
+            if (elempack == 8)
+            {
+                __m256 _a = _mm256_set1_ps(inv_std);
+                __m256 _b;
+                if (affine)
+                {
+                    __m256 _gamma = _mm256_loadu_ps((const float*)gamma_data + g * channels_per_group + q * 8);
+                    __m256 _beta = _mm256_loadu_ps((const float*)beta_data + g * channels_per_group + q * 8);
+
+                    _a = _mm256_mul_ps(_a, _gamma);
+                    _b = _mm256_fnmadd_ps(_mm256_set1_ps(mean), _a, _beta);
+                }
+                else
+                {
+                    _b = _mm256_set1_ps(-mean * inv_std);
+                }
+
+                for (int i = 0; i < size; i += 8)
+                {
+                    __m256 _p = _mm256_loadu_ps(ptr + i);
+                    _p = _mm256_fmadd_ps(_p, _a, _b);
+                    _mm256_storeu_ps(ptr + i, _p);
+                }
+
+                continue;
+            }
+
+            float a;
+            float b;
+            if (affine)
+            {
+                float gamma = gamma_data[g * channels_per_group + q];
+                float beta = beta_data[g * channels_per_group + q];
+
+                a = gamma * inv_std;
+                b = -mean * a + beta;
+            }
+            else
+            {
+                a = inv_std;
+                b = -mean * a;
+            }
+
+            __m256 _a = _mm256_set1_ps(a);
+            __m256 _b = _mm256_set1_ps(b);
+
+            int i = 0;
+            for (; i + 7 < size; i += 8)
+            {
+                __m256 _p = _mm256_loadu_ps(ptr + i);
+                _p = _mm256_fmadd_ps(_p, _a, _b);
+                _mm256_storeu_ps(ptr + i, _p);
+            }
+            for (; i < size; i++)
+            {
+                ptr[i] = ptr[i] * a + b;
+            }
+        }
+    }
+
+    return 0;
+#else
+    return GroupNorm::forward_inplace(bottom_top_blob, opt);
+#endif // __AVX__
+}
+
+} // namespace ncnn
@@ -14,6 +14,8 @@
 
 #if __AVX__
 #include <immintrin.h>
+
+#include "avx_activation.h"
 #endif // __AVX__
 
 #include "hardswish_x86.h"
@@ -25,24 +27,51 @@ HardSwish_x86::HardSwish_x86()
 #if __AVX__
     support_packing = true;
 #endif // __AVX__
+#if __AVX512F__
+    support_packing16 = true;
+#endif // __AVX512F__
 }
 
-int HardSwish_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+// bottom_blob and top_blob may be the same mat
+static void hardswish_x86(const Mat& bottom_blob, Mat& top_blob, float alpha, float beta, float lower, float upper, const Option& opt)
 {
-    int w = bottom_top_blob.w;
-    int h = bottom_top_blob.h;
-    int channels = bottom_top_blob.c;
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int channels = bottom_blob.c;
     int size = w * h;
 
 #if __AVX__
-    int elempack = bottom_top_blob.elempack;
+    int elempack = bottom_blob.elempack;
+
+#if __AVX512F__
+    if (elempack == 16)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < channels; q++)
+        {
+            const float* ptr = bottom_blob.channel(q);
+            float* outptr = top_blob.channel(q);
+
+            for (int i = 0; i < size; i++)
+            {
+                __m512 _p = _mm512_loadu_ps(ptr);
+                _mm512_storeu_ps(outptr, hardswish_avx512(_p, alpha, beta));
+                ptr += 16;
+                outptr += 16;
+            }
+        }
+
+        return;
+    }
+#endif // __AVX512F__
 
     if (elempack == 8)
     {
         #pragma omp parallel for num_threads(opt.num_threads)
         for (int q = 0; q < channels; q++)
         {
-            float* ptr = bottom_top_blob.channel(q);
+            const float* ptr = bottom_blob.channel(q);
+            float* outptr = top_blob.channel(q);
             __m256 _zero = _mm256_set1_ps(0.f);
             __m256 _one = _mm256_set1_ps(1.f);
             for (int i = 0; i < size; i++)
@@ -53,31 +82,52 @@ int HardSwish_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) cons
                 _ans = _mm256_max_ps(_ans, _zero);
                 _ans = _mm256_min_ps(_ans, _one);
                 _ans = _mm256_mul_ps(_ans, _p);
-                _mm256_storeu_ps(ptr, _ans);
+                _mm256_storeu_ps(outptr, _ans);
 
                 ptr += 8;
+                outptr += 8;
             }
         }
-        return 0;
+
+        return;
     }
 #endif // __AVX__
+
     #pragma omp parallel for num_threads(opt.num_threads)
     for (int q = 0; q < channels; q++)
     {
-        float* ptr = bottom_top_blob.channel(q);
+        const float* ptr = bottom_blob.channel(q);
+        float* outptr = top_blob.channel(q);
         int remain = size;
 
         for (; remain > 0; remain--)
         {
             if (*ptr < lower)
-                *ptr = 0.f;
+                *outptr = 0.f;
             else if (*ptr > upper)
-                ;
+                *outptr = *ptr;
             else
-                *ptr = *ptr * (*ptr * alpha + beta);
+                *outptr = *ptr * (*ptr * alpha + beta);
             ++ptr;
+            ++outptr;
         }
     }
+}
+
+int HardSwish_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    top_blob.create_like(bottom_blob, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    hardswish_x86(bottom_blob, top_blob, alpha, beta, lower, upper, opt);
+
+    return 0;
+}
+
+int HardSwish_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    hardswish_x86(bottom_top_blob, bottom_top_blob, alpha, beta, lower, upper, opt);
 
     return 0;
 }
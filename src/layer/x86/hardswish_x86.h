@@ -24,6 +24,8 @@ class HardSwish_x86 : virtual public HardSwish
 public:
     HardSwish_x86();
 
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
     virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
 };
 
@@ -24,14 +24,25 @@
 
 #include "layer_type.h"
 
+#include <string.h>
+
 namespace ncnn {
 
+#if __AVX__
+#include "sgemm_avx.h"
+#endif // __AVX__
+
 InnerProduct_x86::InnerProduct_x86()
 {
 #if __AVX__
     support_packing = true;
     support_weight_fp16_storage = true;
+    support_bf16_storage = true;
+    support_batch = true;
 #endif // __AVX__
+#if __AVX512F__
+    support_packing16 = true;
+#endif // __AVX512F__
 
     flatten = 0;
 }
@@ -53,6 +64,15 @@ int InnerProduct_x86::create_pipeline(const Option& opt)
     {
         ncnn::cast_float32_to_float16(weight_data, weight_data_fp16, opt);
     }
+    if (opt.use_bf16_storage && weight_data.elemsize == 4u)
+    {
+        ncnn::cast_float32_to_bfloat16(weight_data, weight_data_bf16, opt);
+    }
+    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
+    {
+        support_bf16_storage = false;
+        support_packing16 = false;
+    }
 #else
     (void)(opt);
 #endif // __AVX__
@@ -69,6 +89,49 @@ int InnerProduct_x86::destroy_pipeline(const Option& opt)
         flatten = 0;
     }
 
+    weight_data_fp16.release();
+    weight_data_bf16.release();
+
+    return 0;
+}
+
+int InnerProduct_x86::get_prepacked_weights(std::vector<Mat>& weights) const
+{
+    weights.resize(2);
+    weights[0] = weight_data_fp16;
+    weights[1] = weight_data_bf16;
+
+    return 0;
+}
+
+int InnerProduct_x86::create_pipeline_prepacked(const std::vector<Mat>& weights, const Option& opt)
+{
+    if (weights.size() != 2)
+        return -1;
+
+#if __AVX__
+    if (opt.use_packing_layout)
+    {
+        flatten = ncnn::create_layer(ncnn::LayerType::Flatten);
+
+        ncnn::ParamDict pd;
+
+        flatten->load_param(pd);
+
+        flatten->create_pipeline(opt);
+    }
+    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
+    {
+        support_bf16_storage = false;
+        support_packing16 = false;
+    }
+#else
+    (void)(opt);
+#endif // __AVX__
+
+    weight_data_fp16 = weights[0];
+    weight_data_bf16 = weights[1];
+
     return 0;
 }
 
@@ -81,6 +144,11 @@ int InnerProduct_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Optio
     }
 
 #if __AVX__
+    if (opt.use_bf16_storage && bottom_blob.elembits() == 16)
+    {
+        return forward_bf16s(bottom_blob, top_blob, opt);
+    }
+
     int w = bottom_blob.w;
     int h = bottom_blob.h;
     int channels = bottom_blob.c;
@@ -88,7 +156,23 @@ int InnerProduct_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Optio
     int elempack = bottom_blob.elempack;
     int size = w * h;
 
-    if (elempack == 8)
+#if __AVX512F__
+    if (elempack == 16 && bottom_blob.dims != 1)
+    {
+        // flatten has no pack16 path, unpack and take the pack1 route
+        Option opt_unpack = opt;
+        opt_unpack.blob_allocator = opt.workspace_allocator;
+
+        Mat bottom_blob_unpacked;
+        convert_packing(bottom_blob, bottom_blob_unpacked, 1, opt_unpack);
+        if (bottom_blob_unpacked.empty())
+            return -100;
+
+        return forward(bottom_blob_unpacked, top_blob, opt);
+    }
+#endif // __AVX512F__
+
+    if (elempack == 8 || elempack == 16)
     {
         // flatten
         Mat bottom_blob_flattened = bottom_blob;
@@ -161,12 +245,62 @@ int InnerProduct_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Optio
         const float* w6 = weight_data_ptr + size * channels * (p + 6);
         const float* w7 = weight_data_ptr + size * channels * (p + 7);
 
+#if __AVX512F__
+        __m512 _sum0_16 = _mm512_setzero_ps();
+        __m512 _sum1_16 = _mm512_setzero_ps();
+        __m512 _sum2_16 = _mm512_setzero_ps();
+        __m512 _sum3_16 = _mm512_setzero_ps();
+        __m512 _sum4_16 = _mm512_setzero_ps();
+        __m512 _sum5_16 = _mm512_setzero_ps();
+        __m512 _sum6_16 = _mm512_setzero_ps();
+        __m512 _sum7_16 = _mm512_setzero_ps();
+#endif // __AVX512F__
         // channels
         for (int q = 0; q < channels; q++)
         {
             const float* m = bottom_blob.channel(q);
             int nn = size >> 3;
             int remain = size & 7;
+#if __AVX512F__
+            for (; nn >= 2; nn -= 2)
+            {
+                __m512 _m = _mm512_loadu_ps(m);
+
+                __m512 _w0_16 = _mm512_loadu_ps(w0);
+                _sum0_16 = _mm512_fmadd_ps(_m, _w0_16, _sum0_16);
+
+                __m512 _w1_16 = _mm512_loadu_ps(w1);
+                _sum1_16 = _mm512_fmadd_ps(_m, _w1_16, _sum1_16);
+
+                __m512 _w2_16 = _mm512_loadu_ps(w2);
+                _sum2_16 = _mm512_fmadd_ps(_m, _w2_16, _sum2_16);
+
+                __m512 _w3_16 = _mm512_loadu_ps(w3);
+                _sum3_16 = _mm512_fmadd_ps(_m, _w3_16, _sum3_16);
+
+                __m512 _w4_16 = _mm512_loadu_ps(w4);
+                _sum4_16 = _mm512_fmadd_ps(_m, _w4_16, _sum4_16);
+
+                __m512 _w5_16 = _mm512_loadu_ps(w5);
+                _sum5_16 = _mm512_fmadd_ps(_m, _w5_16, _sum5_16);
+
+                __m512 _w6_16 = _mm512_loadu_ps(w6);
+                _sum6_16 = _mm512_fmadd_ps(_m, _w6_16, _sum6_16);
+
+                __m512 _w7_16 = _mm512_loadu_ps(w7);
+                _sum7_16 = _mm512_fmadd_ps(_m, _w7_16, _sum7_16);
+
+                m += 16;
+                w0 += 16;
+                w1 += 16;
+                w2 += 16;
+                w3 += 16;
+                w4 += 16;
+                w5 += 16;
+                w6 += 16;
+                w7 += 16;
+            }
+#endif // __AVX512F__
 
             for (; nn > 0; nn--)
             {
@@ -229,6 +363,16 @@ int InnerProduct_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Optio
                 w7++;
             }
         }
+#if __AVX512F__
+        _sum0 = _mm256_add_ps(_sum0, _mm512_fold_ps(_sum0_16));
+        _sum1 = _mm256_add_ps(_sum1, _mm512_fold_ps(_sum1_16));
+        _sum2 = _mm256_add_ps(_sum2, _mm512_fold_ps(_sum2_16));
+        _sum3 = _mm256_add_ps(_sum3, _mm512_fold_ps(_sum3_16));
+        _sum4 = _mm256_add_ps(_sum4, _mm512_fold_ps(_sum4_16));
+        _sum5 = _mm256_add_ps(_sum5, _mm512_fold_ps(_sum5_16));
+        _sum6 = _mm256_add_ps(_sum6, _mm512_fold_ps(_sum6_16));
+        _sum7 = _mm256_add_ps(_sum7, _mm512_fold_ps(_sum7_16));
+#endif // __AVX512F__
         __m256 _sums = HorizontalSums(_sum0, _sum1, _sum2, _sum3, _sum4, _sum5, _sum6, _sum7);
         __m256 _sums_f = _mm256_loadu_ps(sums);
         _sums = activation_ps(_mm256_add_ps(_sums_f, _sums), activation_type, activation_params);
@@ -262,12 +406,42 @@ int InnerProduct_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Optio
         const float* w2 = weight_data_ptr + size * channels * (p + 2);
         const float* w3 = weight_data_ptr + size * channels * (p + 3);
 
+#if __AVX512F__
+        __m512 _sum0_16 = _mm512_setzero_ps();
+        __m512 _sum1_16 = _mm512_setzero_ps();
+        __m512 _sum2_16 = _mm512_setzero_ps();
+        __m512 _sum3_16 = _mm512_setzero_ps();
+#endif // __AVX512F__
         // channels
         for (int q = 0; q < channels; q++)
         {
             const float* m = bottom_blob.channel(q);
             int nn = size >> 3;
             int remain = size & 7;
+#if __AVX512F__
+            for (; nn >= 2; nn -= 2)
+            {
+                __m512 _m = _mm512_loadu_ps(m);
+
+                __m512 _w0_16 = _mm512_loadu_ps(w0);
+                _sum0_16 = _mm512_fmadd_ps(_m, _w0_16, _sum0_16);
+
+                __m512 _w1_16 = _mm512_loadu_ps(w1);
+                _sum1_16 = _mm512_fmadd_ps(_m, _w1_16, _sum1_16);
+
+                __m512 _w2_16 = _mm512_loadu_ps(w2);
+                _sum2_16 = _mm512_fmadd_ps(_m, _w2_16, _sum2_16);
+
+                __m512 _w3_16 = _mm512_loadu_ps(w3);
+                _sum3_16 = _mm512_fmadd_ps(_m, _w3_16, _sum3_16);
+
+                m += 16;
+                w0 += 16;
+                w1 += 16;
+                w2 += 16;
+                w3 += 16;
+            }
+#endif // __AVX512F__
 
             for (; nn > 0; nn--)
             {
@@ -306,6 +480,12 @@ int InnerProduct_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Optio
                 w3++;
             }
         }
+#if __AVX512F__
+        _sum0 = _mm256_add_ps(_sum0, _mm512_fold_ps(_sum0_16));
+        _sum1 = _mm256_add_ps(_sum1, _mm512_fold_ps(_sum1_16));
+        _sum2 = _mm256_add_ps(_sum2, _mm512_fold_ps(_sum2_16));
+        _sum3 = _mm256_add_ps(_sum3, _mm512_fold_ps(_sum3_16));
+#endif // __AVX512F__
         __m128 _sums = HorizontalSums(_sum0, _sum1, _sum2, _sum3);
         __m256 _sums_a = activation_ps(_mm256_castps128_ps256(_mm_add_ps(_mm_loadu_ps(sums), _sums)), activation_type, activation_params);
         _mm_storeu_ps(output_ptr + p, _mm256_castps256_ps128(_sums_a));
@@ -323,6 +503,9 @@ int InnerProduct_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Optio
         const float* w = weight_data_ptr + size * channels * p;
 
         __m256 _sum = _mm256_set1_ps(0.f);
+#if __AVX512F__
+        __m512 _sum_16 = _mm512_setzero_ps();
+#endif // __AVX512F__
         // channels
         for (int q = 0; q < channels; q++)
         {
@@ -330,6 +513,18 @@ int InnerProduct_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Optio
 
             int nn = size >> 3;
             int remain = size & 7;
+#if __AVX512F__
+            for (; nn >= 2; nn -= 2)
+            {
+                __m512 _m = _mm512_loadu_ps(m);
+
+                __m512 _w_16 = _mm512_loadu_ps(w);
+                _sum_16 = _mm512_fmadd_ps(_m, _w_16, _sum_16);
+
+                m += 16;
+                w += 16;
+            }
+#endif // __AVX512F__
             for (; nn > 0; nn--)
             {
                 __m256 _m = _mm256_loadu_ps(m);
@@ -348,6 +543,9 @@ int InnerProduct_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Optio
             }
         }
 
+#if __AVX512F__
+        _sum = _mm256_add_ps(_sum, _mm512_fold_ps(_sum_16));
+#endif // __AVX512F__
         sum += _mm256_reduce_add_ps(_sum);
         sum = activation_ss(sum, activation_type, activation_params);
 
@@ -358,6 +556,133 @@ int InnerProduct_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Optio
     return InnerProduct::forward(bottom_blob, top_blob, opt);
 #endif // __AVX__
 }
+int InnerProduct_x86::forward_batch(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    const int batch = (int)bottom_blobs.size();
+
+    if (batch == 1 || (opt.use_int8_inference && weight_data.elemsize == (size_t)1u) || (opt.use_bf16_storage && bottom_blobs[0].elembits() == 16))
+    {
+        return Layer::forward_batch(bottom_blobs, top_blobs, opt);
+    }
+
+#if __AVX__
+    const int num_input = weight_data_size / num_output;
+
+    // flatten batch items into contiguous rows
+    std::vector<Mat> bottom_blobs_flattened(batch);
+    for (int b = 0; b < batch; b++)
+    {
+        const Mat& bottom_blob = bottom_blobs[b];
+
+        Mat bottom_blob_flattened = bottom_blob;
+#if __AVX512F__
+        if (bottom_blob.elempack == 16 && bottom_blob.dims != 1)
+        {
+            Option opt_unpack = opt;
+            opt_unpack.blob_allocator = opt.workspace_allocator;
+
+            convert_packing(bottom_blob, bottom_blob_flattened, 1, opt_unpack);
+            if (bottom_blob_flattened.empty())
+                return -100;
+
+            bottom_blob_flattened = bottom_blob_flattened.reshape(num_input, opt.workspace_allocator);
+        }
+        else
+#endif // __AVX512F__
+        if (bottom_blob.elempack == 8 || bottom_blob.elempack == 16)
+        {
+            if (bottom_blob.dims != 1)
+            {
+                Option opt_flatten = opt;
+                opt_flatten.blob_allocator = opt.workspace_allocator;
+
+                flatten->forward(bottom_blob, bottom_blob_flattened, opt_flatten);
+            }
+
+            // pack1
+            {
+                bottom_blob_flattened.w *= bottom_blob_flattened.elempack;
+                bottom_blob_flattened.cstep = bottom_blob_flattened.w;
+                bottom_blob_flattened.elemsize = 4u;
+                bottom_blob_flattened.elempack = 1;
+            }
+        }
+        else if (bottom_blob.dims != 1)
+        {
+            bottom_blob_flattened = bottom_blob.reshape(num_input, opt.workspace_allocator);
+        }
+
+        if (bottom_blob_flattened.empty())
+            return -100;
+
+        bottom_blobs_flattened[b] = bottom_blob_flattened;
+    }
+
+    // batch items become the rows of one sgemm against the weight rows
+    Mat bottom_blob_batch(num_input, batch, 4u, opt.workspace_allocator);
+    Mat top_blob_batch(num_output, batch, 4u, opt.workspace_allocator);
+    if (bottom_blob_batch.empty() || top_blob_batch.empty())
+        return -100;
+
+    for (int b = 0; b < batch; b++)
+    {
+        memcpy(bottom_blob_batch.row(b), bottom_blobs_flattened[b], num_input * sizeof(float));
+    }
+
+    int ret = 0;
+    if (opt.use_weight_fp16_storage)
+    {
+        ret = sgemm_avx(batch, num_output, num_input, (const float*)bottom_blob_batch, num_input, 1, (const unsigned short*)weight_data_fp16, 1, num_input, (float*)top_blob_batch, num_output, opt);
+    }
+    else
+    {
+        ret = sgemm_avx(batch, num_output, num_input, (const float*)bottom_blob_batch, num_input, 1, (const float*)weight_data, 1, num_input, (float*)top_blob_batch, num_output, opt);
+    }
+    if (ret != 0)
+        return ret;
+
+    // same pack1 output layout as forward
+    top_blobs.resize(batch);
+    for (int b = 0; b < batch; b++)
+    {
+        top_blobs[b].create(num_output, 4u, opt.blob_allocator);
+        if (top_blobs[b].empty())
+            return -100;
+    }
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int b = 0; b < batch; b++)
+    {
+        const float* ptr = top_blob_batch.row(b);
+        float* outptr = top_blobs[b];
+
+        int p = 0;
+        for (; p + 7 < num_output; p += 8)
+        {
+            __m256 _sum = _mm256_loadu_ps(ptr + p);
+            if (bias_term)
+            {
+                _sum = _mm256_add_ps(_sum, _mm256_loadu_ps((const float*)bias_data + p));
+            }
+            _mm256_storeu_ps(outptr + p, activation_ps(_sum, activation_type, activation_params));
+        }
+        for (; p < num_output; p++)
+        {
+            float sum = ptr[p];
+            if (bias_term)
+            {
+                sum += bias_data[p];
+            }
+            outptr[p] = activation_ss(sum, activation_type, activation_params);
+        }
+    }
+
+    return 0;
+#else
+    return Layer::forward_batch(bottom_blobs, top_blobs, opt);
+#endif // __AVX__
+}
+
 #if __AVX__
 
 int InnerProduct_x86::forward_fp16(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
@@ -669,6 +994,145 @@ int InnerProduct_x86::forward_fp16(const Mat& bottom_blob, Mat& top_blob, const
     }
     return 0;
 }
+
+int InnerProduct_x86::forward_bf16s(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int num_input = weight_data_size / num_output;
+
+    Option opt_fp32 = opt;
+    opt_fp32.blob_allocator = opt.workspace_allocator;
+    opt_fp32.use_bf16_storage = false;
+
+    Mat bottom_blob_fp32;
+    cast_bfloat16_to_float32(bottom_blob, bottom_blob_fp32, opt_fp32);
+    if (bottom_blob_fp32.empty())
+        return -100;
+
+#if __AVX512F__
+    if (bottom_blob_fp32.elempack == 16 && bottom_blob_fp32.dims != 1)
+    {
+        Mat bottom_blob_unpacked;
+        convert_packing(bottom_blob_fp32, bottom_blob_unpacked, 1, opt_fp32);
+        if (bottom_blob_unpacked.empty())
+            return -100;
+
+        bottom_blob_fp32 = bottom_blob_unpacked;
+    }
+#endif // __AVX512F__
+
+    // flatten into one contiguous row
+    Mat bottom_blob_flattened = bottom_blob_fp32;
+    if (bottom_blob_fp32.elempack != 1)
+    {
+        if (bottom_blob_fp32.dims != 1)
+        {
+            flatten->forward(bottom_blob_fp32, bottom_blob_flattened, opt_fp32);
+        }
+
+        // pack1
+        {
+            bottom_blob_flattened.w *= bottom_blob_flattened.elempack;
+            bottom_blob_flattened.cstep = bottom_blob_flattened.w;
+            bottom_blob_flattened.elemsize = 4u;
+            bottom_blob_flattened.elempack = 1;
+        }
+    }
+    else if (bottom_blob_fp32.dims != 1)
+    {
+        bottom_blob_flattened = bottom_blob_fp32.reshape(num_input, opt.workspace_allocator);
+    }
+    if (bottom_blob_flattened.empty())
+        return -100;
+
+    top_blob.create(num_output, 2u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    const float* m = bottom_blob_flattened;
+    const unsigned short* weight_data_ptr = weight_data_bf16;
+    unsigned short* outptr = top_blob;
+
+    // weights stay bf16 in memory and widen on load, four rows share each input load
+    int nn_num_output = num_output >> 2;
+    int remain_num_output_start = nn_num_output << 2;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int pp = 0; pp < nn_num_output; pp++)
+    {
+        int p = pp * 4;
+
+        const unsigned short* w0 = weight_data_ptr + num_input * p;
+        const unsigned short* w1 = weight_data_ptr + num_input * (p + 1);
+        const unsigned short* w2 = weight_data_ptr + num_input * (p + 2);
+        const unsigned short* w3 = weight_data_ptr + num_input * (p + 3);
+
+        float sum0 = bias_term ? bias_data[p] : 0.f;
+        float sum1 = bias_term ? bias_data[p + 1] : 0.f;
+        float sum2 = bias_term ? bias_data[p + 2] : 0.f;
+        float sum3 = bias_term ? bias_data[p + 3] : 0.f;
+
+        int i = 0;
+        __m256 _sum0 = _mm256_setzero_ps();
+        __m256 _sum1 = _mm256_setzero_ps();
+        __m256 _sum2 = _mm256_setzero_ps();
+        __m256 _sum3 = _mm256_setzero_ps();
+
+        for (; i + 7 < num_input; i += 8)
+        {
+            __m256 _m = _mm256_loadu_ps(m + i);
+
+            _sum0 = _mm256_fmadd_ps(_m, loadbf16(w0 + i), _sum0);
+            _sum1 = _mm256_fmadd_ps(_m, loadbf16(w1 + i), _sum1);
+            _sum2 = _mm256_fmadd_ps(_m, loadbf16(w2 + i), _sum2);
+            _sum3 = _mm256_fmadd_ps(_m, loadbf16(w3 + i), _sum3);
+        }
+
+        sum0 += _mm256_reduce_add_ps(_sum0);
+        sum1 += _mm256_reduce_add_ps(_sum1);
+        sum2 += _mm256_reduce_add_ps(_sum2);
+        sum3 += _mm256_reduce_add_ps(_sum3);
+
+        for (; i < num_input; i++)
+        {
+            sum0 += m[i] * bfloat16_to_float32(w0[i]);
+            sum1 += m[i] * bfloat16_to_float32(w1[i]);
+            sum2 += m[i] * bfloat16_to_float32(w2[i]);
+            sum3 += m[i] * bfloat16_to_float32(w3[i]);
+        }
+
+        outptr[p] = float32_to_bfloat16(activation_ss(sum0, activation_type, activation_params));
+        outptr[p + 1] = float32_to_bfloat16(activation_ss(sum1, activation_type, activation_params));
+        outptr[p + 2] = float32_to_bfloat16(activation_ss(sum2, activation_type, activation_params));
+        outptr[p + 3] = float32_to_bfloat16(activation_ss(sum3, activation_type, activation_params));
+    }
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int p = remain_num_output_start; p < num_output; p++)
+    {
+        const unsigned short* w = weight_data_ptr + num_input * p;
+
+        float sum = bias_term ? bias_data[p] : 0.f;
+
+        int i = 0;
+        __m256 _sum = _mm256_setzero_ps();
+
+        for (; i + 7 < num_input; i += 8)
+        {
+            _sum = _mm256_fmadd_ps(_mm256_loadu_ps(m + i), loadbf16(w + i), _sum);
+        }
+
+        sum += _mm256_reduce_add_ps(_sum);
+
+        for (; i < num_input; i++)
+        {
+            sum += m[i] * bfloat16_to_float32(w[i]);
+        }
+
+        outptr[p] = float32_to_bfloat16(activation_ss(sum, activation_type, activation_params));
+    }
+
+    return 0;
+}
 #endif // __AVX__
 
 } // namespace ncnn
@@ -30,17 +30,27 @@ public:
     virtual int create_pipeline(const Option& opt);
     virtual int destroy_pipeline(const Option& opt);
 
+    virtual int get_prepacked_weights(std::vector<Mat>& weights) const;
+    virtual int create_pipeline_prepacked(const std::vector<Mat>& weights, const Option& opt);
+
     virtual int forward(const Mat& bottom_blob, Mat& top_blob,
                         const Option& opt) const;
 
+    virtual int forward_batch(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs,
+                              const Option& opt) const;
+
 protected:
     int forward_fp16(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+    int forward_bf16s(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
 
 public:
     ncnn::Layer* flatten;
 
     // fp16 weight data
     Mat weight_data_fp16;
+
+    // bf16 weight data
+    Mat weight_data_bf16;
 };
 
 } // namespace ncnn
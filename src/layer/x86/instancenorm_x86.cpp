@@ -0,0 +1,179 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#if __AVX__
+#include "avx_usability.h"
+#include "x86_usability.h"
+#endif // __AVX__
+
+#include "instancenorm_x86.h"
+
+#include <math.h>
+
+namespace ncnn {
+
+InstanceNorm_x86::InstanceNorm_x86()
+{
+#if __AVX__
+    support_packing = true;
+#endif // __AVX__
+}
+
+int InstanceNorm_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+#if __AVX__
+    int dims = bottom_top_blob.dims;
+    int elempack = bottom_top_blob.elempack;
+
+    if (dims != 3)
+    {
+        if (elempack == 1)
+            return InstanceNorm::forward_inplace(bottom_top_blob, opt);
+
+        return forward_inplace_unpacked<InstanceNorm>(this, bottom_top_blob, opt);
+    }
+
+    // x = (x - mean) / (sqrt(var + eps)) * gamma + beta
+
+    int w = bottom_top_blob.w;
+    int h = bottom_top_blob.h;
+    int c = bottom_top_blob.c;
+    int size = w * h;
+
+    if (elempack == 8)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < c; q++)
+        {
+            float* ptr = bottom_top_blob.channel(q);
+
+            // mean and var of every lane in one sweep, shifted by the first element
+            __m256 _pivot = _mm256_loadu_ps(ptr);
+            __m256 _sum = _mm256_setzero_ps();
+            __m256 _sqsum = _mm256_setzero_ps();
+            for (int i = 0; i < size; i++)
+            {
+                __m256 _p = _mm256_sub_ps(_mm256_loadu_ps(ptr + i * 8), _pivot);
+                _sum = _mm256_add_ps(_sum, _p);
+                _sqsum = _mm256_fmadd_ps(_p, _p, _sqsum);
+            }
+
+            __m256 _size_inv = _mm256_set1_ps(1.f / size);
+            __m256 _mean_shifted = _mm256_mul_ps(_sum, _size_inv);
+            __m256 _mean = _mm256_add_ps(_pivot, _mean_shifted);
+            __m256 _var = _mm256_fnmadd_ps(_mean_shifted, _mean_shifted, _mm256_mul_ps(_sqsum, _size_inv));
+            // the var maybe minus due to accuracy
+            _var = _mm256_max_ps(_var, _mm256_setzero_ps());
+
+            __m256 _a = _mm256_div_ps(_mm256_set1_ps(1.f), _mm256_sqrt_ps(_mm256_add_ps(_var, _mm256_set1_ps(eps))));
+            __m256 _b;
+            if (affine)
+            {
+                __m256 _gamma = _mm256_loadu_ps((const float*)gamma_data + q * 8);
+                __m256 _beta = _mm256_loadu_ps((const float*)beta_data + q * 8);
+
+                _a = _mm256_mul_ps(_a, _gamma);
+                _b = _mm256_fnmadd_ps(_mean, _a, _beta);
+            }
+            else
+            {
+                _b = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_mul_ps(_mean, _a));
+            }
+
+            for (int i = 0; i < size; i++)
+            {
+                __m256 _p = _mm256_loadu_ps(ptr);
+                _p = _mm256_fmadd_ps(_p, _a, _b);
+                _mm256_storeu_ps(ptr, _p);
+
+                ptr += 8;
+            }
+        }
+
+        return 0;
+    }
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int q = 0; q < c; q++)
+    {
+        float* ptr = bottom_top_blob.channel(q);
+
+        // mean and var in one sweep, shifted by the first element
+        const float pivot = ptr[0];
+        __m256 _pivot = _mm256_set1_ps(pivot);
+        __m256 _sum = _mm256_setzero_ps();
+        __m256 _sqsum = _mm256_setzero_ps();
+        float sum = 0.f;
+        float sqsum = 0.f;
+
+        int i = 0;
+        for (; i + 7 < size; i += 8)
+        {
+            __m256 _p = _mm256_sub_ps(_mm256_loadu_ps(ptr + i), _pivot);
+            _sum = _mm256_add_ps(_sum, _p);
+            _sqsum = _mm256_fmadd_ps(_p, _p, _sqsum);
+        }
+        for (; i < size; i++)
+        {
+            float v = ptr[i] - pivot;
+            sum += v;
+            sqsum += v * v;
+        }
+        sum += _mm256_reduce_add_ps(_sum);
+        sqsum += _mm256_reduce_add_ps(_sqsum);
+
+        float mean_shifted = sum / size;
+        float mean = pivot + mean_shifted;
+        // the var maybe minus due to accuracy
+        float var = std::max(sqsum / size - mean_shifted * mean_shifted, 0.f);
+
+        float a;
+        float b;
+        if (affine)
+        {
+            float gamma = gamma_data[q];
+            float beta = beta_data[q];
+
+            a = static_cast<float>(gamma / (sqrt(var + eps)));
+            b = -mean * a + beta;
+        }
+        else
+        {
+            a = static_cast<float>(1.f / (sqrt(var + eps)));
+            b = -mean * a;
+        }
+
+        __m256 _a = _mm256_set1_ps(a);
+        __m256 _b = _mm256_set1_ps(b);
+
+        i = 0;
+        for (; i + 7 < size; i += 8)
+        {
+            __m256 _p = _mm256_loadu_ps(ptr + i);
+            _p = _mm256_fmadd_ps(_p, _a, _b);
+            _mm256_storeu_ps(ptr + i, _p);
+        }
+        for (; i < size; i++)
+        {
+            ptr[i] = ptr[i] * a + b;
+        }
+    }
+
+    return 0;
+#else
+    return InstanceNorm::forward_inplace(bottom_top_blob, opt);
+#endif // __AVX__
+}
+
+} // namespace ncnn
@@ -0,0 +1,148 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+static void resize_bicubic_row_pack8(const float* S, float* rows, const float* alpha, const int* xofs, int w)
+{
+    for (int dx = 0; dx < w; dx++)
+    {
+        const float* Sp = S + xofs[dx] * 8;
+
+        __m256 _a0 = _mm256_broadcast_ss(alpha);
+        __m256 _a1 = _mm256_broadcast_ss(alpha + 1);
+        __m256 _a2 = _mm256_broadcast_ss(alpha + 2);
+        __m256 _a3 = _mm256_broadcast_ss(alpha + 3);
+
+        __m256 _S0 = _mm256_loadu_ps(Sp - 8);
+        __m256 _S1 = _mm256_loadu_ps(Sp);
+        __m256 _S2 = _mm256_loadu_ps(Sp + 8);
+        __m256 _S3 = _mm256_loadu_ps(Sp + 16);
+        __m256 _rows = _mm256_mul_ps(_S0, _a0);
+        _rows = _mm256_fmadd_ps(_S1, _a1, _rows);
+        _rows = _mm256_fmadd_ps(_S2, _a2, _rows);
+        _rows = _mm256_fmadd_ps(_S3, _a3, _rows);
+        _mm256_storeu_ps(rows + dx * 8, _rows);
+
+        alpha += 4;
+    }
+}
+
+static void resize_bicubic_image_pack8(const Mat& src, Mat& dst, const float* alpha, const int* xofs, const float* beta, const int* yofs)
+{
+    int w = dst.w;
+    int h = dst.h;
+
+    // loop body
+    Mat rowsbuf0(w, (size_t)4 * 8u, 8);
+    Mat rowsbuf1(w, (size_t)4 * 8u, 8);
+    Mat rowsbuf2(w, (size_t)4 * 8u, 8);
+    Mat rowsbuf3(w, (size_t)4 * 8u, 8);
+    float* rows0 = rowsbuf0;
+    float* rows1 = rowsbuf1;
+    float* rows2 = rowsbuf2;
+    float* rows3 = rowsbuf3;
+
+    int prev_sy1 = -3;
+
+    for (int dy = 0; dy < h; dy++)
+    {
+        int sy = yofs[dy];
+
+        if (sy == prev_sy1)
+        {
+            // reuse all rows
+        }
+        else if (sy == prev_sy1 + 1)
+        {
+            // hresize one row
+            float* rows0_old = rows0;
+            rows0 = rows1;
+            rows1 = rows2;
+            rows2 = rows3;
+            rows3 = rows0_old;
+
+            resize_bicubic_row_pack8(src.row(sy + 2), rows3, alpha, xofs, w);
+        }
+        else if (sy == prev_sy1 + 2)
+        {
+            // hresize two rows
+            float* rows0_old = rows0;
+            float* rows1_old = rows1;
+            rows0 = rows2;
+            rows1 = rows3;
+            rows2 = rows0_old;
+            rows3 = rows1_old;
+
+            resize_bicubic_row_pack8(src.row(sy + 1), rows2, alpha, xofs, w);
+            resize_bicubic_row_pack8(src.row(sy + 2), rows3, alpha, xofs, w);
+        }
+        else if (sy == prev_sy1 + 3)
+        {
+            // hresize three rows
+            float* rows0_old = rows0;
+            float* rows1_old = rows1;
+            float* rows2_old = rows2;
+            rows0 = rows3;
+            rows1 = rows0_old;
+            rows2 = rows1_old;
+            rows3 = rows2_old;
+
+            resize_bicubic_row_pack8(src.row(sy), rows1, alpha, xofs, w);
+            resize_bicubic_row_pack8(src.row(sy + 1), rows2, alpha, xofs, w);
+            resize_bicubic_row_pack8(src.row(sy + 2), rows3, alpha, xofs, w);
+        }
+        else
+        {
+            // hresize four rows
+            resize_bicubic_row_pack8(src.row(sy - 1), rows0, alpha, xofs, w);
+            resize_bicubic_row_pack8(src.row(sy), rows1, alpha, xofs, w);
+            resize_bicubic_row_pack8(src.row(sy + 1), rows2, alpha, xofs, w);
+            resize_bicubic_row_pack8(src.row(sy + 2), rows3, alpha, xofs, w);
+        }
+
+        prev_sy1 = sy;
+
+        // vresize
+        __m256 _b0 = _mm256_broadcast_ss(beta);
+        __m256 _b1 = _mm256_broadcast_ss(beta + 1);
+        __m256 _b2 = _mm256_broadcast_ss(beta + 2);
+        __m256 _b3 = _mm256_broadcast_ss(beta + 3);
+
+        const float* rows0p = rows0;
+        const float* rows1p = rows1;
+        const float* rows2p = rows2;
+        const float* rows3p = rows3;
+        float* Dp = dst.row(dy);
+
+        for (int dx = 0; dx < w; dx++)
+        {
+            __m256 _rows0 = _mm256_loadu_ps(rows0p);
+            __m256 _rows1 = _mm256_loadu_ps(rows1p);
+            __m256 _rows2 = _mm256_loadu_ps(rows2p);
+            __m256 _rows3 = _mm256_loadu_ps(rows3p);
+            __m256 _D = _mm256_mul_ps(_rows0, _b0);
+            _D = _mm256_fmadd_ps(_rows1, _b1, _D);
+            _D = _mm256_fmadd_ps(_rows2, _b2, _D);
+            _D = _mm256_fmadd_ps(_rows3, _b3, _D);
+            _mm256_storeu_ps(Dp, _D);
+
+            Dp += 8;
+            rows0p += 8;
+            rows1p += 8;
+            rows2p += 8;
+            rows3p += 8;
+        }
+
+        beta += 4;
+    }
+}
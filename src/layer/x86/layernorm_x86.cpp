@@ -0,0 +1,155 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#if __AVX__
+#include "avx_usability.h"
+#include "x86_usability.h"
+#endif // __AVX__
+
+#include "layernorm_x86.h"
+
+#include <math.h>
+
+namespace ncnn {
+
+LayerNorm_x86::LayerNorm_x86()
+{
+#if __AVX__
+    support_packing = true;
+#endif // __AVX__
+}
+
+int LayerNorm_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+#if __AVX__
+    int dims = bottom_top_blob.dims;
+    int elempack = bottom_top_blob.elempack;
+
+    if (dims != 3)
+    {
+        if (elempack == 1)
+            return LayerNorm::forward_inplace(bottom_top_blob, opt);
+
+        return forward_inplace_unpacked<LayerNorm>(this, bottom_top_blob, opt);
+    }
+
+    // x = (x - mean) / sqrt(var + eps) * gamma + beta
+
+    int w = bottom_top_blob.w;
+    int h = bottom_top_blob.h;
+    int c = bottom_top_blob.c;
+    int size = w * h * elempack;
+
+    // sum and squared sum in one sweep, reduced per channel then across channels
+    // both are taken around the first element so a large common offset does not cancel
+    Mat stat(2, c, 4u, opt.workspace_allocator);
+    if (stat.empty())
+        return -100;
+
+    const float pivot = ((const float*)bottom_top_blob.channel(0))[0];
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int q = 0; q < c; q++)
+    {
+        const float* ptr = bottom_top_blob.channel(q);
+
+        __m256 _pivot = _mm256_set1_ps(pivot);
+        __m256 _sum = _mm256_setzero_ps();
+        __m256 _sqsum = _mm256_setzero_ps();
+        float sum = 0.f;
+        float sqsum = 0.f;
+
+        int i = 0;
+        for (; i + 7 < size; i += 8)
+        {
+            __m256 _p = _mm256_sub_ps(_mm256_loadu_ps(ptr + i), _pivot);
+            _sum = _mm256_add_ps(_sum, _p);
+            _sqsum = _mm256_fmadd_ps(_p, _p, _sqsum);
+        }
+        for (; i < size; i++)
+        {
+            float v = ptr[i] - pivot;
+            sum += v;
+            sqsum += v * v;
+        }
+
+        float* statptr = stat.row(q);
+        statptr[0] = sum + _mm256_reduce_add_ps(_sum);
+        statptr[1] = sqsum + _mm256_reduce_add_ps(_sqsum);
+    }
+
+    float sum = 0.f;
+    float sqsum = 0.f;
+    for (int q = 0; q < c; q++)
+    {
+        const float* statptr = stat.row(q);
+        sum += statptr[0];
+        sqsum += statptr[1];
+    }
+
+    float mean_shifted = sum / (c * size);
+    float mean = pivot + mean_shifted;
+    // the var maybe minus due to accuracy
+    float var = std::max(sqsum / (c * size) - mean_shifted * mean_shifted, 0.f);
+    float inv_std = static_cast<float>(1.f / sqrt(var + eps));
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int q = 0; q < c; q++)
+    {
+        float* ptr = bottom_top_blob.channel(q);
+
+        if (elempack == 8)
+        {
+            __m256 _gamma = _mm256_loadu_ps((const float*)gamma_data + q * 8);
+            __m256 _beta = _mm256_loadu_ps((const float*)beta_data + q * 8);
+
+            __m256 _a = _mm256_mul_ps(_gamma, _mm256_set1_ps(inv_std));
+            __m256 _b = _mm256_fnmadd_ps(_mm256_set1_ps(mean), _a, _beta);
+
+            for (int i = 0; i < size; i += 8)
+            {
+                __m256 _p = _mm256_loadu_ps(ptr + i);
+                _p = _mm256_fmadd_ps(_p, _a, _b);
+                _mm256_storeu_ps(ptr + i, _p);
+            }
+
+            continue;
+        }
+
+        float a = gamma_data[q] * inv_std;
+        float b = -mean * a + beta_data[q];
+
+        __m256 _a = _mm256_set1_ps(a);
+        __m256 _b = _mm256_set1_ps(b);
+
+        int i = 0;
+        for (; i + 7 < size; i += 8)
+        {
+            __m256 _p = _mm256_loadu_ps(ptr + i);
+            _p = _mm256_fmadd_ps(_p, _a, _b);
+            _mm256_storeu_ps(ptr + i, _p);
+        }
+        for (; i < size; i++)
+        {
+            ptr[i] = ptr[i] * a + b;
+        }
+    }
+
+    return 0;
+#else
+    return LayerNorm::forward_inplace(bottom_top_blob, opt);
+#endif // __AVX__
+}
+
+} // namespace ncnn
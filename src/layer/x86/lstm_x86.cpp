@@ -23,10 +23,15 @@
 
 namespace ncnn {
 
+#if __AVX__
+#include "sgemm_avx.h"
+#endif // __AVX__
+
 LSTM_x86::LSTM_x86()
 {
 #ifdef __AVX__
     support_weight_fp16_storage = true;
+    support_batch = true;
 #endif
     one_blob_only = false;
     support_inplace = false;
@@ -46,851 +51,413 @@ int LSTM_x86::create_pipeline(const Option& opt)
 
     return 0;
 }
-#ifdef __AVX__
 
-static int lstm_fp16(const Mat& bottom_blob, Mat& top_blob, int reverse, const Mat& weight_xc, const Mat& bias_c, const Mat& weight_hc, Mat& hidden_state, Mat& cell_state, const Option& opt)
+#if __AVX__
+// accumulate 4 gate rows dot 1 vector
+template<typename Tw>
+static inline void lstm_dot4_avx(const Tw* w0, const Tw* w1, const Tw* w2, const Tw* w3, const float* a0, int n, float* sums0)
+{
+    __m256 _sum00 = _mm256_setzero_ps();
+    __m256 _sum01 = _mm256_setzero_ps();
+    __m256 _sum02 = _mm256_setzero_ps();
+    __m256 _sum03 = _mm256_setzero_ps();
+
+    int i = 0;
+    for (; i + 7 < n; i += 8)
+    {
+        __m256 _a0 = _mm256_loadu_ps(a0 + i);
+
+        _sum00 = _mm256_fmadd_ps(sgemm_load8_avx(w0 + i), _a0, _sum00);
+        _sum01 = _mm256_fmadd_ps(sgemm_load8_avx(w1 + i), _a0, _sum01);
+        _sum02 = _mm256_fmadd_ps(sgemm_load8_avx(w2 + i), _a0, _sum02);
+        _sum03 = _mm256_fmadd_ps(sgemm_load8_avx(w3 + i), _a0, _sum03);
+    }
+
+    _mm_storeu_ps(sums0, _mm_add_ps(_mm_loadu_ps(sums0), HorizontalSums(_sum00, _sum01, _sum02, _sum03)));
+
+    for (; i < n; i++)
+    {
+        sums0[0] += sgemm_load1_avx(w0 + i) * a0[i];
+        sums0[1] += sgemm_load1_avx(w1 + i) * a0[i];
+        sums0[2] += sgemm_load1_avx(w2 + i) * a0[i];
+        sums0[3] += sgemm_load1_avx(w3 + i) * a0[i];
+    }
+}
+
+// accumulate 4 gate rows dot 2 vectors
+static inline void lstm_batch_dot2(const float* w0, const float* w1, const float* w2, const float* w3, const float* a0, const float* a1, int n, float* sums0, float* sums1)
+{
+    __m256 _sum00 = _mm256_setzero_ps();
+    __m256 _sum01 = _mm256_setzero_ps();
+    __m256 _sum02 = _mm256_setzero_ps();
+    __m256 _sum03 = _mm256_setzero_ps();
+    __m256 _sum10 = _mm256_setzero_ps();
+    __m256 _sum11 = _mm256_setzero_ps();
+    __m256 _sum12 = _mm256_setzero_ps();
+    __m256 _sum13 = _mm256_setzero_ps();
+
+    int i = 0;
+    for (; i + 7 < n; i += 8)
+    {
+        __m256 _a0 = _mm256_loadu_ps(a0 + i);
+        __m256 _a1 = _mm256_loadu_ps(a1 + i);
+
+        __m256 _w0 = _mm256_loadu_ps(w0 + i);
+        __m256 _w1 = _mm256_loadu_ps(w1 + i);
+        __m256 _w2 = _mm256_loadu_ps(w2 + i);
+        __m256 _w3 = _mm256_loadu_ps(w3 + i);
+
+        _sum00 = _mm256_fmadd_ps(_w0, _a0, _sum00);
+        _sum01 = _mm256_fmadd_ps(_w1, _a0, _sum01);
+        _sum02 = _mm256_fmadd_ps(_w2, _a0, _sum02);
+        _sum03 = _mm256_fmadd_ps(_w3, _a0, _sum03);
+        _sum10 = _mm256_fmadd_ps(_w0, _a1, _sum10);
+        _sum11 = _mm256_fmadd_ps(_w1, _a1, _sum11);
+        _sum12 = _mm256_fmadd_ps(_w2, _a1, _sum12);
+        _sum13 = _mm256_fmadd_ps(_w3, _a1, _sum13);
+    }
+
+    _mm_storeu_ps(sums0, _mm_add_ps(_mm_loadu_ps(sums0), HorizontalSums(_sum00, _sum01, _sum02, _sum03)));
+    _mm_storeu_ps(sums1, _mm_add_ps(_mm_loadu_ps(sums1), HorizontalSums(_sum10, _sum11, _sum12, _sum13)));
+
+    for (; i < n; i++)
+    {
+        sums0[0] += w0[i] * a0[i];
+        sums0[1] += w1[i] * a0[i];
+        sums0[2] += w2[i] * a0[i];
+        sums0[3] += w3[i] * a0[i];
+        sums1[0] += w0[i] * a1[i];
+        sums1[1] += w1[i] * a1[i];
+        sums1[2] += w2[i] * a1[i];
+        sums1[3] += w3[i] * a1[i];
+    }
+}
+
+// c_t := f_t .* c_{t-1} + i_t .* g_t
+// h_t := o_t .* tanh[c_t]
+static void lstm_unit_avx(const float* gates_data, float* cell_ptr, float* hidden_ptr, float* output_data, int num_output)
+{
+    const float* gates_data_I = gates_data;
+    const float* gates_data_F = gates_data + num_output;
+    const float* gates_data_O = gates_data + num_output * 2;
+    const float* gates_data_G = gates_data + num_output * 3;
+
+    int q = 0;
+    for (; q + 7 < num_output; q += 8)
+    {
+        __m256 I = sigmoid_avx(_mm256_loadu_ps(gates_data_I + q));
+        __m256 F = sigmoid_avx(_mm256_loadu_ps(gates_data_F + q));
+        __m256 O = sigmoid_avx(_mm256_loadu_ps(gates_data_O + q));
+        __m256 G = tanh_avx(_mm256_loadu_ps(gates_data_G + q));
+        __m256 cell2 = _mm256_add_ps(_mm256_mul_ps(F, _mm256_loadu_ps(cell_ptr + q)), _mm256_mul_ps(I, G));
+        __m256 H = _mm256_mul_ps(O, tanh_avx(cell2));
+        _mm256_storeu_ps(cell_ptr + q, cell2);
+        _mm256_storeu_ps(hidden_ptr + q, H);
+        _mm256_storeu_ps(output_data + q, H);
+    }
+    for (; q < num_output; q++)
+    {
+        float I = 1.f / (1.f + exp(-gates_data_I[q]));
+        float F = 1.f / (1.f + exp(-gates_data_F[q]));
+        float O = 1.f / (1.f + exp(-gates_data_O[q]));
+        float G = tanh(gates_data_G[q]);
+        float cell2 = F * cell_ptr[q] + I * G;
+        float H = O * tanh(cell2);
+        cell_ptr[q] = cell2;
+        hidden_ptr[q] = H;
+        output_data[q] = H;
+    }
+}
+
+// W_xc * x_t does not depend on the hidden state, so the input projection
+// of all timesteps runs as one sgemm up front, only W_hc * h_{t-1} stays in the time loop
+// direction 2 steps the forward and reverse recurrences together, one parallel loop covers both
+// hidden_state and cell_state hold one row per direction
+// output of direction d is written to top_blob starting at column num_output * d
+template<typename Tw>
+static int lstm_avx(const Mat& bottom_blob, Mat& top_blob, int direction, const Mat& weight_xc_data, const Mat& bias_c_data, const Mat& weight_hc_data, Mat& hidden_state, Mat& cell_state, const Option& opt)
 {
     int size = bottom_blob.w;
     int T = bottom_blob.h;
 
-    int num_output = top_blob.w;
-    // fprintf(stderr, "bottom_blob = %d x %d x %d num_output = %d \n", bottom_blob.w,bottom_blob.h,bottom_blob.c,num_output);
-    // 4 x num_output
-    Mat gates(num_output, 4, 4u, opt.workspace_allocator);
+    int num_output = hidden_state.w;
+    int num_directions = direction == 2 ? 2 : 1;
+
+    // I F O G gate inputs of each timestep
+    Mat gates(num_output * 4, T, num_directions, 4u, opt.workspace_allocator);
     if (gates.empty())
         return -100;
+
+    // gate_input_t := W_xc * x_t
+    for (int d = 0; d < num_directions; d++)
+    {
+        Mat gates_d = gates.channel(d);
+
+        int ret = sgemm_avx(T, num_output * 4, size, (const float*)bottom_blob, size, 1, (const Tw*)weight_xc_data.channel(d), 1, weight_xc_data.w, (float*)gates_d, num_output * 4, opt);
+        if (ret != 0)
+            return ret;
+    }
+
     // unroll
     for (int t = 0; t < T; t++)
     {
-        // clip hidden by continuation indicator
-        // h_cont_{t-1} = cont_t * h_{t-1}
-        // h_cont_{t-1} = h_{t-1} if cont_t == 1
-        //                0       otherwise
-        // calculate hidden
-        // gate_input_t := W_hc * h_conted_{t-1} + W_xc * x_t + b_c
-        int ti = reverse ? T - 1 - t : t;
-        int remain_output = (num_output >> 1) << 1;
-        for (int q = 0; q + 1 < num_output; q += 2)
+        // gate_input_t += W_hc * h_{t-1} + b_c
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int i = 0; i < num_directions * num_output; i++)
         {
-            const float* x = bottom_blob.row(ti);
-            const float* hidden_ptr_r = hidden_state;
-            const float* bias_c_I = bias_c.row(0);
-            const float* bias_c_F = bias_c.row(1);
-            const float* bias_c_O = bias_c.row(2);
-            const float* bias_c_G = bias_c.row(3);
-
-            float* gates_data_I = gates.row(0);
-            float* gates_data_F = gates.row(1);
-            float* gates_data_O = gates.row(2);
-            float* gates_data_G = gates.row(3);
-            // gate I F O G
-            const unsigned short* weight_xc_I_0 = (const unsigned short*)weight_xc.row(num_output * 0 + q);
-            const unsigned short* weight_xc_F_0 = (const unsigned short*)weight_xc.row(num_output * 1 + q);
-            const unsigned short* weight_xc_O_0 = (const unsigned short*)weight_xc.row(num_output * 2 + q);
-            const unsigned short* weight_xc_G_0 = (const unsigned short*)weight_xc.row(num_output * 3 + q);
-            const unsigned short* weight_xc_I_1 = (const unsigned short*)weight_xc.row(num_output * 0 + (q + 1));
-            const unsigned short* weight_xc_F_1 = (const unsigned short*)weight_xc.row(num_output * 1 + (q + 1));
-            const unsigned short* weight_xc_O_1 = (const unsigned short*)weight_xc.row(num_output * 2 + (q + 1));
-            const unsigned short* weight_xc_G_1 = (const unsigned short*)weight_xc.row(num_output * 3 + (q + 1));
-
-            const unsigned short* weight_hc_I_0 = (const unsigned short*)weight_hc.row(num_output * 0 + q);
-            const unsigned short* weight_hc_F_0 = (const unsigned short*)weight_hc.row(num_output * 1 + q);
-            const unsigned short* weight_hc_O_0 = (const unsigned short*)weight_hc.row(num_output * 2 + q);
-            const unsigned short* weight_hc_G_0 = (const unsigned short*)weight_hc.row(num_output * 3 + q);
-            const unsigned short* weight_hc_I_1 = (const unsigned short*)weight_hc.row(num_output * 0 + (q + 1));
-            const unsigned short* weight_hc_F_1 = (const unsigned short*)weight_hc.row(num_output * 1 + (q + 1));
-            const unsigned short* weight_hc_O_1 = (const unsigned short*)weight_hc.row(num_output * 2 + (q + 1));
-            const unsigned short* weight_hc_G_1 = (const unsigned short*)weight_hc.row(num_output * 3 + (q + 1));
-
-            // float I = bias_c_I[q];
-            // float F = bias_c_F[q];
-            // float O = bias_c_O[q];
-            // float G = bias_c_G[q];
-            __m256 _sumI_0 = _mm256_setzero_ps();
-            __m256 _sumF_0 = _mm256_setzero_ps();
-            __m256 _sumO_0 = _mm256_setzero_ps();
-            __m256 _sumG_0 = _mm256_setzero_ps();
-            __m256 _sumI_1 = _mm256_setzero_ps();
-            __m256 _sumF_1 = _mm256_setzero_ps();
-            __m256 _sumO_1 = _mm256_setzero_ps();
-            __m256 _sumG_1 = _mm256_setzero_ps();
-            int nn_num_size = size >> 3;
-            int remain_size = size & 7;
-            for (; nn_num_size > 0; nn_num_size--)
-            {
-                __m256 xi = _mm256_loadu_ps(x);
-                _sumI_0 = _mm256_fmadd_ps(loadfp16(weight_xc_I_0), xi, _sumI_0);
-                _sumF_0 = _mm256_fmadd_ps(loadfp16(weight_xc_F_0), xi, _sumF_0);
-                _sumO_0 = _mm256_fmadd_ps(loadfp16(weight_xc_O_0), xi, _sumO_0);
-                _sumG_0 = _mm256_fmadd_ps(loadfp16(weight_xc_G_0), xi, _sumG_0);
-                _sumI_1 = _mm256_fmadd_ps(loadfp16(weight_xc_I_1), xi, _sumI_1);
-                _sumF_1 = _mm256_fmadd_ps(loadfp16(weight_xc_F_1), xi, _sumF_1);
-                _sumO_1 = _mm256_fmadd_ps(loadfp16(weight_xc_O_1), xi, _sumO_1);
-                _sumG_1 = _mm256_fmadd_ps(loadfp16(weight_xc_G_1), xi, _sumG_1);
-                x += 8;
-                weight_xc_I_0 += 8;
-                weight_xc_F_0 += 8;
-                weight_xc_O_0 += 8;
-                weight_xc_G_0 += 8;
-                weight_xc_I_1 += 8;
-                weight_xc_F_1 += 8;
-                weight_xc_O_1 += 8;
-                weight_xc_G_1 += 8;
-            }
-            int nn_num_output = num_output >> 3;
-            int remain_num_output = num_output & 7;
-            for (; nn_num_output > 0; nn_num_output--)
-            {
-                __m256 h_cont = _mm256_loadu_ps(hidden_ptr_r);
-
-                _sumI_0 = _mm256_fmadd_ps(loadfp16(weight_hc_I_0), h_cont, _sumI_0);
-                _sumF_0 = _mm256_fmadd_ps(loadfp16(weight_hc_F_0), h_cont, _sumF_0);
-                _sumO_0 = _mm256_fmadd_ps(loadfp16(weight_hc_O_0), h_cont, _sumO_0);
-                _sumG_0 = _mm256_fmadd_ps(loadfp16(weight_hc_G_0), h_cont, _sumG_0);
-                _sumI_1 = _mm256_fmadd_ps(loadfp16(weight_hc_I_1), h_cont, _sumI_1);
-                _sumF_1 = _mm256_fmadd_ps(loadfp16(weight_hc_F_1), h_cont, _sumF_1);
-                _sumO_1 = _mm256_fmadd_ps(loadfp16(weight_hc_O_1), h_cont, _sumO_1);
-                _sumG_1 = _mm256_fmadd_ps(loadfp16(weight_hc_G_1), h_cont, _sumG_1);
-                hidden_ptr_r += 8;
-                weight_hc_I_0 += 8;
-                weight_hc_F_0 += 8;
-                weight_hc_O_0 += 8;
-                weight_hc_G_0 += 8;
-                weight_hc_I_1 += 8;
-                weight_hc_F_1 += 8;
-                weight_hc_O_1 += 8;
-                weight_hc_G_1 += 8;
-            }
-            if (remain_size != 0)
-            {
-                unsigned short fp16_weights[8][8] = {{0}};
-                float _xi_f[8] = {0};
-                // No fast way to convert to fp32 one element at the time
-                // so batch an 8 lane vector.
-                for (int i = 0; i < remain_size; i++)
-                {
-                    _xi_f[i] = *x;
-                    fp16_weights[0][i] = *weight_xc_I_0;
-                    fp16_weights[1][i] = *weight_xc_F_0;
-                    fp16_weights[2][i] = *weight_xc_O_0;
-                    fp16_weights[3][i] = *weight_xc_G_0;
-                    fp16_weights[4][i] = *weight_xc_I_1;
-                    fp16_weights[5][i] = *weight_xc_F_1;
-                    fp16_weights[6][i] = *weight_xc_O_1;
-                    fp16_weights[7][i] = *weight_xc_G_1;
-                    x++;
-                    weight_xc_I_0++;
-                    weight_xc_F_0++;
-                    weight_xc_O_0++;
-                    weight_xc_G_0++;
-                    weight_xc_I_1++;
-                    weight_xc_F_1++;
-                    weight_xc_O_1++;
-                    weight_xc_G_1++;
-                }
-                __m256 xi = _mm256_loadu_ps(_xi_f);
-                _sumI_0 = _mm256_fmadd_ps(loadfp16(fp16_weights[0]), xi, _sumI_0);
-                _sumF_0 = _mm256_fmadd_ps(loadfp16(fp16_weights[1]), xi, _sumF_0);
-                _sumO_0 = _mm256_fmadd_ps(loadfp16(fp16_weights[2]), xi, _sumO_0);
-                _sumG_0 = _mm256_fmadd_ps(loadfp16(fp16_weights[3]), xi, _sumG_0);
-                _sumI_1 = _mm256_fmadd_ps(loadfp16(fp16_weights[4]), xi, _sumI_1);
-                _sumF_1 = _mm256_fmadd_ps(loadfp16(fp16_weights[5]), xi, _sumF_1);
-                _sumO_1 = _mm256_fmadd_ps(loadfp16(fp16_weights[6]), xi, _sumO_1);
-                _sumG_1 = _mm256_fmadd_ps(loadfp16(fp16_weights[7]), xi, _sumG_1);
-            }
-            if (remain_num_output != 0)
-            {
-                unsigned short fp16_weights[8][8] = {{0}};
-                float _hcont_f[8] = {0};
-                // No fast way to convert to fp32 one element at the time
-                // so batch an 8 lane vector.
-                for (int i = 0; i < remain_num_output; i++)
-                {
-                    _hcont_f[i] = *hidden_ptr_r;
-                    fp16_weights[0][i] = *weight_hc_I_0;
-                    fp16_weights[1][i] = *weight_hc_F_0;
-                    fp16_weights[2][i] = *weight_hc_O_0;
-                    fp16_weights[3][i] = *weight_hc_G_0;
-                    fp16_weights[4][i] = *weight_hc_I_1;
-                    fp16_weights[5][i] = *weight_hc_F_1;
-                    fp16_weights[6][i] = *weight_hc_O_1;
-                    fp16_weights[7][i] = *weight_hc_G_1;
-                    hidden_ptr_r++;
-                    weight_hc_I_0++;
-                    weight_hc_F_0++;
-                    weight_hc_O_0++;
-                    weight_hc_G_0++;
-                    weight_hc_I_1++;
-                    weight_hc_F_1++;
-                    weight_hc_O_1++;
-                    weight_hc_G_1++;
-                }
-                __m256 h_cont = _mm256_loadu_ps(_hcont_f);
-                _sumI_0 = _mm256_fmadd_ps(loadfp16(fp16_weights[0]), h_cont, _sumI_0);
-                _sumF_0 = _mm256_fmadd_ps(loadfp16(fp16_weights[1]), h_cont, _sumF_0);
-                _sumO_0 = _mm256_fmadd_ps(loadfp16(fp16_weights[2]), h_cont, _sumO_0);
-                _sumG_0 = _mm256_fmadd_ps(loadfp16(fp16_weights[3]), h_cont, _sumG_0);
-                _sumI_1 = _mm256_fmadd_ps(loadfp16(fp16_weights[4]), h_cont, _sumI_1);
-                _sumF_1 = _mm256_fmadd_ps(loadfp16(fp16_weights[5]), h_cont, _sumF_1);
-                _sumO_1 = _mm256_fmadd_ps(loadfp16(fp16_weights[6]), h_cont, _sumO_1);
-                _sumG_1 = _mm256_fmadd_ps(loadfp16(fp16_weights[7]), h_cont, _sumG_1);
-            }
-            float sums[8];
-            _mm256_storeu_ps(sums, HorizontalSums(_sumI_0, _sumF_0, _sumO_0, _sumG_0, _sumI_1, _sumF_1, _sumO_1, _sumG_1));
-            sums[0] += bias_c_I[q];
-            sums[1] += bias_c_F[q];
-            sums[2] += bias_c_O[q];
-            sums[3] += bias_c_G[q];
-            sums[4] += bias_c_I[q + 1];
-            sums[5] += bias_c_F[q + 1];
-            sums[6] += bias_c_O[q + 1];
-            sums[7] += bias_c_G[q + 1];
-            gates_data_I[q] = sums[0];
-            gates_data_F[q] = sums[1];
-            gates_data_O[q] = sums[2];
-            gates_data_G[q] = sums[3];
-            gates_data_I[q + 1] = sums[4];
-            gates_data_F[q + 1] = sums[5];
-            gates_data_O[q + 1] = sums[6];
-            gates_data_G[q + 1] = sums[7];
-        }
+            const int d = i / num_output;
+            const int q = i % num_output;
+
+            const int reverse = direction == 2 ? d : direction;
+            const int ti = reverse ? T - 1 - t : t;
+
+            const Mat bias_c = bias_c_data.channel(d);
+            const Tw* weight_hc = (const Tw*)weight_hc_data.channel(d);
 
-        for (int q = remain_output; q < num_output; q++)
-        {
-            const float* x = bottom_blob.row(ti);
-            const float* hidden_ptr_r = hidden_state;
-            const float* bias_c_I = bias_c.row(0);
-            const float* bias_c_F = bias_c.row(1);
-            const float* bias_c_O = bias_c.row(2);
-            const float* bias_c_G = bias_c.row(3);
-
-            float* gates_data_I = gates.row(0);
-            float* gates_data_F = gates.row(1);
-            float* gates_data_O = gates.row(2);
-            float* gates_data_G = gates.row(3);
             // gate I F O G
-            const unsigned short* weight_xc_I = (const unsigned short*)weight_xc.row(num_output * 0 + q);
-            const unsigned short* weight_xc_F = (const unsigned short*)weight_xc.row(num_output * 1 + q);
-            const unsigned short* weight_xc_O = (const unsigned short*)weight_xc.row(num_output * 2 + q);
-            const unsigned short* weight_xc_G = (const unsigned short*)weight_xc.row(num_output * 3 + q);
-
-            const unsigned short* weight_hc_I = (const unsigned short*)weight_hc.row(num_output * 0 + q);
-            const unsigned short* weight_hc_F = (const unsigned short*)weight_hc.row(num_output * 1 + q);
-            const unsigned short* weight_hc_O = (const unsigned short*)weight_hc.row(num_output * 2 + q);
-            const unsigned short* weight_hc_G = (const unsigned short*)weight_hc.row(num_output * 3 + q);
-
-            // float I = bias_c_I[q];
-            // float F = bias_c_F[q];
-            // float O = bias_c_O[q];
-            // float G = bias_c_G[q];
-            __m256 _sumI = _mm256_setzero_ps();
-            __m256 _sumF = _mm256_setzero_ps();
-            __m256 _sumO = _mm256_setzero_ps();
-            __m256 _sumG = _mm256_setzero_ps();
-            int nn_num_size = size >> 3;
-            int remain_size = size & 7;
-            for (; nn_num_size > 0; nn_num_size--)
-            {
-                __m256 xi = _mm256_loadu_ps(x);
-                _sumI = _mm256_fmadd_ps(loadfp16(weight_xc_I), xi, _sumI);
-                _sumF = _mm256_fmadd_ps(loadfp16(weight_xc_F), xi, _sumF);
-                _sumO = _mm256_fmadd_ps(loadfp16(weight_xc_O), xi, _sumO);
-                _sumG = _mm256_fmadd_ps(loadfp16(weight_xc_G), xi, _sumG);
-                x += 8;
-                weight_xc_I += 8;
-                weight_xc_F += 8;
-                weight_xc_O += 8;
-                weight_xc_G += 8;
-            }
-            int nn_num_output = num_output >> 3;
-            int remain_num_output = num_output & 7;
-            for (; nn_num_output > 0; nn_num_output--)
-            {
-                __m256 h_cont = _mm256_loadu_ps(hidden_ptr_r);
-
-                _sumI = _mm256_fmadd_ps(loadfp16(weight_hc_I), h_cont, _sumI);
-                _sumF = _mm256_fmadd_ps(loadfp16(weight_hc_F), h_cont, _sumF);
-                _sumO = _mm256_fmadd_ps(loadfp16(weight_hc_O), h_cont, _sumO);
-                _sumG = _mm256_fmadd_ps(loadfp16(weight_hc_G), h_cont, _sumG);
-                hidden_ptr_r += 8;
-                weight_hc_I += 8;
-                weight_hc_F += 8;
-                weight_hc_O += 8;
-                weight_hc_G += 8;
-            }
-            if (remain_size != 0)
-            {
-                unsigned short fp16_weights[4][8] = {{0}};
-                float _xi_f[8] = {0};
-                // No fast way to convert to fp32 one element at the time
-                // so batch an 8 lane vector.
-                for (int i = 0; i < remain_size; i++)
-                {
-                    _xi_f[i] = *x;
-                    fp16_weights[0][i] = *weight_xc_I;
-                    fp16_weights[1][i] = *weight_xc_F;
-                    fp16_weights[2][i] = *weight_xc_O;
-                    fp16_weights[3][i] = *weight_xc_G;
-                    x++;
-                    weight_xc_I++;
-                    weight_xc_F++;
-                    weight_xc_O++;
-                    weight_xc_G++;
-                }
-                __m256 xi = _mm256_loadu_ps(_xi_f);
-                _sumI = _mm256_fmadd_ps(loadfp16(fp16_weights[0]), xi, _sumI);
-                _sumF = _mm256_fmadd_ps(loadfp16(fp16_weights[1]), xi, _sumF);
-                _sumO = _mm256_fmadd_ps(loadfp16(fp16_weights[2]), xi, _sumO);
-                _sumG = _mm256_fmadd_ps(loadfp16(fp16_weights[3]), xi, _sumG);
-            }
-            if (remain_num_output != 0)
-            {
-                unsigned short fp16_weights[4][8] = {{0}};
-                float _hcont_f[8] = {0};
-                // No fast way to convert to fp32 one element at the time
-                // so batch an 8 lane vector.
-                for (int i = 0; i < remain_num_output; i++)
-                {
-                    _hcont_f[i] = *hidden_ptr_r;
-                    fp16_weights[0][i] = *weight_hc_I;
-                    fp16_weights[1][i] = *weight_hc_F;
-                    fp16_weights[2][i] = *weight_hc_O;
-                    fp16_weights[3][i] = *weight_hc_G;
-                    hidden_ptr_r++;
-                    weight_hc_I++;
-                    weight_hc_F++;
-                    weight_hc_O++;
-                    weight_hc_G++;
-                }
-                __m256 h_cont = _mm256_loadu_ps(_hcont_f);
-                _sumI = _mm256_fmadd_ps(loadfp16(fp16_weights[0]), h_cont, _sumI);
-                _sumF = _mm256_fmadd_ps(loadfp16(fp16_weights[1]), h_cont, _sumF);
-                _sumO = _mm256_fmadd_ps(loadfp16(fp16_weights[2]), h_cont, _sumO);
-                _sumG = _mm256_fmadd_ps(loadfp16(fp16_weights[3]), h_cont, _sumG);
-            }
+            const Tw* weight_hc_I = weight_hc + (size_t)(num_output * 0 + q) * num_output;
+            const Tw* weight_hc_F = weight_hc + (size_t)(num_output * 1 + q) * num_output;
+            const Tw* weight_hc_O = weight_hc + (size_t)(num_output * 2 + q) * num_output;
+            const Tw* weight_hc_G = weight_hc + (size_t)(num_output * 3 + q) * num_output;
+
+            float* gates_data = gates.channel(d).row(ti);
 
             float sums[4];
-            _mm_storeu_ps(sums, HorizontalSums(_sumI, _sumF, _sumO, _sumG));
-            sums[0] += bias_c_I[q];
-            sums[1] += bias_c_F[q];
-            sums[2] += bias_c_O[q];
-            sums[3] += bias_c_G[q];
-            gates_data_I[q] = sums[0];
-            gates_data_F[q] = sums[1];
-            gates_data_O[q] = sums[2];
-            gates_data_G[q] = sums[3];
+            sums[0] = gates_data[num_output * 0 + q] + bias_c.row(0)[q];
+            sums[1] = gates_data[num_output * 1 + q] + bias_c.row(1)[q];
+            sums[2] = gates_data[num_output * 2 + q] + bias_c.row(2)[q];
+            sums[3] = gates_data[num_output * 3 + q] + bias_c.row(3)[q];
+
+            lstm_dot4_avx(weight_hc_I, weight_hc_F, weight_hc_O, weight_hc_G, hidden_state.row(d), num_output, sums);
+
+            gates_data[num_output * 0 + q] = sums[0];
+            gates_data[num_output * 1 + q] = sums[1];
+            gates_data[num_output * 2 + q] = sums[2];
+            gates_data[num_output * 3 + q] = sums[3];
         }
 
         // lstm unit
-        // sigmoid(I)
-        // sigmoid(F)
-        // sigmoid(O)
-        // tanh(G)
-        // c_t := f_t .* c_{t-1} + i_t .* g_t
-        // h_t := o_t .* tanh[c_t]
-        float* output_data = top_blob.row(ti);
-        float* cell_ptr = cell_state;
-        float* hidden_ptr = hidden_state;
-        const float* gates_data_I = gates.row(0);
-        const float* gates_data_F = gates.row(1);
-        const float* gates_data_O = gates.row(2);
-        const float* gates_data_G = gates.row(3);
-        int nn_activation = num_output >> 3;
-        int remain_activations = num_output & 7;
-        for (; nn_activation > 0; nn_activation--)
-        {
-            __m256 I = sigmoid_avx(_mm256_loadu_ps(gates_data_I));
-            __m256 F = sigmoid_avx(_mm256_loadu_ps(gates_data_F));
-            __m256 O = sigmoid_avx(_mm256_loadu_ps(gates_data_O));
-            __m256 G = tanh_avx(_mm256_loadu_ps(gates_data_G));
-            __m256 cell2 = _mm256_add_ps(_mm256_mul_ps(F, _mm256_loadu_ps(cell_ptr)), _mm256_mul_ps(I, G));
-            __m256 H = _mm256_mul_ps(O, tanh_avx(cell2));
-            _mm256_storeu_ps(cell_ptr, cell2);
-            _mm256_storeu_ps(hidden_ptr, H);
-            _mm256_storeu_ps(output_data, H);
-            cell_ptr += 8;
-            output_data += 8;
-            hidden_ptr += 8;
-            gates_data_I += 8;
-            gates_data_F += 8;
-            gates_data_O += 8;
-            gates_data_G += 8;
-        }
-        for (; remain_activations > 0; remain_activations--)
+        for (int d = 0; d < num_directions; d++)
         {
-            float I = *gates_data_I;
-            float F = *gates_data_F;
-            float O = *gates_data_O;
-            float G = *gates_data_G;
-
-            I = 1.f / (1.f + exp(-I));
-            F = 1.f / (1.f + exp(-F));
-            O = 1.f / (1.f + exp(-O));
-            G = tanh(G);
-            float cell2 = F * *cell_ptr + I * G;
-            float H = O * tanh(cell2);
-            *cell_ptr = cell2;
-            *hidden_ptr = H;
-            *output_data = H;
-            cell_ptr++;
-            output_data++;
-            hidden_ptr++;
-            gates_data_I++;
-            gates_data_F++;
-            gates_data_O++;
-            gates_data_G++;
-        }
+            const int reverse = direction == 2 ? d : direction;
+            const int ti = reverse ? T - 1 - t : t;
 
-        // no cell output here
+            lstm_unit_avx(gates.channel(d).row(ti), cell_state.row(d), hidden_state.row(d), top_blob.row(ti) + num_output * d, num_output);
+        }
     }
 
     return 0;
 }
 
-static int lstm(const Mat& bottom_blob, Mat& top_blob, int reverse, const Mat& weight_xc, const Mat& bias_c, const Mat& weight_hc, Mat& hidden_state, Mat& cell_state, const Option& opt)
+// unroll all batch items together, so that weight rows are loaded once per 2 batch items
+// the input projection of each batch item runs as one sgemm up front
+// hidden_state and cell_state hold one row per batch item
+// output of batch item b is written to top_blobs[b] starting at column out_offset
+static int lstm_batch(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, int reverse, int out_offset, const Mat& weight_xc, const Mat& bias_c, const Mat& weight_hc, Mat& hidden_state, Mat& cell_state, const Option& opt)
 {
-    int size = bottom_blob.w;
-    int T = bottom_blob.h;
+    const int batch = (int)bottom_blobs.size();
+
+    int size = bottom_blobs[0].w;
+    int T = bottom_blobs[0].h;
 
-    int num_output = top_blob.w;
+    int num_output = hidden_state.w;
 
-    // 4 x num_output
-    Mat gates(num_output, 4, 4u, opt.workspace_allocator);
+    // I F O G gate inputs of each timestep for each batch item
+    Mat gates(num_output * 4, T, batch, 4u, opt.workspace_allocator);
     if (gates.empty())
         return -100;
 
+    // gate_input_t := W_xc * x_t
+    for (int b = 0; b < batch; b++)
+    {
+        Mat gates_b = gates.channel(b);
+
+        int ret = sgemm_avx(T, num_output * 4, size, (const float*)bottom_blobs[b], size, 1, (const float*)weight_xc, 1, weight_xc.w, (float*)gates_b, num_output * 4, opt);
+        if (ret != 0)
+            return ret;
+    }
+
+    const float* bias_c_I = bias_c.row(0);
+    const float* bias_c_F = bias_c.row(1);
+    const float* bias_c_O = bias_c.row(2);
+    const float* bias_c_G = bias_c.row(3);
+
     // unroll
     for (int t = 0; t < T; t++)
     {
-        // clip hidden by continuation indicator
-        // h_cont_{t-1} = cont_t * h_{t-1}
-        // h_cont_{t-1} = h_{t-1} if cont_t == 1
-        //                0       otherwise
-        // calculate hidden
-        // gate_input_t := W_hc * h_conted_{t-1} + W_xc * x_t + b_c
-
         int ti = reverse ? T - 1 - t : t;
-        int remain_output = (num_output >> 1) << 1;
-        for (int q = 0; q + 1 < num_output; q += 2)
-        {
-            const float* x = bottom_blob.row(ti);
-            const float* hidden_ptr_r = hidden_state;
-            const float* bias_c_I = bias_c.row(0);
-            const float* bias_c_F = bias_c.row(1);
-            const float* bias_c_O = bias_c.row(2);
-            const float* bias_c_G = bias_c.row(3);
-
-            float* gates_data_I = gates.row(0);
-            float* gates_data_F = gates.row(1);
-            float* gates_data_O = gates.row(2);
-            float* gates_data_G = gates.row(3);
-            // gate I F O G
-            const float* weight_xc_I_0 = weight_xc.row(num_output * 0 + q);
-            const float* weight_xc_F_0 = weight_xc.row(num_output * 1 + q);
-            const float* weight_xc_O_0 = weight_xc.row(num_output * 2 + q);
-            const float* weight_xc_G_0 = weight_xc.row(num_output * 3 + q);
-            const float* weight_xc_I_1 = weight_xc.row(num_output * 0 + (q + 1));
-            const float* weight_xc_F_1 = weight_xc.row(num_output * 1 + (q + 1));
-            const float* weight_xc_O_1 = weight_xc.row(num_output * 2 + (q + 1));
-            const float* weight_xc_G_1 = weight_xc.row(num_output * 3 + (q + 1));
-
-            const float* weight_hc_I_0 = weight_hc.row(num_output * 0 + q);
-            const float* weight_hc_F_0 = weight_hc.row(num_output * 1 + q);
-            const float* weight_hc_O_0 = weight_hc.row(num_output * 2 + q);
-            const float* weight_hc_G_0 = weight_hc.row(num_output * 3 + q);
-            const float* weight_hc_I_1 = weight_hc.row(num_output * 0 + (q + 1));
-            const float* weight_hc_F_1 = weight_hc.row(num_output * 1 + (q + 1));
-            const float* weight_hc_O_1 = weight_hc.row(num_output * 2 + (q + 1));
-            const float* weight_hc_G_1 = weight_hc.row(num_output * 3 + (q + 1));
-
-            // float I = bias_c_I[q];
-            // float F = bias_c_F[q];
-            // float O = bias_c_O[q];
-            // float G = bias_c_G[q];
-            __m256 _sumI_0 = _mm256_setzero_ps();
-            __m256 _sumF_0 = _mm256_setzero_ps();
-            __m256 _sumO_0 = _mm256_setzero_ps();
-            __m256 _sumG_0 = _mm256_setzero_ps();
-            __m256 _sumI_1 = _mm256_setzero_ps();
-            __m256 _sumF_1 = _mm256_setzero_ps();
-            __m256 _sumO_1 = _mm256_setzero_ps();
-            __m256 _sumG_1 = _mm256_setzero_ps();
-            int nn_num_size = size >> 3;
-            int remain_size = size & 7;
-            for (; nn_num_size > 0; nn_num_size--)
-            {
-                __m256 xi = _mm256_loadu_ps(x);
-                _sumI_0 = _mm256_fmadd_ps(_mm256_loadu_ps(weight_xc_I_0), xi, _sumI_0);
-                _sumF_0 = _mm256_fmadd_ps(_mm256_loadu_ps(weight_xc_F_0), xi, _sumF_0);
-                _sumO_0 = _mm256_fmadd_ps(_mm256_loadu_ps(weight_xc_O_0), xi, _sumO_0);
-                _sumG_0 = _mm256_fmadd_ps(_mm256_loadu_ps(weight_xc_G_0), xi, _sumG_0);
-                _sumI_1 = _mm256_fmadd_ps(_mm256_loadu_ps(weight_xc_I_1), xi, _sumI_1);
-                _sumF_1 = _mm256_fmadd_ps(_mm256_loadu_ps(weight_xc_F_1), xi, _sumF_1);
-                _sumO_1 = _mm256_fmadd_ps(_mm256_loadu_ps(weight_xc_O_1), xi, _sumO_1);
-                _sumG_1 = _mm256_fmadd_ps(_mm256_loadu_ps(weight_xc_G_1), xi, _sumG_1);
-                x += 8;
-                weight_xc_I_0 += 8;
-                weight_xc_F_0 += 8;
-                weight_xc_O_0 += 8;
-                weight_xc_G_0 += 8;
-                weight_xc_I_1 += 8;
-                weight_xc_F_1 += 8;
-                weight_xc_O_1 += 8;
-                weight_xc_G_1 += 8;
-            }
-            int nn_num_output = num_output >> 3;
-            int remain_num_output = num_output & 7;
-            for (; nn_num_output > 0; nn_num_output--)
-            {
-                __m256 h_cont = _mm256_loadu_ps(hidden_ptr_r);
-
-                _sumI_0 = _mm256_fmadd_ps(_mm256_loadu_ps(weight_hc_I_0), h_cont, _sumI_0);
-                _sumF_0 = _mm256_fmadd_ps(_mm256_loadu_ps(weight_hc_F_0), h_cont, _sumF_0);
-                _sumO_0 = _mm256_fmadd_ps(_mm256_loadu_ps(weight_hc_O_0), h_cont, _sumO_0);
-                _sumG_0 = _mm256_fmadd_ps(_mm256_loadu_ps(weight_hc_G_0), h_cont, _sumG_0);
-                _sumI_1 = _mm256_fmadd_ps(_mm256_loadu_ps(weight_hc_I_1), h_cont, _sumI_1);
-                _sumF_1 = _mm256_fmadd_ps(_mm256_loadu_ps(weight_hc_F_1), h_cont, _sumF_1);
-                _sumO_1 = _mm256_fmadd_ps(_mm256_loadu_ps(weight_hc_O_1), h_cont, _sumO_1);
-                _sumG_1 = _mm256_fmadd_ps(_mm256_loadu_ps(weight_hc_G_1), h_cont, _sumG_1);
-                hidden_ptr_r += 8;
-                weight_hc_I_0 += 8;
-                weight_hc_F_0 += 8;
-                weight_hc_O_0 += 8;
-                weight_hc_G_0 += 8;
-                weight_hc_I_1 += 8;
-                weight_hc_F_1 += 8;
-                weight_hc_O_1 += 8;
-                weight_hc_G_1 += 8;
-            }
-            float sums[8];
-            _mm256_storeu_ps(sums, HorizontalSums(_sumI_0, _sumF_0, _sumO_0, _sumG_0, _sumI_1, _sumF_1, _sumO_1, _sumG_1));
-            sums[0] += bias_c_I[q];
-            sums[1] += bias_c_F[q];
-            sums[2] += bias_c_O[q];
-            sums[3] += bias_c_G[q];
-            sums[4] += bias_c_I[q + 1];
-            sums[5] += bias_c_F[q + 1];
-            sums[6] += bias_c_O[q + 1];
-            sums[7] += bias_c_G[q + 1];
-
-            for (; remain_size > 0; remain_size--)
-            {
-                float xi = *x;
-                sums[0] += *weight_xc_I_0 * xi;
-                sums[1] += *weight_xc_F_0 * xi;
-                sums[2] += *weight_xc_O_0 * xi;
-                sums[3] += *weight_xc_G_0 * xi;
-                sums[4] += *weight_xc_I_1 * xi;
-                sums[5] += *weight_xc_F_1 * xi;
-                sums[6] += *weight_xc_O_1 * xi;
-                sums[7] += *weight_xc_G_1 * xi;
-                x++;
-                weight_xc_I_0++;
-                weight_xc_F_0++;
-                weight_xc_O_0++;
-                weight_xc_G_0++;
-                weight_xc_I_1++;
-                weight_xc_F_1++;
-                weight_xc_O_1++;
-                weight_xc_G_1++;
-            }
 
-            for (; remain_num_output > 0; remain_num_output--)
-            {
-                float h_cont = *hidden_ptr_r;
-                sums[0] += *weight_hc_I_0 * h_cont;
-                sums[1] += *weight_hc_F_0 * h_cont;
-                sums[2] += *weight_hc_O_0 * h_cont;
-                sums[3] += *weight_hc_G_0 * h_cont;
-                sums[4] += *weight_hc_I_1 * h_cont;
-                sums[5] += *weight_hc_F_1 * h_cont;
-                sums[6] += *weight_hc_O_1 * h_cont;
-                sums[7] += *weight_hc_G_1 * h_cont;
-                hidden_ptr_r++;
-                weight_hc_I_0++;
-                weight_hc_F_0++;
-                weight_hc_O_0++;
-                weight_hc_G_0++;
-                weight_hc_I_1++;
-                weight_hc_F_1++;
-                weight_hc_O_1++;
-                weight_hc_G_1++;
-            }
-            gates_data_I[q] = sums[0];
-            gates_data_F[q] = sums[1];
-            gates_data_O[q] = sums[2];
-            gates_data_G[q] = sums[3];
-            gates_data_I[q + 1] = sums[4];
-            gates_data_F[q + 1] = sums[5];
-            gates_data_O[q + 1] = sums[6];
-            gates_data_G[q + 1] = sums[7];
-        }
-
-        for (int q = remain_output; q < num_output; q++)
+        // gate_input_t += W_hc * h_{t-1} + b_c
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < num_output; q++)
         {
-            const float* x = bottom_blob.row(ti);
-            const float* hidden_ptr_r = hidden_state;
-            const float* bias_c_I = bias_c.row(0);
-            const float* bias_c_F = bias_c.row(1);
-            const float* bias_c_O = bias_c.row(2);
-            const float* bias_c_G = bias_c.row(3);
-
-            float* gates_data_I = gates.row(0);
-            float* gates_data_F = gates.row(1);
-            float* gates_data_O = gates.row(2);
-            float* gates_data_G = gates.row(3);
             // gate I F O G
-            const float* weight_xc_I = weight_xc.row(num_output * 0 + q);
-            const float* weight_xc_F = weight_xc.row(num_output * 1 + q);
-            const float* weight_xc_O = weight_xc.row(num_output * 2 + q);
-            const float* weight_xc_G = weight_xc.row(num_output * 3 + q);
-
             const float* weight_hc_I = weight_hc.row(num_output * 0 + q);
             const float* weight_hc_F = weight_hc.row(num_output * 1 + q);
             const float* weight_hc_O = weight_hc.row(num_output * 2 + q);
             const float* weight_hc_G = weight_hc.row(num_output * 3 + q);
 
-            // float I = bias_c_I[q];
-            // float F = bias_c_F[q];
-            // float O = bias_c_O[q];
-            // float G = bias_c_G[q];
-            __m256 _sumI = _mm256_setzero_ps();
-            __m256 _sumF = _mm256_setzero_ps();
-            __m256 _sumO = _mm256_setzero_ps();
-            __m256 _sumG = _mm256_setzero_ps();
-            int nn_num_size = size >> 3;
-            int remain_size = size & 7;
-            for (; nn_num_size > 0; nn_num_size--)
+            int b = 0;
+            for (; b + 1 < batch; b += 2)
             {
-                __m256 xi = _mm256_loadu_ps(x);
-                _sumI = _mm256_fmadd_ps(_mm256_loadu_ps(weight_xc_I), xi, _sumI);
-                _sumF = _mm256_fmadd_ps(_mm256_loadu_ps(weight_xc_F), xi, _sumF);
-                _sumO = _mm256_fmadd_ps(_mm256_loadu_ps(weight_xc_O), xi, _sumO);
-                _sumG = _mm256_fmadd_ps(_mm256_loadu_ps(weight_xc_G), xi, _sumG);
-                x += 8;
-                weight_xc_I += 8;
-                weight_xc_F += 8;
-                weight_xc_O += 8;
-                weight_xc_G += 8;
+                float* gates0 = gates.channel(b).row(ti);
+                float* gates1 = gates.channel(b + 1).row(ti);
+
+                float sums0[4] = {gates0[q] + bias_c_I[q], gates0[num_output + q] + bias_c_F[q], gates0[num_output * 2 + q] + bias_c_O[q], gates0[num_output * 3 + q] + bias_c_G[q]};
+                float sums1[4] = {gates1[q] + bias_c_I[q], gates1[num_output + q] + bias_c_F[q], gates1[num_output * 2 + q] + bias_c_O[q], gates1[num_output * 3 + q] + bias_c_G[q]};
+
+                lstm_batch_dot2(weight_hc_I, weight_hc_F, weight_hc_O, weight_hc_G, hidden_state.row(b), hidden_state.row(b + 1), num_output, sums0, sums1);
+
+                for (int k = 0; k < 4; k++)
+                {
+                    gates0[num_output * k + q] = sums0[k];
+                    gates1[num_output * k + q] = sums1[k];
+                }
             }
-            int nn_num_output = num_output >> 3;
-            int remain_num_output = num_output & 7;
-            for (; nn_num_output > 0; nn_num_output--)
+            for (; b < batch; b++)
             {
-                __m256 h_cont = _mm256_loadu_ps(hidden_ptr_r);
-
-                _sumI = _mm256_fmadd_ps(_mm256_loadu_ps(weight_hc_I), h_cont, _sumI);
-                _sumF = _mm256_fmadd_ps(_mm256_loadu_ps(weight_hc_F), h_cont, _sumF);
-                _sumO = _mm256_fmadd_ps(_mm256_loadu_ps(weight_hc_O), h_cont, _sumO);
-                _sumG = _mm256_fmadd_ps(_mm256_loadu_ps(weight_hc_G), h_cont, _sumG);
-                hidden_ptr_r += 8;
-                weight_hc_I += 8;
-                weight_hc_F += 8;
-                weight_hc_O += 8;
-                weight_hc_G += 8;
-            }
-            float sums[4];
-            _mm_storeu_ps(sums, HorizontalSums(_sumI, _sumF, _sumO, _sumG));
-            sums[0] += bias_c_I[q];
-            sums[1] += bias_c_F[q];
-            sums[2] += bias_c_O[q];
-            sums[3] += bias_c_G[q];
+                float* gates0 = gates.channel(b).row(ti);
 
-            for (; remain_size > 0; remain_size--)
-            {
-                float xi = *x;
-                sums[0] += *weight_xc_I * xi;
-                sums[1] += *weight_xc_F * xi;
-                sums[2] += *weight_xc_O * xi;
-                sums[3] += *weight_xc_G * xi;
-                x++;
-                weight_xc_I++;
-                weight_xc_F++;
-                weight_xc_O++;
-                weight_xc_G++;
-            }
+                float sums0[4] = {gates0[q] + bias_c_I[q], gates0[num_output + q] + bias_c_F[q], gates0[num_output * 2 + q] + bias_c_O[q], gates0[num_output * 3 + q] + bias_c_G[q]};
 
-            for (; remain_num_output > 0; remain_num_output--)
-            {
-                float h_cont = *hidden_ptr_r;
-                sums[0] += *weight_hc_I * h_cont;
-                sums[1] += *weight_hc_F * h_cont;
-                sums[2] += *weight_hc_O * h_cont;
-                sums[3] += *weight_hc_G * h_cont;
-                hidden_ptr_r++;
-                weight_hc_I++;
-                weight_hc_F++;
-                weight_hc_O++;
-                weight_hc_G++;
+                lstm_dot4_avx(weight_hc_I, weight_hc_F, weight_hc_O, weight_hc_G, hidden_state.row(b), num_output, sums0);
+
+                for (int k = 0; k < 4; k++)
+                {
+                    gates0[num_output * k + q] = sums0[k];
+                }
             }
-            gates_data_I[q] = sums[0];
-            gates_data_F[q] = sums[1];
-            gates_data_O[q] = sums[2];
-            gates_data_G[q] = sums[3];
         }
 
         // lstm unit
-        // sigmoid(I)
-        // sigmoid(F)
-        // sigmoid(O)
-        // tanh(G)
-        // c_t := f_t .* c_{t-1} + i_t .* g_t
-        // h_t := o_t .* tanh[c_t]
-        float* output_data = top_blob.row(ti);
-        float* cell_ptr = cell_state;
-        float* hidden_ptr = hidden_state;
-        const float* gates_data_I = gates.row(0);
-        const float* gates_data_F = gates.row(1);
-        const float* gates_data_O = gates.row(2);
-        const float* gates_data_G = gates.row(3);
-        int nn_activation = num_output >> 3;
-        int remain_activations = num_output & 7;
-        for (; nn_activation > 0; nn_activation--)
-        {
-            __m256 I = sigmoid_avx(_mm256_loadu_ps(gates_data_I));
-            __m256 F = sigmoid_avx(_mm256_loadu_ps(gates_data_F));
-            __m256 O = sigmoid_avx(_mm256_loadu_ps(gates_data_O));
-            __m256 G = tanh_avx(_mm256_loadu_ps(gates_data_G));
-            __m256 cell2 = _mm256_add_ps(_mm256_mul_ps(F, _mm256_loadu_ps(cell_ptr)), _mm256_mul_ps(I, G));
-            __m256 H = _mm256_mul_ps(O, tanh_avx(cell2));
-            _mm256_storeu_ps(cell_ptr, cell2);
-            _mm256_storeu_ps(hidden_ptr, H);
-            _mm256_storeu_ps(output_data, H);
-            cell_ptr += 8;
-            output_data += 8;
-            hidden_ptr += 8;
-            gates_data_I += 8;
-            gates_data_F += 8;
-            gates_data_O += 8;
-            gates_data_G += 8;
-        }
-        for (; remain_activations > 0; remain_activations--)
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int b = 0; b < batch; b++)
         {
-            float I = *gates_data_I;
-            float F = *gates_data_F;
-            float O = *gates_data_O;
-            float G = *gates_data_G;
-
-            I = 1.f / (1.f + exp(-I));
-            F = 1.f / (1.f + exp(-F));
-            O = 1.f / (1.f + exp(-O));
-            G = tanh(G);
-            float cell2 = F * *cell_ptr + I * G;
-            float H = O * tanh(cell2);
-            *cell_ptr = cell2;
-            *hidden_ptr = H;
-            *output_data = H;
-            cell_ptr++;
-            output_data++;
-            hidden_ptr++;
-            gates_data_I++;
-            gates_data_F++;
-            gates_data_O++;
-            gates_data_G++;
+            lstm_unit_avx(gates.channel(b).row(ti), cell_state.row(b), hidden_state.row(b), top_blobs[b].row(ti) + out_offset, num_output);
         }
-
-        // no cell output here
     }
 
     return 0;
 }
-#endif
+#endif // __AVX__
 
-int LSTM_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+int LSTM_x86::forward_batch(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
 {
+    const int batch = (int)bottom_blobs.size();
+
 #if __AVX__
-    int T = bottom_blob.h;
+    if (batch == 1 || opt.use_weight_fp16_storage)
+    {
+        return Layer::forward_batch(bottom_blobs, top_blobs, opt);
+    }
+
+    int T = bottom_blobs[0].h;
     int num_directions = direction == 2 ? 2 : 1;
 
-    // initial hidden state
-    Mat hidden(num_output, 4u, opt.workspace_allocator);
+    // hidden and cell state of all batch items
+    Mat hidden(num_output, batch, 4u, opt.workspace_allocator);
     if (hidden.empty())
         return -100;
     hidden.fill(0.f);
-    // internal cell state
-    Mat cell(num_output, 4u, opt.workspace_allocator);
+
+    Mat cell(num_output, batch, 4u, opt.workspace_allocator);
     if (cell.empty())
         return -100;
     cell.fill(0.f);
 
-    top_blob.create(num_output * num_directions, T, 4u, opt.blob_allocator);
-    if (top_blob.empty())
-        return -100;
+    top_blobs.resize(batch);
+    for (int b = 0; b < batch; b++)
+    {
+        top_blobs[b].create(num_output * num_directions, T, 4u, opt.blob_allocator);
+        if (top_blobs[b].empty())
+            return -100;
+    }
 
     // Uni directional
     if (direction == 0 || direction == 1)
     {
-        if (opt.use_weight_fp16_storage)
-        {
-            // Uni directional
-            int ret = lstm_fp16(bottom_blob, top_blob, direction, weight_xc_data_fp16.channel(0), bias_c_data.channel(0), weight_hc_data_fp16.channel(0), hidden, cell, opt);
-            if (ret != 0)
-                return ret;
-        }
-        else
-        {
-            // Uni directional
-            int ret = lstm(bottom_blob, top_blob, direction, weight_xc_data.channel(0), bias_c_data.channel(0), weight_hc_data.channel(0), hidden, cell, opt);
-            if (ret != 0)
-                return ret;
-        }
+        int ret = lstm_batch(bottom_blobs, top_blobs, direction, 0, weight_xc_data.channel(0), bias_c_data.channel(0), weight_hc_data.channel(0), hidden, cell, opt);
+        if (ret != 0)
+            return ret;
     }
 
     if (direction == 2)
     {
-        Mat top_blob_forward(num_output, T, 4u, opt.workspace_allocator);
-        if (top_blob_forward.empty())
-            return -100;
+        // forward and reverse write to the two halves of each output row
+        int ret0 = lstm_batch(bottom_blobs, top_blobs, 0, 0, weight_xc_data.channel(0), bias_c_data.channel(0), weight_hc_data.channel(0), hidden, cell, opt);
+        if (ret0 != 0)
+            return ret0;
 
-        Mat top_blob_reverse(num_output, T, 4u, opt.workspace_allocator);
-        if (top_blob_reverse.empty())
-            return -100;
+        hidden.fill(0.f);
+        cell.fill(0.f);
 
-        if (opt.use_weight_fp16_storage)
-        {
-            // Uni directional
-            int ret0 = lstm_fp16(bottom_blob, top_blob_forward, 0, weight_xc_data_fp16.channel(0), bias_c_data.channel(0), weight_hc_data_fp16.channel(0), hidden, cell, opt);
-            if (ret0 != 0)
-                return ret0;
-        }
-        else
-        {
-            // Uni directional
-            int ret0 = lstm(bottom_blob, top_blob_forward, 0, weight_xc_data.channel(0), bias_c_data.channel(0), weight_hc_data.channel(0), hidden, cell, opt);
-            if (ret0 != 0)
-                return ret0;
-        }
+        int ret1 = lstm_batch(bottom_blobs, top_blobs, 1, num_output, weight_xc_data.channel(1), bias_c_data.channel(1), weight_hc_data.channel(1), hidden, cell, opt);
+        if (ret1 != 0)
+            return ret1;
+    }
 
-        hidden.fill(0.0f);
-        cell.fill(0.0f);
-        if (opt.use_weight_fp16_storage)
-        {
-            // Uni directional
-            int ret1 = lstm_fp16(bottom_blob, top_blob_reverse, 1, weight_xc_data_fp16.channel(1), bias_c_data.channel(1), weight_hc_data_fp16.channel(1), hidden, cell, opt);
-            if (ret1 != 0)
-                return ret1;
-        }
-        else
+    return 0;
+#else
+    return Layer::forward_batch(bottom_blobs, top_blobs, opt);
+#endif // __AVX__
+}
+
+int LSTM_x86::forward_batch(const std::vector<std::vector<Mat> >& bottom_blobs_batch, std::vector<std::vector<Mat> >& top_blobs_batch, const Option& opt) const
+{
+    const int batch = (int)bottom_blobs_batch.size();
+
+    // batch items carrying previous states are forwarded one by one
+    std::vector<Mat> bottom_blobs(batch);
+    for (int b = 0; b < batch; b++)
+    {
+        if (bottom_blobs_batch[b].size() != 1 || top_blobs_batch[b].size() != 1)
         {
-            // Uni directional
-            int ret1 = lstm(bottom_blob, top_blob_reverse, 1, weight_xc_data.channel(1), bias_c_data.channel(1), weight_hc_data.channel(1), hidden, cell, opt);
-            if (ret1 != 0)
-                return ret1;
+            return Layer::forward_batch(bottom_blobs_batch, top_blobs_batch, opt);
         }
 
-        // concat w
-        for (int i = 0; i < T; i++)
-        {
-            const float* pf = top_blob_forward.row(i);
-            const float* pr = top_blob_reverse.row(i);
-            float* ptr = top_blob.row(i);
+        bottom_blobs[b] = bottom_blobs_batch[b][0];
+    }
 
-            memcpy(ptr, pf, num_output * sizeof(float));
-            memcpy(ptr + num_output, pr, num_output * sizeof(float));
-        }
+    std::vector<Mat> top_blobs(batch);
+    int ret = forward_batch(bottom_blobs, top_blobs, opt);
+    if (ret != 0)
+        return ret;
+
+    for (int b = 0; b < batch; b++)
+    {
+        top_blobs_batch[b][0] = top_blobs[b];
     }
 
     return 0;
+}
+
+int LSTM_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+#if __AVX__
+    int T = bottom_blob.h;
+    int num_directions = direction == 2 ? 2 : 1;
+
+    // initial hidden state
+    Mat hidden(num_output, num_directions, 4u, opt.workspace_allocator);
+    if (hidden.empty())
+        return -100;
+    hidden.fill(0.f);
+    // internal cell state
+    Mat cell(num_output, num_directions, 4u, opt.workspace_allocator);
+    if (cell.empty())
+        return -100;
+    cell.fill(0.f);
+
+    top_blob.create(num_output * num_directions, T, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    if (opt.use_weight_fp16_storage)
+    {
+        return lstm_avx<unsigned short>(bottom_blob, top_blob, direction, weight_xc_data_fp16, bias_c_data, weight_hc_data_fp16, hidden, cell, opt);
+    }
+
+    return lstm_avx<float>(bottom_blob, top_blob, direction, weight_xc_data, bias_c_data, weight_hc_data, hidden, cell, opt);
 #else
     return LSTM::forward(bottom_blob, top_blob, opt);
 #endif
@@ -903,6 +470,10 @@ int LSTM_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& to
     {
         return forward(bottom_blobs[0], top_blobs[0], opt);
     }
+    if (direction == 2)
+    {
+        return LSTM::forward(bottom_blobs, top_blobs, opt);
+    }
     const Mat& bottom_blob = bottom_blobs[0];
 
     int T = bottom_blob.h;
@@ -918,21 +489,13 @@ int LSTM_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& to
     if (top_blob.empty())
         return -100;
 
+    // Uni directional
     if (opt.use_weight_fp16_storage)
     {
-        // Uni directional
-        int ret = lstm_fp16(bottom_blob, top_blob, direction, weight_xc_data_fp16.channel(0), bias_c_data.channel(0), weight_hc_data_fp16.channel(0), hidden_state, cell_state, opt);
-        if (ret != 0)
-            return ret;
-    }
-    else
-    {
-        // Uni directional
-        int ret = lstm(bottom_blob, top_blob, direction, weight_xc_data.channel(0), bias_c_data.channel(0), weight_hc_data.channel(0), hidden_state, cell_state, opt);
-        if (ret != 0)
-            return ret;
+        return lstm_avx<unsigned short>(bottom_blob, top_blob, direction, weight_xc_data_fp16, bias_c_data, weight_hc_data_fp16, hidden_state, cell_state, opt);
     }
-    return 0;
+
+    return lstm_avx<float>(bottom_blob, top_blob, direction, weight_xc_data, bias_c_data, weight_hc_data, hidden_state, cell_state, opt);
 #else
     return LSTM::forward(bottom_blobs, top_blobs, opt);
 #endif
@@ -30,6 +30,10 @@ public:
 
     virtual int forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
 
+    virtual int forward_batch(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
+
+    virtual int forward_batch(const std::vector<std::vector<Mat> >& bottom_blobs_batch, std::vector<std::vector<Mat> >& top_blobs_batch, const Option& opt) const;
+
 public:
     Mat weight_hc_data_fp16;
     Mat weight_xc_data_fp16;
@@ -26,6 +26,9 @@ Mish_x86::Mish_x86()
 #if __AVX__
     support_packing = true;
 #endif // __AVX__
+#if __AVX512F__
+    support_packing16 = true;
+#endif // __AVX512F__
 }
 
 int Mish_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
@@ -38,6 +41,26 @@ int Mish_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
 #if __AVX__
     int elempack = bottom_top_blob.elempack;
 
+#if __AVX512F__
+    if (elempack == 16)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < channels; q++)
+        {
+            float* ptr = bottom_top_blob.channel(q);
+
+            for (int i = 0; i < size; i++)
+            {
+                __m512 _p = _mm512_loadu_ps(ptr);
+                _mm512_storeu_ps(ptr, mish_avx512(_p));
+                ptr += 16;
+            }
+        }
+
+        return 0;
+    }
+#endif // __AVX512F__
+
     if (elempack == 8)
     {
         #pragma omp parallel for num_threads(opt.num_threads)
@@ -0,0 +1,224 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#if __AVX__
+#include "avx_usability.h"
+#include "x86_usability.h"
+#endif // __AVX__
+
+#include "mvn_x86.h"
+
+#include <math.h>
+
+namespace ncnn {
+
+MVN_x86::MVN_x86()
+{
+#if __AVX__
+    support_packing = true;
+#endif // __AVX__
+}
+
+int MVN_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+#if __AVX__
+    int dims = bottom_blob.dims;
+    int elempack = bottom_blob.elempack;
+
+    if (dims != 3)
+    {
+        if (elempack == 1)
+            return MVN::forward(bottom_blob, top_blob, opt);
+
+        return forward_unpacked<MVN>(this, bottom_blob, top_blob, opt);
+    }
+
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int channels = bottom_blob.c;
+    size_t elemsize = bottom_blob.elemsize;
+    int size = w * h;
+
+    top_blob.create(w, h, channels, elemsize, elempack, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    // sum and squared sum per channel in one sweep, both taken around a pivot
+    // mean of squared deviation is then sqsum / size - shifted mean * shifted mean
+    // the pivot is the first element of the channel, or of the blob when normalizing across channels
+    Mat sum(channels * elempack, 4u, opt.workspace_allocator);
+    if (sum.empty())
+        return -100;
+
+    Mat sqsum(channels * elempack, 4u, opt.workspace_allocator);
+    if (sqsum.empty())
+        return -100;
+
+    Mat pivot(channels * elempack, 4u, opt.workspace_allocator);
+    if (pivot.empty())
+        return -100;
+
+    const float pivot0 = ((const float*)bottom_blob.channel(0))[0];
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int q = 0; q < channels; q++)
+    {
+        const float* ptr = bottom_blob.channel(q);
+
+        __m256 _sum = _mm256_setzero_ps();
+        __m256 _sqsum = _mm256_setzero_ps();
+
+        if (elempack == 8)
+        {
+            __m256 _pivot = across_channels ? _mm256_set1_ps(pivot0) : _mm256_loadu_ps(ptr);
+
+            for (int i = 0; i < size; i++)
+            {
+                __m256 _p = _mm256_sub_ps(_mm256_loadu_ps(ptr), _pivot);
+                _sum = _mm256_add_ps(_sum, _p);
+                _sqsum = _mm256_fmadd_ps(_p, _p, _sqsum);
+
+                ptr += 8;
+            }
+
+            _mm256_storeu_ps((float*)sum + q * 8, _sum);
+            _mm256_storeu_ps((float*)sqsum + q * 8, _sqsum);
+            _mm256_storeu_ps((float*)pivot + q * 8, _pivot);
+
+            continue;
+        }
+
+        const float k = across_channels ? pivot0 : ptr[0];
+        __m256 _pivot = _mm256_set1_ps(k);
+        float s = 0.f;
+        float ss = 0.f;
+
+        int i = 0;
+        for (; i + 7 < size; i += 8)
+        {
+            __m256 _p = _mm256_sub_ps(_mm256_loadu_ps(ptr + i), _pivot);
+            _sum = _mm256_add_ps(_sum, _p);
+            _sqsum = _mm256_fmadd_ps(_p, _p, _sqsum);
+        }
+        for (; i < size; i++)
+        {
+            float v = ptr[i] - k;
+            s += v;
+            ss += v * v;
+        }
+
+        sum[q] = s + _mm256_reduce_add_ps(_sum);
+        sqsum[q] = ss + _mm256_reduce_add_ps(_sqsum);
+        pivot[q] = k;
+    }
+
+    // per channel scale and shift, out = x * a + b
+    Mat a(channels * elempack, 4u, opt.workspace_allocator);
+    if (a.empty())
+        return -100;
+
+    Mat b(channels * elempack, 4u, opt.workspace_allocator);
+    if (b.empty())
+        return -100;
+
+    if (across_channels)
+    {
+        float s = 0.f;
+        float ss = 0.f;
+        for (int q = 0; q < channels * elempack; q++)
+        {
+            s += sum[q];
+            ss += sqsum[q];
+        }
+
+        float mean_shifted = s / (channels * elempack * size);
+        float mean = pivot0 + mean_shifted;
+
+        float norm_var_inv = 1.f;
+        if (normalize_variance)
+        {
+            // the sqmean maybe minus due to accuracy
+            float sqmean = std::max(ss / (channels * elempack * size) - mean_shifted * mean_shifted, 0.f);
+            norm_var_inv = static_cast<float>(1.f / (sqrt(sqmean) + eps));
+        }
+
+        a.fill(norm_var_inv);
+        b.fill(-mean * norm_var_inv);
+    }
+    else
+    {
+        for (int q = 0; q < channels * elempack; q++)
+        {
+            float mean_shifted = sum[q] / size;
+            float mean = pivot[q] + mean_shifted;
+
+            float norm_var_inv = 1.f;
+            if (normalize_variance)
+            {
+                float sqmean = std::max(sqsum[q] / size - mean_shifted * mean_shifted, 0.f);
+                norm_var_inv = static_cast<float>(1.f / (sqrt(sqmean) + eps));
+            }
+
+            a[q] = norm_var_inv;
+            b[q] = -mean * norm_var_inv;
+        }
+    }
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int q = 0; q < channels; q++)
+    {
+        const float* ptr = bottom_blob.channel(q);
+        float* outptr = top_blob.channel(q);
+
+        if (elempack == 8)
+        {
+            __m256 _a = _mm256_loadu_ps((const float*)a + q * 8);
+            __m256 _b = _mm256_loadu_ps((const float*)b + q * 8);
+
+            for (int i = 0; i < size; i++)
+            {
+                __m256 _p = _mm256_loadu_ps(ptr);
+                _p = _mm256_fmadd_ps(_p, _a, _b);
+                _mm256_storeu_ps(outptr, _p);
+
+                ptr += 8;
+                outptr += 8;
+            }
+
+            continue;
+        }
+
+        __m256 _a = _mm256_set1_ps(a[q]);
+        __m256 _b = _mm256_set1_ps(b[q]);
+
+        int i = 0;
+        for (; i + 7 < size; i += 8)
+        {
+            __m256 _p = _mm256_loadu_ps(ptr + i);
+            _p = _mm256_fmadd_ps(_p, _a, _b);
+            _mm256_storeu_ps(outptr + i, _p);
+        }
+        for (; i < size; i++)
+        {
+            outptr[i] = ptr[i] * a[q] + b[q];
+        }
+    }
+
+    return 0;
+#else
+    return MVN::forward(bottom_blob, top_blob, opt);
+#endif // __AVX__
+}
+
+} // namespace ncnn
@@ -22,19 +22,405 @@ namespace ncnn {
 Packing_x86::Packing_x86()
 {
     support_packing = true;
+    support_bf16_storage = true;
 }
 
+#if __AVX__
+static void packing_pack1to8_16bit_avx(const unsigned short* const* r, unsigned short* outptr, int size)
+{
+    int i = 0;
+    for (; i + 7 < size; i += 8)
+    {
+        __m128i _r0 = _mm_loadu_si128((const __m128i*)(r[0] + i));
+        __m128i _r1 = _mm_loadu_si128((const __m128i*)(r[1] + i));
+        __m128i _r2 = _mm_loadu_si128((const __m128i*)(r[2] + i));
+        __m128i _r3 = _mm_loadu_si128((const __m128i*)(r[3] + i));
+        __m128i _r4 = _mm_loadu_si128((const __m128i*)(r[4] + i));
+        __m128i _r5 = _mm_loadu_si128((const __m128i*)(r[5] + i));
+        __m128i _r6 = _mm_loadu_si128((const __m128i*)(r[6] + i));
+        __m128i _r7 = _mm_loadu_si128((const __m128i*)(r[7] + i));
+        transpose8_epi16(_r0, _r1, _r2, _r3, _r4, _r5, _r6, _r7);
+        _mm_storeu_si128((__m128i*)outptr, _r0);
+        _mm_storeu_si128((__m128i*)(outptr + 8), _r1);
+        _mm_storeu_si128((__m128i*)(outptr + 16), _r2);
+        _mm_storeu_si128((__m128i*)(outptr + 24), _r3);
+        _mm_storeu_si128((__m128i*)(outptr + 32), _r4);
+        _mm_storeu_si128((__m128i*)(outptr + 40), _r5);
+        _mm_storeu_si128((__m128i*)(outptr + 48), _r6);
+        _mm_storeu_si128((__m128i*)(outptr + 56), _r7);
+        outptr += 64;
+    }
+    for (; i < size; i++)
+    {
+        for (int k = 0; k < 8; k++)
+        {
+            outptr[k] = r[k][i];
+        }
+
+        outptr += 8;
+    }
+}
+
+static void packing_pack8to1_16bit_avx(const unsigned short* r0, unsigned short* const* outptr, int size)
+{
+    int i = 0;
+    for (; i + 7 < size; i += 8)
+    {
+        __m128i _r0 = _mm_loadu_si128((const __m128i*)r0);
+        __m128i _r1 = _mm_loadu_si128((const __m128i*)(r0 + 8));
+        __m128i _r2 = _mm_loadu_si128((const __m128i*)(r0 + 16));
+        __m128i _r3 = _mm_loadu_si128((const __m128i*)(r0 + 24));
+        __m128i _r4 = _mm_loadu_si128((const __m128i*)(r0 + 32));
+        __m128i _r5 = _mm_loadu_si128((const __m128i*)(r0 + 40));
+        __m128i _r6 = _mm_loadu_si128((const __m128i*)(r0 + 48));
+        __m128i _r7 = _mm_loadu_si128((const __m128i*)(r0 + 56));
+        transpose8_epi16(_r0, _r1, _r2, _r3, _r4, _r5, _r6, _r7);
+        _mm_storeu_si128((__m128i*)(outptr[0] + i), _r0);
+        _mm_storeu_si128((__m128i*)(outptr[1] + i), _r1);
+        _mm_storeu_si128((__m128i*)(outptr[2] + i), _r2);
+        _mm_storeu_si128((__m128i*)(outptr[3] + i), _r3);
+        _mm_storeu_si128((__m128i*)(outptr[4] + i), _r4);
+        _mm_storeu_si128((__m128i*)(outptr[5] + i), _r5);
+        _mm_storeu_si128((__m128i*)(outptr[6] + i), _r6);
+        _mm_storeu_si128((__m128i*)(outptr[7] + i), _r7);
+        r0 += 64;
+    }
+    for (; i < size; i++)
+    {
+        for (int k = 0; k < 8; k++)
+        {
+            outptr[k][i] = r0[k];
+        }
+
+        r0 += 8;
+    }
+}
+
+// 16bit storage pack1 <-> pack8, rows of dims 2 and channels of dims 3 are packed the same way
+static int packing_pack8_16bit_avx(const Mat& bottom_blob, Mat& top_blob, int out_elempack, const Option& opt)
+{
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int channels = bottom_blob.c;
+    int dims = bottom_blob.dims;
+    size_t elemsize = bottom_blob.elemsize;
+    int elempack = bottom_blob.elempack;
+
+    // identity if use_padding not allowed
+    int outer = dims == 1 ? w : dims == 2 ? h : channels;
+    if (outer * elempack % out_elempack != 0)
+    {
+        top_blob = bottom_blob;
+        return 0;
+    }
+
+    size_t out_elemsize = elemsize / elempack * out_elempack;
+
+    if (dims == 1)
+    {
+        top_blob = bottom_blob;
+        top_blob.w = w * elempack / out_elempack;
+        top_blob.cstep = w * elempack / out_elempack;
+        top_blob.elemsize = out_elemsize;
+        top_blob.elempack = out_elempack;
+        return 0;
+    }
+
+    int outer_out = outer * elempack / out_elempack;
+    int size = dims == 2 ? w : w * h;
+
+    if (dims == 2)
+        top_blob.create(w, outer_out, out_elemsize, out_elempack, opt.blob_allocator);
+    else
+        top_blob.create(w, h, outer_out, out_elemsize, out_elempack, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    if (out_elempack == 8)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < outer_out; q++)
+        {
+            const unsigned short* r[8];
+            for (int k = 0; k < 8; k++)
+            {
+                if (dims == 2)
+                    r[k] = bottom_blob.row<unsigned short>(q * 8 + k);
+                else
+                    r[k] = bottom_blob.channel(q * 8 + k);
+            }
+
+            unsigned short* outptr = dims == 2 ? top_blob.row<unsigned short>(q) : (unsigned short*)top_blob.channel(q);
+
+            packing_pack1to8_16bit_avx(r, outptr, size);
+        }
+    }
+    else
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < outer; q++)
+        {
+            const unsigned short* r0 = dims == 2 ? bottom_blob.row<unsigned short>(q) : (const unsigned short*)bottom_blob.channel(q);
+
+            unsigned short* outptr[8];
+            for (int k = 0; k < 8; k++)
+            {
+                if (dims == 2)
+                    outptr[k] = top_blob.row<unsigned short>(q * 8 + k);
+                else
+                    outptr[k] = top_blob.channel(q * 8 + k);
+            }
+
+            packing_pack8to1_16bit_avx(r0, outptr, size);
+        }
+    }
+
+    return 0;
+}
+#endif // __AVX__
+
+#if __AVX512F__
+static void packing_pack1to16_avx512(const float* const* r, float* outptr, int size)
+{
+    int i = 0;
+    for (; i + 15 < size; i += 16)
+    {
+        __m512 _r0 = _mm512_loadu_ps(r[0] + i);
+        __m512 _r1 = _mm512_loadu_ps(r[1] + i);
+        __m512 _r2 = _mm512_loadu_ps(r[2] + i);
+        __m512 _r3 = _mm512_loadu_ps(r[3] + i);
+        __m512 _r4 = _mm512_loadu_ps(r[4] + i);
+        __m512 _r5 = _mm512_loadu_ps(r[5] + i);
+        __m512 _r6 = _mm512_loadu_ps(r[6] + i);
+        __m512 _r7 = _mm512_loadu_ps(r[7] + i);
+        __m512 _r8 = _mm512_loadu_ps(r[8] + i);
+        __m512 _r9 = _mm512_loadu_ps(r[9] + i);
+        __m512 _ra = _mm512_loadu_ps(r[10] + i);
+        __m512 _rb = _mm512_loadu_ps(r[11] + i);
+        __m512 _rc = _mm512_loadu_ps(r[12] + i);
+        __m512 _rd = _mm512_loadu_ps(r[13] + i);
+        __m512 _re = _mm512_loadu_ps(r[14] + i);
+        __m512 _rf = _mm512_loadu_ps(r[15] + i);
+        transpose16_ps(_r0, _r1, _r2, _r3, _r4, _r5, _r6, _r7, _r8, _r9, _ra, _rb, _rc, _rd, _re, _rf);
+        _mm512_storeu_ps(outptr, _r0);
+        _mm512_storeu_ps(outptr + 16, _r1);
+        _mm512_storeu_ps(outptr + 16 * 2, _r2);
+        _mm512_storeu_ps(outptr + 16 * 3, _r3);
+        _mm512_storeu_ps(outptr + 16 * 4, _r4);
+        _mm512_storeu_ps(outptr + 16 * 5, _r5);
+        _mm512_storeu_ps(outptr + 16 * 6, _r6);
+        _mm512_storeu_ps(outptr + 16 * 7, _r7);
+        _mm512_storeu_ps(outptr + 16 * 8, _r8);
+        _mm512_storeu_ps(outptr + 16 * 9, _r9);
+        _mm512_storeu_ps(outptr + 16 * 10, _ra);
+        _mm512_storeu_ps(outptr + 16 * 11, _rb);
+        _mm512_storeu_ps(outptr + 16 * 12, _rc);
+        _mm512_storeu_ps(outptr + 16 * 13, _rd);
+        _mm512_storeu_ps(outptr + 16 * 14, _re);
+        _mm512_storeu_ps(outptr + 16 * 15, _rf);
+        outptr += 256;
+    }
+    for (; i < size; i++)
+    {
+        for (int k = 0; k < 16; k++)
+        {
+            outptr[k] = r[k][i];
+        }
+
+        outptr += 16;
+    }
+}
+
+static void packing_pack16to1_avx512(const float* r0, float* const* outptr, int size)
+{
+    int i = 0;
+    for (; i + 15 < size; i += 16)
+    {
+        __m512 _r0 = _mm512_loadu_ps(r0);
+        __m512 _r1 = _mm512_loadu_ps(r0 + 16);
+        __m512 _r2 = _mm512_loadu_ps(r0 + 16 * 2);
+        __m512 _r3 = _mm512_loadu_ps(r0 + 16 * 3);
+        __m512 _r4 = _mm512_loadu_ps(r0 + 16 * 4);
+        __m512 _r5 = _mm512_loadu_ps(r0 + 16 * 5);
+        __m512 _r6 = _mm512_loadu_ps(r0 + 16 * 6);
+        __m512 _r7 = _mm512_loadu_ps(r0 + 16 * 7);
+        __m512 _r8 = _mm512_loadu_ps(r0 + 16 * 8);
+        __m512 _r9 = _mm512_loadu_ps(r0 + 16 * 9);
+        __m512 _ra = _mm512_loadu_ps(r0 + 16 * 10);
+        __m512 _rb = _mm512_loadu_ps(r0 + 16 * 11);
+        __m512 _rc = _mm512_loadu_ps(r0 + 16 * 12);
+        __m512 _rd = _mm512_loadu_ps(r0 + 16 * 13);
+        __m512 _re = _mm512_loadu_ps(r0 + 16 * 14);
+        __m512 _rf = _mm512_loadu_ps(r0 + 16 * 15);
+        transpose16_ps(_r0, _r1, _r2, _r3, _r4, _r5, _r6, _r7, _r8, _r9, _ra, _rb, _rc, _rd, _re, _rf);
+        _mm512_storeu_ps(outptr[0] + i, _r0);
+        _mm512_storeu_ps(outptr[1] + i, _r1);
+        _mm512_storeu_ps(outptr[2] + i, _r2);
+        _mm512_storeu_ps(outptr[3] + i, _r3);
+        _mm512_storeu_ps(outptr[4] + i, _r4);
+        _mm512_storeu_ps(outptr[5] + i, _r5);
+        _mm512_storeu_ps(outptr[6] + i, _r6);
+        _mm512_storeu_ps(outptr[7] + i, _r7);
+        _mm512_storeu_ps(outptr[8] + i, _r8);
+        _mm512_storeu_ps(outptr[9] + i, _r9);
+        _mm512_storeu_ps(outptr[10] + i, _ra);
+        _mm512_storeu_ps(outptr[11] + i, _rb);
+        _mm512_storeu_ps(outptr[12] + i, _rc);
+        _mm512_storeu_ps(outptr[13] + i, _rd);
+        _mm512_storeu_ps(outptr[14] + i, _re);
+        _mm512_storeu_ps(outptr[15] + i, _rf);
+        r0 += 256;
+    }
+    for (; i < size; i++)
+    {
+        for (int k = 0; k < 16; k++)
+        {
+            outptr[k][i] = r0[k];
+        }
+
+        r0 += 16;
+    }
+}
+
+static void packing_pack8to16_avx512(const float* r0, const float* r1, float* outptr, int size)
+{
+    for (int i = 0; i < size; i++)
+    {
+        _mm256_storeu_ps(outptr, _mm256_loadu_ps(r0));
+        _mm256_storeu_ps(outptr + 8, _mm256_loadu_ps(r1));
+        r0 += 8;
+        r1 += 8;
+        outptr += 16;
+    }
+}
+
+static void packing_pack16to8_avx512(const float* r0, float* outptr0, float* outptr1, int size)
+{
+    for (int i = 0; i < size; i++)
+    {
+        _mm256_storeu_ps(outptr0, _mm256_loadu_ps(r0));
+        _mm256_storeu_ps(outptr1, _mm256_loadu_ps(r0 + 8));
+        r0 += 16;
+        outptr0 += 8;
+        outptr1 += 8;
+    }
+}
+
+// fp32 pack1/pack8 <-> pack16, rows of dims 2 and channels of dims 3 are packed the same way
+static int packing_pack16_avx512(const Mat& bottom_blob, Mat& top_blob, int out_elempack, const Option& opt)
+{
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int channels = bottom_blob.c;
+    int dims = bottom_blob.dims;
+    size_t elemsize = bottom_blob.elemsize;
+    int elempack = bottom_blob.elempack;
+
+    // identity if use_padding not allowed
+    int outer = dims == 1 ? w : dims == 2 ? h : channels;
+    if (outer * elempack % out_elempack != 0)
+    {
+        top_blob = bottom_blob;
+        return 0;
+    }
+
+    size_t out_elemsize = elemsize / elempack * out_elempack;
+
+    if (dims == 1)
+    {
+        top_blob = bottom_blob;
+        top_blob.w = w * elempack / out_elempack;
+        top_blob.cstep = w * elempack / out_elempack;
+        top_blob.elemsize = out_elemsize;
+        top_blob.elempack = out_elempack;
+        return 0;
+    }
+
+    int outer_out = outer * elempack / out_elempack;
+    int size = dims == 2 ? w : w * h;
+
+    if (dims == 2)
+        top_blob.create(w, outer_out, out_elemsize, out_elempack, opt.blob_allocator);
+    else
+        top_blob.create(w, h, outer_out, out_elemsize, out_elempack, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    if (out_elempack == 16)
+    {
+        // inputs taken per output pack
+        const int n = 16 / elempack;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < outer_out; q++)
+        {
+            const float* r[16];
+            for (int k = 0; k < n; k++)
+            {
+                if (dims == 2)
+                    r[k] = bottom_blob.row(q * n + k);
+                else
+                    r[k] = bottom_blob.channel(q * n + k);
+            }
+
+            float* outptr = dims == 2 ? top_blob.row(q) : (float*)top_blob.channel(q);
+
+            if (elempack == 1)
+                packing_pack1to16_avx512(r, outptr, size);
+            else
+                packing_pack8to16_avx512(r[0], r[1], outptr, size);
+        }
+    }
+    else
+    {
+        // outputs written per input pack
+        const int n = 16 / out_elempack;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < outer; q++)
+        {
+            const float* r0 = dims == 2 ? bottom_blob.row(q) : (const float*)bottom_blob.channel(q);
+
+            float* outptr[16];
+            for (int k = 0; k < n; k++)
+            {
+                if (dims == 2)
+                    outptr[k] = top_blob.row(q * n + k);
+                else
+                    outptr[k] = top_blob.channel(q * n + k);
+            }
+
+            if (out_elempack == 1)
+                packing_pack16to1_avx512(r0, outptr, size);
+            else
+                packing_pack16to8_avx512(r0, outptr[0], outptr[1], size);
+        }
+    }
+
+    return 0;
+}
+#endif // __AVX512F__
+
 int Packing_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
     size_t elemsize = bottom_blob.elemsize;
     int elempack = bottom_blob.elempack;
 
-    bool elemtype_is_fp32 = (elemsize == 4u && elempack == 1) || (elemsize == 32u && elempack == 8);
+    bool elemtype_is_fp32 = (elemsize == 4u && elempack == 1) || (elemsize == 32u && elempack == 8) || (elemsize == 64u && elempack == 16);
     if (use_padding)
     {
         return Packing::forward(bottom_blob, top_blob, opt);
     }
 
+#if __AVX__
+    // bf16 and fp16 storage share the 16bit transpose
+    bool elemtype_is_16bit = (elemsize == 2u && elempack == 1) || (elemsize == 16u && elempack == 8);
+    if (elemtype_is_16bit && ((elempack == 1 && out_elempack == 8) || (elempack == 8 && out_elempack == 1)))
+    {
+        return packing_pack8_16bit_avx(bottom_blob, top_blob, out_elempack, opt);
+    }
+#endif // __AVX__
+
     if (!elemtype_is_fp32)
     {
         // non-fp32 type
@@ -50,6 +436,14 @@ int Packing_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& op
     bool pack1to8 = elempack == 1 && out_elempack == 8;
     bool pack8to1 = elempack == 8 && out_elempack == 1;
 
+#if __AVX512F__
+    bool pack16 = (elempack == 16 && (out_elempack == 1 || out_elempack == 8)) || (out_elempack == 16 && (elempack == 1 || elempack == 8));
+    if (pack16)
+    {
+        return packing_pack16_avx512(bottom_blob, top_blob, out_elempack, opt);
+    }
+#endif // __AVX512F__
+
     if (!pack1to8 && !pack8to1)
     {
         return Packing::forward(bottom_blob, top_blob, opt);
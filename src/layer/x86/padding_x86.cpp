@@ -22,6 +22,9 @@ namespace ncnn {
 
 #if __AVX__
 #include "padding_pack8.h"
+#if __AVX512F__
+#include "padding_pack16.h"
+#endif // __AVX512F__
 #endif // __AVX__
 
 Padding_x86::Padding_x86()
@@ -29,6 +32,9 @@ Padding_x86::Padding_x86()
 #if __AVX__
     support_packing = true;
 #endif // __AVX__
+#if __AVX512F__
+    support_packing16 = true;
+#endif // __AVX512F__
 }
 
 int Padding_x86::create_pipeline(const Option& /*opt*/)
@@ -85,6 +91,81 @@ int Padding_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& op
         }
     }
 
+#if __AVX512F__
+    if (elempack == 16 && out_elempack == 16)
+    {
+        int outw = w + left + right;
+
+        if (dims == 1)
+        {
+            top_blob.create(outw, elemsize, elempack, opt.blob_allocator);
+            if (top_blob.empty())
+                return -100;
+
+            if (type == 0)
+                padding_constant_pack16_avx512(bottom_blob, top_blob, 0, 0, left, right, _mm512_set1_ps(value));
+            if (type == 1)
+                padding_replicate_pack16_avx512(bottom_blob, top_blob, 0, 0, left, right);
+            if (type == 2)
+                padding_reflect_pack16_avx512(bottom_blob, top_blob, 0, 0, left, right);
+
+            return 0;
+        }
+
+        int outh = h + top + bottom;
+
+        if (dims == 2)
+        {
+            top_blob.create(outw, outh, elemsize, elempack, opt.blob_allocator);
+            if (top_blob.empty())
+                return -100;
+
+            if (type == 0)
+                padding_constant_pack16_avx512(bottom_blob, top_blob, top, bottom, left, right, _mm512_set1_ps(value));
+            if (type == 1)
+                padding_replicate_pack16_avx512(bottom_blob, top_blob, top, bottom, left, right);
+            if (type == 2)
+                padding_reflect_pack16_avx512(bottom_blob, top_blob, top, bottom, left, right);
+
+            return 0;
+        }
+
+        if (dims == 3)
+        {
+            top_blob.create(outw, outh, outc, elemsize, elempack, opt.blob_allocator);
+            if (top_blob.empty())
+                return -100;
+            int front_ = front / elempack;
+            #pragma omp parallel for num_threads(opt.num_threads)
+            for (int q = 0; q < outc; q++)
+            {
+                Mat borderm = top_blob.channel(q);
+
+                __m512 pad_value = per_channel_pad_data_size ? _mm512_loadu_ps((const float*)per_channel_pad_data + q * 16) : _mm512_set1_ps(value);
+                //Channel padding
+                if ((q - front_) < 0 || (q - front_) >= channels)
+                {
+                    borderm.fill(pad_value);
+                }
+                else
+                {
+                    const Mat m = bottom_blob.channel(q - front_);
+                    if (type == 0)
+                        padding_constant_pack16_avx512(m, borderm, top, bottom, left, right, pad_value);
+                    if (type == 1)
+                        padding_replicate_pack16_avx512(m, borderm, top, bottom, left, right);
+                    if (type == 2)
+                        padding_reflect_pack16_avx512(m, borderm, top, bottom, left, right);
+                }
+            }
+
+            return 0;
+        }
+
+        return 0;
+    }
+#endif // __AVX512F__
+
     if (elempack == 8 && out_elempack == 8)
     {
         int outw = w + left + right;
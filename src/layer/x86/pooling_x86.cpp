@@ -16,9 +16,12 @@
 // the License.
 
 #if __AVX__
+#include "avx_usability.h"
+
 #include <immintrin.h>
 #endif
 #include "pooling_x86.h"
+#include <algorithm>
 #include <float.h>
 
 namespace ncnn {
@@ -33,7 +36,11 @@ Pooling_x86::Pooling_x86()
 {
 #if __AVX__
     support_packing = true;
+    support_bf16_storage = true;
 #endif // __AVX__
+#if __AVX512F__
+    support_packing16 = true;
+#endif // __AVX512F__
 }
 
 int Pooling_x86::forward(const Mat& bottom_blob, Mat& top_blob,
@@ -43,6 +50,9 @@ int Pooling_x86::forward(const Mat& bottom_blob, Mat& top_blob,
     // avg value in NxN window
 
 #if __AVX__
+    if (opt.use_bf16_storage && bottom_blob.elembits() == 16)
+        return forward_bf16s(bottom_blob, top_blob, opt);
+
     int elempack = bottom_blob.elempack;
     int w = bottom_blob.w;
     int h = bottom_blob.h;
@@ -50,6 +60,229 @@ int Pooling_x86::forward(const Mat& bottom_blob, Mat& top_blob,
     size_t elemsize = bottom_blob.elemsize;
 
     //     NCNN_LOGE("Pooling     input %d x %d  pad = %d %d %d %d  ksize=%d %d  stride=%d %d", w, h, pad_left, pad_right, pad_top, pad_bottom, kernel_w, kernel_h, stride_w, stride_h);
+#if __AVX512F__
+    if (elempack == 16)
+    {
+        if (global_pooling)
+        {
+            top_blob.create(channels, elemsize, elempack, opt.blob_allocator);
+            if (top_blob.empty())
+                return -100;
+
+            int size = w * h;
+
+            if (pooling_type == PoolMethod_MAX)
+            {
+                #pragma omp parallel for num_threads(opt.num_threads)
+                for (int q = 0; q < channels; q++)
+                {
+                    const float* ptr = bottom_blob.channel(q);
+
+                    __m512 _max = _mm512_loadu_ps(ptr);
+                    for (int i = 0; i < size; i++)
+                    {
+                        __m512 _val = _mm512_loadu_ps(ptr);
+                        _max = _mm512_max_ps(_max, _val);
+                        ptr += 16;
+                    }
+
+                    float* outptr = top_blob;
+                    _mm512_storeu_ps(outptr + q * 16, _max);
+                }
+            }
+            else if (pooling_type == PoolMethod_AVE)
+            {
+                #pragma omp parallel for num_threads(opt.num_threads)
+                for (int q = 0; q < channels; q++)
+                {
+                    const float* ptr = bottom_blob.channel(q);
+
+                    __m512 _sum = _mm512_set1_ps(0.f);
+                    for (int i = 0; i < size; i++)
+                    {
+                        __m512 _val = _mm512_loadu_ps(ptr);
+                        _sum = _mm512_add_ps(_sum, _val);
+                        ptr += 16;
+                    }
+
+                    __m512 _inv_size = _mm512_set1_ps(1.f / size);
+                    __m512 _avg = _mm512_mul_ps(_sum, _inv_size);
+
+                    float* outptr = top_blob;
+                    _mm512_storeu_ps(outptr + q * 16, _avg);
+                }
+            }
+
+            return 0;
+        }
+
+        Mat bottom_blob_bordered;
+        make_padding(bottom_blob, bottom_blob_bordered, opt);
+        if (bottom_blob_bordered.empty())
+            return -100;
+
+        w = bottom_blob_bordered.w;
+        h = bottom_blob_bordered.h;
+
+        int outw = (w - kernel_w) / stride_w + 1;
+        int outh = (h - kernel_h) / stride_h + 1;
+
+        top_blob.create(outw, outh, channels, elemsize, elempack, opt.blob_allocator);
+        if (top_blob.empty())
+            return -100;
+
+        const int maxk = kernel_w * kernel_h;
+
+        // kernel offsets
+        std::vector<int> _space_ofs(maxk);
+        int* space_ofs = &_space_ofs[0];
+        {
+            int p1 = 0;
+            int p2 = 0;
+            int gap = w - kernel_w;
+            for (int i = 0; i < kernel_h; i++)
+            {
+                for (int j = 0; j < kernel_w; j++)
+                {
+                    space_ofs[p1] = p2;
+                    p1++;
+                    p2++;
+                }
+                p2 += gap;
+            }
+        }
+        if (pooling_type == PoolMethod_MAX)
+        {
+            #pragma omp parallel for num_threads(opt.num_threads)
+            for (int q = 0; q < channels; q++)
+            {
+                const Mat m = bottom_blob_bordered.channel(q);
+                float* outptr = top_blob.channel(q);
+
+                for (int i = 0; i < outh; i++)
+                {
+                    for (int j = 0; j < outw; j++)
+                    {
+                        const float* sptr = m.row(i * stride_h) + j * stride_w * 16;
+
+                        __m512 _max = _mm512_loadu_ps(sptr);
+
+                        for (int k = 0; k < maxk; k++)
+                        {
+                            __m512 _val = _mm512_loadu_ps(sptr + space_ofs[k] * 16);
+                            _max = _mm512_max_ps(_max, _val);
+                        }
+
+                        _mm512_storeu_ps(outptr + j * 16, _max);
+                    }
+
+                    outptr += outw * 16;
+                }
+            }
+        }
+        else if (pooling_type == PoolMethod_AVE)
+        {
+            if (avgpool_count_include_pad == 0)
+            {
+                int wtailpad = 0;
+                int htailpad = 0;
+
+                if (pad_mode == 0) // full padding
+                {
+                    wtailpad = bottom_blob_bordered.w - bottom_blob.w - pad_left - pad_right;
+                    htailpad = bottom_blob_bordered.h - bottom_blob.h - pad_top - pad_bottom;
+                }
+
+                #pragma omp parallel for num_threads(opt.num_threads)
+                for (int q = 0; q < channels; q++)
+                {
+                    const Mat m = bottom_blob_bordered.channel(q);
+                    float* outptr = top_blob.channel(q);
+
+                    for (int i = 0; i < outh; i++)
+                    {
+                        int sy0 = i * stride_h;
+
+                        for (int j = 0; j < outw; j++)
+                        {
+                            int sx0 = j * stride_w;
+
+                            __m512 _sum = _mm512_set1_ps(0.f);
+                            int area = 0;
+
+                            for (int ki = 0; ki < kernel_h; ki++)
+                            {
+                                int sy = sy0 + ki;
+
+                                if (sy < pad_top)
+                                    continue;
+
+                                if (sy >= h - pad_bottom - htailpad)
+                                    break;
+
+                                for (int kj = 0; kj < kernel_w; kj++)
+                                {
+                                    int sx = sx0 + kj;
+
+                                    if (sx < pad_left)
+                                        continue;
+
+                                    if (sx >= w - pad_right - wtailpad)
+                                        break;
+
+                                    __m512 _val = _mm512_loadu_ps(m.row(sy) + sx * 16);
+                                    _sum = _mm512_add_ps(_sum, _val);
+                                    area += 1;
+                                }
+                            }
+
+                            __m512 _inv_area = _mm512_set1_ps(1.f / area);
+                            __m512 _avg = _mm512_mul_ps(_sum, _inv_area);
+                            _mm512_storeu_ps(outptr + j * 16, _avg);
+                        }
+
+                        outptr += outw * 16;
+                    }
+                }
+            }
+            else // if (avgpool_count_include_pad == 1)
+            {
+                #pragma omp parallel for num_threads(opt.num_threads)
+                for (int q = 0; q < channels; q++)
+                {
+                    const Mat m = bottom_blob_bordered.channel(q);
+                    float* outptr = top_blob.channel(q);
+
+                    __m512 _inv_maxk = _mm512_set1_ps(1.f / maxk);
+
+                    for (int i = 0; i < outh; i++)
+                    {
+                        for (int j = 0; j < outw; j++)
+                        {
+                            const float* sptr = m.row(i * stride_h) + j * stride_w * 16;
+
+                            __m512 _sum = _mm512_set1_ps(0.f);
+
+                            for (int k = 0; k < maxk; k++)
+                            {
+                                __m512 _val = _mm512_loadu_ps(sptr + space_ofs[k] * 16);
+                                _sum = _mm512_add_ps(_sum, _val);
+                            }
+
+                            __m512 _avg = _mm512_mul_ps(_sum, _inv_maxk);
+                            _mm512_storeu_ps(outptr + j * 16, _avg);
+                        }
+
+                        outptr += outw * 16;
+                    }
+                }
+            }
+        }
+
+        return 0;
+    }
+#endif // __AVX512F__
+
     if (elempack == 8)
     {
         if (global_pooling)
@@ -329,4 +562,92 @@ int Pooling_x86::forward(const Mat& bottom_blob, Mat& top_blob,
 #endif
 }
 
+#if __AVX__
+int Pooling_x86::forward_bf16s(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    // pool on fp32, bf16 only narrows the blobs between layers
+    Option opt_fp32 = opt;
+    opt_fp32.blob_allocator = opt.workspace_allocator;
+    opt_fp32.use_bf16_storage = false;
+
+    if (bottom_blob.dims != 3)
+    {
+        Mat bottom_blob_fp32;
+        cast_bfloat16_to_float32(bottom_blob, bottom_blob_fp32, opt_fp32);
+        if (bottom_blob_fp32.empty())
+            return -100;
+
+        Mat top_blob_fp32;
+        int ret = forward(bottom_blob_fp32, top_blob_fp32, opt_fp32);
+        if (ret != 0)
+            return ret;
+
+        cast_float32_to_bfloat16(top_blob_fp32, top_blob, opt);
+        if (top_blob.empty())
+            return -100;
+
+        return 0;
+    }
+
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int channels = bottom_blob.c;
+    int elempack = bottom_blob.elempack;
+
+    // channels pool independently, widen a block of them at a time
+    // the fp32 block stays around 256KB but still feeds every thread
+    const int channel_size = w * h * elempack * (int)sizeof(float);
+    const int block_channels = std::min(std::max(256 * 1024 / channel_size, opt.num_threads), channels);
+
+    for (int q0 = 0; q0 < channels; q0 += block_channels)
+    {
+        const int n = std::min(block_channels, channels - q0);
+
+        Mat bottom_block(w, h, n, 4u * elempack, elempack, opt.workspace_allocator);
+        if (bottom_block.empty())
+            return -100;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < n; q++)
+        {
+            cast_bfloat16_to_float32_avx(bottom_blob.channel(q0 + q), bottom_block.channel(q), w * h * elempack);
+        }
+
+        Mat top_block;
+        int ret = forward(bottom_block, top_block, opt_fp32);
+        if (ret != 0)
+            return ret;
+
+        if (top_block.dims == 1)
+        {
+            // global pooling
+            if (q0 == 0)
+            {
+                top_blob.create(channels, 2u * elempack, elempack, opt.blob_allocator);
+                if (top_blob.empty())
+                    return -100;
+            }
+
+            cast_float32_to_bfloat16_avx(top_block, (unsigned short*)top_blob + q0 * elempack, n * elempack);
+            continue;
+        }
+
+        if (q0 == 0)
+        {
+            top_blob.create(top_block.w, top_block.h, channels, 2u * elempack, elempack, opt.blob_allocator);
+            if (top_blob.empty())
+                return -100;
+        }
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < n; q++)
+        {
+            cast_float32_to_bfloat16_avx(top_block.channel(q), top_blob.channel(q0 + q), top_block.w * top_block.h * elempack);
+        }
+    }
+
+    return 0;
+}
+#endif // __AVX__
+
 } // namespace ncnn
@@ -29,6 +29,11 @@ public:
 
     virtual int forward(const Mat& bottom_blob, Mat& top_blob,
                         const Option& opt) const;
+
+protected:
+#if __AVX__
+    int forward_bf16s(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+#endif // __AVX__
 };
 
 } // namespace ncnn
@@ -0,0 +1,144 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#if __AVX2__
+#include "avx_usability.h"
+#endif // __AVX2__
+
+#include "quantize_x86.h"
+
+#include <math.h>
+
+namespace ncnn {
+
+Quantize_x86::Quantize_x86()
+{
+#if __AVX2__
+    support_packing = true;
+#endif // __AVX2__
+}
+
+#if __AVX2__
+static inline signed char float2int8(float v)
+{
+    int int32 = static_cast<int>(round(v));
+    if (int32 > 127) return 127;
+    if (int32 < -127) return -127;
+    return (signed char)int32;
+}
+
+static void quantize_avx(const float* ptr, signed char* outptr, int size, float scale)
+{
+    __m256 _scale = _mm256_set1_ps(scale);
+
+    int i = 0;
+    for (; i + 15 < size; i += 16)
+    {
+        __m256 _p0 = _mm256_loadu_ps(ptr + i);
+        __m256 _p1 = _mm256_loadu_ps(ptr + i + 8);
+        __m128i _v0 = float2int8_avx(_mm256_mul_ps(_p0, _scale));
+        __m128i _v1 = float2int8_avx(_mm256_mul_ps(_p1, _scale));
+        _mm_storeu_si128((__m128i*)(outptr + i), _mm_unpacklo_epi64(_v0, _v1));
+    }
+    for (; i + 7 < size; i += 8)
+    {
+        __m256 _p = _mm256_loadu_ps(ptr + i);
+        _mm_storel_epi64((__m128i*)(outptr + i), float2int8_avx(_mm256_mul_ps(_p, _scale)));
+    }
+    for (; i < size; i++)
+    {
+        outptr[i] = float2int8(ptr[i] * scale);
+    }
+}
+#endif // __AVX2__
+
+int Quantize_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+#if __AVX2__
+    int dims = bottom_blob.dims;
+    int elempack = bottom_blob.elempack;
+
+    // int8 keeps the packing, one byte per lane
+    size_t out_elemsize = elempack * 1u;
+
+    if (dims == 1)
+    {
+        int w = bottom_blob.w;
+        int size = w * elempack;
+
+        top_blob.create(w, out_elemsize, elempack, opt.blob_allocator);
+        if (top_blob.empty())
+            return -100;
+
+        const float* ptr = bottom_blob;
+        signed char* outptr = top_blob;
+
+        const int nn_size = (size + 63) / 64;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int ii = 0; ii < nn_size; ii++)
+        {
+            const int i = ii * 64;
+
+            quantize_avx(ptr + i, outptr + i, std::min(64, size - i), scale);
+        }
+    }
+
+    if (dims == 2)
+    {
+        int w = bottom_blob.w;
+        int h = bottom_blob.h;
+
+        top_blob.create(w, h, out_elemsize, elempack, opt.blob_allocator);
+        if (top_blob.empty())
+            return -100;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int i = 0; i < h; i++)
+        {
+            const float* ptr = bottom_blob.row(i);
+            signed char* outptr = top_blob.row<signed char>(i);
+
+            quantize_avx(ptr, outptr, w * elempack, scale);
+        }
+    }
+
+    if (dims == 3)
+    {
+        int w = bottom_blob.w;
+        int h = bottom_blob.h;
+        int channels = bottom_blob.c;
+        int size = w * h;
+
+        top_blob.create(w, h, channels, out_elemsize, elempack, opt.blob_allocator);
+        if (top_blob.empty())
+            return -100;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < channels; q++)
+        {
+            const float* ptr = bottom_blob.channel(q);
+            signed char* outptr = top_blob.channel(q);
+
+            quantize_avx(ptr, outptr, size * elempack, scale);
+        }
+    }
+
+    return 0;
+#else
+    return Quantize::forward(bottom_blob, top_blob, opt);
+#endif // __AVX2__
+}
+
+} // namespace ncnn
@@ -25,17 +25,43 @@ ReLU_x86::ReLU_x86()
 #if __AVX__
     support_packing = true;
 #endif // __AVX__
+#if __AVX512F__
+    support_packing16 = true;
+#endif // __AVX512F__
 }
 
-int ReLU_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+// bottom_blob and top_blob may be the same mat
+static void relu_x86(const Mat& bottom_blob, Mat& top_blob, float slope, const Option& opt)
 {
-    int w = bottom_top_blob.w;
-    int h = bottom_top_blob.h;
-    int channels = bottom_top_blob.c;
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int channels = bottom_blob.c;
     int size = w * h;
 
 #if __AVX__
-    int elempack = bottom_top_blob.elempack;
+    int elempack = bottom_blob.elempack;
+
+#if __AVX512F__
+    if (elempack == 16)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < channels; q++)
+        {
+            const float* ptr = bottom_blob.channel(q);
+            float* outptr = top_blob.channel(q);
+
+            for (int i = 0; i < size; i++)
+            {
+                __m512 _p = _mm512_loadu_ps(ptr);
+                _mm512_storeu_ps(outptr, lrelu_avx512(_p, slope));
+                ptr += 16;
+                outptr += 16;
+            }
+        }
+
+        return;
+    }
+#endif // __AVX512F__
 
     if (elempack == 8)
     {
@@ -44,13 +70,15 @@ int ReLU_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
             #pragma omp parallel for num_threads(opt.num_threads)
             for (int q = 0; q < channels; q++)
             {
-                float* ptr = bottom_top_blob.channel(q);
+                const float* ptr = bottom_blob.channel(q);
+                float* outptr = top_blob.channel(q);
                 __m256 _zero = _mm256_set1_ps(0.f);
                 for (int i = 0; i < size; i++)
                 {
                     __m256 _p = _mm256_loadu_ps(ptr);
-                    _mm256_storeu_ps(ptr, _mm256_max_ps(_zero, _p));
+                    _mm256_storeu_ps(outptr, _mm256_max_ps(_zero, _p));
                     ptr += 8;
+                    outptr += 8;
                 }
             }
         }
@@ -59,17 +87,19 @@ int ReLU_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
             #pragma omp parallel for num_threads(opt.num_threads)
             for (int q = 0; q < channels; q++)
             {
-                float* ptr = bottom_top_blob.channel(q);
+                const float* ptr = bottom_blob.channel(q);
+                float* outptr = top_blob.channel(q);
                 for (int i = 0; i < size; i++)
                 {
                     __m256 _p = _mm256_loadu_ps(ptr);
-                    _mm256_storeu_ps(ptr, lrelu_avx(_p, slope));
+                    _mm256_storeu_ps(outptr, lrelu_avx(_p, slope));
                     ptr += 8;
+                    outptr += 8;
                 }
             }
         }
 
-        return 0;
+        return;
     }
 #endif // __AVX__
 
@@ -78,14 +108,16 @@ int ReLU_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
         #pragma omp parallel for num_threads(opt.num_threads)
         for (int q = 0; q < channels; q++)
         {
-            float* ptr = bottom_top_blob.channel(q);
+            const float* ptr = bottom_blob.channel(q);
+            float* outptr = top_blob.channel(q);
 
             int remain = size;
             for (; remain > 0; remain--)
             {
-                *ptr = std::max(*ptr, 0.f);
+                *outptr = std::max(*ptr, 0.f);
 
                 ptr++;
+                outptr++;
             }
         }
     }
@@ -94,17 +126,34 @@ int ReLU_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
         #pragma omp parallel for num_threads(opt.num_threads)
         for (int q = 0; q < channels; q++)
         {
-            float* ptr = bottom_top_blob.channel(q);
+            const float* ptr = bottom_blob.channel(q);
+            float* outptr = top_blob.channel(q);
             int remain = size;
             for (; remain > 0; remain--)
             {
-                if (*ptr < 0)
-                    *ptr *= slope;
+                *outptr = *ptr < 0 ? *ptr * slope : *ptr;
 
                 ptr++;
+                outptr++;
             }
         }
     }
+}
+
+int ReLU_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    top_blob.create_like(bottom_blob, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    relu_x86(bottom_blob, top_blob, slope, opt);
+
+    return 0;
+}
+
+int ReLU_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    relu_x86(bottom_top_blob, bottom_top_blob, slope, opt);
 
     return 0;
 }
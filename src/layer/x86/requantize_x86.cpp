@@ -0,0 +1,164 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#if __AVX2__
+#include "avx_usability.h"
+#endif // __AVX2__
+
+#include "requantize_x86.h"
+
+#include <math.h>
+
+namespace ncnn {
+
+Requantize_x86::Requantize_x86()
+{
+#if __AVX2__
+    support_packing = true;
+#endif // __AVX2__
+}
+
+#if __AVX2__
+static inline signed char float2int8(float v)
+{
+    int int32 = static_cast<int>(round(v));
+    if (int32 > 127) return 127;
+    if (int32 < -127) return -127;
+    return (signed char)int32;
+}
+
+// _bias repeats every 8 values, bias is for the pack1 tail
+static void requantize_avx(const int* intptr, signed char* ptr, int size, float scale_in, __m256 _bias, float bias, float scale_out, bool fusion_relu)
+{
+    __m256 _scale_in = _mm256_set1_ps(scale_in);
+    __m256 _scale_out = _mm256_set1_ps(scale_out);
+
+    int i = 0;
+    for (; i + 7 < size; i += 8)
+    {
+        __m256 _v = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(intptr + i)));
+        _v = _mm256_mul_ps(_mm256_fmadd_ps(_v, _scale_in, _bias), _scale_out);
+        if (fusion_relu)
+            _v = _mm256_max_ps(_v, _mm256_setzero_ps());
+        _mm_storel_epi64((__m128i*)(ptr + i), float2int8_avx(_v));
+    }
+    for (; i < size; i++)
+    {
+        ptr[i] = float2int8(((intptr[i] * scale_in) + bias) * scale_out);
+        if (fusion_relu && ptr[i] < 0)
+            ptr[i] = 0;
+    }
+}
+#endif // __AVX2__
+
+int Requantize_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+#if __AVX2__
+    int dims = bottom_blob.dims;
+    int elempack = bottom_blob.elempack;
+
+    // int8 keeps the packing, one byte per lane
+    size_t out_elemsize = elempack * 1u;
+
+    const float bias0 = bias_term ? bias_data[0] : 0.f;
+
+    if (dims == 1)
+    {
+        int w = bottom_blob.w;
+        int size = w * elempack;
+
+        top_blob.create(w, out_elemsize, elempack, opt.blob_allocator);
+        if (top_blob.empty())
+            return -100;
+
+        const int* intptr = bottom_blob;
+        signed char* ptr = top_blob;
+
+        const int nn_size = (size + 63) / 64;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int ii = 0; ii < nn_size; ii++)
+        {
+            const int i = ii * 64;
+            const int len = std::min(64, size - i);
+
+            if (bias_term && bias_data_size > 1)
+            {
+                // bias follows every element
+                __m256 _scale_in = _mm256_set1_ps(scale_in);
+                __m256 _scale_out = _mm256_set1_ps(scale_out);
+
+                int j = 0;
+                for (; j + 7 < len; j += 8)
+                {
+                    __m256 _v = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(intptr + i + j)));
+                    _v = _mm256_mul_ps(_mm256_fmadd_ps(_v, _scale_in, _mm256_loadu_ps((const float*)bias_data + i + j)), _scale_out);
+                    if (fusion_relu)
+                        _v = _mm256_max_ps(_v, _mm256_setzero_ps());
+                    _mm_storel_epi64((__m128i*)(ptr + i + j), float2int8_avx(_v));
+                }
+                for (; j < len; j++)
+                {
+                    ptr[i + j] = float2int8(((intptr[i + j] * scale_in) + bias_data[i + j]) * scale_out);
+                    if (fusion_relu && ptr[i + j] < 0)
+                        ptr[i + j] = 0;
+                }
+            }
+            else
+            {
+                requantize_avx(intptr + i, ptr + i, len, scale_in, _mm256_set1_ps(bias0), bias0, scale_out, fusion_relu);
+            }
+        }
+    }
+
+    if (dims == 2 || dims == 3)
+    {
+        // one bias per row of a 2-dim blob or per channel of a 3-dim blob
+        int w = bottom_blob.w;
+        int h = bottom_blob.h;
+        int channels = dims == 2 ? h : bottom_blob.c;
+        int size = dims == 2 ? w * elempack : w * h * elempack;
+
+        if (dims == 2)
+            top_blob.create(w, h, out_elemsize, elempack, opt.blob_allocator);
+        else
+            top_blob.create(w, h, channels, out_elemsize, elempack, opt.blob_allocator);
+        if (top_blob.empty())
+            return -100;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < channels; q++)
+        {
+            const int* intptr = dims == 2 ? bottom_blob.row<const int>(q) : (const int*)bottom_blob.channel(q);
+            signed char* ptr = dims == 2 ? top_blob.row<signed char>(q) : (signed char*)top_blob.channel(q);
+
+            float bias = bias_term && bias_data_size > 1 ? bias_data[q * elempack] : bias0;
+
+            __m256 _bias = _mm256_set1_ps(bias);
+            if (elempack == 8 && bias_term && bias_data_size > 1)
+            {
+                _bias = _mm256_loadu_ps((const float*)bias_data + q * 8);
+            }
+
+            requantize_avx(intptr, ptr, size, scale_in, _bias, bias, scale_out, fusion_relu);
+        }
+    }
+
+    return 0;
+#else
+    return Requantize::forward(bottom_blob, top_blob, opt);
+#endif // __AVX2__
+}
+
+} // namespace ncnn
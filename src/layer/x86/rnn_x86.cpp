@@ -0,0 +1,166 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#if __AVX__
+#include "avx_activation.h"
+#include "avx_usability.h"
+#endif // __AVX__
+
+#include "rnn_x86.h"
+
+#include <math.h>
+
+namespace ncnn {
+
+#if __AVX__
+#include "sgemm_avx.h"
+#endif // __AVX__
+
+int RNN_x86::create_pipeline(const Option& /*opt*/)
+{
+#if __AVX__
+    // the reference scales every W_hh row by the hidden value of its own output,
+    // so W_hh * h_cont_{t-1} reduces to rowsum(W_hh) .* h_cont_{t-1}
+    const int size = weight_hh_data.w;
+
+    weight_hh_data_sum.create(num_output);
+    if (weight_hh_data_sum.empty())
+        return -100;
+
+    for (int q = 0; q < num_output; q++)
+    {
+        const float* weight_hh_data_ptr = weight_hh_data.row(q);
+
+        float sum = 0.f;
+        for (int i = 0; i < size; i++)
+        {
+            sum += weight_hh_data_ptr[i];
+        }
+
+        weight_hh_data_sum[q] = sum;
+    }
+#endif // __AVX__
+
+    return 0;
+}
+
+int RNN_x86::destroy_pipeline(const Option& /*opt*/)
+{
+    weight_hh_data_sum.release();
+
+    return 0;
+}
+
+int RNN_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+#if __AVX__
+    // size x 1 x T
+    const Mat& input_blob = bottom_blobs[0];
+    size_t elemsize = input_blob.elemsize;
+
+    // T, 0 or 1 each
+    const Mat& cont_blob = bottom_blobs[1];
+
+    int T = input_blob.c;
+    int size = input_blob.w;
+
+    // the reference walks size columns of W_hh and W_ho
+    if (size != weight_hh_data.w || size != num_output)
+    {
+        return RNN::forward(bottom_blobs, top_blobs, opt);
+    }
+
+    Mat& top_blob = top_blobs[0];
+    top_blob.create(num_output, 1, T, elemsize, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    // hidden state of every timestep
+    Mat hidden(num_output, T, 4u, opt.workspace_allocator);
+    if (hidden.empty())
+        return -100;
+
+    // neither projection depends on the previous hidden state,
+    // so both run as one sgemm over all timesteps and only the recurrence stays sequential
+
+    // W_xh * x_t
+    int ret = sgemm_avx(T, num_output, size, (const float*)input_blob, (int)input_blob.cstep, 1, (const float*)weight_xh_data, 1, weight_xh_data.w, (float*)hidden, num_output, opt);
+    if (ret != 0)
+        return ret;
+
+    // unroll
+    for (int t = 0; t < T; t++)
+    {
+        // clip hidden by continuation indicator
+        // h_cont_{t-1} = cont_t * h_{t-1}
+        // h_t = tanh( W_hh * h_cont_{t-1} + W_xh * x_t + b_h )
+        const float cont = cont_blob[t];
+        const float* hidden_prev = t > 0 && cont ? hidden.row(t - 1) : 0;
+        const float* weight_hh_sum_ptr = weight_hh_data_sum;
+        const float* bias_h_ptr = bias_h_data;
+        float* hidden_data = hidden.row(t);
+
+        int q = 0;
+        for (; q + 7 < num_output; q += 8)
+        {
+            __m256 _sum = _mm256_add_ps(_mm256_loadu_ps(hidden_data + q), _mm256_loadu_ps(bias_h_ptr + q));
+            if (hidden_prev)
+            {
+                _sum = _mm256_fmadd_ps(_mm256_loadu_ps(weight_hh_sum_ptr + q), _mm256_loadu_ps(hidden_prev + q), _sum);
+            }
+            _mm256_storeu_ps(hidden_data + q, tanh_avx(_sum));
+        }
+        for (; q < num_output; q++)
+        {
+            float sum = hidden_data[q] + bias_h_ptr[q];
+            if (hidden_prev)
+            {
+                sum += weight_hh_sum_ptr[q] * hidden_prev[q];
+            }
+            hidden_data[q] = tanh(sum);
+        }
+    }
+
+    // o_t = tanh( W_ho * h_t + b_o )
+    ret = sgemm_avx(T, num_output, num_output, (const float*)hidden, num_output, 1, (const float*)weight_ho_data, 1, num_output, (float*)top_blob, (int)top_blob.cstep, opt);
+    if (ret != 0)
+        return ret;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int t = 0; t < T; t++)
+    {
+        const float* bias_o_ptr = bias_o_data;
+        float* output_data = top_blob.channel(t);
+
+        int q = 0;
+        for (; q + 7 < num_output; q += 8)
+        {
+            __m256 _sum = _mm256_add_ps(_mm256_loadu_ps(output_data + q), _mm256_loadu_ps(bias_o_ptr + q));
+            _mm256_storeu_ps(output_data + q, tanh_avx(_sum));
+        }
+        for (; q < num_output; q++)
+        {
+            output_data[q] = tanh(output_data[q] + bias_o_ptr[q]);
+        }
+    }
+
+    // no hidden output here
+
+    return 0;
+#else
+    return RNN::forward(bottom_blobs, top_blobs, opt);
+#endif // __AVX__
+}
+
+} // namespace ncnn
@@ -0,0 +1,320 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// blocked sgemm, C = A * B with A M x K and B K x N
+// operands are addressed by row and column stride, so transposed inputs need no copy
+// A is packed into 6-row panels and B into 16-column panels, both k-major
+// B may be fp16 (unsigned short), it is widened while packing
+
+static inline __m256 sgemm_load8_avx(const float* ptr)
+{
+    return _mm256_loadu_ps(ptr);
+}
+
+static inline __m256 sgemm_load8_avx(const unsigned short* ptr)
+{
+    return loadfp16(ptr);
+}
+
+static inline float sgemm_load1_avx(const float* ptr)
+{
+    return *ptr;
+}
+
+static inline float sgemm_load1_avx(const unsigned short* ptr)
+{
+    return float16_to_float32(*ptr);
+}
+
+static void sgemm_pack_a_avx(const float* A, int lda_row, int lda_col, int i0, int mc, int k0, int kc, float* Ap, const Option& opt)
+{
+    const int nn_mr = (mc + 5) / 6;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int ii = 0; ii < nn_mr; ii++)
+    {
+        const int i = ii * 6;
+        const int mr = std::min(mc - i, 6);
+
+        const float* p0 = A + (size_t)(i0 + i) * lda_row + (size_t)k0 * lda_col;
+        float* pp = Ap + ii * 6 * kc;
+
+        for (int k = 0; k < kc; k++)
+        {
+            const float* p = p0 + (size_t)k * lda_col;
+
+            int r = 0;
+            for (; r < mr; r++)
+            {
+                pp[r] = p[(size_t)r * lda_row];
+            }
+            for (; r < 6; r++)
+            {
+                pp[r] = 0.f;
+            }
+
+            pp += 6;
+        }
+    }
+}
+
+template<typename T>
+static void sgemm_pack_b_avx(const T* B, int ldb_row, int ldb_col, int k0, int kc, int j0, int nc, float* Bp, const Option& opt)
+{
+    const int nn_nr = (nc + 15) / 16;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int jj = 0; jj < nn_nr; jj++)
+    {
+        const int j = jj * 16;
+        const int nr = std::min(nc - j, 16);
+
+        const T* p0 = B + (size_t)k0 * ldb_row + (size_t)(j0 + j) * ldb_col;
+        float* pp = Bp + jj * 16 * kc;
+
+        int k = 0;
+        if (nr == 16 && ldb_col == 1)
+        {
+            // rows of B are contiguous
+            for (; k < kc; k++)
+            {
+                const T* p = p0 + (size_t)k * ldb_row;
+
+                _mm256_storeu_ps(pp, sgemm_load8_avx(p));
+                _mm256_storeu_ps(pp + 8, sgemm_load8_avx(p + 8));
+
+                pp += 16;
+            }
+        }
+        if (nr == 16 && ldb_row == 1)
+        {
+            // columns of B are contiguous, transpose 8x8 blocks
+            for (; k + 7 < kc; k += 8)
+            {
+                for (int h = 0; h < 2; h++)
+                {
+                    const T* p = p0 + k + (size_t)(h * 8) * ldb_col;
+
+                    __m256 _r0 = sgemm_load8_avx(p);
+                    __m256 _r1 = sgemm_load8_avx(p + ldb_col);
+                    __m256 _r2 = sgemm_load8_avx(p + (size_t)ldb_col * 2);
+                    __m256 _r3 = sgemm_load8_avx(p + (size_t)ldb_col * 3);
+                    __m256 _r4 = sgemm_load8_avx(p + (size_t)ldb_col * 4);
+                    __m256 _r5 = sgemm_load8_avx(p + (size_t)ldb_col * 5);
+                    __m256 _r6 = sgemm_load8_avx(p + (size_t)ldb_col * 6);
+                    __m256 _r7 = sgemm_load8_avx(p + (size_t)ldb_col * 7);
+
+                    transpose8_ps(_r0, _r1, _r2, _r3, _r4, _r5, _r6, _r7);
+
+                    _mm256_storeu_ps(pp + h * 8, _r0);
+                    _mm256_storeu_ps(pp + 16 + h * 8, _r1);
+                    _mm256_storeu_ps(pp + 16 * 2 + h * 8, _r2);
+                    _mm256_storeu_ps(pp + 16 * 3 + h * 8, _r3);
+                    _mm256_storeu_ps(pp + 16 * 4 + h * 8, _r4);
+                    _mm256_storeu_ps(pp + 16 * 5 + h * 8, _r5);
+                    _mm256_storeu_ps(pp + 16 * 6 + h * 8, _r6);
+                    _mm256_storeu_ps(pp + 16 * 7 + h * 8, _r7);
+                }
+
+                pp += 16 * 8;
+            }
+        }
+        for (; k < kc; k++)
+        {
+            const T* p = p0 + (size_t)k * ldb_row;
+
+            int c = 0;
+            for (; c < nr; c++)
+            {
+                pp[c] = sgemm_load1_avx(p + (size_t)c * ldb_col);
+            }
+            for (; c < 16; c++)
+            {
+                pp[c] = 0.f;
+            }
+
+            pp += 16;
+        }
+    }
+}
+
+// 12 accumulators, two B vectors and one A broadcast fit the 16 ymm registers
+static void sgemm_kernel_6x16_avx(int kc, const float* Ap, const float* Bp, float* C, int ldc, int mr, int nr, bool accumulate)
+{
+    __m256 _c00 = _mm256_setzero_ps();
+    __m256 _c01 = _mm256_setzero_ps();
+    __m256 _c10 = _mm256_setzero_ps();
+    __m256 _c11 = _mm256_setzero_ps();
+    __m256 _c20 = _mm256_setzero_ps();
+    __m256 _c21 = _mm256_setzero_ps();
+    __m256 _c30 = _mm256_setzero_ps();
+    __m256 _c31 = _mm256_setzero_ps();
+    __m256 _c40 = _mm256_setzero_ps();
+    __m256 _c41 = _mm256_setzero_ps();
+    __m256 _c50 = _mm256_setzero_ps();
+    __m256 _c51 = _mm256_setzero_ps();
+
+    for (int k = 0; k < kc; k++)
+    {
+        __m256 _b0 = _mm256_loadu_ps(Bp);
+        __m256 _b1 = _mm256_loadu_ps(Bp + 8);
+
+        __m256 _a = _mm256_broadcast_ss(Ap);
+        _c00 = _mm256_fmadd_ps(_a, _b0, _c00);
+        _c01 = _mm256_fmadd_ps(_a, _b1, _c01);
+        _a = _mm256_broadcast_ss(Ap + 1);
+        _c10 = _mm256_fmadd_ps(_a, _b0, _c10);
+        _c11 = _mm256_fmadd_ps(_a, _b1, _c11);
+        _a = _mm256_broadcast_ss(Ap + 2);
+        _c20 = _mm256_fmadd_ps(_a, _b0, _c20);
+        _c21 = _mm256_fmadd_ps(_a, _b1, _c21);
+        _a = _mm256_broadcast_ss(Ap + 3);
+        _c30 = _mm256_fmadd_ps(_a, _b0, _c30);
+        _c31 = _mm256_fmadd_ps(_a, _b1, _c31);
+        _a = _mm256_broadcast_ss(Ap + 4);
+        _c40 = _mm256_fmadd_ps(_a, _b0, _c40);
+        _c41 = _mm256_fmadd_ps(_a, _b1, _c41);
+        _a = _mm256_broadcast_ss(Ap + 5);
+        _c50 = _mm256_fmadd_ps(_a, _b0, _c50);
+        _c51 = _mm256_fmadd_ps(_a, _b1, _c51);
+
+        Ap += 6;
+        Bp += 16;
+    }
+
+    if (mr == 6 && nr == 16)
+    {
+        if (accumulate)
+        {
+            _c00 = _mm256_add_ps(_c00, _mm256_loadu_ps(C));
+            _c01 = _mm256_add_ps(_c01, _mm256_loadu_ps(C + 8));
+            _c10 = _mm256_add_ps(_c10, _mm256_loadu_ps(C + ldc));
+            _c11 = _mm256_add_ps(_c11, _mm256_loadu_ps(C + ldc + 8));
+            _c20 = _mm256_add_ps(_c20, _mm256_loadu_ps(C + ldc * 2));
+            _c21 = _mm256_add_ps(_c21, _mm256_loadu_ps(C + ldc * 2 + 8));
+            _c30 = _mm256_add_ps(_c30, _mm256_loadu_ps(C + ldc * 3));
+            _c31 = _mm256_add_ps(_c31, _mm256_loadu_ps(C + ldc * 3 + 8));
+            _c40 = _mm256_add_ps(_c40, _mm256_loadu_ps(C + ldc * 4));
+            _c41 = _mm256_add_ps(_c41, _mm256_loadu_ps(C + ldc * 4 + 8));
+            _c50 = _mm256_add_ps(_c50, _mm256_loadu_ps(C + ldc * 5));
+            _c51 = _mm256_add_ps(_c51, _mm256_loadu_ps(C + ldc * 5 + 8));
+        }
+
+        _mm256_storeu_ps(C, _c00);
+        _mm256_storeu_ps(C + 8, _c01);
+        _mm256_storeu_ps(C + ldc, _c10);
+        _mm256_storeu_ps(C + ldc + 8, _c11);
+        _mm256_storeu_ps(C + ldc * 2, _c20);
+        _mm256_storeu_ps(C + ldc * 2 + 8, _c21);
+        _mm256_storeu_ps(C + ldc * 3, _c30);
+        _mm256_storeu_ps(C + ldc * 3 + 8, _c31);
+        _mm256_storeu_ps(C + ldc * 4, _c40);
+        _mm256_storeu_ps(C + ldc * 4 + 8, _c41);
+        _mm256_storeu_ps(C + ldc * 5, _c50);
+        _mm256_storeu_ps(C + ldc * 5 + 8, _c51);
+
+        return;
+    }
+
+    // partial tile on the right or bottom edge
+    float tmp[6 * 16];
+    _mm256_storeu_ps(tmp, _c00);
+    _mm256_storeu_ps(tmp + 8, _c01);
+    _mm256_storeu_ps(tmp + 16, _c10);
+    _mm256_storeu_ps(tmp + 16 + 8, _c11);
+    _mm256_storeu_ps(tmp + 16 * 2, _c20);
+    _mm256_storeu_ps(tmp + 16 * 2 + 8, _c21);
+    _mm256_storeu_ps(tmp + 16 * 3, _c30);
+    _mm256_storeu_ps(tmp + 16 * 3 + 8, _c31);
+    _mm256_storeu_ps(tmp + 16 * 4, _c40);
+    _mm256_storeu_ps(tmp + 16 * 4 + 8, _c41);
+    _mm256_storeu_ps(tmp + 16 * 5, _c50);
+    _mm256_storeu_ps(tmp + 16 * 5 + 8, _c51);
+
+    for (int r = 0; r < mr; r++)
+    {
+        float* outptr = C + (size_t)r * ldc;
+        const float* ptr = tmp + r * 16;
+
+        for (int c = 0; c < nr; c++)
+        {
+            outptr[c] = accumulate ? outptr[c] + ptr[c] : ptr[c];
+        }
+    }
+}
+
+// C is row-major with row stride ldc
+template<typename T>
+static int sgemm_avx(int M, int N, int K, const float* A, int lda_row, int lda_col, const T* B, int ldb_row, int ldb_col, float* C, int ldc, const Option& opt)
+{
+    // A block stays in L2, B block in L3
+    const int MC = 192;
+    const int KC = 256;
+    const int NC = 2048;
+
+    if (K == 0)
+    {
+        for (int i = 0; i < M; i++)
+        {
+            memset(C + (size_t)i * ldc, 0, N * sizeof(float));
+        }
+
+        return 0;
+    }
+
+    Mat Ap(std::min(MC, (M + 5) / 6 * 6) * std::min(KC, K), 4u, opt.workspace_allocator);
+    Mat Bp(std::min(NC, (N + 15) / 16 * 16) * std::min(KC, K), 4u, opt.workspace_allocator);
+    if (Ap.empty() || Bp.empty())
+        return -100;
+
+    for (int jc = 0; jc < N; jc += NC)
+    {
+        const int nc = std::min(NC, N - jc);
+        const int nn_nr = (nc + 15) / 16;
+
+        for (int pc = 0; pc < K; pc += KC)
+        {
+            const int kc = std::min(KC, K - pc);
+
+            sgemm_pack_b_avx(B, ldb_row, ldb_col, pc, kc, jc, nc, Bp, opt);
+
+            for (int ic = 0; ic < M; ic += MC)
+            {
+                const int mc = std::min(MC, M - ic);
+                const int nn_mr = (mc + 5) / 6;
+
+                sgemm_pack_a_avx(A, lda_row, lda_col, ic, mc, pc, kc, Ap, opt);
+
+                // every micro tile is independent, a few rows still spread over all threads
+                #pragma omp parallel for num_threads(opt.num_threads)
+                for (int t = 0; t < nn_mr * nn_nr; t++)
+                {
+                    const int ii = t % nn_mr;
+                    const int jj = t / nn_mr;
+
+                    const float* pA = (const float*)Ap + ii * 6 * kc;
+                    const float* pB = (const float*)Bp + jj * 16 * kc;
+                    float* pC = C + (size_t)(ic + ii * 6) * ldc + jc + jj * 16;
+
+                    const int mr = std::min(mc - ii * 6, 6);
+                    const int nr = std::min(nc - jj * 16, 16);
+
+                    sgemm_kernel_6x16_avx(kc, pA, pB, pC, ldc, mr, nr, pc > 0);
+                }
+            }
+        }
+    }
+
+    return 0;
+}
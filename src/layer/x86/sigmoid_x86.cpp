@@ -27,40 +27,69 @@ Sigmoid_x86::Sigmoid_x86()
 #if __AVX__
     support_packing = true;
 #endif // __AVX__
+#if __AVX512F__
+    support_packing16 = true;
+#endif // __AVX512F__
 }
 
-int Sigmoid_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+// bottom_blob and top_blob may be the same mat
+static void sigmoid_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt)
 {
-    int w = bottom_top_blob.w;
-    int h = bottom_top_blob.h;
-    int channels = bottom_top_blob.c;
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    int channels = bottom_blob.c;
     int size = w * h;
 
 #if __AVX__
-    int elempack = bottom_top_blob.elempack;
+    int elempack = bottom_blob.elempack;
+
+#if __AVX512F__
+    if (elempack == 16)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < channels; q++)
+        {
+            const float* ptr = bottom_blob.channel(q);
+            float* outptr = top_blob.channel(q);
+
+            for (int i = 0; i < size; i++)
+            {
+                __m512 _p = _mm512_loadu_ps(ptr);
+                _mm512_storeu_ps(outptr, sigmoid_avx512(_p));
+                ptr += 16;
+                outptr += 16;
+            }
+        }
+
+        return;
+    }
+#endif // __AVX512F__
 
     if (elempack == 8)
     {
         #pragma omp parallel for num_threads(opt.num_threads)
         for (int q = 0; q < channels; q++)
         {
-            float* ptr = bottom_top_blob.channel(q);
+            const float* ptr = bottom_blob.channel(q);
+            float* outptr = top_blob.channel(q);
             for (int i = 0; i < size; i++)
             {
                 __m256 _p = _mm256_loadu_ps(ptr);
-                _mm256_storeu_ps(ptr, sigmoid_avx(_p));
+                _mm256_storeu_ps(outptr, sigmoid_avx(_p));
                 ptr += 8;
+                outptr += 8;
             }
         }
 
-        return 0;
+        return;
     }
 #endif // __AVX__
 
     #pragma omp parallel for num_threads(opt.num_threads)
     for (int q = 0; q < channels; q++)
     {
-        float* ptr = bottom_top_blob.channel(q);
+        const float* ptr = bottom_blob.channel(q);
+        float* outptr = top_blob.channel(q);
 
 #if __AVX__
         int nn = size >> 3;
@@ -73,17 +102,35 @@ int Sigmoid_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
         for (; nn > 0; nn--)
         {
             __m256 _p = _mm256_loadu_ps(ptr);
-            _mm256_storeu_ps(ptr, sigmoid_avx(_p));
+            _mm256_storeu_ps(outptr, sigmoid_avx(_p));
             ptr += 8;
+            outptr += 8;
         }
 #endif // __AVX__
         for (; remain > 0; remain--)
         {
-            *ptr = 1.f / (1.f + exp(-*ptr));
+            *outptr = 1.f / (1.f + exp(-*ptr));
 
             ptr++;
+            outptr++;
         }
     }
+}
+
+int Sigmoid_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    top_blob.create_like(bottom_blob, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    sigmoid_x86(bottom_blob, top_blob, opt);
+
+    return 0;
+}
+
+int Sigmoid_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    sigmoid_x86(bottom_top_blob, bottom_top_blob, opt);
 
     return 0;
 }
@@ -0,0 +1,335 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#if __AVX__
+#include "avx_mathfun.h"
+#include "avx_usability.h"
+#endif // __AVX__
+
+#include "softmax_x86.h"
+
+#include <float.h>
+#include <math.h>
+
+namespace ncnn {
+
+Softmax_x86::Softmax_x86()
+{
+#if __AVX__
+    support_packing = true;
+#endif // __AVX__
+}
+
+#if __AVX__
+// softmax over a contiguous run
+static void softmax_avx(float* ptr, int size)
+{
+    __m256 _max = _mm256_set1_ps(-FLT_MAX);
+    float max = -FLT_MAX;
+    int i = 0;
+    for (; i + 7 < size; i += 8)
+    {
+        _max = _mm256_max_ps(_max, _mm256_loadu_ps(ptr + i));
+    }
+    for (; i < size; i++)
+    {
+        max = std::max(max, ptr[i]);
+    }
+    max = std::max(max, _mm256_reduce_max_ps(_max));
+    _max = _mm256_set1_ps(max);
+
+    __m256 _sum = _mm256_setzero_ps();
+    float sum = 0.f;
+    i = 0;
+    for (; i + 7 < size; i += 8)
+    {
+        __m256 _p = exp256_ps(_mm256_sub_ps(_mm256_loadu_ps(ptr + i), _max));
+        _mm256_storeu_ps(ptr + i, _p);
+        _sum = _mm256_add_ps(_sum, _p);
+    }
+    for (; i < size; i++)
+    {
+        ptr[i] = static_cast<float>(exp(ptr[i] - max));
+        sum += ptr[i];
+    }
+    sum += _mm256_reduce_add_ps(_sum);
+
+    __m256 _sum_inv = _mm256_set1_ps(1.f / sum);
+    i = 0;
+    for (; i + 7 < size; i += 8)
+    {
+        _mm256_storeu_ps(ptr + i, _mm256_mul_ps(_mm256_loadu_ps(ptr + i), _sum_inv));
+    }
+    for (; i < size; i++)
+    {
+        ptr[i] /= sum;
+    }
+}
+
+// softmax along a pack8 run, each lane on its own
+static void softmax_pack8_avx(float* ptr, int size)
+{
+    __m256 _max = _mm256_set1_ps(-FLT_MAX);
+    for (int i = 0; i < size; i++)
+    {
+        _max = _mm256_max_ps(_max, _mm256_loadu_ps(ptr + i * 8));
+    }
+
+    __m256 _sum = _mm256_setzero_ps();
+    for (int i = 0; i < size; i++)
+    {
+        __m256 _p = exp256_ps(_mm256_sub_ps(_mm256_loadu_ps(ptr + i * 8), _max));
+        _mm256_storeu_ps(ptr + i * 8, _p);
+        _sum = _mm256_add_ps(_sum, _p);
+    }
+
+    __m256 _sum_inv = _mm256_div_ps(_mm256_set1_ps(1.f), _sum);
+    for (int i = 0; i < size; i++)
+    {
+        _mm256_storeu_ps(ptr + i * 8, _mm256_mul_ps(_mm256_loadu_ps(ptr + i * 8), _sum_inv));
+    }
+}
+
+// softmax across n runs spaced by stride, independently at each of the len floats
+// with elempack 8 the lanes of one element join the same softmax
+// len is at most 128
+static void softmax_across_avx(float* ptr, int n, size_t stride, int len, int elempack)
+{
+    float maxbuf[128];
+    float sumbuf[128];
+
+    int j = 0;
+    for (; j + 7 < len; j += 8)
+    {
+        _mm256_storeu_ps(maxbuf + j, _mm256_set1_ps(-FLT_MAX));
+        _mm256_storeu_ps(sumbuf + j, _mm256_setzero_ps());
+    }
+    for (; j < len; j++)
+    {
+        maxbuf[j] = -FLT_MAX;
+        sumbuf[j] = 0.f;
+    }
+
+    for (int r = 0; r < n; r++)
+    {
+        const float* p = ptr + r * stride;
+
+        j = 0;
+        for (; j + 7 < len; j += 8)
+        {
+            _mm256_storeu_ps(maxbuf + j, _mm256_max_ps(_mm256_loadu_ps(maxbuf + j), _mm256_loadu_ps(p + j)));
+        }
+        for (; j < len; j++)
+        {
+            maxbuf[j] = std::max(maxbuf[j], p[j]);
+        }
+    }
+
+    if (elempack == 8)
+    {
+        for (j = 0; j < len; j += 8)
+        {
+            _mm256_storeu_ps(maxbuf + j, _mm256_set1_ps(_mm256_reduce_max_ps(_mm256_loadu_ps(maxbuf + j))));
+        }
+    }
+
+    for (int r = 0; r < n; r++)
+    {
+        float* p = ptr + r * stride;
+
+        j = 0;
+        for (; j + 7 < len; j += 8)
+        {
+            __m256 _p = exp256_ps(_mm256_sub_ps(_mm256_loadu_ps(p + j), _mm256_loadu_ps(maxbuf + j)));
+            _mm256_storeu_ps(p + j, _p);
+            _mm256_storeu_ps(sumbuf + j, _mm256_add_ps(_mm256_loadu_ps(sumbuf + j), _p));
+        }
+        for (; j < len; j++)
+        {
+            p[j] = static_cast<float>(exp(p[j] - maxbuf[j]));
+            sumbuf[j] += p[j];
+        }
+    }
+
+    if (elempack == 8)
+    {
+        for (j = 0; j < len; j += 8)
+        {
+            _mm256_storeu_ps(sumbuf + j, _mm256_set1_ps(_mm256_reduce_add_ps(_mm256_loadu_ps(sumbuf + j))));
+        }
+    }
+
+    j = 0;
+    for (; j + 7 < len; j += 8)
+    {
+        _mm256_storeu_ps(sumbuf + j, _mm256_div_ps(_mm256_set1_ps(1.f), _mm256_loadu_ps(sumbuf + j)));
+    }
+    for (; j < len; j++)
+    {
+        sumbuf[j] = 1.f / sumbuf[j];
+    }
+
+    for (int r = 0; r < n; r++)
+    {
+        float* p = ptr + r * stride;
+
+        j = 0;
+        for (; j + 7 < len; j += 8)
+        {
+            _mm256_storeu_ps(p + j, _mm256_mul_ps(_mm256_loadu_ps(p + j), _mm256_loadu_ps(sumbuf + j)));
+        }
+        for (; j < len; j++)
+        {
+            p[j] *= sumbuf[j];
+        }
+    }
+}
+#endif // __AVX__
+
+int Softmax_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+#if __AVX__
+    int dims = bottom_top_blob.dims;
+    int elempack = bottom_top_blob.elempack;
+
+    if (dims == 1) // axis == 0
+    {
+        int w = bottom_top_blob.w;
+
+        float* ptr = bottom_top_blob;
+
+        softmax_avx(ptr, w * elempack);
+
+        return 0;
+    }
+
+    if (dims == 2 && axis == 0)
+    {
+        int w = bottom_top_blob.w;
+        int h = bottom_top_blob.h;
+
+        // split columns into tiles of 16 so the running max and sum stay in l1
+        const int nn_w = (w + 15) / 16;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int ii = 0; ii < nn_w; ii++)
+        {
+            const int j = ii * 16;
+            const int len = std::min(16, w - j) * elempack;
+
+            float* ptr = (float*)bottom_top_blob + j * elempack;
+
+            softmax_across_avx(ptr, h, (size_t)w * elempack, len, elempack);
+        }
+
+        return 0;
+    }
+
+    if (dims == 2 && axis == 1)
+    {
+        int w = bottom_top_blob.w;
+        int h = bottom_top_blob.h;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int i = 0; i < h; i++)
+        {
+            float* ptr = bottom_top_blob.row(i);
+
+            if (elempack == 8)
+                softmax_pack8_avx(ptr, w);
+            else
+                softmax_avx(ptr, w);
+        }
+
+        return 0;
+    }
+
+    if (dims == 3 && axis == 0)
+    {
+        int w = bottom_top_blob.w;
+        int h = bottom_top_blob.h;
+        int channels = bottom_top_blob.c;
+        int size = w * h;
+
+        const int nn_size = (size + 15) / 16;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int ii = 0; ii < nn_size; ii++)
+        {
+            const int i = ii * 16;
+            const int len = std::min(16, size - i) * elempack;
+
+            float* ptr = (float*)bottom_top_blob + i * elempack;
+
+            softmax_across_avx(ptr, channels, bottom_top_blob.cstep * elempack, len, elempack);
+        }
+
+        return 0;
+    }
+
+    if (dims == 3 && axis == 1)
+    {
+        int w = bottom_top_blob.w;
+        int h = bottom_top_blob.h;
+        int channels = bottom_top_blob.c;
+
+        // lanes are separate channels here, no folding
+        const int wp = w * elempack;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < channels; q++)
+        {
+            float* ptr = bottom_top_blob.channel(q);
+
+            for (int j = 0; j < wp; j += 128)
+            {
+                softmax_across_avx(ptr + j, h, wp, std::min(128, wp - j), 1);
+            }
+        }
+
+        return 0;
+    }
+
+    if (dims == 3 && axis == 2)
+    {
+        int w = bottom_top_blob.w;
+        int h = bottom_top_blob.h;
+        int channels = bottom_top_blob.c;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < channels; q++)
+        {
+            float* ptr = bottom_top_blob.channel(q);
+
+            for (int i = 0; i < h; i++)
+            {
+                if (elempack == 8)
+                    softmax_pack8_avx(ptr, w);
+                else
+                    softmax_avx(ptr, w);
+
+                ptr += w * elempack;
+            }
+        }
+
+        return 0;
+    }
+
+    return 0;
+#else
+    return Softmax::forward_inplace(bottom_top_blob, opt);
+#endif // __AVX__
+}
+
+} // namespace ncnn
@@ -24,6 +24,8 @@ class Swish_x86 : virtual public Swish
 public:
     Swish_x86();
 
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
     virtual int forward_inplace(Mat& bottom_top_blob, const Option& opt) const;
 };
 
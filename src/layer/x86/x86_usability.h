@@ -0,0 +1,76 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef X86_USABILITY_H
+#define X86_USABILITY_H
+
+#include "mat.h"
+#include "option.h"
+
+namespace ncnn {
+
+// run the reference forward of T on a packed blob, the reference path indexes unpacked channels
+// T is the base layer class, called non-virtually so the x86 override is not entered again
+template<typename T>
+static int forward_inplace_unpacked(const T* layer, Mat& bottom_top_blob, const Option& opt)
+{
+    int elempack = bottom_top_blob.elempack;
+
+    Option opt_unpack = opt;
+    opt_unpack.blob_allocator = opt.workspace_allocator;
+
+    Mat bottom_top_blob_unpacked;
+    convert_packing(bottom_top_blob, bottom_top_blob_unpacked, 1, opt_unpack);
+    if (bottom_top_blob_unpacked.empty())
+        return -100;
+
+    int ret = layer->T::forward_inplace(bottom_top_blob_unpacked, opt_unpack);
+    if (ret != 0)
+        return ret;
+
+    convert_packing(bottom_top_blob_unpacked, bottom_top_blob, elempack, opt);
+    if (bottom_top_blob.empty())
+        return -100;
+
+    return 0;
+}
+
+template<typename T>
+static int forward_unpacked(const T* layer, const Mat& bottom_blob, Mat& top_blob, const Option& opt)
+{
+    int elempack = bottom_blob.elempack;
+
+    Option opt_unpack = opt;
+    opt_unpack.blob_allocator = opt.workspace_allocator;
+
+    Mat bottom_blob_unpacked;
+    convert_packing(bottom_blob, bottom_blob_unpacked, 1, opt_unpack);
+    if (bottom_blob_unpacked.empty())
+        return -100;
+
+    Mat top_blob_unpacked;
+    int ret = layer->T::forward(bottom_blob_unpacked, top_blob_unpacked, opt_unpack);
+    if (ret != 0)
+        return ret;
+
+    convert_packing(top_blob_unpacked, top_blob, elempack, opt);
+    if (top_blob.empty())
+        return -100;
+
+    return 0;
+}
+
+} // namespace ncnn
+
+#endif // X86_USABILITY_H
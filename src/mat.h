@@ -97,6 +97,9 @@ public:
     void fill(__m256 _v);
     void fill(__m128i _v);
 #endif // __AVX__
+#if __AVX512F__
+    void fill(__m512 _v);
+#endif // __AVX512F__
     template<typename T>
     void fill(T v);
     // deep copy
@@ -941,6 +944,18 @@ inline void Mat::fill(__m128i _v)
     }
 }
 #endif // __AVX__
+#if __AVX512F__
+inline void Mat::fill(__m512 _v)
+{
+    int size = total();
+    float* ptr = (float*)data;
+    for (int i = 0; i < size; i++)
+    {
+        _mm512_storeu_ps(ptr, _v);
+        ptr += 16;
+    }
+}
+#endif // __AVX512F__
 
 template<typename T>
 inline void Mat::fill(T _v)
@@ -93,6 +93,14 @@ Mat ModelBinFromDataReader::load(int w, int type) const
         {
             // int8 data
             size_t align_data_size = alignSize(w, 4);
+
+            const void* refbuf = 0;
+            nread = dr.reference(align_data_size, &refbuf);
+            if (nread == align_data_size)
+            {
+                return Mat(w, (void*)refbuf, (size_t)1u);
+            }
+
             std::vector<signed char> int8_weights;
             int8_weights.resize(align_data_size);
             nread = dr.read(int8_weights.data(), align_data_size);
@@ -112,6 +120,13 @@ Mat ModelBinFromDataReader::load(int w, int type) const
         }
         else if (flag_struct.tag == 0x0002C056)
         {
+            const void* refbuf = 0;
+            nread = dr.reference(w * sizeof(float), &refbuf);
+            if (nread == w * sizeof(float))
+            {
+                return Mat(w, (void*)refbuf);
+            }
+
             Mat m(w);
             if (m.empty())
                 return m;
@@ -127,6 +142,17 @@ Mat ModelBinFromDataReader::load(int w, int type) const
             return m;
         }
 
+        if (flag == 0 && flag_struct.f0 == 0)
+        {
+            // raw data, reference in place if possible
+            const void* refbuf = 0;
+            nread = dr.reference(w * sizeof(float), &refbuf);
+            if (nread == w * sizeof(float))
+            {
+                return Mat(w, (void*)refbuf);
+            }
+        }
+
         Mat m(w);
         if (m.empty())
             return m;
@@ -173,6 +199,14 @@ Mat ModelBinFromDataReader::load(int w, int type) const
     }
     else if (type == 1)
     {
+        // raw data, reference in place if possible
+        const void* refbuf = 0;
+        size_t nref = dr.reference(w * sizeof(float), &refbuf);
+        if (nref == w * sizeof(float))
+        {
+            return Mat(w, (void*)refbuf);
+        }
+
         Mat m(w);
         if (m.empty())
             return m;
@@ -14,23 +14,31 @@
 
 #include "net.h"
 
+#include "autotune.h"
+#include "batchnorm.h"
+#include "benchmark.h"
+#include "bias.h"
+#include "clip.h"
 #include "convolution.h"
 #include "convolutiondepthwise.h"
 #include "cpu.h"
 #include "datareader.h"
+#include "hardswish.h"
+#include "innerproduct.h"
+#include "input.h"
 #include "layer_type.h"
 #include "modelbin.h"
 #include "paramdict.h"
+#include "profiler.h"
 #include "relu.h"
+#include "scale.h"
+#include "weightbudget.h"
 
+#include <algorithm>
 #include <stdarg.h>
 #include <stdint.h>
 #include <string.h>
 
-#if NCNN_BENCHMARK
-#include "benchmark.h"
-#endif // NCNN_BENCHMARK
-
 #if NCNN_VULKAN
 #include "command.h"
 #include "pipelinecache.h"
@@ -38,8 +46,163 @@
 
 namespace ncnn {
 
+#if NCNN_STDIO
+#define PREPACKED_CACHE_MAGIC 0x5750434e // NCPW
+#define PREPACKED_CACHE_ALIGN 64
+// bump when the file format or any layer weight transform changes
+#define PREPACKED_CACHE_VERSION 3
+
+// options that affect weight transform in create_pipeline
+static int get_prepacked_option_key(const Option& opt)
+{
+    int key = 0;
+    if (opt.use_winograd_convolution) key |= 1 << 0;
+    if (opt.use_sgemm_convolution) key |= 1 << 1;
+    if (opt.use_int8_inference) key |= 1 << 2;
+    if (opt.use_packing_layout) key |= 1 << 3;
+    if (opt.use_fp16_packed) key |= 1 << 4;
+    if (opt.use_fp16_storage) key |= 1 << 5;
+    if (opt.use_fp16_arithmetic) key |= 1 << 6;
+    if (opt.use_int8_storage) key |= 1 << 7;
+    if (opt.use_int8_arithmetic) key |= 1 << 8;
+    if (opt.use_bf16_storage) key |= 1 << 9;
+    if (opt.use_weight_fp16_storage) key |= 1 << 10;
+    if (opt.use_layer_fusion) key |= 1 << 11;
+    if (opt.use_conv_autotune) key |= 1 << 12;
+    if (opt.use_mmap_mtime_key) key |= 1 << 13;
+    return key;
+}
+
+// murmur3 mixing over 32bit words, bytes of an unaligned tail are mixed one by one
+static unsigned int hash_model_data(unsigned int h, const unsigned char* p, size_t size)
+{
+    size_t i = 0;
+    for (; i + 3 < size; i += 4)
+    {
+        unsigned int k;
+        memcpy(&k, p + i, 4);
+
+        k *= 0xcc9e2d51;
+        k = (k << 15) | (k >> 17);
+        k *= 0x1b873593;
+
+        h ^= k;
+        h = (h << 13) | (h >> 19);
+        h = h * 5 + 0xe6546b64;
+    }
+    for (; i < size; i++)
+    {
+        h ^= p[i];
+        h *= 0x01000193;
+    }
+    return h;
+}
+
+// hash all model data read through it
+// a prepacked cache saved from other weights with the same layer shapes is detected by the hash
+// referenced data is only counted if hash_reference is off, the caller hashes a mapped file in one go when needed
+class DataReaderWithHash : public DataReader
+{
+public:
+    DataReaderWithHash(const DataReader& _dr, bool _hash_reference)
+        : dr(_dr), hash_reference(_hash_reference), hash(0), size(0)
+    {
+    }
+
+#if NCNN_STRING
+    virtual int scan(const char* format, void* p) const
+    {
+        return dr.scan(format, p);
+    }
+#endif // NCNN_STRING
+
+    virtual size_t read(void* buf, size_t _size) const
+    {
+        size_t nread = dr.read(buf, _size);
+        hash = hash_model_data(hash, (const unsigned char*)buf, nread);
+        size += nread;
+        return nread;
+    }
+
+    virtual size_t reference(size_t _size, const void** buf) const
+    {
+        size_t nref = dr.reference(_size, buf);
+        if (nref)
+        {
+            if (hash_reference)
+                hash = hash_model_data(hash, (const unsigned char*)*buf, nref);
+            size += nref;
+        }
+        return nref;
+    }
+
+public:
+    const DataReader& dr;
+    bool hash_reference;
+    mutable unsigned int hash;
+    mutable size_t size;
+};
+#endif // NCNN_STDIO
+
+// extractors specialized for one input shape
+// blob and workspace pools keep the buffers sized for this shape between requests
+// with use_conv_autotune the convolution kernels are measured on the first forward of the shape and kept here
+class ShapeBucket
+{
+public:
+    ShapeBucket(const Mat& shape)
+        : dims(shape.dims), w(shape.w), h(shape.h), c(shape.c), elempack(shape.elempack), in_use(0)
+    {
+    }
+
+    ~ShapeBucket()
+    {
+        // extractors release their blobs into the pools
+        for (size_t i = 0; i < idle.size(); i++)
+        {
+            delete idle[i];
+        }
+        idle.clear();
+    }
+
+    bool match(const Mat& shape) const
+    {
+        return dims == shape.dims && w == shape.w && h == shape.h && c == shape.c && elempack == shape.elempack;
+    }
+
+public:
+    int dims;
+    int w;
+    int h;
+    int c;
+    int elempack;
+
+    PoolAllocator blob_allocator;
+    PoolAllocator workspace_allocator;
+
+    // kernel choices for this shape, seeded from the net autotune cache
+    AutotuneCache kernels;
+
+    std::vector<Extractor*> idle;
+    int in_use;
+};
+
 Net::Net()
 {
+    shape_cache_capacity = 8;
+    cast_layer_count = 0;
+    autotune_cache = 0;
+    weight_budget = 0;
+#if NCNN_STDIO
+    model_mmap = 0;
+    prepacked_mmap = 0;
+    prepacked_option_key = 0;
+    prepacked_model_hash = 0;
+    prepacked_model_size = 0;
+    model_hash = 0;
+    model_size = 0;
+    model_hash_deferred = false;
+#endif // NCNN_STDIO
 #if NCNN_VULKAN
     vkdev = 0;
     weight_vkallocator = 0;
@@ -228,7 +391,17 @@ int Net::load_param(const DataReader& dr)
             char bottom_name[256];
             SCAN_VALUE("%255s", bottom_name)
 
-            int bottom_blob_index = find_blob_index_by_name(bottom_name);
+            // bottoms are mostly produced by recent layers, search backwards
+            // over the blobs created so far, and stay quiet if not found
+            int bottom_blob_index = -1;
+            for (int k = blob_index - 1; k >= 0; k--)
+            {
+                if (blobs[k].name == bottom_name)
+                {
+                    bottom_blob_index = k;
+                    break;
+                }
+            }
             if (bottom_blob_index == -1)
             {
                 Blob& blob = blobs[blob_index];
@@ -330,6 +503,11 @@ int Net::load_param(const DataReader& dr)
 #endif // NCNN_STRING
 
 int Net::load_param_bin(const DataReader& dr)
+{
+    return load_param_bin(dr, 0);
+}
+
+int Net::load_param_bin(const DataReader& dr, int reference_array)
 {
 #define READ_VALUE(buf)                            \
     if (dr.read(&buf, sizeof(buf)) != sizeof(buf)) \
@@ -465,7 +643,7 @@ int Net::load_param_bin(const DataReader& dr)
         }
 
         // layer specific params
-        int pdlr = pd.load_param_bin(dr);
+        int pdlr = pd.load_param_bin(dr, reference_array);
         if (pdlr != 0)
         {
             NCNN_LOGE("ParamDict load_param failed");
@@ -534,10 +712,20 @@ int Net::load_model(const DataReader& dr)
         return -1;
     }
 
+    // plan the storage precision again on reload
+    strip_storage_precision();
+
     // load file
     int ret = 0;
 
+#if NCNN_STDIO
+    // hashing mapped weight data while loading would page in the whole file
+    const bool mapped = model_mmap && &dr == model_mmap;
+    DataReaderWithHash drh(dr, !mapped);
+    ModelBinFromDataReader mb(drh);
+#else
     ModelBinFromDataReader mb(dr);
+#endif // NCNN_STDIO
     for (size_t i = 0; i < layers.size(); i++)
     {
         Layer* layer = layers[i];
@@ -568,7 +756,39 @@ int Net::load_model(const DataReader& dr)
         }
     }
 
-    fuse_network();
+#if NCNN_STDIO
+    model_hash = drh.hash;
+    model_size = drh.size;
+    model_hash_deferred = false;
+    if (mapped && opt.use_mmap_mtime_key)
+    {
+        long long mtime = model_mmap->mtime();
+        model_hash = hash_model_data(0, (const unsigned char*)&mtime, sizeof(mtime));
+    }
+    else if (mapped && !prepacked_weights.empty())
+    {
+        // the model data was read front to back in 4 byte multiples, one pass gives the same hash
+        model_hash = hash_model_data(0, model_mmap->mapped_data(), model_size);
+    }
+    else if (mapped)
+    {
+        // hashed by save_prepacked_cache if ever needed
+        model_hash_deferred = true;
+    }
+#endif // NCNN_STDIO
+
+    if (ret == 0)
+    {
+        if (fuse_network() != 0 || plan_storage_precision(layer_fp32) != 0)
+            ret = -1;
+    }
+
+    if (opt.use_conv_autotune && !opt.autotune_cache)
+    {
+        if (!autotune_cache)
+            autotune_cache = new AutotuneCache;
+        opt.autotune_cache = autotune_cache;
+    }
 
 #if NCNN_VULKAN
     if (opt.use_vulkan_compute)
@@ -584,27 +804,41 @@ int Net::load_model(const DataReader& dr)
     }
 #endif // NCNN_VULKAN
 
-    for (size_t i = 0; i < layers.size(); i++)
+#if NCNN_STDIO
+    if (!prepacked_weights.empty() && (opt.use_vulkan_compute || prepacked_option_key != get_prepacked_option_key(opt)))
     {
-        Layer* layer = layers[i];
+        NCNN_LOGE("prepacked cache option mismatch, ignored");
+        prepacked_weights.clear();
+    }
+
+    if (!prepacked_weights.empty() && (prepacked_model_hash != model_hash || prepacked_model_size != model_size))
+    {
+        NCNN_LOGE("prepacked cache model weight mismatch, ignored");
+        prepacked_weights.clear();
+    }
+#endif // NCNN_STDIO
+
+    // pipelines are created on first forward in lazy mode
+    const bool lazy = opt.use_lazy_pipeline && !opt.use_vulkan_compute;
+    if (lazy && ret == 0)
+    {
+        pipeline_created.assign(layers.size(), 0);
+        pipeline_users.assign(layers.size(), 0);
+        pipeline_bytes.assign(layers.size(), 0);
+        weight_budget = opt.weight_budget;
+    }
 
+    for (size_t i = 0; i < layers.size() && !lazy; i++)
+    {
         //Here we found inconsistent content in the parameter file.
-        if (!layer)
+        if (!layers[i])
         {
             NCNN_LOGE("load_model error at layer %d, parameter file has inconsistent content.", (int)i);
             ret = -1;
             break;
         }
 
-        Option opt1 = opt;
-#if NCNN_VULKAN
-        if (opt.use_vulkan_compute)
-        {
-            if (!layer->support_image_storage) opt1.use_image_storage = false;
-        }
-#endif // NCNN_VULKAN
-
-        int cret = layer->create_pipeline(opt1);
+        int cret = create_layer_pipeline(i);
         if (cret != 0)
         {
             NCNN_LOGE("layer create_pipeline %d failed", (int)i);
@@ -613,6 +847,13 @@ int Net::load_model(const DataReader& dr)
         }
     }
 
+#if NCNN_STDIO
+    // layers keep referencing the mapped data, drop our handles only
+    // lazy layers still need them on first forward
+    if (!lazy)
+        prepacked_weights.clear();
+#endif // NCNN_STDIO
+
 #if NCNN_VULKAN
     if (opt.use_vulkan_compute)
     {
@@ -694,6 +935,318 @@ int Net::load_model(const char* modelpath)
     fclose(fp);
     return ret;
 }
+
+int Net::load_model_mmap(const char* modelpath)
+{
+    DataReaderFromMmap* dr = new DataReaderFromMmap(modelpath);
+    if (dr->empty())
+    {
+        delete dr;
+        return -1;
+    }
+
+    // layers keep referencing the previous mapping until they load from the new one
+    DataReaderFromMmap* previous_mmap = model_mmap;
+    model_mmap = dr;
+
+    int ret = load_model(*dr);
+    if (ret != 0)
+    {
+        // layers before the failing one moved to the new mapping, the others did not
+        if (previous_mmap)
+            stale_model_mmaps.push_back(previous_mmap);
+
+        return ret;
+    }
+
+    delete previous_mmap;
+
+    return 0;
+}
+
+int Net::save_prepacked_cache(const char* path) const
+{
+    if (layers.empty())
+    {
+        NCNN_LOGE("network graph not ready");
+        return -1;
+    }
+
+    FILE* fp = fopen(path, "wb");
+    if (!fp)
+    {
+        NCNN_LOGE("fopen %s failed", path);
+        return -1;
+    }
+
+#define WRITE_VALUE(v)                           \
+    if (fwrite(&v, sizeof(v), 1, fp) != 1)       \
+    {                                            \
+        NCNN_LOGE("write " #v " failed");        \
+        fclose(fp);                              \
+        return -1;                               \
+    }
+
+    int magic = PREPACKED_CACHE_MAGIC;
+    int version = PREPACKED_CACHE_VERSION;
+    int cpu_key = get_cpu_isa_key();
+    int option_key = get_prepacked_option_key(opt);
+    // cast layers from precision planning are rebuilt on load
+    int layer_count = (int)layers.size() - cast_layer_count;
+    unsigned int hash = model_hash_deferred ? hash_model_data(0, model_mmap->mapped_data(), model_size) : model_hash;
+    WRITE_VALUE(magic)
+    WRITE_VALUE(version)
+    WRITE_VALUE(cpu_key)
+    WRITE_VALUE(option_key)
+    WRITE_VALUE(layer_count)
+    WRITE_VALUE(hash)
+    WRITE_VALUE(model_size)
+
+    for (int i = 0; i < layer_count; i++)
+    {
+        const Layer* layer = layers[i];
+
+        std::vector<Mat> weights;
+        if (layer->get_prepacked_weights(weights) != 0)
+            continue;
+
+        int typeindex = layer->typeindex;
+        int weight_count = (int)weights.size();
+        WRITE_VALUE(i)
+        WRITE_VALUE(typeindex)
+        WRITE_VALUE(weight_count)
+
+        for (int j = 0; j < weight_count; j++)
+        {
+            const Mat& m = weights[j];
+
+            int dims = m.dims;
+            int w = m.w;
+            int h = m.h;
+            int c = m.c;
+            int elemsize = (int)m.elemsize;
+            int elempack = m.elempack;
+            int cstep = (int)m.cstep;
+            WRITE_VALUE(dims)
+            WRITE_VALUE(w)
+            WRITE_VALUE(h)
+            WRITE_VALUE(c)
+            WRITE_VALUE(elemsize)
+            WRITE_VALUE(elempack)
+            WRITE_VALUE(cstep)
+
+            if (dims == 0)
+                continue;
+
+            // align weight data for in place reference
+            static const unsigned char zeros[PREPACKED_CACHE_ALIGN] = {0};
+            int pad = (int)(alignSize(ftell(fp) + sizeof(int), PREPACKED_CACHE_ALIGN) - ftell(fp) - sizeof(int));
+            WRITE_VALUE(pad)
+            if (pad > 0 && fwrite(zeros, 1, pad, fp) != (size_t)pad)
+            {
+                NCNN_LOGE("write pad failed");
+                fclose(fp);
+                return -1;
+            }
+
+            size_t size = m.total() * m.elemsize;
+            if (fwrite(m.data, 1, size, fp) != size)
+            {
+                NCNN_LOGE("write weight data failed");
+                fclose(fp);
+                return -1;
+            }
+        }
+    }
+
+    int end = -1;
+    WRITE_VALUE(end)
+
+#undef WRITE_VALUE
+
+    fclose(fp);
+    return 0;
+}
+
+int Net::load_autotune_cache(const char* path)
+{
+    if (!opt.autotune_cache)
+    {
+        if (!autotune_cache)
+            autotune_cache = new AutotuneCache;
+        opt.autotune_cache = autotune_cache;
+    }
+
+    return opt.autotune_cache->load(path);
+}
+
+int Net::save_autotune_cache(const char* path) const
+{
+    if (!opt.autotune_cache)
+    {
+        NCNN_LOGE("no autotune cache");
+        return -1;
+    }
+
+    return opt.autotune_cache->save(path);
+}
+
+int Net::load_prepacked_cache(const char* path)
+{
+    if (layers.empty())
+    {
+        NCNN_LOGE("network graph not ready");
+        return -1;
+    }
+
+    DataReaderFromMmap* dr = new DataReaderFromMmap(path);
+    if (dr->empty())
+    {
+        delete dr;
+        return -1;
+    }
+
+#define READ_VALUE(buf)                             \
+    if (dr->read(&buf, sizeof(buf)) != sizeof(buf)) \
+    {                                               \
+        NCNN_LOGE("read " #buf " failed");          \
+        delete dr;                                  \
+        return -1;                                  \
+    }
+
+    int magic = 0;
+    int version = 0;
+    int cpu_key = 0;
+    int option_key = 0;
+    int layer_count = 0;
+    unsigned int cache_model_hash = 0;
+    size_t cache_model_size = 0;
+    READ_VALUE(magic)
+    if (magic != PREPACKED_CACHE_MAGIC)
+    {
+        NCNN_LOGE("prepacked cache bad magic");
+        delete dr;
+        return -1;
+    }
+
+    READ_VALUE(version)
+    READ_VALUE(cpu_key)
+    READ_VALUE(option_key)
+    READ_VALUE(layer_count)
+    READ_VALUE(cache_model_hash)
+    READ_VALUE(cache_model_size)
+
+    if (version != PREPACKED_CACHE_VERSION)
+    {
+        NCNN_LOGE("prepacked cache version %d mismatch", version);
+        delete dr;
+        return -1;
+    }
+
+    if (layer_count != (int)layers.size())
+    {
+        NCNN_LOGE("prepacked cache does not match network");
+        delete dr;
+        return -1;
+    }
+
+    if (cpu_key != get_cpu_isa_key())
+    {
+        NCNN_LOGE("prepacked cache does not match cpu");
+        delete dr;
+        return -1;
+    }
+
+    std::vector<std::vector<Mat> > weights_all(layer_count);
+
+    for (;;)
+    {
+        int layer_index = -1;
+        READ_VALUE(layer_index)
+        if (layer_index == -1)
+            break;
+
+        int typeindex = 0;
+        int weight_count = 0;
+        READ_VALUE(typeindex)
+        READ_VALUE(weight_count)
+
+        if (layer_index < 0 || layer_index >= layer_count || layers[layer_index]->typeindex != typeindex || weight_count < 0)
+        {
+            NCNN_LOGE("prepacked cache does not match network");
+            delete dr;
+            return -1;
+        }
+
+        std::vector<Mat>& weights = weights_all[layer_index];
+        weights.resize(weight_count);
+
+        for (int j = 0; j < weight_count; j++)
+        {
+            int dims = 0;
+            int w = 0;
+            int h = 0;
+            int c = 0;
+            int elemsize = 0;
+            int elempack = 0;
+            int cstep = 0;
+            READ_VALUE(dims)
+            READ_VALUE(w)
+            READ_VALUE(h)
+            READ_VALUE(c)
+            READ_VALUE(elemsize)
+            READ_VALUE(elempack)
+            READ_VALUE(cstep)
+
+            if (dims == 0)
+                continue;
+
+            int pad = 0;
+            READ_VALUE(pad)
+
+            const void* refbuf = 0;
+            if (pad > 0 && dr->reference(pad, &refbuf) != (size_t)pad)
+            {
+                NCNN_LOGE("read pad failed");
+                delete dr;
+                return -1;
+            }
+
+            size_t size = (size_t)cstep * c * elemsize;
+            if (dr->reference(size, &refbuf) != size)
+            {
+                NCNN_LOGE("read weight data failed");
+                delete dr;
+                return -1;
+            }
+
+            Mat m;
+            if (dims == 1) m = Mat(w, (void*)refbuf, (size_t)elemsize, elempack);
+            if (dims == 2) m = Mat(w, h, (void*)refbuf, (size_t)elemsize, elempack);
+            if (dims == 3) m = Mat(w, h, c, (void*)refbuf, (size_t)elemsize, elempack);
+
+            if ((int)m.cstep != cstep)
+            {
+                NCNN_LOGE("prepacked cache weight layout mismatch");
+                delete dr;
+                return -1;
+            }
+
+            weights[j] = m;
+        }
+    }
+
+#undef READ_VALUE
+
+    delete prepacked_mmap;
+    prepacked_mmap = dr;
+    prepacked_option_key = option_key;
+    prepacked_model_hash = cache_model_hash;
+    prepacked_model_size = cache_model_size;
+    prepacked_weights.swap(weights_all);
+
+    return 0;
+}
 #endif // NCNN_STDIO
 
 int Net::load_param(const unsigned char* _mem)
@@ -704,6 +1257,14 @@ int Net::load_param(const unsigned char* _mem)
     return static_cast<int>(mem - _mem);
 }
 
+int Net::load_param_reference(const unsigned char* _mem)
+{
+    const unsigned char* mem = _mem;
+    DataReaderFromMemory dr(mem);
+    load_param_bin(dr, 1);
+    return static_cast<int>(mem - _mem);
+}
+
 int Net::load_model(const unsigned char* _mem)
 {
     const unsigned char* mem = _mem;
@@ -776,13 +1337,276 @@ int Net::load_model(AAssetManager* mgr, const char* assetpath)
 }
 #endif // __ANDROID_API__ >= 9
 
-int Net::fuse_network()
+// weights may live in a read-only mapped model, take a private copy before modifying
+static void make_writable(Mat& m)
 {
-    // set the int8 op fusion:requantize
-#if NCNN_STRING && NCNN_REQUANT
-    // NCNN_LOGE("Test op fusion to int8 implement:");
-    // parse the network whether is a quantization model
-    bool net_quantized = false;
+    if (!m.empty() && m.refcount == 0)
+        m = m.clone();
+}
+
+// fold per-channel affine y = x * b + a into weight and bias
+template<typename T>
+static int fuse_affine(T* op, const std::vector<float>& a, const std::vector<float>& b)
+{
+    const int channels = op->num_output;
+    const int weight_per_outch = op->weight_data_size / channels;
+
+    make_writable(op->weight_data);
+    if (op->weight_data.empty())
+        return -100;
+
+    if (op->bias_term == 0)
+    {
+        op->bias_data.create(channels);
+        if (op->bias_data.empty())
+            return -100;
+
+        op->bias_data.fill(0.f);
+        op->bias_term = 1;
+    }
+    else
+    {
+        make_writable(op->bias_data);
+        if (op->bias_data.empty())
+            return -100;
+    }
+
+    float* weight = op->weight_data;
+    float* bias = op->bias_data;
+    for (int i = 0; i < channels; i++)
+    {
+        float* conv_weight_outch = weight + weight_per_outch * i;
+        for (int j = 0; j < weight_per_outch; j++)
+        {
+            conv_weight_outch[j] *= b[i];
+        }
+
+        bias[i] = bias[i] * b[i] + a[i];
+    }
+
+    return 0;
+}
+
+// express batchnorm scale and bias of channels as y = x * b + a
+// return false if next is none of them
+static bool get_affine(const Layer* next, int channels, std::vector<float>& a, std::vector<float>& b)
+{
+    a.assign(channels, 0.f);
+    b.assign(channels, 1.f);
+
+    if (next->typeindex == LayerType::BatchNorm)
+    {
+        const BatchNorm* batchnorm = (const BatchNorm*)next;
+        if (batchnorm->channels != channels)
+            return false;
+
+        for (int i = 0; i < channels; i++)
+        {
+            float sqrt_var = static_cast<float>(sqrt(batchnorm->var_data[i] + batchnorm->eps));
+            b[i] = batchnorm->slope_data[i] / sqrt_var;
+            a[i] = batchnorm->bias_data[i] - batchnorm->slope_data[i] * batchnorm->mean_data[i] / sqrt_var;
+        }
+
+        return true;
+    }
+
+    if (next->typeindex == LayerType::Scale)
+    {
+        const Scale* scale = (const Scale*)next;
+        if (next->bottoms.size() != 1 || scale->scale_data_size != channels)
+            return false;
+
+        for (int i = 0; i < channels; i++)
+        {
+            b[i] = scale->scale_data[i];
+            a[i] = scale->bias_term ? scale->bias_data[i] : 0.f;
+        }
+
+        return true;
+    }
+
+    if (next->typeindex == LayerType::Bias)
+    {
+        const Bias* bias = (const Bias*)next;
+        if (bias->bias_data_size != channels)
+            return false;
+
+        for (int i = 0; i < channels; i++)
+        {
+            a[i] = bias->bias_data[i];
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+// translate an activation layer into the fused activation_type and activation_params
+// return false if next can not be fused
+static bool get_activation(const Layer* next, const Option& opt, int& activation_type, Mat& activation_params)
+{
+    if (next->typeindex == LayerType::ReLU)
+    {
+        const ReLU* relu = (const ReLU*)next;
+        if (relu->slope == 0.f)
+        {
+            activation_type = 1;
+        }
+        else
+        {
+            activation_type = 2;
+            activation_params = Mat(1);
+            activation_params[0] = relu->slope;
+        }
+
+        return true;
+    }
+
+    if (next->typeindex == LayerType::Clip)
+    {
+        const Clip* clip = (const Clip*)next;
+
+        activation_type = 3;
+        activation_params = Mat(2);
+        activation_params[0] = clip->min;
+        activation_params[1] = clip->max;
+
+        return true;
+    }
+
+    if (next->typeindex == LayerType::Sigmoid)
+    {
+        activation_type = 4;
+        return true;
+    }
+
+    if (next->typeindex == LayerType::Mish)
+    {
+        activation_type = 5;
+        return true;
+    }
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+    // only the generic and x86 kernels know hardswish
+    if (next->typeindex == LayerType::HardSwish && !opt.use_vulkan_compute)
+    {
+        const HardSwish* hardswish = (const HardSwish*)next;
+
+        activation_type = 6;
+        activation_params = Mat(2);
+        activation_params[0] = hardswish->alpha;
+        activation_params[1] = hardswish->beta;
+
+        return true;
+    }
+#else
+    (void)opt;
+#endif
+
+    return false;
+}
+
+template<typename T>
+static bool fuse_activation(T* op, const Layer* next, const Option& opt)
+{
+    if (op->activation_type != 0)
+        return false;
+
+    return get_activation(next, opt, op->activation_type, op->activation_params);
+}
+
+// move the top blob of layer j onto layer i, layer j becomes unreachable
+static void fuse_layer_pair(std::vector<Layer*>& layers, std::vector<Blob>& blobs, int i, int j)
+{
+    int mid = layers[i]->tops[0];
+    int top = layers[j]->tops[0];
+
+    layers[i]->tops[0] = top;
+    blobs[top].producer = i;
+
+    blobs[mid].producer = -1;
+    blobs[mid].consumers.clear();
+}
+
+// absorb the layers following op for as long as its output has a single fusable consumer
+template<typename T>
+static int fuse_forward_chain(T* op, int i, std::vector<Layer*>& layers, std::vector<Blob>& blobs, const Option& opt)
+{
+    if (op->int8_scale_term != 0 || op->weight_data.elemsize != 4u || op->num_output <= 0 || op->weight_data_size % op->num_output != 0)
+        return 0;
+
+    for (;;)
+    {
+        if (op->tops.size() != 1 || blobs[op->tops[0]].consumers.size() != 1)
+            break;
+
+        int j = blobs[op->tops[0]].consumers[0];
+        const Layer* next = layers[j];
+
+        bool fused = false;
+        if (next->bottoms.size() == 1 && next->tops.size() == 1)
+        {
+            std::vector<float> a;
+            std::vector<float> b;
+            if (op->activation_type == 0 && get_affine(next, op->num_output, a, b))
+            {
+                int ret = fuse_affine(op, a, b);
+                if (ret != 0)
+                    return ret;
+
+                fused = true;
+            }
+            else
+            {
+                fused = fuse_activation(op, next, opt);
+            }
+        }
+
+        if (!fused)
+            break;
+
+        fuse_layer_pair(layers, blobs, i, j);
+    }
+
+    return 0;
+}
+
+int Net::fuse_layers()
+{
+    for (int i = 0; i < (int)layers.size(); i++)
+    {
+        Layer* layer = layers[i];
+
+        int ret = 0;
+        if (layer->typeindex == LayerType::Convolution)
+            ret = fuse_forward_chain((Convolution*)layer, i, layers, blobs, opt);
+        else if (layer->typeindex == LayerType::ConvolutionDepthWise)
+            ret = fuse_forward_chain((ConvolutionDepthWise*)layer, i, layers, blobs, opt);
+        else if (layer->typeindex == LayerType::InnerProduct)
+            ret = fuse_forward_chain((InnerProduct*)layer, i, layers, blobs, opt);
+
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+int Net::fuse_network()
+{
+    if (opt.use_layer_fusion)
+    {
+        int ret = fuse_layers();
+        if (ret != 0)
+            return ret;
+    }
+
+    // set the int8 op fusion:requantize
+#if NCNN_STRING && NCNN_REQUANT
+    // NCNN_LOGE("Test op fusion to int8 implement:");
+    // parse the network whether is a quantization model
+    bool net_quantized = false;
     for (size_t i = 0; i < layers.size(); i++)
     {
         Layer* layer = layers[i];
@@ -930,57 +1754,787 @@ int Net::fuse_network()
     return 0;
 }
 
+// bytes moved per blob element
+// a cast reads fp32 and writes 16bit, or the other way round
+// a 16bit layer saves half of the fp32 traffic on each blob it reads or writes
+#define PRECISION_CAST_COST  6
+#define PRECISION_LAYER_GAIN 2
+
+static int find_precision_group(std::vector<int>& group, int i)
+{
+    while (group[i] != i)
+    {
+        group[i] = group[group[i]];
+        i = group[i];
+    }
+
+    return i;
+}
+
+int Net::plan_storage_precision(std::vector<char>& layer_fp32)
+{
+    const int layer_count = (int)layers.size();
+    const int blob_count = (int)blobs.size();
+
+    layer_fp32.assign(layer_count, 0);
+    cast_layer_count = 0;
+
+    if (opt.use_vulkan_compute)
+        return 0;
+
+    // 16bit storage as cast element type, 2=float16 4=bfloat16
+    int type16 = 0;
+#if NCNN_ARM82
+    if (opt.use_fp16_storage && cpu_support_arm_asimdhp())
+        type16 = 2;
+    else
+#endif // NCNN_ARM82
+    if (opt.use_bf16_storage)
+        type16 = 4;
+
+    if (type16 == 0)
+        return 0;
+
+    // layers accepting 16bit storage, the input layer always hands out what the user feeds
+    std::vector<char> can16(layer_count, 0);
+    std::vector<int> group(layer_count);
+    for (int i = 0; i < layer_count; i++)
+    {
+        const Layer* layer = layers[i];
+
+        group[i] = i;
+
+        bool alive = true;
+        for (size_t j = 0; j < layer->tops.size(); j++)
+        {
+            if (blobs[layer->tops[j]].producer != i)
+                alive = false;
+        }
+
+        bool support16 = type16 == 2 ? layer->support_fp16_storage : layer->support_bf16_storage;
+        can16[i] = alive && support16 && layer->typeindex != LayerType::Input;
+    }
+
+    // connected 16bit capable layers share one precision
+    for (int i = 0; i < blob_count; i++)
+    {
+        const Blob& blob = blobs[i];
+        if (blob.producer < 0 || !can16[blob.producer])
+            continue;
+
+        for (size_t j = 0; j < blob.consumers.size(); j++)
+        {
+            int c = blob.consumers[j];
+            if (can16[c])
+                group[find_precision_group(group, c)] = find_precision_group(group, blob.producer);
+        }
+    }
+
+    // blob element count from the shape hints and the input layer shape
+    // blobs without any hint take the average of the known ones
+    std::vector<double> blob_size(blob_count, 0.0);
+    double known_size = 0.0;
+    int known_count = 0;
+    for (int i = 0; i < blob_count; i++)
+    {
+        const Mat& shape = blobs[i].shape;
+        if (shape.dims != 0)
+        {
+            blob_size[i] = (double)shape.w * shape.h * shape.c;
+        }
+        else if (blobs[i].producer >= 0 && layers[blobs[i].producer]->typeindex == LayerType::Input)
+        {
+            const Input* input = (const Input*)layers[blobs[i].producer];
+            if (input->w > 0)
+                blob_size[i] = (double)input->w * std::max(input->h, 1) * std::max(input->c, 1);
+        }
+
+        if (blob_size[i] > 0.0)
+        {
+            known_size += blob_size[i];
+            known_count += 1;
+        }
+    }
+    for (int i = 0; i < blob_count; i++)
+    {
+        if (blob_size[i] == 0.0)
+            blob_size[i] = known_count ? known_size / known_count : 1.0;
+    }
+
+    // gain of running each group in 16bit minus the casts on its boundary
+    std::vector<double> score(layer_count, 0.0);
+    for (int i = 0; i < layer_count; i++)
+    {
+        if (!can16[i])
+            continue;
+
+        const Layer* layer = layers[i];
+
+        double traffic = 0.0;
+        for (size_t j = 0; j < layer->bottoms.size(); j++)
+        {
+            traffic += blob_size[layer->bottoms[j]];
+        }
+        for (size_t j = 0; j < layer->tops.size(); j++)
+        {
+            traffic += blob_size[layer->tops[j]];
+        }
+
+        score[find_precision_group(group, i)] += PRECISION_LAYER_GAIN * traffic;
+    }
+
+    for (int i = 0; i < blob_count; i++)
+    {
+        const Blob& blob = blobs[i];
+        if (blob.producer < 0)
+            continue;
+
+        int producer_group = can16[blob.producer] ? find_precision_group(group, blob.producer) : -1;
+
+        // one cast per blob and direction, shared by all consumers on the other side
+        bool fp32_consumer = false;
+        std::vector<int> consumer_groups;
+        for (size_t j = 0; j < blob.consumers.size(); j++)
+        {
+            int c = blob.consumers[j];
+            if (!can16[c])
+            {
+                fp32_consumer = true;
+                continue;
+            }
+
+            int g = find_precision_group(group, c);
+            if (g != producer_group && std::find(consumer_groups.begin(), consumer_groups.end(), g) == consumer_groups.end())
+                consumer_groups.push_back(g);
+        }
+
+        if (producer_group != -1 && fp32_consumer)
+            score[producer_group] -= PRECISION_CAST_COST * blob_size[i];
+
+        for (size_t j = 0; j < consumer_groups.size(); j++)
+        {
+            score[consumer_groups[j]] -= PRECISION_CAST_COST * blob_size[i];
+        }
+    }
+
+    std::vector<char> use16(layer_count, 0);
+    for (int i = 0; i < layer_count; i++)
+    {
+        if (!can16[i])
+            continue;
+
+        if (score[find_precision_group(group, i)] > 0)
+        {
+            use16[i] = 1;
+            continue;
+        }
+
+        // not worth the casts, keep it on fp32
+        layer_fp32[i] = (char)type16;
+        if (type16 == 2)
+            layers[i]->support_fp16_storage = false;
+        else
+            layers[i]->support_bf16_storage = false;
+    }
+
+    // insert one cast layer per blob whose consumers want the other precision
+    for (int i = 0; i < blob_count; i++)
+    {
+        if (blobs[i].producer < 0)
+            continue;
+
+        const bool from16 = use16[blobs[i].producer];
+
+        std::vector<int> cast_consumers;
+        std::vector<int> other_consumers;
+        for (size_t j = 0; j < blobs[i].consumers.size(); j++)
+        {
+            int c = blobs[i].consumers[j];
+            std::vector<int>& consumers = (bool)use16[c] != from16 ? cast_consumers : other_consumers;
+            if (std::find(consumers.begin(), consumers.end(), c) == consumers.end())
+                consumers.push_back(c);
+        }
+
+        if (cast_consumers.empty())
+            continue;
+
+        Layer* cast = create_layer(LayerType::Cast);
+        if (!cast)
+        {
+            NCNN_LOGE("create cast layer failed");
+            return -1;
+        }
+
+        ParamDict pd;
+        pd.set(0, from16 ? type16 : 1);
+        pd.set(1, from16 ? 1 : type16);
+        cast->load_param(pd);
+
+        // take the input in the precision it arrives
+        if (type16 == 2)
+            cast->support_fp16_storage = from16;
+        else
+            cast->support_bf16_storage = from16;
+
+        const int cast_index = (int)layers.size();
+        const int cast_top = (int)blobs.size();
+
+        Blob cast_blob;
+#if NCNN_STRING
+        cast_blob.name = blobs[i].name + (from16 ? "_fp32" : type16 == 2 ? "_fp16" : "_bf16");
+        cast->type = "Cast";
+        cast->name = cast_blob.name;
+#endif // NCNN_STRING
+        cast_blob.producer = cast_index;
+        cast_blob.consumers = cast_consumers;
+
+        cast->bottoms.push_back(i);
+        cast->tops.push_back(cast_top);
+
+        for (size_t j = 0; j < cast_consumers.size(); j++)
+        {
+            std::vector<int>& bottoms = layers[cast_consumers[j]]->bottoms;
+            for (size_t k = 0; k < bottoms.size(); k++)
+            {
+                if (bottoms[k] == i)
+                    bottoms[k] = cast_top;
+            }
+        }
+
+        other_consumers.push_back(cast_index);
+        blobs[i].consumers = other_consumers;
+
+        blobs.push_back(cast_blob);
+        layers.push_back(cast);
+        layer_fp32.push_back(0);
+    }
+
+    cast_layer_count = (int)layers.size() - layer_count;
+
+    return 0;
+}
+
+void Net::strip_storage_precision()
+{
+    const int layer_count = (int)layers.size() - cast_layer_count;
+
+    // casts and their top blobs were appended in the same order, undo them from the back
+    for (int i = (int)layers.size() - 1; i >= layer_count; i--)
+    {
+        Layer* cast = layers[i];
+
+        const int bottom = cast->bottoms[0];
+        const int top = cast->tops[0];
+
+        // hand the consumers of the cast back to the blob it read
+        std::vector<int>& consumers = blobs[bottom].consumers;
+        consumers.erase(std::find(consumers.begin(), consumers.end(), i));
+
+        for (size_t j = 0; j < blobs[top].consumers.size(); j++)
+        {
+            const int c = blobs[top].consumers[j];
+
+            std::vector<int>& bottoms = layers[c]->bottoms;
+            for (size_t k = 0; k < bottoms.size(); k++)
+            {
+                if (bottoms[k] == top)
+                    bottoms[k] = bottom;
+            }
+
+            if (std::find(consumers.begin(), consumers.end(), c) == consumers.end())
+                consumers.push_back(c);
+        }
+
+        if (pipeline_created.empty() || pipeline_created[i])
+            cast->destroy_pipeline(get_layer_option(i));
+
+        delete cast;
+
+        layers.pop_back();
+        blobs.pop_back();
+    }
+
+    for (size_t i = 0; i < layer_fp32.size() && i < layers.size(); i++)
+    {
+        if (layer_fp32[i] == 2)
+            layers[i]->support_fp16_storage = true;
+        if (layer_fp32[i] == 4)
+            layers[i]->support_bf16_storage = true;
+    }
+
+    cast_layer_count = 0;
+    layer_fp32.clear();
+
+    if (!pipeline_created.empty())
+    {
+        pipeline_created.resize(layers.size());
+        pipeline_users.resize(layers.size());
+        pipeline_bytes.resize(layers.size());
+    }
+}
+
 void Net::clear()
 {
+    // pooled extractors may hold gpu allocators, reclaim them first
+    {
+        MutexLockGuard lock(extractor_pool_lock);
+
+        for (size_t i = 0; i < extractor_pool.size(); i++)
+        {
+            delete extractor_pool[i];
+        }
+        extractor_pool.clear();
+
+        for (size_t i = 0; i < shape_buckets.size(); i++)
+        {
+            delete shape_buckets[i];
+        }
+        shape_buckets.clear();
+    }
+
 #if NCNN_VULKAN
     destroy_pipeline();
 #endif // NCNN_VULKAN
 
+    // no more evictions from other nets sharing the budget
+    if (weight_budget)
+    {
+        weight_budget->remove(this);
+        weight_budget = 0;
+    }
+
     blobs.clear();
     for (size_t i = 0; i < layers.size(); i++)
     {
         Layer* layer = layers[i];
 
+        // left empty by a failed load_param
+        if (!layer)
+            continue;
+
+        if (!pipeline_created.empty() && !pipeline_created[i])
+        {
+            delete layer;
+            continue;
+        }
+
         Option opt1 = opt;
         if (!layer->support_image_storage)
         {
             opt1.use_image_storage = false;
         }
 
-        int dret = layer->destroy_pipeline(opt1);
+        int dret = layer->destroy_pipeline(opt1);
+        if (dret != 0)
+        {
+            NCNN_LOGE("layer destroy_pipeline failed");
+            // ignore anyway
+        }
+
+        delete layer;
+    }
+    layers.clear();
+    cast_layer_count = 0;
+    layer_fp32.clear();
+    pipeline_created.clear();
+    pipeline_users.clear();
+    pipeline_bytes.clear();
+
+#if NCNN_STDIO
+    // unmap after all layers referencing weight data are gone
+    delete model_mmap;
+    model_mmap = 0;
+    for (size_t i = 0; i < stale_model_mmaps.size(); i++)
+    {
+        delete stale_model_mmaps[i];
+    }
+    stale_model_mmaps.clear();
+
+    prepacked_weights.clear();
+    delete prepacked_mmap;
+    prepacked_mmap = 0;
+    prepacked_option_key = 0;
+    prepacked_model_hash = 0;
+    prepacked_model_size = 0;
+    model_hash = 0;
+    model_size = 0;
+    model_hash_deferred = false;
+#endif // NCNN_STDIO
+
+    if (autotune_cache)
+    {
+        if (opt.autotune_cache == autotune_cache)
+            opt.autotune_cache = 0;
+        delete autotune_cache;
+        autotune_cache = 0;
+    }
+
+#if NCNN_VULKAN
+    if (weight_vkallocator)
+    {
+        delete weight_vkallocator;
+        weight_vkallocator = 0;
+    }
+    if (weight_staging_vkallocator)
+    {
+        delete weight_staging_vkallocator;
+        weight_staging_vkallocator = 0;
+    }
+    if (pipeline_cache)
+    {
+        delete pipeline_cache;
+        pipeline_cache = 0;
+        opt.pipeline_cache = 0;
+    }
+#endif // NCNN_VULKAN
+}
+
+Extractor Net::create_extractor() const
+{
+    return Extractor(this, blobs.size());
+}
+
+int Net::autotune(const std::vector<int>& input_blob_indexes, const std::vector<Mat>& inputs)
+{
+    if (!opt.use_conv_autotune)
+    {
+        NCNN_LOGE("autotune requires opt.use_conv_autotune");
+        return -1;
+    }
+
+    if (input_blob_indexes.size() != inputs.size())
+    {
+        NCNN_LOGE("input blob count %d and input count %d mismatch", (int)input_blob_indexes.size(), (int)inputs.size());
+        return -1;
+    }
+
+    if (!opt.autotune_cache)
+    {
+        if (!autotune_cache)
+            autotune_cache = new AutotuneCache;
+        opt.autotune_cache = autotune_cache;
+    }
+
+    // measure into a private cache, extractors running meanwhile keep the default choices
+    AutotuneCache tuning;
+    tuning.merge(*opt.autotune_cache);
+    tuning.set_measuring(true);
+
+    int ret = 0;
+    {
+        Extractor ex = create_extractor();
+        ex.opt.autotune_cache = &tuning;
+#if NCNN_CNNCACHE
+        // cached layers run the reference kernels, time the optimized ones
+        ex.cache_mode = false;
+#endif // NCNN_CNNCACHE
+
+        for (size_t i = 0; ret == 0 && i < inputs.size(); i++)
+        {
+            ret = ex.input(input_blob_indexes[i], inputs[i]);
+        }
+
+        // forward every network output
+        for (int i = 0; ret == 0 && i < (int)blobs.size(); i++)
+        {
+            if (blobs[i].producer == -1 || !blobs[i].consumers.empty())
+                continue;
+
+            Mat out;
+            ret = ex.extract(i, out, 1);
+        }
+    }
+
+    if (ret != 0)
+        return ret;
+
+    opt.autotune_cache->merge(tuning);
+
+    return 0;
+}
+
+#if NCNN_STRING
+int Net::autotune(const std::vector<const char*>& input_blob_names, const std::vector<Mat>& inputs)
+{
+    std::vector<int> input_blob_indexes(input_blob_names.size());
+    for (size_t i = 0; i < input_blob_names.size(); i++)
+    {
+        input_blob_indexes[i] = find_blob_index_by_name(input_blob_names[i]);
+        if (input_blob_indexes[i] == -1)
+            return -1;
+    }
+
+    return autotune(input_blob_indexes, inputs);
+}
+#endif // NCNN_STRING
+
+Extractor* Net::acquire_extractor() const
+{
+    {
+        MutexLockGuard lock(extractor_pool_lock);
+
+        if (!extractor_pool.empty())
+        {
+            Extractor* ex = extractor_pool.back();
+            extractor_pool.pop_back();
+            return ex;
+        }
+    }
+
+    return new Extractor(this, blobs.size());
+}
+
+Extractor* Net::acquire_extractor(const Mat& shape) const
+{
+    MutexLockGuard lock(extractor_pool_lock);
+
+    ShapeBucket* bucket = 0;
+    for (size_t i = 0; i < shape_buckets.size(); i++)
+    {
+        if (shape_buckets[i]->match(shape))
+        {
+            // most recently used goes last
+            bucket = shape_buckets[i];
+            shape_buckets.erase(shape_buckets.begin() + i);
+            shape_buckets.push_back(bucket);
+            break;
+        }
+    }
+
+    if (!bucket)
+    {
+        bucket = new ShapeBucket(shape);
+        shape_buckets.push_back(bucket);
+
+        if (opt.use_conv_autotune && opt.autotune_cache)
+        {
+            // layers not measured yet time their kernels on the first forward of this shape
+            bucket->kernels.merge(*opt.autotune_cache);
+            bucket->kernels.set_measuring(true);
+        }
+
+        // evict least recently used shapes without extractors in flight
+        for (size_t i = 0; (int)shape_buckets.size() > shape_cache_capacity && i + 1 < shape_buckets.size();)
+        {
+            if (shape_buckets[i]->in_use != 0)
+            {
+                i++;
+                continue;
+            }
+
+            // keep the measured kernel choices for save_autotune_cache and later buckets
+            if (opt.use_conv_autotune && opt.autotune_cache)
+                opt.autotune_cache->merge(shape_buckets[i]->kernels);
+
+            delete shape_buckets[i];
+            shape_buckets.erase(shape_buckets.begin() + i);
+        }
+    }
+
+    Extractor* ex = 0;
+    if (!bucket->idle.empty())
+    {
+        ex = bucket->idle.back();
+        bucket->idle.pop_back();
+    }
+    else
+    {
+        ex = new Extractor(this, blobs.size());
+        ex->set_blob_allocator(&bucket->blob_allocator);
+        ex->set_workspace_allocator(&bucket->workspace_allocator);
+        if (opt.use_conv_autotune && opt.autotune_cache)
+            ex->opt.autotune_cache = &bucket->kernels;
+        ex->shape_bucket = bucket;
+    }
+
+    bucket->in_use++;
+
+    return ex;
+}
+
+void Net::release_extractor(Extractor* ex) const
+{
+    if (!ex)
+        return;
+
+    if (ex->net != this)
+    {
+        NCNN_LOGE("release_extractor from another net");
+        return;
+    }
+
+    ex->reset();
+
+    // the profiler belongs to the previous borrower, it may be gone before the next one
+    ex->set_profiler(0);
+
+    MutexLockGuard lock(extractor_pool_lock);
+
+    if (ex->shape_bucket)
+    {
+        // buckets with extractors in flight are never evicted
+        ex->shape_bucket->in_use--;
+        ex->shape_bucket->idle.push_back(ex);
+        return;
+    }
+
+    extractor_pool.push_back(ex);
+}
+
+void Net::set_shape_cache_capacity(int capacity)
+{
+    MutexLockGuard lock(extractor_pool_lock);
+    shape_cache_capacity = capacity < 1 ? 1 : capacity;
+}
+
+void Net::evict_pipelines() const
+{
+    // pipelines accounted to the budget are evicted through it to keep usage in sync
+    if (weight_budget)
+        weight_budget->evict(this);
+
+    MutexLockGuard lock(pipeline_lock);
+
+    for (size_t i = 0; i < pipeline_created.size(); i++)
+    {
+        if (!pipeline_created[i] || pipeline_users[i] != 0 || pipeline_bytes[i] != 0)
+            continue;
+
+        int dret = layers[i]->destroy_pipeline(get_layer_option(i));
         if (dret != 0)
         {
-            NCNN_LOGE("layer destroy_pipeline failed");
+            NCNN_LOGE("layer destroy_pipeline %d failed", (int)i);
             // ignore anyway
         }
 
-        delete layer;
+        pipeline_created[i] = 0;
     }
-    layers.clear();
+}
 
+Option Net::get_layer_option(size_t layer_index) const
+{
+    Option opt1 = opt;
 #if NCNN_VULKAN
-    if (weight_vkallocator)
+    if (opt.use_vulkan_compute)
     {
-        delete weight_vkallocator;
-        weight_vkallocator = 0;
+        if (!layers[layer_index]->support_image_storage) opt1.use_image_storage = false;
     }
-    if (weight_staging_vkallocator)
+#endif // NCNN_VULKAN
+    if (layer_index < layer_fp32.size() && layer_fp32[layer_index])
     {
-        delete weight_staging_vkallocator;
-        weight_staging_vkallocator = 0;
+        opt1.use_fp16_storage = false;
+        opt1.use_fp16_arithmetic = false;
+        opt1.use_bf16_storage = false;
     }
-    if (pipeline_cache)
+
+    return opt1;
+}
+
+int Net::create_layer_pipeline(size_t layer_index) const
+{
+    Layer* layer = layers[layer_index];
+
+    Option opt1 = get_layer_option(layer_index);
+
+    int cret = -1;
+#if NCNN_STDIO
+    if (layer_index < prepacked_weights.size() && !prepacked_weights[layer_index].empty())
     {
-        delete pipeline_cache;
-        pipeline_cache = 0;
-        opt.pipeline_cache = 0;
+        cret = layer->create_pipeline_prepacked(prepacked_weights[layer_index], opt1);
     }
-#endif // NCNN_VULKAN
+    if (cret != 0)
+#endif // NCNN_STDIO
+    cret = layer->create_pipeline(opt1);
+
+    return cret;
 }
 
-Extractor Net::create_extractor() const
+// bytes of weight data transformed in create_pipeline
+// data referenced from a mapped prepacked cache is not counted
+static size_t get_pipeline_bytes(const Layer* layer)
 {
-    return Extractor(this, blobs.size());
+    std::vector<Mat> weights;
+    if (layer->get_prepacked_weights(weights) != 0)
+        return 0;
+
+    size_t bytes = 0;
+    for (size_t i = 0; i < weights.size(); i++)
+    {
+        if (weights[i].refcount)
+            bytes += weights[i].total() * weights[i].elemsize;
+    }
+
+    return bytes;
+}
+
+int Net::acquire_pipeline(int layer_index) const
+{
+    if (pipeline_created.empty())
+        return 0;
+
+    bool created = false;
+    size_t bytes = 0;
+    {
+        MutexLockGuard lock(pipeline_lock);
+
+        if (!pipeline_created[layer_index])
+        {
+            int cret = create_layer_pipeline(layer_index);
+            if (cret != 0)
+            {
+                NCNN_LOGE("layer create_pipeline %d failed", layer_index);
+                return -1;
+            }
+
+            pipeline_created[layer_index] = 1;
+            pipeline_bytes[layer_index] = weight_budget ? get_pipeline_bytes(layers[layer_index]) : 0;
+
+            created = true;
+        }
+
+        pipeline_users[layer_index]++;
+        bytes = pipeline_bytes[layer_index];
+    }
+
+    // outside pipeline_lock, the budget may evict other layers of this net
+    if (bytes != 0)
+    {
+        if (created)
+            weight_budget->add(this, layer_index, bytes);
+        else
+            weight_budget->touch(this, layer_index);
+    }
+
+    return 0;
+}
+
+void Net::release_pipeline(int layer_index) const
+{
+    if (pipeline_created.empty())
+        return;
+
+    MutexLockGuard lock(pipeline_lock);
+    pipeline_users[layer_index]--;
+}
+
+int Net::evict_pipeline(int layer_index) const
+{
+    MutexLockGuard lock(pipeline_lock);
+
+    if (!pipeline_created[layer_index] || pipeline_users[layer_index] != 0)
+        return -1;
+
+    int dret = layers[layer_index]->destroy_pipeline(get_layer_option(layer_index));
+    if (dret != 0)
+    {
+        NCNN_LOGE("layer destroy_pipeline %d failed", layer_index);
+        // ignore anyway
+    }
+
+    pipeline_created[layer_index] = 0;
+    pipeline_bytes[layer_index] = 0;
+
+    return 0;
 }
 
 #if NCNN_VULKAN
@@ -1113,6 +2667,103 @@ Layer* Net::create_custom_layer(int index)
     return layer_creator();
 }
 
+// cast and pack bottom blob into the storage layout the layer accepts
+static void convert_layout(Mat& bottom_blob, const Layer* layer, const Option& opt)
+{
+    // clang-format off
+    // *INDENT-OFF*
+#if NCNN_ARM82
+    if (opt.use_fp16_storage && cpu_support_arm_asimdhp())
+    {
+        if (bottom_blob.elembits() == 32 && layer->support_fp16_storage)
+        {
+            Mat bottom_blob_fp16;
+            cast_float32_to_float16(bottom_blob, bottom_blob_fp16, opt);
+            bottom_blob = bottom_blob_fp16;
+        }
+        if (bottom_blob.elembits() == 16 && !layer->support_fp16_storage)
+        {
+            Mat bottom_blob_fp32;
+            cast_float16_to_float32(bottom_blob, bottom_blob_fp32, opt);
+            bottom_blob = bottom_blob_fp32;
+        }
+    }
+    else
+#endif // NCNN_ARM82
+    if (opt.use_bf16_storage)
+    {
+        if (bottom_blob.elembits() == 32 && layer->support_bf16_storage)
+        {
+            Mat bottom_blob_bf16;
+            cast_float32_to_bfloat16(bottom_blob, bottom_blob_bf16, opt);
+            bottom_blob = bottom_blob_bf16;
+        }
+        if (bottom_blob.elembits() == 16 && !layer->support_bf16_storage)
+        {
+            Mat bottom_blob_fp32;
+            cast_bfloat16_to_float32(bottom_blob, bottom_blob_fp32, opt);
+            bottom_blob = bottom_blob_fp32;
+        }
+    }
+    // *INDENT-ON*
+    // clang-format on
+
+    if (opt.use_packing_layout)
+    {
+        // resolve dst_elempack
+        int dims = bottom_blob.dims;
+        int elemcount = 0;
+        if (dims == 1) elemcount = bottom_blob.elempack * bottom_blob.w;
+        if (dims == 2) elemcount = bottom_blob.elempack * bottom_blob.h;
+        if (dims == 3) elemcount = bottom_blob.elempack * bottom_blob.c;
+
+        int dst_elempack = 1;
+        if (layer->support_packing)
+        {
+#if NCNN_AVX2
+            // layers built for avx512 take pack16 where they implement it
+            if (elemcount % 16 == 0 && layer->support_packing16)
+                dst_elempack = 16;
+            else if (elemcount % 8 == 0)
+                dst_elempack = 8;
+#elif NCNN_ARM82
+            if (elemcount % 8 == 0 && opt.use_fp16_storage && opt.use_fp16_arithmetic && layer->support_fp16_storage)
+                dst_elempack = 8;
+            else if (elemcount % 4 == 0)
+                dst_elempack = 4;
+#else
+            if (elemcount % 4 == 0)
+                dst_elempack = 4;
+#endif
+        }
+
+        Mat bottom_blob_packed;
+        convert_packing(bottom_blob, bottom_blob_packed, dst_elempack, opt);
+        bottom_blob = bottom_blob_packed;
+    }
+}
+
+// keeps the pipeline of a lazy layer resident while the layer runs
+class PipelineGuard
+{
+public:
+    PipelineGuard(const Net* _net, int _layer_index)
+        : net(_net), layer_index(_layer_index)
+    {
+        ret = net->acquire_pipeline(layer_index);
+    }
+
+    ~PipelineGuard()
+    {
+        if (ret == 0)
+            net->release_pipeline(layer_index);
+    }
+
+    const Net* net;
+    int layer_index;
+    int ret;
+};
+
 int Net::forward_layer(int layer_index, std::vector<Mat>& blob_mats, Extractor* extract, const Option& opt) const
 {
     const Layer* layer = layers[layer_index];
@@ -1138,11 +2789,6 @@ int Net::forward_layer(int layer_index, std::vector<Mat>& blob_mats, Extractor*
         {
             // delete after taken in light mode
             blob_mats[bottom_blob_index].release();
-            // deep copy for inplace forward if data is shared
-            if (layer->support_inplace && *bottom_blob.refcount != 1)
-            {
-                bottom_blob = bottom_blob.clone();
-            }
         }
 
 #if NCNN_CNNCACHE
@@ -1150,77 +2796,28 @@ int Net::forward_layer(int layer_index, std::vector<Mat>& blob_mats, Extractor*
             extract->rois[top_blob_index], extract->padrois[top_blob_index]);
 #endif //NCNN_CNNCACHE
 
-        // clang-format off
-        // *INDENT-OFF*
-#if NCNN_ARM82
-        if (opt.use_fp16_storage && cpu_support_arm_asimdhp())
-        {
-            if (bottom_blob.elembits() == 32 && layer->support_fp16_storage)
-            {
-                Mat bottom_blob_fp16;
-                cast_float32_to_float16(bottom_blob, bottom_blob_fp16, opt);
-                bottom_blob = bottom_blob_fp16;
-            }
-            if (bottom_blob.elembits() == 16 && !layer->support_fp16_storage)
-            {
-                Mat bottom_blob_fp32;
-                cast_float16_to_float32(bottom_blob, bottom_blob_fp32, opt);
-                bottom_blob = bottom_blob_fp32;
-            }
-        }
-        else
-#endif // NCNN_ARM82
-        if (opt.use_bf16_storage)
-        {
-            if (bottom_blob.elembits() == 32 && layer->support_bf16_storage)
-            {
-                Mat bottom_blob_bf16;
-                cast_float32_to_bfloat16(bottom_blob, bottom_blob_bf16, opt);
-                bottom_blob = bottom_blob_bf16;
-            }
-            if (bottom_blob.elembits() == 16 && !layer->support_bf16_storage)
-            {
-                Mat bottom_blob_fp32;
-                cast_bfloat16_to_float32(bottom_blob, bottom_blob_fp32, opt);
-                bottom_blob = bottom_blob_fp32;
-            }
-        }
-        // *INDENT-ON*
-        // clang-format on
+        // create_pipeline may decide the packing the layer accepts
+        PipelineGuard pipeline_guard(this, layer_index);
+        if (pipeline_guard.ret != 0)
+            return pipeline_guard.ret;
 
-        if (opt.use_packing_layout)
-        {
-            // resolve dst_elempack
-            int dims = bottom_blob.dims;
-            int elemcount = 0;
-            if (dims == 1) elemcount = bottom_blob.elempack * bottom_blob.w;
-            if (dims == 2) elemcount = bottom_blob.elempack * bottom_blob.h;
-            if (dims == 3) elemcount = bottom_blob.elempack * bottom_blob.c;
+        convert_layout(bottom_blob, layer, opt);
 
-            int dst_elempack = 1;
-            if (layer->support_packing)
-            {
-#if NCNN_AVX2
-                if (elemcount % 8 == 0)
-                    dst_elempack = 8;
-#elif NCNN_ARM82
-                if (elemcount % 8 == 0 && opt.use_fp16_storage && opt.use_fp16_arithmetic && layer->support_fp16_storage)
-                    dst_elempack = 8;
-                else if (elemcount % 4 == 0)
-                    dst_elempack = 4;
-#else
-                if (elemcount % 4 == 0)
-                    dst_elempack = 4;
-#endif
-            }
+        // the last consumer of a blob owns it and may forward inplace
+        // earlier consumers of a shared blob write into a fresh top blob instead of a deep copy
+        bool forward_inplace = opt.lightmode && layer->support_inplace && bottom_blob.refcount && *bottom_blob.refcount == 1;
 
-            Mat bottom_blob_packed;
-            convert_packing(bottom_blob, bottom_blob_packed, dst_elempack, opt);
-            bottom_blob = bottom_blob_packed;
+        Mat profile_bottom_blob;
+        double profile_start = 0;
+        if (extract->profiler)
+        {
+            profile_bottom_blob = bottom_blob;
+            extract->profiler->mark(opt);
+            profile_start = get_current_time();
         }
 
         // forward
-        if (opt.lightmode && layer->support_inplace)
+        if (forward_inplace)
         {
             Mat& bottom_top_blob = bottom_blob;
 #if NCNN_BENCHMARK
@@ -1263,6 +2860,12 @@ int Net::forward_layer(int layer_index, std::vector<Mat>& blob_mats, Extractor*
             // store top blob
             blob_mats[top_blob_index] = top_blob;
         }
+
+        if (extract->profiler)
+        {
+            double profile_end = get_current_time();
+            extract->profiler->record(extract, layer_index, layer, std::vector<Mat>(1, profile_bottom_blob), std::vector<Mat>(1, blob_mats[top_blob_index]), profile_start, profile_end, opt);
+        }
     }
     else
     {
@@ -1292,11 +2895,6 @@ int Net::forward_layer(int layer_index, std::vector<Mat>& blob_mats, Extractor*
             {
                 // delete after taken in light mode
                 blob_mats[bottom_blob_index].release();
-                // deep copy for inplace forward if data is shared
-                if (layer->support_inplace && *bottom_blobs[i].refcount != 1)
-                {
-                    bottom_blobs[i] = bottom_blobs[i].clone();
-                }
             }
 
 #if NCNN_CNNCACHE
@@ -1310,128 +2908,247 @@ int Net::forward_layer(int layer_index, std::vector<Mat>& blob_mats, Extractor*
                 extract->padrois[top_blob_index].copyFrom(top_padrois[i]);
             }
 #endif
+        }
 
-            // clang-format off
-            // *INDENT-OFF*
-#if NCNN_ARM82
-            if (opt.use_fp16_storage && cpu_support_arm_asimdhp())
+        // create_pipeline may decide the packing the layer accepts
+        PipelineGuard pipeline_guard(this, layer_index);
+        if (pipeline_guard.ret != 0)
+            return pipeline_guard.ret;
+
+        for (size_t i = 0; i < layer->bottoms.size(); i++)
+        {
+            convert_layout(bottom_blobs[i], layer, opt);
+
+            // deep copy for inplace forward if data is still shared after layout conversion
+            if (opt.lightmode && layer->support_inplace && (!bottom_blobs[i].refcount || *bottom_blobs[i].refcount != 1))
             {
-                if (bottom_blobs[i].elembits() == 32 && layer->support_fp16_storage)
-                {
-                    Mat bottom_blob_fp16;
-                    cast_float32_to_float16(bottom_blobs[i], bottom_blob_fp16, opt);
-                    bottom_blobs[i] = bottom_blob_fp16;
-                }
-                if (bottom_blobs[i].elembits() == 16 && !layer->support_fp16_storage)
-                {
-                    Mat bottom_blob_fp32;
-                    cast_float16_to_float32(bottom_blobs[i], bottom_blob_fp32, opt);
-                    bottom_blobs[i] = bottom_blob_fp32;
-                }
+                bottom_blobs[i] = bottom_blobs[i].clone();
             }
-            else
-#endif // NCNN_ARM82
-            if (opt.use_bf16_storage)
+        }
+
+        std::vector<Mat> profile_bottom_blobs;
+        double profile_start = 0;
+        if (extract->profiler)
+        {
+            profile_bottom_blobs = bottom_blobs;
+            extract->profiler->mark(opt);
+            profile_start = get_current_time();
+        }
+
+        // forward
+        if (opt.lightmode && layer->support_inplace)
+        {
+            std::vector<Mat>& bottom_top_blobs = bottom_blobs;
+#if NCNN_BENCHMARK
+            double start = get_current_time();
+            int ret = layer->forward_inplace(bottom_top_blobs, opt);
+            double end = get_current_time();
+            benchmark(layer, start, end);
+#else
+            int ret = layer->forward_inplace(bottom_top_blobs, opt);
+#endif // NCNN_BENCHMARK
+            if (ret != 0)
+                return ret;
+
+            // store top blobs
+            for (size_t i = 0; i < layer->tops.size(); i++)
             {
-                if (bottom_blobs[i].elembits() == 32 && layer->support_bf16_storage)
-                {
-                    Mat bottom_blob_bf16;
-                    cast_float32_to_bfloat16(bottom_blobs[i], bottom_blob_bf16, opt);
-                    bottom_blobs[i] = bottom_blob_bf16;
-                }
-                if (bottom_blobs[i].elembits() == 16 && !layer->support_bf16_storage)
-                {
-                    Mat bottom_blob_fp32;
-                    cast_bfloat16_to_float32(bottom_blobs[i], bottom_blob_fp32, opt);
-                    bottom_blobs[i] = bottom_blob_fp32;
-                }
+                int top_blob_index = layer->tops[i];
+
+                blob_mats[top_blob_index] = bottom_top_blobs[i];
+            }
+        }
+        else
+        {
+            std::vector<Mat> top_blobs(layer->tops.size());
+#if NCNN_BENCHMARK
+            double start = get_current_time();
+            int ret = layer->forward(bottom_blobs, top_blobs, opt);
+            double end = get_current_time();
+            benchmark(layer, start, end);
+#else
+            int ret = layer->forward(bottom_blobs, top_blobs, opt);
+#endif // NCNN_BENCHMARK
+            if (ret != 0)
+                return ret;
+
+            // store top blobs
+            for (size_t i = 0; i < layer->tops.size(); i++)
+            {
+                int top_blob_index = layer->tops[i];
+
+                blob_mats[top_blob_index] = top_blobs[i];
             }
-            // *INDENT-ON*
-            // clang-format on
+        }
 
-            if (opt.use_packing_layout)
+        if (extract->profiler)
+        {
+            double profile_end = get_current_time();
+
+            std::vector<Mat> profile_top_blobs(layer->tops.size());
+            for (size_t i = 0; i < layer->tops.size(); i++)
             {
-                // resolve dst_elempack
-                int dims = bottom_blobs[i].dims;
-                int elemcount = 0;
-                if (dims == 1) elemcount = bottom_blobs[i].elempack * bottom_blobs[i].w;
-                if (dims == 2) elemcount = bottom_blobs[i].elempack * bottom_blobs[i].h;
-                if (dims == 3) elemcount = bottom_blobs[i].elempack * bottom_blobs[i].c;
-
-                int dst_elempack = 1;
-                if (layer->support_packing)
-                {
-#if NCNN_AVX2
-                    if (elemcount % 8 == 0)
-                        dst_elempack = 8;
-#elif NCNN_ARM82
-                    if (elemcount % 8 == 0 && opt.use_fp16_storage && opt.use_fp16_arithmetic && layer->support_fp16_storage)
-                        dst_elempack = 8;
-                    else if (elemcount % 4 == 0)
-                        dst_elempack = 4;
-#else
-                    if (elemcount % 4 == 0)
-                        dst_elempack = 4;
-#endif
-                }
+                profile_top_blobs[i] = blob_mats[layer->tops[i]];
+            }
+
+            extract->profiler->record(extract, layer_index, layer, profile_bottom_blobs, profile_top_blobs, profile_start, profile_end, opt);
+        }
+    }
+
+    //     NCNN_LOGE("forward_layer %d %s done", layer_index, layer->name.c_str());
+    //     const Mat& blob = blob_mats[layer->tops[0]];
+    //     NCNN_LOGE("[%-2d %-16s %-16s]  %d    blobs count = %-3d   size = %-3d x %-3d", layer_index, layer->type.c_str(), layer->name.c_str(), layer->tops[0], blob.c, blob.h, blob.w);
+
+    return 0;
+}
+
+int Net::forward_layer_batch(int layer_index, std::vector<std::vector<Mat> >& batch_blob_mats, Extractor* extract, const Option& opt) const
+{
+    const Layer* layer = layers[layer_index];
+
+    const int batch = (int)batch_blob_mats.size();
+
+    // load bottom blobs of all batch items
+    for (size_t i = 0; i < layer->bottoms.size(); i++)
+    {
+        int bottom_blob_index = layer->bottoms[i];
+
+        if (batch_blob_mats[0][bottom_blob_index].dims == 0)
+        {
+            int ret = forward_layer_batch(blobs[bottom_blob_index].producer, batch_blob_mats, extract, opt);
+            if (ret != 0)
+                return ret;
+        }
+    }
+
+    if (!layer->support_batch)
+    {
+        // bottom blobs are ready, forward_layer runs this layer only
+        for (int b = 0; b < batch; b++)
+        {
+            int ret = forward_layer(layer_index, batch_blob_mats[b], extract, opt);
+            if (ret != 0)
+                return ret;
+        }
+
+        return 0;
+    }
+
+    PipelineGuard pipeline_guard(this, layer_index);
+    if (pipeline_guard.ret != 0)
+        return pipeline_guard.ret;
+
+    if (layer->one_blob_only)
+    {
+        int bottom_blob_index = layer->bottoms[0];
+        int top_blob_index = layer->tops[0];
+
+        std::vector<Mat> bottom_blobs(batch);
+        for (int b = 0; b < batch; b++)
+        {
+            bottom_blobs[b] = batch_blob_mats[b][bottom_blob_index];
 
-                Mat bottom_blob_packed;
-                convert_packing(bottom_blobs[i], bottom_blob_packed, dst_elempack, opt);
-                bottom_blobs[i] = bottom_blob_packed;
+            if (opt.lightmode)
+            {
+                // delete after taken in light mode
+                batch_blob_mats[b][bottom_blob_index].release();
             }
+
+            convert_layout(bottom_blobs[b], layer, opt);
         }
 
-        // forward
-        if (opt.lightmode && layer->support_inplace)
+        double profile_start = 0;
+        if (extract->profiler)
         {
-            std::vector<Mat>& bottom_top_blobs = bottom_blobs;
+            extract->profiler->mark(opt);
+            profile_start = get_current_time();
+        }
+
+        std::vector<Mat> top_blobs(batch);
 #if NCNN_BENCHMARK
-            double start = get_current_time();
-            int ret = layer->forward_inplace(bottom_top_blobs, opt);
-            double end = get_current_time();
-            benchmark(layer, start, end);
+        double start = get_current_time();
+        int ret = layer->forward_batch(bottom_blobs, top_blobs, opt);
+        double end = get_current_time();
+        benchmark(layer, start, end);
 #else
-            int ret = layer->forward_inplace(bottom_top_blobs, opt);
+        int ret = layer->forward_batch(bottom_blobs, top_blobs, opt);
 #endif // NCNN_BENCHMARK
-            if (ret != 0)
-                return ret;
+        if (ret != 0)
+            return ret;
 
-            // store top blobs
-            for (size_t i = 0; i < layer->tops.size(); i++)
+        if (extract->profiler)
+        {
+            double profile_end = get_current_time();
+            extract->profiler->record(extract, layer_index, layer, std::vector<Mat>(1, bottom_blobs[0]), std::vector<Mat>(1, top_blobs[0]), profile_start, profile_end, opt, batch);
+        }
+
+        // store top blob
+        for (int b = 0; b < batch; b++)
+        {
+            batch_blob_mats[b][top_blob_index] = top_blobs[b];
+        }
+    }
+    else
+    {
+        std::vector<std::vector<Mat> > bottom_blobs_batch(batch);
+        for (int b = 0; b < batch; b++)
+        {
+            std::vector<Mat>& bottom_blobs = bottom_blobs_batch[b];
+            bottom_blobs.resize(layer->bottoms.size());
+
+            for (size_t i = 0; i < layer->bottoms.size(); i++)
             {
-                int top_blob_index = layer->tops[i];
+                int bottom_blob_index = layer->bottoms[i];
 
-                blob_mats[top_blob_index] = bottom_top_blobs[i];
+                bottom_blobs[i] = batch_blob_mats[b][bottom_blob_index];
+
+                if (opt.lightmode)
+                {
+                    // delete after taken in light mode
+                    batch_blob_mats[b][bottom_blob_index].release();
+                }
+
+                convert_layout(bottom_blobs[i], layer, opt);
             }
         }
-        else
+
+        double profile_start = 0;
+        if (extract->profiler)
         {
-            std::vector<Mat> top_blobs(layer->tops.size());
+            extract->profiler->mark(opt);
+            profile_start = get_current_time();
+        }
+
+        std::vector<std::vector<Mat> > top_blobs_batch(batch, std::vector<Mat>(layer->tops.size()));
 #if NCNN_BENCHMARK
-            double start = get_current_time();
-            int ret = layer->forward(bottom_blobs, top_blobs, opt);
-            double end = get_current_time();
-            benchmark(layer, start, end);
+        double start = get_current_time();
+        int ret = layer->forward_batch(bottom_blobs_batch, top_blobs_batch, opt);
+        double end = get_current_time();
+        benchmark(layer, start, end);
 #else
-            int ret = layer->forward(bottom_blobs, top_blobs, opt);
+        int ret = layer->forward_batch(bottom_blobs_batch, top_blobs_batch, opt);
 #endif // NCNN_BENCHMARK
-            if (ret != 0)
-                return ret;
+        if (ret != 0)
+            return ret;
 
-            // store top blobs
+        if (extract->profiler)
+        {
+            double profile_end = get_current_time();
+            extract->profiler->record(extract, layer_index, layer, bottom_blobs_batch[0], top_blobs_batch[0], profile_start, profile_end, opt, batch);
+        }
+
+        // store top blobs
+        for (int b = 0; b < batch; b++)
+        {
             for (size_t i = 0; i < layer->tops.size(); i++)
             {
                 int top_blob_index = layer->tops[i];
 
-                blob_mats[top_blob_index] = top_blobs[i];
+                batch_blob_mats[b][top_blob_index] = top_blobs_batch[b][i];
             }
         }
     }
 
-    //     NCNN_LOGE("forward_layer %d %s done", layer_index, layer->name.c_str());
-    //     const Mat& blob = blob_mats[layer->tops[0]];
-    //     NCNN_LOGE("[%-2d %-16s %-16s]  %d    blobs count = %-3d   size = %-3d x %-3d", layer_index, layer->type.c_str(), layer->name.c_str(), layer->tops[0], blob.c, blob.h, blob.w);
-
     return 0;
 }
 
@@ -2576,8 +4293,45 @@ IMAGE_ALLOCATION_FAILED:
 }
 #endif // NCNN_VULKAN
 
+// unpack and cast extracted blob back to fp32 pack1
+static void convert_extract_layout(Mat& feat, const Option& opt)
+{
+    if (opt.use_packing_layout)
+    {
+        Mat bottom_blob_unpacked;
+        convert_packing(feat, bottom_blob_unpacked, 1, opt);
+        feat = bottom_blob_unpacked;
+    }
+
+    // clang-format off
+    // *INDENT-OFF*
+#if NCNN_ARM82
+    if (opt.use_fp16_storage && cpu_support_arm_asimdhp())
+    {
+        if (feat.elembits() == 16)
+        {
+            Mat feat_fp32;
+            cast_float16_to_float32(feat, feat_fp32, opt);
+            feat = feat_fp32;
+        }
+    }
+    else
+#endif // NCNN_ARM82
+    if (opt.use_bf16_storage)
+    {
+        if (feat.elembits() == 16)
+        {
+            Mat feat_fp32;
+            cast_bfloat16_to_float32(feat, feat_fp32, opt);
+            feat = feat_fp32;
+        }
+    }
+    // *INDENT-ON*
+    // clang-format on
+}
+
 Extractor::Extractor(const Net* _net, size_t blob_count)
-    : net(_net)
+    : net(_net), profiler(0), shape_bucket(0)
 {
     NCNN_LOGE("IN EXTRACTOR, BLOB_COUNT = %d, LAYERS SIZE = %d", blob_count, net->layers.size());
     blob_mats.resize(blob_count);
@@ -2604,6 +4358,9 @@ Extractor::Extractor(const Net* _net, size_t blob_count)
 
 Extractor::~Extractor()
 {
+    if (profiler)
+        profiler->remove_stream(this);
+
     blob_mats.clear();
 
 #if NCNN_VULKAN
@@ -2644,6 +4401,65 @@ void Extractor::set_workspace_allocator(Allocator* allocator)
     opt.workspace_allocator = allocator;
 }
 
+void Extractor::set_profiler(Profiler* _profiler)
+{
+    if (profiler && profiler != _profiler)
+        profiler->remove_stream(this);
+
+    profiler = _profiler;
+}
+
+void Extractor::reset()
+{
+    for (size_t i = 0; i < blob_mats.size(); i++)
+    {
+        blob_mats[i].release();
+    }
+
+    for (size_t b = 0; b < batch_blob_mats.size(); b++)
+    {
+        std::vector<Mat>& mats = batch_blob_mats[b];
+        for (size_t i = 0; i < mats.size(); i++)
+        {
+            mats[i].release();
+        }
+    }
+
+#if NCNN_CNNCACHE
+    for (size_t i = 0; i < blob_mats_cached.size(); i++)
+    {
+        blob_mats_cached[i].release();
+    }
+    for (size_t i = 0; i < temp_tops.size(); i++)
+    {
+        std::vector<Mat>& tops = temp_tops[i];
+        for (size_t j = 0; j < tops.size(); j++)
+        {
+            tops[j].release();
+        }
+    }
+    for (size_t i = 0; i < rois.size(); i++)
+    {
+        rois[i].clear();
+        padrois[i].clear();
+    }
+#endif // NCNN_CNNCACHE
+
+#if NCNN_VULKAN
+    if (net->opt.use_vulkan_compute)
+    {
+        for (size_t i = 0; i < blob_mats_gpu.size(); i++)
+        {
+            blob_mats_gpu[i].release();
+        }
+        for (size_t i = 0; i < blob_mats_gpu_image.size(); i++)
+        {
+            blob_mats_gpu_image[i].release();
+        }
+    }
+#endif // NCNN_VULKAN
+}
+
 #if NCNN_VULKAN
 void Extractor::set_vulkan_compute(bool enable)
 {
@@ -2691,6 +4507,15 @@ int Extractor::extract(const char* blob_name, Mat& feat)
 
     return extract(blob_index, feat);
 }
+
+int Extractor::extract(const char* blob_name, Mat& feat, int type)
+{
+    int blob_index = net->find_blob_index_by_name(blob_name);
+    if (blob_index == -1)
+        return -1;
+
+    return extract(blob_index, feat, type);
+}
 #endif // NCNN_STRING
 
 int Extractor::input(int blob_index, const Mat& in)
@@ -2704,10 +4529,22 @@ int Extractor::input(int blob_index, const Mat& in)
 }
 
 int Extractor::extract(int blob_index, Mat& feat)
+{
+    return extract(blob_index, feat, 0);
+}
+
+int Extractor::extract(int blob_index, Mat& feat, int type)
 {
     if (blob_index < 0 || blob_index >= (int)blob_mats.size())
         return -1;
 
+    if (net->blobs[blob_index].producer == -1 && blob_mats[blob_index].dims == 0)
+    {
+        // consumed inside a fused layer chain, see Option::use_layer_fusion
+        NCNN_LOGE("blob %d is fused away", blob_index);
+        return -1;
+    }
+
     int old_blocktime = get_kmp_blocktime();
     set_kmp_blocktime(opt.openmp_blocktime);
 
@@ -2808,38 +4645,132 @@ int Extractor::extract(int blob_index, Mat& feat)
 
     feat = blob_mats[blob_index];
 
-    if (opt.use_packing_layout)
-    {
-        Mat bottom_blob_unpacked;
-        convert_packing(feat, bottom_blob_unpacked, 1, opt);
-        feat = bottom_blob_unpacked;
-    }
+    if (type == 0)
+        convert_extract_layout(feat, opt);
 
-    // clang-format off
-    // *INDENT-OFF*
-#if NCNN_ARM82
-    if (opt.use_fp16_storage && cpu_support_arm_asimdhp())
+    set_kmp_blocktime(old_blocktime);
+
+    return ret;
+}
+
+#if NCNN_STRING
+int Extractor::input(const char* blob_name, const std::vector<Mat>& in)
+{
+    int blob_index = net->find_blob_index_by_name(blob_name);
+    if (blob_index == -1)
+        return -1;
+
+    return input(blob_index, in);
+}
+
+int Extractor::extract(const char* blob_name, std::vector<Mat>& feats)
+{
+    int blob_index = net->find_blob_index_by_name(blob_name);
+    if (blob_index == -1)
+        return -1;
+
+    return extract(blob_index, feats);
+}
+#endif // NCNN_STRING
+
+int Extractor::input(int blob_index, const std::vector<Mat>& in)
+{
+    if (blob_index < 0 || blob_index >= (int)blob_mats.size())
+        return -1;
+
+    if (in.empty())
+        return -1;
+
+    for (size_t b = 1; b < in.size(); b++)
     {
-        if (feat.elembits() == 16)
+        if (in[b].dims != in[0].dims || in[b].w != in[0].w || in[b].h != in[0].h || in[b].c != in[0].c || in[b].elemsize != in[0].elemsize || in[b].elempack != in[0].elempack)
         {
-            Mat feat_fp32;
-            cast_float16_to_float32(feat, feat_fp32, opt);
-            feat = feat_fp32;
+            NCNN_LOGE("batch input shape mismatch");
+            return -1;
         }
     }
-    else
-#endif // NCNN_ARM82
-    if (opt.use_bf16_storage)
+
+    if (batch_blob_mats.size() != in.size())
     {
-        if (feat.elembits() == 16)
+        // batch size can only change before any batch input is set
+        for (size_t b = 0; b < batch_blob_mats.size(); b++)
         {
-            Mat feat_fp32;
-            cast_bfloat16_to_float32(feat, feat_fp32, opt);
-            feat = feat_fp32;
+            for (size_t i = 0; i < batch_blob_mats[b].size(); i++)
+            {
+                if (batch_blob_mats[b][i].dims != 0)
+                {
+                    NCNN_LOGE("batch input size mismatch %d vs %d", (int)in.size(), (int)batch_blob_mats.size());
+                    return -1;
+                }
+            }
+        }
+
+        batch_blob_mats.resize(in.size());
+        for (size_t b = 0; b < in.size(); b++)
+        {
+            batch_blob_mats[b].resize(blob_mats.size());
         }
     }
-    // *INDENT-ON*
-    // clang-format on
+
+    for (size_t b = 0; b < in.size(); b++)
+    {
+        batch_blob_mats[b][blob_index] = in[b];
+    }
+
+    return 0;
+}
+
+int Extractor::extract(int blob_index, std::vector<Mat>& feats)
+{
+    if (blob_index < 0 || blob_index >= (int)blob_mats.size())
+        return -1;
+
+    if (batch_blob_mats.empty())
+    {
+        NCNN_LOGE("batch input not set");
+        return -1;
+    }
+
+    if (net->blobs[blob_index].producer == -1 && batch_blob_mats[0][blob_index].dims == 0)
+    {
+        // consumed inside a fused layer chain, see Option::use_layer_fusion
+        NCNN_LOGE("blob %d is fused away", blob_index);
+        return -1;
+    }
+
+    int old_blocktime = get_kmp_blocktime();
+    set_kmp_blocktime(opt.openmp_blocktime);
+
+    int ret = 0;
+
+    if (batch_blob_mats[0][blob_index].dims == 0)
+    {
+        int layer_index = net->blobs[blob_index].producer;
+
+        // batched inference always runs on cpu
+        Option opt_batch = opt;
+        opt_batch.use_vulkan_compute = false;
+
+#if NCNN_CNNCACHE
+        // cached results of single inference do not apply to batch items
+        bool cache_mode0 = cache_mode;
+        cache_mode = false;
+#endif // NCNN_CNNCACHE
+
+        ret = net->forward_layer_batch(layer_index, batch_blob_mats, this, opt_batch);
+
+#if NCNN_CNNCACHE
+        cache_mode = cache_mode0;
+#endif // NCNN_CNNCACHE
+    }
+
+    feats.resize(batch_blob_mats.size());
+    for (size_t b = 0; b < batch_blob_mats.size(); b++)
+    {
+        feats[b] = batch_blob_mats[b][blob_index];
+
+        convert_extract_layout(feats[b], opt);
+    }
 
     set_kmp_blocktime(old_blocktime);
 
@@ -2900,6 +4831,13 @@ int Extractor::extract(int blob_index, VkMat& feat, VkCompute& cmd)
     if (blob_index < 0 || blob_index >= (int)blob_mats.size())
         return -1;
 
+    if (net->blobs[blob_index].producer == -1 && blob_mats_gpu[blob_index].dims == 0)
+    {
+        // consumed inside a fused layer chain, see Option::use_layer_fusion
+        NCNN_LOGE("blob %d is fused away", blob_index);
+        return -1;
+    }
+
     int ret = 0;
 
     if (blob_mats_gpu[blob_index].dims == 0)
@@ -2934,6 +4872,13 @@ int Extractor::extract(int blob_index, VkImageMat& feat, VkCompute& cmd)
     if (blob_index < 0 || blob_index >= (int)blob_mats.size())
         return -1;
 
+    if (net->blobs[blob_index].producer == -1 && blob_mats_gpu_image[blob_index].dims == 0)
+    {
+        // consumed inside a fused layer chain, see Option::use_layer_fusion
+        NCNN_LOGE("blob %d is fused away", blob_index);
+        return -1;
+    }
+
     int old_blocktime = get_kmp_blocktime();
     set_kmp_blocktime(opt.openmp_blocktime);
 
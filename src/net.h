@@ -33,7 +33,13 @@ class VkCompute;
 class PipelineCache;
 #endif // NCNN_VULKAN
 class DataReader;
+#if NCNN_STDIO
+class DataReaderFromMmap;
+#endif // NCNN_STDIO
 class Extractor;
+class Profiler;
+class ShapeBucket;
+class PipelineGuard;
 class Net
 {
 public:
@@ -90,6 +96,38 @@ public:
     // return 0 if success
     int load_model(FILE* fp);
     int load_model(const char* modelpath);
+
+    // map network weight data from model file into memory
+    // fp32 and int8 weight data is referenced in place instead of copied
+    // referenced weight data keeps its file offset and is only 4 byte aligned, data at other offsets is copied
+    // pages are loaded on demand and shared among processes mapping the same file
+    // the mapping is kept until clear(), the previous one until the new mapping is loaded
+    // return 0 if success
+    int load_model_mmap(const char* modelpath);
+
+    // save weight data transformed in create_pipeline into prepacked cache file
+    // call after load_model
+    // return 0 if success
+    int save_prepacked_cache(const char* path) const;
+
+    // map prepacked cache file saved from the same model, cpu and option
+    // call between load_param and load_model
+    // layers found in cache skip weight transform in create_pipeline
+    // the file is rejected if cache format version or cpu mismatch
+    // the cache is ignored in load_model if option or model weight data mismatch
+    // weight data loaded by load_model_mmap is hashed too, which reads the whole file once
+    // unless opt.use_mmap_mtime_key matches it by file size and modification time instead
+    // return 0 if success
+    int load_prepacked_cache(const char* path);
+
+    // read convolution kernel choices measured by autotune on a previous run
+    // the file is ignored if it was measured on another cpu kind, cpu count or cache version
+    // return 0 if success
+    int load_autotune_cache(const char* path);
+
+    // write convolution kernel choices measured so far, tagged with cpu features, cpu count and cache version
+    // return 0 if success
+    int save_autotune_cache(const char* path) const;
 #endif // NCNN_STDIO
 
     // load network structure from external memory
@@ -97,6 +135,12 @@ public:
     // return bytes consumed
     int load_param(const unsigned char* mem);
 
+    // load network structure from external memory without copying array params
+    // array params are referenced in place, so external memory must outlive the net
+    // memory pointer must be 32-bit aligned
+    // return bytes consumed
+    int load_param_reference(const unsigned char* mem);
+
     // reference network weight data from external memory
     // weight data is not copied but referenced
     // so external memory should be retained when used
@@ -125,14 +169,61 @@ public:
     // construct an Extractor from network
     Extractor create_extractor() const;
 
+    // time candidate convolution kernels on one forward of representative inputs
+    // the fastest choices are remembered in the autotune cache for these input shapes and opt.num_threads
+    // other forwards only measure on extractors from acquire_extractor(shape), shapes not tuned use the default kernel choice
+    // requires opt.use_conv_autotune, call after load_model
+    // return 0 if success
+    int autotune(const std::vector<int>& input_blob_indexes, const std::vector<Mat>& inputs);
+#if NCNN_STRING
+    int autotune(const std::vector<const char*>& input_blob_names, const std::vector<Mat>& inputs);
+#endif // NCNN_STRING
+
+    // take an Extractor from the pool, a new one is created if the pool is empty
+    // the Extractor keeps its internal storage and allocators between requests
+    // options set on it are kept as well
+    // thread-safe
+    Extractor* acquire_extractor() const;
+
+    // take an Extractor specialized for one input shape
+    // Extractors of the same shape share pool allocators warmed up by previous runs of that shape
+    // with opt.use_conv_autotune they also share convolution kernel choices measured on the first forward of that shape
+    // up to shape_cache_capacity shapes are kept, the least recently used idle shape is evicted
+    // choices of an evicted shape go to the net autotune cache
+    // thread-safe
+    Extractor* acquire_extractor(const Mat& shape) const;
+
+    // reset the Extractor, detach its profiler and put it back to the pool
+    // all acquired Extractors must be returned before clear()
+    // thread-safe
+    void release_extractor(Extractor* ex) const;
+
+    // number of distinct input shapes kept by acquire_extractor
+    // default is 8
+    void set_shape_cache_capacity(int capacity);
+
+    // destroy the idle pipelines created by use_lazy_pipeline
+    // they are created again on next forward
+    // thread-safe
+    void evict_pipelines() const;
+
 public:
     std::vector<Blob> blobs;
     std::vector<Layer*> layers;
 
 protected:
+    // array params reference the reader memory if reference_array is set
+    int load_param_bin(const DataReader& dr, int reference_array);
+
     // parse the structure of network
     // fuse int8 op dequantize and quantize by requantize
     int fuse_network();
+    // fold batchnorm scale bias and activation into the preceding convolution and innerproduct
+    int fuse_layers();
+    // choose fp32 or 16bit storage for each layer and insert cast layers between them
+    int plan_storage_precision(std::vector<char>& layer_fp32);
+    // remove the cast layers of a previous plan and restore the storage flags it cleared
+    void strip_storage_precision();
 
 #if NCNN_VULKAN
 
@@ -145,6 +236,19 @@ protected:
 #endif // NCNN_VULKAN
 
     friend class Extractor;
+    friend class Executor;
+    friend class PipelineExecutor;
+    friend class PipelineGuard;
+    friend class WeightBudget;
+    // option passed to create_pipeline of a layer
+    Option get_layer_option(size_t layer_index) const;
+    int create_layer_pipeline(size_t layer_index) const;
+    // create the pipeline of a lazy layer on first use and keep it while running
+    int acquire_pipeline(int layer_index) const;
+    void release_pipeline(int layer_index) const;
+    // destroy the pipeline of an idle lazy layer
+    // return 0 if destroyed, -1 if running or not created
+    int evict_pipeline(int layer_index) const;
 #if NCNN_STRING
     int find_blob_index_by_name(const char* name) const;
     int find_layer_index_by_name(const char* name) const;
@@ -153,6 +257,7 @@ protected:
 #endif // NCNN_STRING
     Layer* create_custom_layer(int index);
     int forward_layer(int layer_index, std::vector<Mat>& blob_mats, Extractor* extract, const Option& opt) const;
+    int forward_layer_batch(int layer_index, std::vector<std::vector<Mat> >& batch_blob_mats, Extractor* extract, const Option& opt) const;
 
 #if NCNN_VULKAN
     int forward_layer(int layer_index, std::vector<Mat>& blob_mats, std::vector<VkMat>& blob_mats_gpu, VkCompute& cmd, const Option& opt) const;
@@ -162,6 +267,50 @@ protected:
 protected:
     std::vector<layer_registry_entry> custom_layer_registry;
 
+    // idle extractors for reuse
+    mutable Mutex extractor_pool_lock;
+    mutable std::vector<Extractor*> extractor_pool;
+
+    // extractors and allocators per input shape, least recently used first
+    mutable std::vector<ShapeBucket*> shape_buckets;
+    int shape_cache_capacity;
+
+    // cast layers appended by plan_storage_precision
+    int cast_layer_count;
+
+    // layers kept on fp32 by plan_storage_precision, holding the cleared cast type 2=float16 4=bfloat16
+    std::vector<char> layer_fp32;
+
+    // pipelines created on first forward, empty unless use_lazy_pipeline
+    mutable Mutex pipeline_lock;
+    mutable std::vector<char> pipeline_created;
+    mutable std::vector<int> pipeline_users;
+    // transformed weight bytes accounted to weight_budget
+    mutable std::vector<size_t> pipeline_bytes;
+    WeightBudget* weight_budget;
+
+    // measured kernel choices, used if opt.autotune_cache is not set
+    AutotuneCache* autotune_cache;
+
+#if NCNN_STDIO
+    DataReaderFromMmap* model_mmap;
+    // mappings replaced by a failed load_model_mmap, layers may still reference them
+    std::vector<DataReaderFromMmap*> stale_model_mmaps;
+
+    // prepacked cache
+    DataReaderFromMmap* prepacked_mmap;
+    int prepacked_option_key;
+    unsigned int prepacked_model_hash;
+    size_t prepacked_model_size;
+    std::vector<std::vector<Mat> > prepacked_weights;
+
+    // hash and size of the model data read in load_model
+    unsigned int model_hash;
+    size_t model_size;
+    // mapped model data is hashed only when a prepacked cache is loaded or saved
+    bool model_hash_deferred;
+#endif // NCNN_STDIO
+
 #if NCNN_VULKAN
     const VulkanDevice* vkdev;
 
@@ -193,6 +342,14 @@ public:
     // set workspace memory allocator
     void set_workspace_allocator(Allocator* allocator);
 
+    // record per-layer forward into profiler, pass null to disable
+    // the profiler must outlive the extractor
+    void set_profiler(Profiler* profiler);
+
+    // release all blobs for another inference
+    // storage, options, allocators and the profiler are retained
+    void reset();
+
 #if NCNN_VULKAN
     void set_vulkan_compute(bool enable);
 
@@ -211,6 +368,12 @@ public:
     // get result by blob name
     // return 0 if success
     int extract(const char* blob_name, Mat& feat);
+
+    // get result by blob name
+    // type = 0, default
+    // type = 1, keep the internal elempack and fp16/bf16 storage, the mat can be fed to input as is
+    // return 0 if success
+    int extract(const char* blob_name, Mat& feat, int type);
 #endif // NCNN_STRING
 
     // set input by blob index
@@ -221,6 +384,33 @@ public:
     // return 0 if success
     int extract(int blob_index, Mat& feat);
 
+    // get result by blob index
+    // type = 0, default
+    // type = 1, keep the internal elempack and fp16/bf16 storage, the mat can be fed to input as is
+    // return 0 if success
+    int extract(int blob_index, Mat& feat, int type);
+
+    // batched inference on cpu
+    // layers supporting batch forward all batch items together
+    // batch inputs must be of the same shape
+#if NCNN_STRING
+    // set batch input by blob name
+    // return 0 if success
+    int input(const char* blob_name, const std::vector<Mat>& in);
+
+    // get batch result by blob name
+    // return 0 if success
+    int extract(const char* blob_name, std::vector<Mat>& feats);
+#endif // NCNN_STRING
+
+    // set batch input by blob index
+    // return 0 if success
+    int input(int blob_index, const std::vector<Mat>& in);
+
+    // get batch result by blob index
+    // return 0 if success
+    int extract(int blob_index, std::vector<Mat>& feats);
+
 #if NCNN_VULKAN
 #if NCNN_STRING
     // set input by blob name
@@ -258,6 +448,7 @@ public:
 #endif // NCNN_VULKAN
 
 //protected:
+    friend class Net;
     friend Extractor Net::create_extractor() const;
     Extractor(const Net* net, size_t blob_count);
     Extractor() {};
@@ -266,6 +457,13 @@ private:
     const Net* net;
     std::vector<Mat> blob_mats;
     Option opt;
+    Profiler* profiler;
+
+    // owner bucket if acquired for an input shape
+    ShapeBucket* shape_bucket;
+
+    // blob mats of each batch item
+    std::vector<std::vector<Mat> > batch_blob_mats;
 
 #if NCNN_VULKAN
     VkAllocator* local_blob_vkallocator;
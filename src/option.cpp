@@ -60,6 +60,16 @@ Option::Option()
     use_bf16_storage = false;
 
     use_weight_fp16_storage = false;
+
+    use_layer_fusion = false;
+
+    use_conv_autotune = false;
+    autotune_cache = 0;
+
+    use_lazy_pipeline = false;
+    weight_budget = 0;
+
+    use_mmap_mtime_key = false;
 }
 
 } // namespace ncnn
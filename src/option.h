@@ -25,6 +25,8 @@ class PipelineCache;
 #endif // NCNN_VULKAN
 
 class Allocator;
+class AutotuneCache;
+class WeightBudget;
 class Option
 {
 public:
@@ -118,6 +120,38 @@ public:
     // used for fp16 weight storage in AVX
     // TODO drop this option
     bool use_weight_fp16_storage;
+
+    // fold batchnorm scale bias and activation into convolution and innerproduct at load time
+    // intermediate blobs inside a fused chain can no longer be extracted
+    // changes should be applied before loading network structure and weight
+    // disabled by default
+    bool use_layer_fusion;
+
+    // prepare candidate 3x3 stride 1 convolution kernels and pick the one Net::autotune measured fastest
+    // winograd23 or im2col sgemm on pack1, winograd63 or direct convolution on pack8
+    // input shapes without a measurement use the default choice, only shape specialized extractors measure in forward
+    // changes should be applied before loading network structure and weight
+    // disabled by default
+    bool use_conv_autotune;
+
+    // measured kernel choices, created by net on load if not set
+    AutotuneCache* autotune_cache;
+
+    // create layer pipelines on first forward instead of in load_model
+    // untransformed weight data stays in the model file when loaded by load_model_mmap
+    // no vulkan support yet
+    // changes should be applied before loading network weight
+    // disabled by default
+    bool use_lazy_pipeline;
+
+    // shared budget for pipelines created lazily, no limit if not set
+    WeightBudget* weight_budget;
+
+    // match weight data loaded by load_model_mmap against the prepacked cache by file size and modification time
+    // instead of hashing its content, another file with the same size and time is taken for the same weights
+    // changes should be applied before loading network weight
+    // disabled by default
+    bool use_mmap_mtime_key;
 };
 
 } // namespace ncnn
@@ -169,6 +169,31 @@ static float vstr_to_float(const char vstr[16])
     return sign ? (float)v : (float)-v;
 }
 
+static int vstr_to_int(const char vstr[16], int* v)
+{
+    const char* p = vstr;
+
+    // sign
+    bool sign = *p != '-';
+    if (*p == '+' || *p == '-')
+    {
+        p++;
+    }
+
+    if (!isdigit(*p))
+        return 0;
+
+    unsigned int v1 = 0;
+    while (isdigit(*p))
+    {
+        v1 = v1 * 10 + (*p - '0');
+        p++;
+    }
+
+    *v = sign ? (int)v1 : -(int)v1;
+    return 1;
+}
+
 int ParamDict::load_param(const DataReader& dr)
 {
     clear();
@@ -217,7 +242,7 @@ int ParamDict::load_param(const DataReader& dr)
                 else
                 {
                     int* ptr = params[id].v;
-                    nscan = sscanf(vstr, "%d", &ptr[j]);
+                    nscan = vstr_to_int(vstr, &ptr[j]);
                     if (nscan != 1)
                     {
                         NCNN_LOGE("ParamDict parse array element failed");
@@ -246,7 +271,7 @@ int ParamDict::load_param(const DataReader& dr)
             }
             else
             {
-                nscan = sscanf(vstr, "%d", &params[id].i);
+                nscan = vstr_to_int(vstr, &params[id].i);
                 if (nscan != 1)
                 {
                     NCNN_LOGE("ParamDict parse value failed");
@@ -262,7 +287,7 @@ int ParamDict::load_param(const DataReader& dr)
 }
 #endif // NCNN_STRING
 
-int ParamDict::load_param_bin(const DataReader& dr)
+int ParamDict::load_param_bin(const DataReader& dr, int reference_array)
 {
     clear();
 
@@ -306,14 +331,24 @@ int ParamDict::load_param_bin(const DataReader& dr)
                 return -1;
             }
 
-            params[id].v.create(len);
-
-            float* ptr = params[id].v;
-            nread = dr.read(ptr, sizeof(float) * len);
-            if (nread != sizeof(float) * len)
+            // reference array in place if asked and the reader supports it
+            const void* refbuf = 0;
+            nread = reference_array ? dr.reference(sizeof(float) * len, &refbuf) : 0;
+            if (nread == sizeof(float) * len)
             {
-                NCNN_LOGE("ParamDict read array element failed %zd", nread);
-                return -1;
+                params[id].v = Mat(len, (void*)refbuf);
+            }
+            else
+            {
+                params[id].v.create(len);
+
+                float* ptr = params[id].v;
+                nread = dr.read(ptr, sizeof(float) * len);
+                if (nread != sizeof(float) * len)
+                {
+                    NCNN_LOGE("ParamDict read array element failed %zd", nread);
+                    return -1;
+                }
             }
 
             params[id].type = 4;
@@ -50,7 +50,9 @@ protected:
     void clear();
 
     int load_param(const DataReader& dr);
-    int load_param_bin(const DataReader& dr);
+    // array params are copied unless reference_array is set
+    // referenced arrays point into the reader memory, which must outlive the params
+    int load_param_bin(const DataReader& dr, int reference_array = 0);
 
 protected:
     struct
@@ -0,0 +1,507 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "profiler.h"
+
+#include "layer/convolution.h"
+#include "layer/convolutiondepthwise.h"
+#include "layer/deconvolution.h"
+#include "layer/deconvolutiondepthwise.h"
+#include "layer/gemm.h"
+#include "layer/innerproduct.h"
+#include "layer/lstm.h"
+#include "layer/rnn.h"
+
+#include <float.h>
+#include <string.h>
+
+namespace ncnn {
+
+static ProfileBlob make_profile_blob(const Mat& m)
+{
+    ProfileBlob blob;
+    blob.dims = m.dims;
+    blob.w = m.w;
+    blob.h = m.h;
+    blob.c = m.c;
+    blob.elemsize = m.elemsize;
+    blob.elempack = m.elempack;
+    return blob;
+}
+
+static double blob_bytes(const ProfileBlob& blob)
+{
+    if (blob.dims == 0)
+        return 0;
+
+    return (double)blob.w * blob.h * blob.c * blob.elemsize;
+}
+
+static double blob_elements(const ProfileBlob& blob)
+{
+    if (blob.dims == 0)
+        return 0;
+
+    return (double)blob.w * blob.h * blob.c * blob.elempack;
+}
+
+static const char* precision_name(const ProfileBlob& blob, const Option& opt)
+{
+    if (blob.dims == 0 || blob.elempack == 0)
+        return "fp32";
+
+    size_t elembits = blob.elemsize * 8 / blob.elempack;
+    if (elembits == 8)
+        return "int8";
+    if (elembits == 16)
+        return opt.use_bf16_storage ? "bf16" : "fp16";
+
+    return "fp32";
+}
+
+// multiply-add counts as two operations, bias and activation are ignored
+static double estimate_flops(const Layer* layer, const std::vector<ProfileBlob>& bottoms, const std::vector<ProfileBlob>& tops)
+{
+    const ProfileBlob& bottom = bottoms.empty() ? ProfileBlob() : bottoms[0];
+    const ProfileBlob& top = tops.empty() ? ProfileBlob() : tops[0];
+
+    if (layer->type == "Convolution")
+    {
+        return 2.0 * top.w * top.h * ((const Convolution*)layer)->weight_data_size;
+    }
+    if (layer->type == "ConvolutionDepthWise")
+    {
+        return 2.0 * top.w * top.h * ((const ConvolutionDepthWise*)layer)->weight_data_size;
+    }
+    if (layer->type == "Deconvolution")
+    {
+        return 2.0 * bottom.w * bottom.h * ((const Deconvolution*)layer)->weight_data_size;
+    }
+    if (layer->type == "DeconvolutionDepthWise")
+    {
+        return 2.0 * bottom.w * bottom.h * ((const DeconvolutionDepthWise*)layer)->weight_data_size;
+    }
+    if (layer->type == "InnerProduct")
+    {
+        int rows = bottom.dims == 2 ? bottom.h : 1;
+        return 2.0 * rows * ((const InnerProduct*)layer)->weight_data_size;
+    }
+    if (layer->type == "Gemm" && bottoms.size() >= 1)
+    {
+        int K = ((const Gemm*)layer)->transA ? bottom.h : bottom.w;
+        return 2.0 * top.w * top.h * K;
+    }
+    if (layer->type == "LSTM")
+    {
+        const LSTM* lstm = (const LSTM*)layer;
+        int num_directions = lstm->direction == 2 ? 2 : 1;
+        double weight_hc_size = 4.0 * lstm->num_output * lstm->num_output * num_directions;
+        return 2.0 * bottom.h * (lstm->weight_data_size + weight_hc_size);
+    }
+    if (layer->type == "RNN")
+    {
+        const RNN* rnn = (const RNN*)layer;
+        double weight_hc_size = (double)rnn->num_output * rnn->num_output;
+        return 2.0 * bottom.h * (rnn->weight_data_size + weight_hc_size);
+    }
+
+    // one operation per output element
+    double flops = 0;
+    for (size_t i = 0; i < tops.size(); i++)
+    {
+        flops += blob_elements(tops[i]);
+    }
+    return flops;
+}
+
+static double estimate_weight_bytes(const Layer* layer, const Option& opt)
+{
+    int weight_data_size = 0;
+    if (layer->type == "Convolution")
+        weight_data_size = ((const Convolution*)layer)->weight_data_size;
+    else if (layer->type == "ConvolutionDepthWise")
+        weight_data_size = ((const ConvolutionDepthWise*)layer)->weight_data_size;
+    else if (layer->type == "Deconvolution")
+        weight_data_size = ((const Deconvolution*)layer)->weight_data_size;
+    else if (layer->type == "DeconvolutionDepthWise")
+        weight_data_size = ((const DeconvolutionDepthWise*)layer)->weight_data_size;
+    else if (layer->type == "InnerProduct")
+        weight_data_size = ((const InnerProduct*)layer)->weight_data_size;
+
+    if (opt.use_int8_inference && layer->use_int8_inference)
+        return weight_data_size;
+
+    if (opt.use_weight_fp16_storage && layer->support_weight_fp16_storage)
+        return weight_data_size * 2.0;
+
+    return weight_data_size * 4.0;
+}
+
+Profiler::Profiler()
+{
+    max_records = 65536;
+    head = 0;
+}
+
+Profiler::~Profiler()
+{
+}
+
+Profiler::Profiler(const Profiler&)
+{
+}
+
+Profiler& Profiler::operator=(const Profiler&)
+{
+    return *this;
+}
+
+void Profiler::clear()
+{
+    MutexLockGuard guard(lock);
+
+    _records.clear();
+    head = 0;
+    streams.clear();
+}
+
+void Profiler::set_max_records(size_t n)
+{
+    MutexLockGuard guard(lock);
+
+    // unroll the ring buffer, oldest first
+    std::vector<ProfileRecord> rs(_records.begin() + head, _records.end());
+    rs.insert(rs.end(), _records.begin(), _records.begin() + head);
+
+    if (n && rs.size() > n)
+    {
+        rs.erase(rs.begin(), rs.end() - n);
+    }
+
+    _records.swap(rs);
+    head = 0;
+    max_records = n;
+}
+
+void Profiler::mark(const Option& opt)
+{
+    if (opt.blob_allocator)
+        opt.blob_allocator->mark_statistics();
+
+    if (opt.workspace_allocator && opt.workspace_allocator != opt.blob_allocator)
+        opt.workspace_allocator->mark_statistics();
+}
+
+void Profiler::record(const void* stream, int layer_index, const Layer* layer, const std::vector<Mat>& bottom_blobs, const std::vector<Mat>& top_blobs, double start, double end, const Option& opt, int batch)
+{
+    ProfileRecord r;
+    r.layer_index = layer_index;
+    r.name = layer->name;
+    r.type = layer->type;
+    r.start = start;
+    r.end = end;
+    r.num_threads = opt.num_threads;
+    r.batch = batch;
+
+    r.bottoms.resize(bottom_blobs.size());
+    for (size_t i = 0; i < bottom_blobs.size(); i++)
+    {
+        r.bottoms[i] = make_profile_blob(bottom_blobs[i]);
+    }
+
+    r.tops.resize(top_blobs.size());
+    for (size_t i = 0; i < top_blobs.size(); i++)
+    {
+        r.tops[i] = make_profile_blob(top_blobs[i]);
+    }
+
+    r.precision = precision_name(r.tops.empty() ? ProfileBlob() : r.tops[0], opt);
+
+    double bytes = estimate_weight_bytes(layer, opt);
+    for (size_t i = 0; i < r.bottoms.size(); i++)
+    {
+        bytes += blob_bytes(r.bottoms[i]) * batch;
+    }
+    for (size_t i = 0; i < r.tops.size(); i++)
+    {
+        bytes += blob_bytes(r.tops[i]) * batch;
+    }
+
+    r.flops = estimate_flops(layer, r.bottoms, r.tops) * batch;
+    r.bytes = bytes;
+
+    r.blob_bytes = 0;
+    r.blob_peak_bytes = 0;
+    r.workspace_peak_bytes = 0;
+    if (opt.blob_allocator)
+    {
+        AllocatorStatistics stat = opt.blob_allocator->statistics();
+        r.blob_bytes = stat.current_bytes;
+        r.blob_peak_bytes = stat.mark_peak_bytes;
+    }
+    if (opt.workspace_allocator)
+    {
+        r.workspace_peak_bytes = opt.workspace_allocator->statistics().mark_peak_bytes;
+    }
+
+    MutexLockGuard guard(lock);
+
+    // streams only holds live extractors, so the scan stays short
+    r.stream = -1;
+    int free_stream = -1;
+    for (size_t i = 0; i < streams.size(); i++)
+    {
+        if (streams[i] == stream)
+        {
+            r.stream = (int)i;
+            break;
+        }
+        if (!streams[i] && free_stream == -1)
+        {
+            free_stream = (int)i;
+        }
+    }
+    if (r.stream == -1)
+    {
+        if (free_stream == -1)
+        {
+            free_stream = (int)streams.size();
+            streams.push_back(0);
+        }
+
+        r.stream = free_stream;
+        streams[free_stream] = stream;
+    }
+
+    if (max_records == 0 || _records.size() < max_records)
+    {
+        _records.push_back(r);
+    }
+    else
+    {
+        // overwrite the oldest
+        _records[head] = r;
+        head = (head + 1) % max_records;
+    }
+}
+
+void Profiler::remove_stream(const void* stream)
+{
+    MutexLockGuard guard(lock);
+
+    for (size_t i = 0; i < streams.size(); i++)
+    {
+        if (streams[i] == stream)
+        {
+            streams[i] = 0;
+            break;
+        }
+    }
+
+    while (!streams.empty() && !streams.back())
+    {
+        streams.pop_back();
+    }
+}
+
+std::vector<ProfileRecord> Profiler::records() const
+{
+    MutexLockGuard guard(lock);
+
+    if (head == 0)
+        return _records;
+
+    std::vector<ProfileRecord> rs;
+    rs.reserve(_records.size());
+    rs.insert(rs.end(), _records.begin() + head, _records.end());
+    rs.insert(rs.end(), _records.begin(), _records.begin() + head);
+    return rs;
+}
+
+#if NCNN_STDIO
+static void print_shape(char* buf, size_t len, const ProfileBlob& blob)
+{
+    if (blob.dims == 1)
+        snprintf(buf, len, "%d pack%d", blob.w, blob.elempack);
+    else if (blob.dims == 2)
+        snprintf(buf, len, "%dx%d pack%d", blob.w, blob.h, blob.elempack);
+    else if (blob.dims == 3)
+        snprintf(buf, len, "%dx%dx%d pack%d", blob.w, blob.h, blob.c, blob.elempack);
+    else
+        snprintf(buf, len, "-");
+}
+
+static void print_json_string(FILE* fp, const std::string& s)
+{
+    fputc('"', fp);
+    for (size_t i = 0; i < s.size(); i++)
+    {
+        char ch = s[i];
+        if (ch == '"' || ch == '\\')
+        {
+            fputc('\\', fp);
+            fputc(ch, fp);
+        }
+        else if ((unsigned char)ch < 0x20)
+        {
+            fprintf(fp, "\\u%04x", (unsigned char)ch);
+        }
+        else
+        {
+            fputc(ch, fp);
+        }
+    }
+    fputc('"', fp);
+}
+
+static void print_json_shapes(FILE* fp, const std::vector<ProfileBlob>& blobs)
+{
+    fputc('[', fp);
+    for (size_t i = 0; i < blobs.size(); i++)
+    {
+        char shape[64];
+        print_shape(shape, sizeof(shape), blobs[i]);
+        fprintf(fp, "%s\"%s\"", i == 0 ? "" : ",", shape);
+    }
+    fputc(']', fp);
+}
+
+int Profiler::save_chrome_trace(const char* path) const
+{
+    FILE* fp = fopen(path, "wb");
+    if (!fp)
+    {
+        NCNN_LOGE("fopen %s failed", path);
+        return -1;
+    }
+
+    std::vector<ProfileRecord> rs = records();
+
+    double origin = DBL_MAX;
+    for (size_t i = 0; i < rs.size(); i++)
+    {
+        origin = std::min(origin, rs[i].start);
+    }
+
+    fprintf(fp, "{\"traceEvents\":[\n");
+    for (size_t i = 0; i < rs.size(); i++)
+    {
+        const ProfileRecord& r = rs[i];
+
+        // chrome trace timestamps are in microseconds
+        fprintf(fp, "{\"name\":");
+        print_json_string(fp, r.name);
+        fprintf(fp, ",\"cat\":");
+        print_json_string(fp, r.type);
+        fprintf(fp, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%d", (r.start - origin) * 1000, (r.end - r.start) * 1000, r.stream);
+        fprintf(fp, ",\"args\":{\"layer\":%d,\"threads\":%d,\"batch\":%d,\"precision\":\"%s\",\"flops\":%.0f,\"bytes\":%.0f", r.layer_index, r.num_threads, r.batch, r.precision, r.flops, r.bytes);
+        fprintf(fp, ",\"blob_bytes\":%lu,\"blob_peak_bytes\":%lu,\"workspace_peak_bytes\":%lu,\"bottoms\":", (unsigned long)r.blob_bytes, (unsigned long)r.blob_peak_bytes, (unsigned long)r.workspace_peak_bytes);
+        print_json_shapes(fp, r.bottoms);
+        fprintf(fp, ",\"tops\":");
+        print_json_shapes(fp, r.tops);
+        fprintf(fp, "}}%s\n", i + 1 == rs.size() ? "" : ",");
+    }
+    fprintf(fp, "],\"displayTimeUnit\":\"ms\"}\n");
+
+    fclose(fp);
+
+    return 0;
+}
+
+int Profiler::save_summary(FILE* fp) const
+{
+    std::vector<ProfileRecord> rs = records();
+
+    // aggregate by layer in forward order
+    std::vector<int> order;
+    std::vector<int> first;
+    std::vector<int> count;
+    std::vector<double> time_total;
+    std::vector<double> time_min;
+    std::vector<double> time_max;
+    std::vector<double> flops_total;
+    std::vector<double> bytes_total;
+    std::vector<size_t> blob_peak;
+    std::vector<size_t> workspace_peak;
+    double time_all = 0;
+
+    for (size_t i = 0; i < rs.size(); i++)
+    {
+        const ProfileRecord& r = rs[i];
+
+        if (r.layer_index >= (int)first.size())
+        {
+            int n = r.layer_index + 1;
+            first.resize(n, -1);
+            count.resize(n, 0);
+            time_total.resize(n, 0.0);
+            time_min.resize(n, DBL_MAX);
+            time_max.resize(n, 0.0);
+            flops_total.resize(n, 0.0);
+            bytes_total.resize(n, 0.0);
+            blob_peak.resize(n, 0);
+            workspace_peak.resize(n, 0);
+        }
+
+        int li = r.layer_index;
+        double time = r.end - r.start;
+
+        if (first[li] == -1)
+        {
+            first[li] = (int)i;
+            order.push_back(li);
+        }
+
+        count[li] += 1;
+        time_total[li] += time;
+        time_min[li] = std::min(time_min[li], time);
+        time_max[li] = std::max(time_max[li], time);
+        flops_total[li] += r.flops;
+        bytes_total[li] += r.bytes;
+        blob_peak[li] = std::max(blob_peak[li], r.blob_peak_bytes);
+        workspace_peak[li] = std::max(workspace_peak[li], r.workspace_peak_bytes);
+        time_all += time;
+    }
+
+    fprintf(fp, "%-5s %-24s %-22s %5s %9s %9s %9s %6s %3s %-20s %-20s %-4s %10s %10s %8s %10s %10s\n",
+            "index", "name", "type", "count", "avg(ms)", "min(ms)", "max(ms)", "%", "thr", "bottom", "top", "prec", "MFLOPs", "MB", "GFLOPS", "blob(MB)", "ws(MB)");
+
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        int li = order[i];
+        const ProfileRecord& r = rs[first[li]];
+
+        char bottom_shape[64];
+        char top_shape[64];
+        print_shape(bottom_shape, sizeof(bottom_shape), r.bottoms.empty() ? ProfileBlob() : r.bottoms[0]);
+        print_shape(top_shape, sizeof(top_shape), r.tops.empty() ? ProfileBlob() : r.tops[0]);
+
+        double avg = time_total[li] / count[li];
+        double flops_avg = flops_total[li] / count[li];
+        double bytes_avg = bytes_total[li] / count[li];
+        double gflops = avg > 0 ? flops_avg / (avg * 1e6) : 0;
+        double percent = time_all > 0 ? time_total[li] * 100 / time_all : 0;
+
+        fprintf(fp, "%-5d %-24s %-22s %5d %9.3f %9.3f %9.3f %6.2f %3d %-20s %-20s %-4s %10.2f %10.2f %8.2f %10.2f %10.2f\n",
+                li, r.name.c_str(), r.type.c_str(), count[li], avg, time_min[li], time_max[li], percent, r.num_threads,
+                bottom_shape, top_shape, r.precision, flops_avg / 1e6, bytes_avg / 1e6, gflops, blob_peak[li] / 1e6, workspace_peak[li] / 1e6);
+    }
+
+    fprintf(fp, "total %d records  %.3f ms\n", (int)rs.size(), time_all);
+
+    return 0;
+}
+#endif // NCNN_STDIO
+
+} // namespace ncnn
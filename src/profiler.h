@@ -0,0 +1,134 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef NCNN_PROFILER_H
+#define NCNN_PROFILER_H
+
+#include "layer.h"
+#include "mat.h"
+#include "option.h"
+#include "platform.h"
+
+#if NCNN_STDIO
+#include <stdio.h>
+#endif // NCNN_STDIO
+
+namespace ncnn {
+
+// shape and storage of one blob seen by a profiled layer
+struct ProfileBlob
+{
+    int dims;
+    int w;
+    int h;
+    int c;
+    size_t elemsize;
+    int elempack;
+};
+
+// one layer forward
+class ProfileRecord
+{
+public:
+    int layer_index;
+    std::string name;
+    std::string type;
+
+    // timestamp in ms, as returned by get_current_time
+    double start;
+    double end;
+
+    // distinguish extractors sharing the same profiler
+    int stream;
+    int num_threads;
+    int batch;
+
+    std::vector<ProfileBlob> bottoms;
+    std::vector<ProfileBlob> tops;
+
+    // fp32 fp16 bf16 or int8, taken from the first top blob
+    const char* precision;
+
+    // estimated floating point operations and bytes moved
+    double flops;
+    double bytes;
+
+    // blob allocator usage after forward, blob and workspace allocator peak usage during forward
+    // zero if the allocator keeps no statistics
+    size_t blob_bytes;
+    size_t blob_peak_bytes;
+    size_t workspace_peak_bytes;
+};
+
+// runtime per-layer profiler
+// attach to an extractor with Extractor::set_profiler
+// a profiler may be shared by extractors running on different threads
+// records are kept in a ring buffer, the oldest ones are overwritten once max_records is reached
+// allocator peaks are per layer only if the profiled extractor does not share its allocators
+// with another extractor running at the same time, otherwise they mix both
+class Profiler
+{
+public:
+    Profiler();
+    ~Profiler();
+
+    // drop all records
+    void clear();
+
+    // keep at most the latest n records, zero for unlimited
+    // default is 65536
+    void set_max_records(size_t n);
+
+    // restart allocator peak tracking before one layer forward
+    // the allocators are marked without the profiler lock
+    void mark(const Option& opt);
+
+    // record one layer forward
+    // each distinct stream gets its own index in the records
+    void record(const void* stream, int layer_index, const Layer* layer, const std::vector<Mat>& bottom_blobs, const std::vector<Mat>& top_blobs, double start, double end, const Option& opt, int batch = 1);
+
+    // forget a stream that records no more, its index is given to the next new stream
+    // called when the extractor is destroyed or detached
+    void remove_stream(const void* stream);
+
+    // snapshot of the kept records, oldest first
+    std::vector<ProfileRecord> records() const;
+
+#if NCNN_STDIO
+    // chrome://tracing and perfetto json
+    // return 0 if success
+    int save_chrome_trace(const char* path) const;
+
+    // per-layer table aggregated over all records
+    // return 0 if success
+    int save_summary(FILE* fp) const;
+#endif // NCNN_STDIO
+
+private:
+    Profiler(const Profiler&);
+    Profiler& operator=(const Profiler&);
+
+private:
+    mutable Mutex lock;
+    std::vector<ProfileRecord> _records;
+    size_t max_records;
+    // index of the oldest record once the ring buffer is full
+    size_t head;
+    // live streams by index, null for a free index
+    std::vector<const void*> streams;
+};
+
+} // namespace ncnn
+
+#endif // NCNN_PROFILER_H
@@ -0,0 +1,149 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "weightbudget.h"
+
+#include "net.h"
+
+namespace ncnn {
+
+WeightBudget::WeightBudget(size_t budget)
+    : _budget(budget), _usage(0)
+{
+}
+
+WeightBudget::~WeightBudget()
+{
+    if (!entries.empty())
+    {
+        NCNN_LOGE("WeightBudget destroyed with %d pipelines of loaded nets", (int)entries.size());
+    }
+}
+
+void WeightBudget::set_budget(size_t budget)
+{
+    MutexLockGuard guard(lock);
+
+    _budget = budget;
+
+    if (_budget != 0 && _usage > _budget)
+        shrink(_budget);
+}
+
+size_t WeightBudget::budget() const
+{
+    MutexLockGuard guard(lock);
+
+    return _budget;
+}
+
+size_t WeightBudget::usage() const
+{
+    MutexLockGuard guard(lock);
+
+    return _usage;
+}
+
+void WeightBudget::trim()
+{
+    MutexLockGuard guard(lock);
+
+    shrink(0);
+}
+
+void WeightBudget::add(const Net* net, int layer_index, size_t bytes)
+{
+    MutexLockGuard guard(lock);
+
+    Entry e;
+    e.net = net;
+    e.layer_index = layer_index;
+    e.bytes = bytes;
+    entries.push_back(e);
+
+    _usage += bytes;
+
+    // the new pipeline is in use and never picked
+    if (_budget != 0 && _usage > _budget)
+        shrink(_budget);
+}
+
+void WeightBudget::touch(const Net* net, int layer_index)
+{
+    MutexLockGuard guard(lock);
+
+    // recent entries are most likely touched again, search from the back
+    for (int i = (int)entries.size() - 1; i >= 0; i--)
+    {
+        if (entries[i].net != net || entries[i].layer_index != layer_index)
+            continue;
+
+        Entry e = entries[i];
+        entries.erase(entries.begin() + i);
+        entries.push_back(e);
+        break;
+    }
+}
+
+void WeightBudget::evict(const Net* net)
+{
+    MutexLockGuard guard(lock);
+
+    for (size_t i = 0; i < entries.size();)
+    {
+        if (entries[i].net != net || net->evict_pipeline(entries[i].layer_index) != 0)
+        {
+            i++;
+            continue;
+        }
+
+        _usage -= entries[i].bytes;
+        entries.erase(entries.begin() + i);
+    }
+}
+
+void WeightBudget::remove(const Net* net)
+{
+    MutexLockGuard guard(lock);
+
+    for (size_t i = 0; i < entries.size();)
+    {
+        if (entries[i].net != net)
+        {
+            i++;
+            continue;
+        }
+
+        _usage -= entries[i].bytes;
+        entries.erase(entries.begin() + i);
+    }
+}
+
+void WeightBudget::shrink(size_t target)
+{
+    for (size_t i = 0; i < entries.size() && _usage > target;)
+    {
+        // pipelines running right now are skipped, the budget may be exceeded until they go idle
+        if (entries[i].net->evict_pipeline(entries[i].layer_index) != 0)
+        {
+            i++;
+            continue;
+        }
+
+        _usage -= entries[i].bytes;
+        entries.erase(entries.begin() + i);
+    }
+}
+
+} // namespace ncnn
@@ -0,0 +1,96 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef NCNN_WEIGHTBUDGET_H
+#define NCNN_WEIGHTBUDGET_H
+
+#include "platform.h"
+
+#include <stddef.h>
+
+namespace ncnn {
+
+class Net;
+
+// memory budget for weight data transformed in create_pipeline
+// shared by nets loaded with use_lazy_pipeline
+// a layer pipeline is accounted when it is created on first use
+// once the total exceeds the budget, the least recently used idle pipelines of any net are destroyed
+// and created again from the untransformed weight data on next use
+// only layers exposing their transformed weights through get_prepacked_weights are accounted,
+// which are the x86 Convolution, ConvolutionDepthWise, InnerProduct, Deconvolution and DeconvolutionDepthWise so far
+// pipelines of other layers are created lazily as well, but the budget neither counts nor evicts them
+// Net::evict_pipelines still destroys them
+// nets must be cleared before the budget is destroyed
+// thread-safe
+class WeightBudget
+{
+public:
+    // budget in bytes, 0 for no limit
+    WeightBudget(size_t budget = 0);
+    ~WeightBudget();
+
+    // evict down to the new budget
+    void set_budget(size_t budget);
+
+    size_t budget() const;
+
+    // bytes held by resident pipelines
+    size_t usage() const;
+
+    // destroy all idle pipelines
+    void trim();
+
+protected:
+    friend class Net;
+
+    // account a newly created pipeline as most recently used
+    void add(const Net* net, int layer_index, size_t bytes);
+
+    // mark a resident pipeline as most recently used
+    void touch(const Net* net, int layer_index);
+
+    // destroy the idle pipelines of a net
+    void evict(const Net* net);
+
+    // forget all pipelines of a net
+    void remove(const Net* net);
+
+private:
+    WeightBudget(const WeightBudget&);
+    WeightBudget& operator=(const WeightBudget&);
+
+    // destroy idle pipelines in lru order until usage drops to target
+    // called with lock held
+    void shrink(size_t target);
+
+private:
+    struct Entry
+    {
+        const Net* net;
+        int layer_index;
+        size_t bytes;
+    };
+
+    mutable Mutex lock;
+    size_t _budget;
+    size_t _usage;
+
+    // least recently used first
+    std::vector<Entry> entries;
+};
+
+} // namespace ncnn
+
+#endif // NCNN_WEIGHTBUDGET_H
@@ -0,0 +1,102 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "allocator.h"
+
+#include <stdio.h>
+
+static int check(const char* name, const char* what, size_t value, size_t expect)
+{
+    if (value != expect)
+    {
+        fprintf(stderr, "test_allocator %s %s %lu expect %lu\n", name, what, (unsigned long)value, (unsigned long)expect);
+        return -1;
+    }
+
+    return 0;
+}
+
+template<typename T>
+static int test_allocator(const char* name)
+{
+    T allocator;
+
+    void* a = allocator.fastMalloc(1000);
+    void* b = allocator.fastMalloc(2000);
+
+    ncnn::AllocatorStatistics stat = allocator.statistics();
+    if (check(name, "current_bytes", stat.current_bytes, 3000)
+            || check(name, "peak_bytes", stat.peak_bytes, 3000)
+            || check(name, "reserved_bytes", stat.reserved_bytes, 3000)
+            || check(name, "malloc_count", stat.malloc_count, 2)
+            || check(name, "miss_count", stat.miss_count, 2)
+            || check(name, "hit_count", stat.hit_count, 0))
+        return -1;
+
+    allocator.fastFree(a);
+
+    // peak since mark restarts from current usage
+    allocator.mark_statistics();
+
+    // 900 bytes reuse the 1000 bytes budget within the default size compare ratio
+    void* c = allocator.fastMalloc(900);
+
+    stat = allocator.statistics();
+    if (check(name, "current_bytes", stat.current_bytes, 3000)
+            || check(name, "peak_bytes", stat.peak_bytes, 3000)
+            || check(name, "mark_peak_bytes", stat.mark_peak_bytes, 3000)
+            || check(name, "reserved_bytes", stat.reserved_bytes, 3000)
+            || check(name, "free_count", stat.free_count, 1)
+            || check(name, "hit_count", stat.hit_count, 1)
+            || check(name, "slack_bytes", stat.slack_bytes, 100))
+        return -1;
+
+    allocator.fastFree(b);
+    allocator.mark_statistics();
+
+    stat = allocator.statistics();
+    if (check(name, "current_bytes", stat.current_bytes, 1000)
+            || check(name, "peak_bytes", stat.peak_bytes, 3000)
+            || check(name, "mark_peak_bytes", stat.mark_peak_bytes, 1000))
+        return -1;
+
+    allocator.fastFree(c);
+
+    // counters restart, pool budgets stay reserved until clear
+    allocator.reset_statistics();
+
+    stat = allocator.statistics();
+    if (check(name, "current_bytes", stat.current_bytes, 0)
+            || check(name, "peak_bytes", stat.peak_bytes, 0)
+            || check(name, "malloc_count", stat.malloc_count, 0)
+            || check(name, "free_count", stat.free_count, 0)
+            || check(name, "reserved_bytes", stat.reserved_bytes, 3000))
+        return -1;
+
+    allocator.clear();
+
+    stat = allocator.statistics();
+    if (check(name, "reserved_bytes", stat.reserved_bytes, 0)
+            || check(name, "peak_reserved_bytes", stat.peak_reserved_bytes, 3000))
+        return -1;
+
+    return 0;
+}
+
+int main()
+{
+    return 0
+           || test_allocator<ncnn::PoolAllocator>("PoolAllocator")
+           || test_allocator<ncnn::UnlockedPoolAllocator>("UnlockedPoolAllocator");
+}
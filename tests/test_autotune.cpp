@@ -0,0 +1,166 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "autotune.h"
+#include "net.h"
+#include "testutil.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// conv0 runs pack8 and conv2 runs pack1, both 3x3 stride 1
+// 8 channels keep conv0 off the pack16 path of avx512 builds
+static const char param[] = "7767517\n"
+                            "4 4\n"
+                            "Input            data   0 1 data 0=16 1=16 2=8\n"
+                            "Convolution      conv0  1 1 data conv0 0=8 1=3 4=1 5=1 6=576 9=1\n"
+                            "Convolution      conv1  1 1 conv0 conv1 0=4 1=1 5=1 6=32\n"
+                            "Convolution      conv2  1 1 conv1 out 0=4 1=3 4=1 5=1 6=144\n";
+
+static const int weight_sizes[] = {576, -8, 32, -4, 144, -4};
+
+static int forward(const ncnn::Net& net, const ncnn::Mat& in, ncnn::Mat& out)
+{
+    ncnn::Extractor ex = net.create_extractor();
+#if NCNN_CNNCACHE
+    // the cached path runs the reference convolution
+    ex.cache_mode = false;
+#endif // NCNN_CNNCACHE
+    ex.input("data", in);
+    return ex.extract("out", out);
+}
+
+// entries of a saved autotune cache, header line skipped
+static int read_autotune_keys(const char* path, std::vector<std::string>& keys)
+{
+    FILE* fp = fopen(path, "rb");
+    if (!fp)
+        return -1;
+
+    char line[256];
+    if (!fgets(line, sizeof(line), fp))
+    {
+        fclose(fp);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), fp))
+    {
+        char* eq = strrchr(line, '=');
+        if (!eq || eq == line)
+            continue;
+
+        keys.push_back(std::string(line, eq - line - 1));
+    }
+
+    fclose(fp);
+
+    return 0;
+}
+
+static int test_autotune_0(const ncnn::Mat& model, const ncnn::Mat& in, const char* path)
+{
+    ncnn::Net net0;
+    net0.opt.use_packing_layout = true;
+    net0.load_param_mem(param);
+    net0.load_model((const unsigned char*)model.data);
+
+    ncnn::Mat out0;
+    if (forward(net0, in, out0) != 0)
+        return -1;
+
+    ncnn::Net net;
+    net.opt.use_packing_layout = true;
+    net.opt.use_conv_autotune = true;
+    net.load_param_mem(param);
+    net.load_model((const unsigned char*)model.data);
+
+    if (net.autotune(std::vector<const char*>(1, "data"), std::vector<ncnn::Mat>(1, in)) != 0)
+    {
+        fprintf(stderr, "test_autotune_0 autotune failed\n");
+        return -1;
+    }
+
+    if (net.save_autotune_cache(path) != 0)
+    {
+        fprintf(stderr, "test_autotune_0 save_autotune_cache failed\n");
+        return -1;
+    }
+
+    // one choice for the packed and one for the unpacked convolution
+    std::vector<std::string> keys;
+    read_autotune_keys(path, keys);
+    if (keys.size() != 2 || keys[0].find("pack8") == std::string::npos || keys[1].find("pack1") == std::string::npos)
+    {
+        fprintf(stderr, "test_autotune_0 measured %d kernel choices expect 2\n", (int)keys.size());
+        return -1;
+    }
+
+    // every candidate kernel gives the untuned result
+    for (int algo = 0; algo < 2; algo++)
+    {
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            net.opt.autotune_cache->set(keys[i], algo);
+        }
+
+        ncnn::Mat out;
+        if (forward(net, in, out) != 0 || CompareMat(out0, out, 0.01) != 0)
+        {
+            fprintf(stderr, "test_autotune_0 algo %d output not match\n", algo);
+            return -1;
+        }
+    }
+
+    ncnn::Net net1;
+    net1.opt.use_conv_autotune = true;
+    if (net1.load_autotune_cache(path) != 0)
+    {
+        fprintf(stderr, "test_autotune_0 load_autotune_cache failed\n");
+        return -1;
+    }
+
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        if (net1.opt.autotune_cache->get(keys[i]) != net.opt.autotune_cache->get(keys[i]))
+        {
+            fprintf(stderr, "test_autotune_0 reloaded choice of %s not match\n", keys[i].c_str());
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    const char* tmpdir = getenv("TMPDIR");
+    if (!tmpdir) tmpdir = getenv("TEMP");
+    if (!tmpdir) tmpdir = ".";
+
+    char path[256];
+    sprintf(path, "%s/test_autotune_%d.txt", tmpdir, (int)time(NULL));
+
+    ncnn::Mat model = RandomModelData(weight_sizes, sizeof(weight_sizes) / sizeof(int));
+    ncnn::Mat in = RandomMat(16, 16, 8);
+
+    int ret = test_autotune_0(model, in, path);
+
+    remove(path);
+
+    return ret;
+}
@@ -251,9 +251,20 @@ static int test_convolutiondepthwise_1()
     return 0;
 }
 
+static int test_convolutiondepthwise_2()
+{
+    // bf16 storage widens the input in bands of output rows
+    // these shapes split into several bands or fall back to the whole blob
+    return 0
+           || test_convolutiondepthwise(64, 64, 32, 32, 3, 1, 1, 1, 1, 32)
+           || test_convolutiondepthwise(64, 64, 32, 32, 3, 1, 2, 1, 0, 32)
+           || test_convolutiondepthwise(128, 128, 4, 4, 5, 1, 1, 2, 1, 4)
+           || test_convolutiondepthwise(512, 8, 32, 32, 3, 1, 1, 1, 0, 32);
+}
+
 int main()
 {
     SRAND(7767517);
 
-    return test_convolutiondepthwise_0() || test_convolutiondepthwise_1();
+    return test_convolutiondepthwise_0() || test_convolutiondepthwise_1() || test_convolutiondepthwise_2();
 }
@@ -0,0 +1,266 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "executor.h"
+#include "net.h"
+#include "testutil.h"
+
+static const char param[] = "7767517\n"
+                            "8 9\n"
+                            "Input            data   0 1 data 0=16 1=16 2=8\n"
+                            "Split            split  1 2 data data_0 data_1\n"
+                            "Convolution      conv0  1 1 data_0 conv0 0=16 1=3 4=1 5=1 6=1152\n"
+                            "Convolution      conv1  1 1 data_1 conv1 0=16 1=1 5=1 6=128\n"
+                            "Eltwise          sum    2 1 conv0 conv1 sum 0=1\n"
+                            "Pooling          pool   1 1 sum pool 0=0 1=2 2=2\n"
+                            "InnerProduct     fc     1 1 pool fc 0=10 1=1 2=10240\n"
+                            "Softmax          prob   1 1 fc prob\n";
+
+static const int weight_sizes[] = {1152, -16, 128, -16, 10240, -10};
+
+static const int input_count = 16;
+
+// outputs of a plain extractor per input
+static int forward_reference(const ncnn::Net& net, const std::vector<ncnn::Mat>& inputs, std::vector<std::vector<ncnn::Mat> >& outputs)
+{
+    outputs.resize(inputs.size());
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        outputs[i].resize(2);
+
+        ncnn::Extractor ex = net.create_extractor();
+        ex.input("data", inputs[i]);
+        if (ex.extract("sum", outputs[i][0]) != 0 || ex.extract("prob", outputs[i][1]) != 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+struct CallbackCounter
+{
+    ncnn::Mutex lock;
+    int finished;
+};
+
+static void count_finished(int ret, const std::vector<ncnn::Mat>& /*outputs*/, void* userdata)
+{
+    CallbackCounter* counter = (CallbackCounter*)userdata;
+
+    if (ret != 0)
+        return;
+
+    counter->lock.lock();
+    counter->finished++;
+    counter->lock.unlock();
+}
+
+static int test_executor(const ncnn::Net& net, const std::vector<ncnn::Mat>& inputs, const std::vector<std::vector<ncnn::Mat> >& expect, int worker_count, int max_pending)
+{
+    CallbackCounter counter;
+    counter.finished = 0;
+
+    std::vector<const char*> input_names(1, "data");
+    std::vector<const char*> output_names;
+    output_names.push_back("sum");
+    output_names.push_back("prob");
+
+    std::vector<ncnn::ExtractFuture> futures(inputs.size());
+    {
+        ncnn::Executor executor(&net, worker_count, max_pending);
+        executor.set_num_threads(1);
+
+        for (size_t i = 0; i < inputs.size(); i++)
+        {
+            futures[i] = executor.extract_async(input_names, std::vector<ncnn::Mat>(1, inputs[i]), output_names, count_finished, &counter);
+            if (!futures[i].valid())
+            {
+                fprintf(stderr, "test_executor request %d rejected\n", (int)i);
+                return -1;
+            }
+        }
+
+        for (size_t i = 0; i < futures.size(); i++)
+        {
+            std::vector<ncnn::Mat> outputs;
+            int ret = futures[i].get(outputs);
+            if (ret != 0 || outputs.size() != 2)
+            {
+                fprintf(stderr, "test_executor request %d failed %d\n", (int)i, ret);
+                return -1;
+            }
+
+            if (CompareMat(outputs, expect[i], 0.001) != 0)
+            {
+                fprintf(stderr, "test_executor request %d output not match worker_count=%d max_pending=%d\n", (int)i, worker_count, max_pending);
+                return -1;
+            }
+        }
+    }
+
+    // every callback has run once the executor joined its workers
+    if (counter.finished != (int)inputs.size())
+    {
+        fprintf(stderr, "test_executor callback count %d expect %d\n", counter.finished, (int)inputs.size());
+        return -1;
+    }
+
+    return 0;
+}
+
+struct PipelineFeeder
+{
+    ncnn::PipelineExecutor* executor;
+    const std::vector<ncnn::Mat>* inputs;
+    int ret;
+};
+
+static void* feed_pipeline(void* args)
+{
+    PipelineFeeder* feeder = (PipelineFeeder*)args;
+
+    feeder->ret = 0;
+    for (size_t i = 0; i < feeder->inputs->size(); i++)
+    {
+        if (feeder->executor->push(std::vector<ncnn::Mat>(1, (*feeder->inputs)[i])) != 0)
+            feeder->ret = -1;
+    }
+
+    feeder->executor->close();
+
+    return 0;
+}
+
+// frames leave the pipeline in push order with the plain extractor results
+static int test_pipeline_executor(const ncnn::Net& net, const std::vector<ncnn::Mat>& inputs, const std::vector<std::vector<ncnn::Mat> >& expect, const std::vector<const char*>& stage_first_layer_names, int max_pending)
+{
+    std::vector<const char*> input_names(1, "data");
+    std::vector<const char*> output_names;
+    output_names.push_back("sum");
+    output_names.push_back("prob");
+
+    ncnn::PipelineExecutor executor(&net, input_names, output_names, stage_first_layer_names, max_pending);
+    if (executor.stage_count() != (int)stage_first_layer_names.size() + 1)
+    {
+        fprintf(stderr, "test_pipeline_executor stage count %d expect %d\n", executor.stage_count(), (int)stage_first_layer_names.size() + 1);
+        return -1;
+    }
+
+    for (int i = 0; i < executor.stage_count(); i++)
+    {
+        executor.set_num_threads(i, 1);
+    }
+
+    PipelineFeeder feeder;
+    feeder.executor = &executor;
+    feeder.inputs = &inputs;
+    feeder.ret = 0;
+
+#if NCNN_THREADS
+    // the feeder blocks on the bounded stage queues until frames are popped
+    ncnn::Thread feeder_thread(feed_pipeline, &feeder);
+#else
+    feed_pipeline(&feeder);
+#endif // NCNN_THREADS
+
+    int ret = 0;
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        std::vector<ncnn::Mat> outputs;
+        if (executor.pop(outputs) != 0 || outputs.size() != 2)
+        {
+            fprintf(stderr, "test_pipeline_executor frame %d failed\n", (int)i);
+            ret = -1;
+            break;
+        }
+
+        if (CompareMat(outputs, expect[i], 0.001) != 0)
+        {
+            fprintf(stderr, "test_pipeline_executor frame %d output not match stages=%d max_pending=%d\n", (int)i, executor.stage_count(), max_pending);
+            ret = -1;
+            break;
+        }
+    }
+
+    std::vector<ncnn::Mat> outputs;
+    if (ret == 0 && executor.pop(outputs) != -1)
+    {
+        fprintf(stderr, "test_pipeline_executor pop after the last frame did not return -1\n");
+        ret = -1;
+    }
+
+#if NCNN_THREADS
+    // unblock the feeder if a frame failed
+    while (ret != 0 && executor.pop(outputs) != -1)
+    {
+    }
+
+    feeder_thread.join();
+#endif // NCNN_THREADS
+
+    if (feeder.ret != 0)
+    {
+        fprintf(stderr, "test_pipeline_executor push failed\n");
+        return -1;
+    }
+
+    return ret;
+}
+
+static int test_pipeline_executor_0(const ncnn::Net& net, const std::vector<ncnn::Mat>& inputs, const std::vector<std::vector<ncnn::Mat> >& expect)
+{
+    std::vector<const char*> cut1;
+    cut1.push_back("sum");
+
+    // the split outputs cross the first cut, sum is kept for the output after the second
+    std::vector<const char*> cut2;
+    cut2.push_back("conv1");
+    cut2.push_back("pool");
+
+    return 0
+           || test_pipeline_executor(net, inputs, expect, cut1, 1)
+           || test_pipeline_executor(net, inputs, expect, cut1, 4)
+           || test_pipeline_executor(net, inputs, expect, cut2, 2);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    ncnn::Mat model = RandomModelData(weight_sizes, sizeof(weight_sizes) / sizeof(int));
+
+    ncnn::Net net;
+    net.opt.use_packing_layout = false;
+    net.load_param_mem(param);
+    net.load_model((const unsigned char*)model.data);
+
+    std::vector<ncnn::Mat> inputs(input_count);
+    for (int i = 0; i < input_count; i++)
+    {
+        inputs[i] = RandomMat(16, 16, 8);
+    }
+
+    std::vector<std::vector<ncnn::Mat> > expect;
+    if (forward_reference(net, inputs, expect) != 0)
+    {
+        fprintf(stderr, "forward_reference failed\n");
+        return -1;
+    }
+
+    return 0
+           || test_executor(net, inputs, expect, 1, 16)
+           || test_executor(net, inputs, expect, 4, 2)
+           || test_executor(net, inputs, expect, 4, 16)
+           || test_pipeline_executor_0(net, inputs, expect);
+}
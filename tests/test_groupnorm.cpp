@@ -48,10 +48,39 @@ static int test_groupnorm_0()
            || test_groupnorm(RandomMat(8, 9, 24), 3, 0.0001f);
 }
 
+// each group sits at its own large offset, a shared pivot across groups would cancel
+static ncnn::Mat RandomGroupMat(int w, int h, int c, int group)
+{
+    ncnn::Mat m = RandomMat(w, h, c, 0.f, 1.f);
+
+    const int channels_per_group = c / group;
+    for (int q = 0; q < c; q++)
+    {
+        float* ptr = m.channel(q);
+        const int g = q / channels_per_group;
+        const float offset = g % 2 == 0 ? 100.f + g * 50.f : -200.f - g * 50.f;
+        for (int i = 0; i < w * h; i++)
+        {
+            ptr[i] += offset;
+        }
+    }
+
+    return m;
+}
+
+static int test_groupnorm_1()
+{
+    return 0
+           || test_groupnorm(RandomGroupMat(6, 7, 24, 3), 3, 0.001f)
+           || test_groupnorm(RandomGroupMat(5, 6, 16, 2), 2, 0.001f)
+           || test_groupnorm(RandomGroupMat(4, 5, 12, 4), 4, 0.0001f);
+}
+
 int main()
 {
     SRAND(7767517);
 
     return 0
-           || test_groupnorm_0();
+           || test_groupnorm_0()
+           || test_groupnorm_1();
 }
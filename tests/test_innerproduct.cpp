@@ -133,6 +133,103 @@ static int test_innerproduct_3()
            || test_innerproduct_int8(RandomMat(6, 3, 16), 16, 1);
 }
 
+static int test_innerproduct_batch(const ncnn::Mat& a, int batch, int outch, int bias)
+{
+    ncnn::ParamDict pd;
+    pd.set(0, outch); // num_output
+    pd.set(1, bias);  // bias_term
+    pd.set(2, outch * a.w * a.h * a.c);
+
+    int activation_type = RAND() % 6; // 0 1 2 3 4 5
+    ncnn::Mat activation_params(2);
+    activation_params[0] = RandomFloat(-1, 0); // alpha
+    activation_params[1] = RandomFloat(0, 1);  // beta
+    pd.set(9, activation_type);
+    pd.set(10, activation_params);
+
+    std::vector<ncnn::Mat> weights(bias ? 2 : 1);
+    weights[0] = RandomMat(outch * a.w * a.h * a.c);
+    if (bias)
+        weights[1] = RandomMat(outch);
+
+    ncnn::Option opt;
+    opt.num_threads = 1;
+    opt.use_packing_layout = true;
+    opt.use_bf16_storage = false;
+    opt.use_weight_fp16_storage = false;
+
+    ncnn::Layer* op = ncnn::create_layer("InnerProduct");
+
+    op->load_param(pd);
+
+    ncnn::ModelBinFromMatArray mb(weights.data());
+
+    op->load_model(mb);
+
+    if (!op->support_packing) opt.use_packing_layout = false;
+
+    op->create_pipeline(opt);
+
+    // batch items arrive packed the same way the net would pack them
+    std::vector<ncnn::Mat> bottom_blobs(batch);
+    for (int b = 0; b < batch; b++)
+    {
+        ncnn::Mat ab = RandomMat(a.w, a.h, a.c);
+        if (a.dims == 1) ab = RandomMat(a.w);
+        if (a.dims == 2) ab = RandomMat(a.w, a.h);
+
+        int elemcount = a.dims == 1 ? a.w : a.dims == 2 ? a.h : a.c;
+        if (opt.use_packing_layout && elemcount % 8 == 0)
+            ncnn::convert_packing(ab, bottom_blobs[b], 8, opt);
+        else
+            bottom_blobs[b] = ab;
+    }
+
+    std::vector<ncnn::Mat> top_blobs;
+    int ret = op->forward_batch(bottom_blobs, top_blobs, opt);
+
+    for (int b = 0; ret == 0 && b < batch; b++)
+    {
+        ncnn::Mat top_blob;
+        ret = op->forward(bottom_blobs[b], top_blob, opt);
+        if (ret != 0)
+            break;
+
+        if (top_blobs[b].dims != top_blob.dims || top_blobs[b].elempack != top_blob.elempack || top_blobs[b].elemsize != top_blob.elemsize)
+        {
+            fprintf(stderr, "forward_batch layout mismatch dims=%d elempack=%d expect dims=%d elempack=%d\n", top_blobs[b].dims, top_blobs[b].elempack, top_blob.dims, top_blob.elempack);
+            ret = -1;
+            break;
+        }
+
+        ret = CompareMat(top_blobs[b], top_blob, 0.001);
+    }
+
+    op->destroy_pipeline(opt);
+
+    delete op;
+
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_innerproduct_batch failed a.dims=%d a=(%d %d %d) batch=%d outch=%d bias=%d act=%d actparams=[%f,%f]\n", a.dims, a.w, a.h, a.c, batch, outch, bias, activation_type, activation_params[0], activation_params[1]);
+    }
+
+    return ret;
+}
+
+static int test_innerproduct_4()
+{
+    return 0
+           || test_innerproduct_batch(RandomMat(3, 2, 2), 3, 2, 1)
+           || test_innerproduct_batch(RandomMat(9, 3, 8), 4, 7, 1)
+           || test_innerproduct_batch(RandomMat(2, 2, 8), 2, 8, 0)
+           || test_innerproduct_batch(RandomMat(6, 2, 16), 5, 16, 1)
+           || test_innerproduct_batch(RandomMat(4, 16), 3, 12, 1)
+           || test_innerproduct_batch(RandomMat(6, 5), 2, 16, 0)
+           || test_innerproduct_batch(RandomMat(24), 4, 32, 1)
+           || test_innerproduct_batch(RandomMat(15), 3, 8, 1);
+}
+
 int main()
 {
     SRAND(7767517);
@@ -141,5 +238,6 @@ int main()
            || test_innerproduct_0()
            || test_innerproduct_1()
            || test_innerproduct_2()
-           || test_innerproduct_3();
+           || test_innerproduct_3()
+           || test_innerproduct_4();
 }
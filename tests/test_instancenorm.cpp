@@ -48,10 +48,36 @@ static int test_instancenorm_0()
            || test_instancenorm(RandomMat(5, 7, 16), 0.02f, 1);
 }
 
+// every channel sits at its own large offset over a large plane
+static ncnn::Mat RandomInstanceMat(int w, int h, int c)
+{
+    ncnn::Mat m = RandomMat(w, h, c, 0.f, 1.f);
+    for (int q = 0; q < c; q++)
+    {
+        float* ptr = m.channel(q);
+        const float offset = q % 2 == 0 ? 100.f + q * 10.f : -100.f - q * 10.f;
+        for (int i = 0; i < w * h; i++)
+        {
+            ptr[i] += offset;
+        }
+    }
+
+    return m;
+}
+
+static int test_instancenorm_1()
+{
+    return 0
+           || test_instancenorm(RandomInstanceMat(16, 16, 8), 0.001f, 0)
+           || test_instancenorm(RandomInstanceMat(24, 20, 16), 0.001f, 1)
+           || test_instancenorm(RandomInstanceMat(17, 13, 3), 0.0001f, 1);
+}
+
 int main()
 {
     SRAND(7767517);
 
     return 0
-           || test_instancenorm_0();
+           || test_instancenorm_0()
+           || test_instancenorm_1();
 }
@@ -0,0 +1,192 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "net.h"
+#include "testutil.h"
+
+static int forward(const char* param, const ncnn::Mat& model, bool use_layer_fusion, const ncnn::Mat& in, const char* mid, ncnn::Mat& out, bool& mid_fused)
+{
+    ncnn::Net net;
+    net.opt.use_packing_layout = true;
+    net.opt.use_layer_fusion = use_layer_fusion;
+
+    if (net.load_param_mem(param) != 0 || net.load_model((const unsigned char*)model.data) == 0)
+        return -1;
+
+    ncnn::Extractor ex = net.create_extractor();
+#if NCNN_CNNCACHE
+    // the cached path runs the reference convolution
+    ex.cache_mode = false;
+#endif // NCNN_CNNCACHE
+    ex.input("data", in);
+    if (ex.extract("out", out) != 0)
+        return -1;
+
+    // the blob between the fused layers is gone
+    ncnn::Extractor ex_mid = net.create_extractor();
+#if NCNN_CNNCACHE
+    ex_mid.cache_mode = false;
+#endif // NCNN_CNNCACHE
+    ex_mid.input("data", in);
+
+    ncnn::Mat mid_blob;
+    mid_fused = ex_mid.extract(mid, mid_blob) != 0;
+
+    return 0;
+}
+
+// the fused net gives the result of the unfused one, expect_fused tells whether the blob mid is fused away
+static int test_layerfusion(const char* param, const int* weight_sizes, int weight_count, const ncnn::Mat& in, const char* mid, bool expect_fused)
+{
+    ncnn::Mat model = RandomModelData(weight_sizes, weight_count);
+
+    ncnn::Mat out0;
+    ncnn::Mat out1;
+    bool mid_fused0 = false;
+    bool mid_fused1 = false;
+    if (forward(param, model, false, in, mid, out0, mid_fused0) != 0 || forward(param, model, true, in, mid, out1, mid_fused1) != 0)
+    {
+        fprintf(stderr, "test_layerfusion forward failed %s\n", mid);
+        return -1;
+    }
+
+    if (CompareMat(out0, out1, 0.001) != 0)
+    {
+        fprintf(stderr, "test_layerfusion output not match %s\n", mid);
+        return -1;
+    }
+
+    if (mid_fused0 || mid_fused1 != expect_fused)
+    {
+        fprintf(stderr, "test_layerfusion %s fused %d %d expect %d\n", mid, mid_fused0, mid_fused1, expect_fused);
+        return -1;
+    }
+
+    return 0;
+}
+
+// batchnorm scale and bias folded into the convolution weights
+static int test_layerfusion_0()
+{
+    static const char param[] = "7767517\n"
+                                "5 5\n"
+                                "Input            data   0 1 data 0=8 1=8 2=16\n"
+                                "Convolution      conv   1 1 data conv 0=16 1=3 4=1 5=1 6=2304\n"
+                                "BatchNorm        bn     1 1 conv bn 0=16 1=1.0\n"
+                                "Scale            scale  1 1 bn scale 0=16 1=1\n"
+                                "Bias             bias   1 1 scale out 0=16\n";
+
+    static const int weight_sizes[] = {2304, -16, -16, -16, -16, -16, -16, -16, -16};
+
+    return test_layerfusion(param, weight_sizes, sizeof(weight_sizes) / sizeof(int), RandomMat(8, 8, 16), "bn", true);
+}
+
+// relu and leakyrelu as fused activation
+static int test_layerfusion_1()
+{
+    static const char param[] = "7767517\n"
+                                "5 5\n"
+                                "Input            data   0 1 data 0=8 1=8 2=16\n"
+                                "Convolution      conv0  1 1 data conv0 0=16 1=3 4=1 5=1 6=2304\n"
+                                "ReLU             relu0  1 1 conv0 relu0\n"
+                                "Convolution      conv1  1 1 relu0 conv1 0=8 1=1 5=1 6=128\n"
+                                "ReLU             relu1  1 1 conv1 out 0=0.1\n";
+
+    static const int weight_sizes[] = {2304, -16, 128, -8};
+
+    ncnn::Mat in = RandomMat(8, 8, 16);
+
+    return 0
+           || test_layerfusion(param, weight_sizes, sizeof(weight_sizes) / sizeof(int), in, "conv0", true)
+           || test_layerfusion(param, weight_sizes, sizeof(weight_sizes) / sizeof(int), in, "conv1", true);
+}
+
+// hardswish as fused activation_type 6
+static int test_layerfusion_2()
+{
+    static const char param[] = "7767517\n"
+                                "3 3\n"
+                                "Input            data   0 1 data 0=8 1=8 2=16\n"
+                                "Convolution      conv   1 1 data conv 0=16 1=3 4=1 5=1 6=2304\n"
+                                "HardSwish        hswish 1 1 conv out 0=0.166667 1=0.5\n";
+
+    static const int weight_sizes[] = {2304, -16};
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+    const bool expect_fused = true;
+#else
+    // only the generic and x86 kernels know hardswish
+    const bool expect_fused = false;
+#endif
+
+    return test_layerfusion(param, weight_sizes, sizeof(weight_sizes) / sizeof(int), RandomMat(8, 8, 16), "conv", expect_fused);
+}
+
+// depthwise convolution and innerproduct fold the affine and take the activation too
+static int test_layerfusion_3()
+{
+    static const char param_dw[] = "7767517\n"
+                                   "4 4\n"
+                                   "Input            data   0 1 data 0=8 1=8 2=16\n"
+                                   "ConvolutionDepthWise convdw 1 1 data convdw 0=16 1=3 4=1 5=1 6=144 7=16\n"
+                                   "BatchNorm        bn     1 1 convdw bn 0=16 1=1.0\n"
+                                   "ReLU             relu   1 1 bn out\n";
+
+    static const int weight_sizes_dw[] = {144, -16, -16, -16, -16, -16};
+
+    static const char param_fc[] = "7767517\n"
+                                   "4 4\n"
+                                   "Input            data   0 1 data 0=4 1=4 2=4\n"
+                                   "InnerProduct     fc     1 1 data fc 0=16 1=1 2=1024\n"
+                                   "Scale            scale  1 1 fc scale 0=16 1=1\n"
+                                   "Sigmoid          sigmoid 1 1 scale out\n";
+
+    static const int weight_sizes_fc[] = {1024, -16, -16, -16};
+
+    return 0
+           || test_layerfusion(param_dw, weight_sizes_dw, sizeof(weight_sizes_dw) / sizeof(int), RandomMat(8, 8, 16), "bn", true)
+           || test_layerfusion(param_fc, weight_sizes_fc, sizeof(weight_sizes_fc) / sizeof(int), RandomMat(4, 4, 4), "scale", true);
+}
+
+// the residual eltwise sum stays a layer of its own
+static int test_layerfusion_4()
+{
+    static const char param[] = "7767517\n"
+                                "5 6\n"
+                                "Input            data   0 1 data 0=8 1=8 2=16\n"
+                                "Split            split  1 2 data data0 data1\n"
+                                "Convolution      conv   1 1 data0 conv 0=16 1=3 4=1 5=1 6=2304\n"
+                                "Eltwise          sum    2 1 conv data1 sum 0=1\n"
+                                "ReLU             relu   1 1 sum out\n";
+
+    static const int weight_sizes[] = {2304, -16};
+
+    ncnn::Mat in = RandomMat(8, 8, 16);
+
+    return 0
+           || test_layerfusion(param, weight_sizes, sizeof(weight_sizes) / sizeof(int), in, "conv", false)
+           || test_layerfusion(param, weight_sizes, sizeof(weight_sizes) / sizeof(int), in, "sum", false);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_layerfusion_0()
+           || test_layerfusion_1()
+           || test_layerfusion_2()
+           || test_layerfusion_3()
+           || test_layerfusion_4();
+}
@@ -46,10 +46,36 @@ static int test_layernorm_0()
            || test_layernorm(RandomMat(6, 7, 24), 0.001f);
 }
 
+// the statistics span the whole blob, channels sit at distinct levels on top of a large common offset
+static ncnn::Mat RandomLayerMat(int w, int h, int c, float offset)
+{
+    ncnn::Mat m = RandomMat(w, h, c, -0.05f, 0.05f);
+    for (int q = 0; q < c; q++)
+    {
+        float* ptr = m.channel(q);
+        const float level = offset + (float)(q % 5) * 0.25f;
+        for (int i = 0; i < w * h; i++)
+        {
+            ptr[i] += level;
+        }
+    }
+
+    return m;
+}
+
+static int test_layernorm_1()
+{
+    return 0
+           || test_layernorm(RandomLayerMat(2, 2, 48, 200.f), 0.001f)
+           || test_layernorm(RandomLayerMat(3, 1, 20, -300.f), 0.001f)
+           || test_layernorm(RandomLayerMat(16, 16, 8, 100.f), 0.0001f);
+}
+
 int main()
 {
     SRAND(7767517);
 
     return 0
-           || test_layernorm_0();
+           || test_layernorm_0()
+           || test_layernorm_1();
 }
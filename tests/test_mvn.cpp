@@ -0,0 +1,80 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "layer/mvn.h"
+#include "testutil.h"
+
+static int test_mvn(const ncnn::Mat& a, int normalize_variance, int across_channels)
+{
+    ncnn::ParamDict pd;
+    pd.set(0, normalize_variance);
+    pd.set(1, across_channels);
+    pd.set(2, 0.0001f); // eps
+
+    std::vector<ncnn::Mat> weights(0);
+
+    int ret = test_layer<ncnn::MVN>("MVN", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_mvn failed a.dims=%d a=(%d %d %d) normalize_variance=%d across_channels=%d\n", a.dims, a.w, a.h, a.c, normalize_variance, across_channels);
+    }
+
+    return ret;
+}
+
+static int test_mvn_modes(const ncnn::Mat& a)
+{
+    return 0
+           || test_mvn(a, 0, 0)
+           || test_mvn(a, 0, 1)
+           || test_mvn(a, 1, 0)
+           || test_mvn(a, 1, 1);
+}
+
+static int test_mvn_0()
+{
+    return 0
+           || test_mvn_modes(RandomMat(6, 4, 2))
+           || test_mvn_modes(RandomMat(5, 7, 3))
+           || test_mvn_modes(RandomMat(3, 3, 8))
+           || test_mvn_modes(RandomMat(7, 9, 16))
+           || test_mvn_modes(RandomMat(9, 5, 24));
+}
+
+static int test_mvn_1()
+{
+    // large offset against a small spread
+    return 0
+           || test_mvn_modes(RandomMat(5, 7, 3, 100.f, 101.f))
+           || test_mvn_modes(RandomMat(6, 4, 16, -300.f, -299.f));
+}
+
+static int test_mvn_2()
+{
+    // 2d blobs take the unpacked reference path, packed when h is a multiple of 8
+    return 0
+           || test_mvn_modes(RandomMat(13, 5))
+           || test_mvn_modes(RandomMat(7, 8))
+           || test_mvn_modes(RandomMat(9, 16));
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_mvn_0()
+           || test_mvn_1()
+           || test_mvn_2();
+}
@@ -0,0 +1,137 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "datareader.h"
+#include "net.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// file reader over a temporary copy of text
+class DataReaderFromTempFile : public ncnn::DataReaderFromStdio
+{
+public:
+    DataReaderFromTempFile(const char* text)
+        : ncnn::DataReaderFromStdio(tmpfile())
+    {
+        if (fp)
+        {
+            fputs(text, fp);
+            rewind(fp);
+        }
+    }
+
+    ~DataReaderFromTempFile()
+    {
+        if (fp)
+            fclose(fp);
+    }
+};
+
+// the memory and stdio readers leave the same state behind on a key without =
+static int test_paramdict_scan(const char* text)
+{
+    const unsigned char* mem = (const unsigned char*)text;
+    ncnn::DataReaderFromMemory dr0(mem);
+    DataReaderFromTempFile dr1(text);
+
+    for (int i = 0; i < 8; i++)
+    {
+        int id0 = -1;
+        int id1 = -1;
+        int nscan0 = dr0.scan("%d=", &id0);
+        int nscan1 = dr1.scan("%d=", &id1);
+        if (nscan0 != nscan1 || id0 != id1)
+        {
+            fprintf(stderr, "test_paramdict_scan key mismatch %d %d %d %d at %d in [%s]\n", nscan0, nscan1, id0, id1, i, text);
+            return -1;
+        }
+
+        char vstr0[16] = {0};
+        char vstr1[16] = {0};
+        nscan0 = dr0.scan("%15s", vstr0);
+        nscan1 = dr1.scan("%15s", vstr1);
+        if (nscan0 != nscan1 || (nscan0 == 1 && strcmp(vstr0, vstr1) != 0))
+        {
+            fprintf(stderr, "test_paramdict_scan value mismatch %d %d [%s] [%s] at %d in [%s]\n", nscan0, nscan1, vstr0, vstr1, i, text);
+            return -1;
+        }
+
+        if (nscan0 != 1)
+            break;
+    }
+
+    return 0;
+}
+
+static int test_paramdict_load(const char* param, int expect_ret)
+{
+    int ret0;
+    {
+        ncnn::Net net;
+        ret0 = net.load_param_mem(param);
+    }
+
+    int ret1;
+    {
+        DataReaderFromTempFile dr(param);
+
+        ncnn::Net net;
+        ret1 = net.load_param(dr);
+    }
+
+    if (ret0 != expect_ret || ret1 != expect_ret)
+    {
+        fprintf(stderr, "test_paramdict_load failed memory=%d stdio=%d expect=%d\n", ret0, ret1, expect_ret);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_paramdict_0()
+{
+    return 0
+           || test_paramdict_scan("0=1 1=2.5 2=-3")
+           || test_paramdict_scan("0=1 5 2=3")
+           || test_paramdict_scan("0=1 5")
+           || test_paramdict_scan("0=1 -5\n2=3")
+           || test_paramdict_scan("0=1 abc 2=3");
+}
+
+static int test_paramdict_1()
+{
+    static const char param_good[] = "7767517\n"
+                                     "2 2\n"
+                                     "Input data 0 1 data 0=4 1=4 2=3\n"
+                                     "ReLU relu 1 1 data out 0=0.1\n";
+
+    // the key 5 has no value, the rest of the line is taken as the next layer
+    static const char param_missing_assign[] = "7767517\n"
+            "3 3\n"
+            "Input data 0 1 data 0=4 1=4 2=3\n"
+            "ReLU relu 1 1 data relu 0=0.1 5 1=2\n"
+            "ReLU relu2 1 1 relu out\n";
+
+    return 0
+           || test_paramdict_load(param_good, 0)
+           || test_paramdict_load(param_missing_assign, -1);
+}
+
+int main()
+{
+    return 0
+           || test_paramdict_0()
+           || test_paramdict_1();
+}
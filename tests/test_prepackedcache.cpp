@@ -0,0 +1,243 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "net.h"
+#include "testutil.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <sys/utime.h>
+#define utime    _utime
+#define utimbuf  _utimbuf
+#else
+#include <utime.h>
+#endif
+
+static const char param[] = "7767517\n"
+                            "3 3\n"
+                            "Input            data   0 1 data 0=16 1=16 2=8\n"
+                            "Convolution      conv0  1 1 data conv0 0=16 1=3 4=1 5=1 6=1152 9=1\n"
+                            "Convolution      conv1  1 1 conv0 out 0=8 1=1 5=1 6=128\n";
+
+static const int weight_sizes[] = {1152, -16, 128, -8};
+
+enum LoadMode
+{
+    LOAD_MEMORY,
+    LOAD_FILE,
+    LOAD_MMAP
+};
+
+static int write_file(const char* path, const void* data, size_t size)
+{
+    FILE* fp = fopen(path, "wb");
+    if (!fp)
+        return -1;
+
+    size_t nwrite = fwrite(data, 1, size, fp);
+    fclose(fp);
+
+    return nwrite == size ? 0 : -1;
+}
+
+// shift every weight value of a prepacked cache, the header and record fields stay intact
+// small integers read as denormal floats and the end marker reads as nan
+static int tamper_cache(const char* path, const char* tampered_path)
+{
+    FILE* fp = fopen(path, "rb");
+    if (!fp)
+        return -1;
+
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    std::vector<unsigned char> data(size);
+    size_t nread = fread(data.data(), 1, size, fp);
+    fclose(fp);
+    if (nread != (size_t)size)
+        return -1;
+
+    for (long i = 64; i + 3 < size; i += 4)
+    {
+        float v;
+        memcpy(&v, &data[i], 4);
+        if (fabs(v) > 1e-20f && fabs(v) < 1e3f)
+        {
+            v += 1.f;
+            memcpy(&data[i], &v, 4);
+        }
+    }
+
+    return write_file(tampered_path, data.data(), size);
+}
+
+static int forward(const ncnn::Option& opt, const ncnn::Mat& model, const char* bin_path, int load_mode, const char* cache_path, const char* save_path, const ncnn::Mat& in, ncnn::Mat& out)
+{
+    ncnn::Net net;
+    net.opt = opt;
+
+    if (net.load_param_mem(param) != 0)
+        return -1;
+
+    if (cache_path && net.load_prepacked_cache(cache_path) != 0)
+        return -1;
+
+    int ret = 0;
+    if (load_mode == LOAD_MEMORY)
+        ret = net.load_model((const unsigned char*)model.data) == 0 ? -1 : 0;
+    if (load_mode == LOAD_FILE)
+        ret = net.load_model(bin_path);
+    if (load_mode == LOAD_MMAP)
+        ret = net.load_model_mmap(bin_path);
+    if (ret != 0)
+        return -1;
+
+    if (save_path && net.save_prepacked_cache(save_path) != 0)
+        return -1;
+
+    ncnn::Extractor ex = net.create_extractor();
+#if NCNN_CNNCACHE
+    // the cached path runs the reference convolution
+    ex.cache_mode = false;
+#endif // NCNN_CNNCACHE
+    ex.input("data", in);
+    return ex.extract("out", out);
+}
+
+// expect_hit tells whether the cached weights are used, the tampered cache changes the output then
+static int test_cache(const ncnn::Option& opt, const ncnn::Mat& model, const char* bin_path, int load_mode, const char* cache_path, const char* tampered_path, bool expect_hit, const ncnn::Mat& in, const ncnn::Mat& expect, const char* name)
+{
+    ncnn::Mat out;
+    if (forward(opt, model, bin_path, load_mode, cache_path, 0, in, out) != 0 || CompareMat(out, expect, 0.001) != 0)
+    {
+        fprintf(stderr, "test_prepackedcache %s output not match\n", name);
+        return -1;
+    }
+
+    ncnn::Mat out_tampered;
+    if (forward(opt, model, bin_path, load_mode, tampered_path, 0, in, out_tampered) != 0)
+    {
+        fprintf(stderr, "test_prepackedcache %s forward failed\n", name);
+        return -1;
+    }
+
+    bool hit = CompareMat(out_tampered, expect, 0.001) != 0;
+    if (hit != expect_hit)
+    {
+        fprintf(stderr, "test_prepackedcache %s cache %s expect %s\n", name, hit ? "used" : "ignored", expect_hit ? "used" : "ignored");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_prepackedcache_0(const char* tmpdir)
+{
+    char bin0_path[256];
+    char bin1_path[256];
+    char cache_path[256];
+    char tampered_path[256];
+    sprintf(bin0_path, "%s/test_prepackedcache_%d_0.bin", tmpdir, (int)time(NULL));
+    sprintf(bin1_path, "%s/test_prepackedcache_%d_1.bin", tmpdir, (int)time(NULL));
+    sprintf(cache_path, "%s/test_prepackedcache_%d.prepacked", tmpdir, (int)time(NULL));
+    sprintf(tampered_path, "%s/test_prepackedcache_%d_tampered.prepacked", tmpdir, (int)time(NULL));
+
+    // fine-tuned weights of the same architecture, same file size and modification time
+    ncnn::Mat model0 = RandomModelData(weight_sizes, sizeof(weight_sizes) / sizeof(int));
+    ncnn::Mat model1 = RandomModelData(weight_sizes, sizeof(weight_sizes) / sizeof(int));
+    ncnn::Mat in = RandomMat(16, 16, 8);
+
+    ncnn::Option opt;
+    opt.use_packing_layout = true;
+
+    ncnn::Option opt_mtime = opt;
+    opt_mtime.use_mmap_mtime_key = true;
+
+    int ret = -1;
+    ncnn::Mat out0;
+    ncnn::Mat out1;
+    struct utimbuf times;
+    times.actime = 1600000000;
+    times.modtime = 1600000000;
+
+    if (write_file(bin0_path, model0.data, model0.total() * model0.elemsize) != 0 || write_file(bin1_path, model1.data, model1.total() * model1.elemsize) != 0)
+    {
+        fprintf(stderr, "test_prepackedcache write model failed\n");
+        goto out;
+    }
+
+    utime(bin0_path, &times);
+    utime(bin1_path, &times);
+
+    if (forward(opt, model0, 0, LOAD_MEMORY, 0, 0, in, out0) != 0 || forward(opt, model1, 0, LOAD_MEMORY, 0, 0, in, out1) != 0)
+    {
+        fprintf(stderr, "test_prepackedcache reference forward failed\n");
+        goto out;
+    }
+
+    // cache saved from the mapped model
+    {
+        ncnn::Mat out;
+        if (forward(opt, model0, bin0_path, LOAD_MMAP, 0, cache_path, in, out) != 0 || tamper_cache(cache_path, tampered_path) != 0)
+        {
+            fprintf(stderr, "test_prepackedcache save cache failed\n");
+            goto out;
+        }
+    }
+
+    if (test_cache(opt, model0, bin0_path, LOAD_MMAP, cache_path, tampered_path, true, in, out0, "mmap hit") != 0
+            || test_cache(opt, model0, bin0_path, LOAD_FILE, cache_path, tampered_path, true, in, out0, "file hit")
+            || test_cache(opt, model1, bin1_path, LOAD_MMAP, cache_path, tampered_path, false, in, out1, "mmap changed weights")
+            || test_cache(opt, model1, bin1_path, LOAD_FILE, cache_path, tampered_path, false, in, out1, "file changed weights")
+            || test_cache(opt, model1, 0, LOAD_MEMORY, cache_path, tampered_path, false, in, out1, "memory changed weights"))
+        goto out;
+
+    // size and modification time as key on request
+    {
+        ncnn::Mat out;
+        if (forward(opt_mtime, model0, bin0_path, LOAD_MMAP, 0, cache_path, in, out) != 0 || tamper_cache(cache_path, tampered_path) != 0)
+        {
+            fprintf(stderr, "test_prepackedcache save mtime keyed cache failed\n");
+            goto out;
+        }
+    }
+
+    if (test_cache(opt_mtime, model0, bin0_path, LOAD_MMAP, cache_path, tampered_path, true, in, out0, "mtime hit") != 0
+            || test_cache(opt, model0, bin0_path, LOAD_MMAP, cache_path, tampered_path, false, in, out0, "mtime cache without mtime key"))
+        goto out;
+
+    ret = 0;
+
+out:
+    remove(bin0_path);
+    remove(bin1_path);
+    remove(cache_path);
+    remove(tampered_path);
+
+    return ret;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    const char* tmpdir = getenv("TMPDIR");
+    if (!tmpdir) tmpdir = getenv("TEMP");
+    if (!tmpdir) tmpdir = ".";
+
+    return test_prepackedcache_0(tmpdir);
+}
@@ -0,0 +1,166 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "net.h"
+#include "profiler.h"
+#include "testutil.h"
+
+static const char param[] = "7767517\n"
+                            "6 6\n"
+                            "Input            data   0 1 data 0=16 1=16 2=8\n"
+                            "Convolution      conv0  1 1 data conv0 0=16 1=3 4=1 5=1 6=1152 9=1\n"
+                            "ConvolutionDepthWise conv1 1 1 conv0 conv1 0=16 1=3 4=1 5=1 6=144 7=16\n"
+                            "Pooling          pool   1 1 conv1 pool 0=0 1=2 2=2\n"
+                            "InnerProduct     fc     1 1 pool fc 0=10 1=1 2=10240\n"
+                            "Softmax          prob   1 1 fc prob\n";
+
+static const int weight_sizes[] = {1152, -16, 144, -16, 10240, -10};
+
+// conv0 conv1 pool fc prob
+static const int forward_layer_count = 5;
+
+static int run(ncnn::Extractor& ex, const ncnn::Mat& in)
+{
+    ncnn::Mat out;
+    ex.input("data", in);
+    return ex.extract("prob", out);
+}
+
+static int test_profiler_0(const ncnn::Net& net, const ncnn::Mat& in)
+{
+    ncnn::Profiler profiler;
+
+    ncnn::Extractor ex = net.create_extractor();
+    ex.set_profiler(&profiler);
+
+    if (run(ex, in) != 0)
+        return -1;
+
+    std::vector<ncnn::ProfileRecord> records = profiler.records();
+    if ((int)records.size() != forward_layer_count)
+    {
+        fprintf(stderr, "test_profiler_0 record count %d expect %d\n", (int)records.size(), forward_layer_count);
+        return -1;
+    }
+
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        const ncnn::ProfileRecord& r = records[i];
+        if (r.end < r.start || r.stream != 0 || net.layers[r.layer_index]->name != r.name)
+        {
+            fprintf(stderr, "test_profiler_0 bad record %d %s\n", (int)i, r.name.c_str());
+            return -1;
+        }
+    }
+
+    // reset keeps the profiler attached for the next run
+    ex.reset();
+    if (run(ex, in) != 0)
+        return -1;
+
+    if ((int)profiler.records().size() != forward_layer_count * 2)
+    {
+        fprintf(stderr, "test_profiler_0 profiler detached by reset\n");
+        return -1;
+    }
+
+    FILE* fp = tmpfile();
+    int ret = profiler.save_summary(fp);
+    fclose(fp);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_profiler_0 save_summary failed\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_profiler_1(const ncnn::Net& net, const ncnn::Mat& in)
+{
+    ncnn::Profiler profiler;
+    profiler.set_max_records(3);
+
+    // destroyed extractors hand their stream index to the next one
+    for (int i = 0; i < 4; i++)
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        ex.set_profiler(&profiler);
+
+        if (run(ex, in) != 0)
+            return -1;
+    }
+
+    std::vector<ncnn::ProfileRecord> records = profiler.records();
+    if (records.size() != 3)
+    {
+        fprintf(stderr, "test_profiler_1 record count %d expect 3\n", (int)records.size());
+        return -1;
+    }
+
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        if (records[i].stream != 0)
+        {
+            fprintf(stderr, "test_profiler_1 stream %d expect 0\n", records[i].stream);
+            return -1;
+        }
+    }
+
+    // the latest records are kept, oldest first
+    if (records[2].name != "prob" || records[1].name != "fc" || records[0].name != "pool")
+    {
+        fprintf(stderr, "test_profiler_1 kept %s %s %s\n", records[0].name.c_str(), records[1].name.c_str(), records[2].name.c_str());
+        return -1;
+    }
+
+    // two live extractors record on two streams
+    profiler.clear();
+    {
+        ncnn::Extractor ex0 = net.create_extractor();
+        ncnn::Extractor ex1 = net.create_extractor();
+        ex0.set_profiler(&profiler);
+        ex1.set_profiler(&profiler);
+
+        if (run(ex0, in) != 0 || run(ex1, in) != 0)
+            return -1;
+    }
+
+    records = profiler.records();
+    if (records.size() != 3 || records[2].stream != 1)
+    {
+        fprintf(stderr, "test_profiler_1 second extractor not on stream 1\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    ncnn::Mat model = RandomModelData(weight_sizes, sizeof(weight_sizes) / sizeof(int));
+
+    ncnn::Net net;
+    net.opt.use_packing_layout = true;
+    net.load_param_mem(param);
+    net.load_model((const unsigned char*)model.data);
+
+    ncnn::Mat in = RandomMat(16, 16, 8);
+
+    return 0
+           || test_profiler_0(net, in)
+           || test_profiler_1(net, in);
+}
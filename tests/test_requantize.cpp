@@ -0,0 +1,99 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "layer/requantize.h"
+#include "testutil.h"
+
+static int test_requantize(const ncnn::Mat& a, float scale_in, float scale_out, int bias_data_size, int fusion_relu)
+{
+    ncnn::ParamDict pd;
+    pd.set(0, scale_in);
+    pd.set(1, scale_out);
+    pd.set(2, bias_data_size ? 1 : 0); // bias_term
+    pd.set(3, bias_data_size);
+    pd.set(4, fusion_relu);
+
+    std::vector<ncnn::Mat> weights(bias_data_size ? 1 : 0);
+    if (bias_data_size)
+        weights[0] = RandomMat(bias_data_size);
+
+    // the int32 input must reach the layer untouched, so only packing varies
+    for (int i = 0; i < 2; i++)
+    {
+        ncnn::Option opt;
+        opt.use_packing_layout = i == 1;
+        opt.use_fp16_packed = false;
+        opt.use_fp16_storage = false;
+        opt.use_fp16_arithmetic = false;
+        opt.use_bf16_storage = false;
+        opt.use_shader_pack8 = false;
+        opt.use_image_storage = false;
+        opt.use_weight_fp16_storage = false;
+
+        int ret = test_layer<ncnn::Requantize>(ncnn::layer_to_index("Requantize"), pd, weights, opt, a);
+        if (ret != 0)
+        {
+            fprintf(stderr, "test_requantize failed a.dims=%d a=(%d %d %d) scale_in=%f scale_out=%f bias_data_size=%d fusion_relu=%d use_packing_layout=%d\n", a.dims, a.w, a.h, a.c, scale_in, scale_out, bias_data_size, fusion_relu, opt.use_packing_layout);
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+static int test_requantize_0()
+{
+    return 0
+           || test_requantize(RandomIntMat(5, 7, 3), 1 / 100.f, 1.f, 0, 0)
+           || test_requantize(RandomIntMat(5, 7, 3), 1 / 100.f, 1.f, 1, 1)
+           || test_requantize(RandomIntMat(5, 7, 3), 1 / 100.f, 1.f, 3, 0)
+           || test_requantize(RandomIntMat(5, 7, 8), 1 / 64.f, 0.8f, 0, 1)
+           || test_requantize(RandomIntMat(5, 7, 8), 1 / 64.f, 0.8f, 1, 0)
+           || test_requantize(RandomIntMat(5, 7, 8), 1 / 64.f, 0.8f, 8, 1)
+           || test_requantize(RandomIntMat(7, 9, 24), 1 / 50.f, 2.f, 0, 0)
+           || test_requantize(RandomIntMat(7, 9, 24), 1 / 50.f, 2.f, 1, 1)
+           || test_requantize(RandomIntMat(7, 9, 24), 1 / 50.f, 2.f, 24, 0);
+}
+
+static int test_requantize_1()
+{
+    return 0
+           || test_requantize(RandomIntMat(15, 3), 1 / 100.f, 1.f, 0, 0)
+           || test_requantize(RandomIntMat(15, 3), 1 / 100.f, 1.f, 1, 1)
+           || test_requantize(RandomIntMat(15, 3), 1 / 100.f, 1.f, 3, 0)
+           || test_requantize(RandomIntMat(17, 16), 1 / 64.f, 0.8f, 0, 1)
+           || test_requantize(RandomIntMat(17, 16), 1 / 64.f, 0.8f, 1, 0)
+           || test_requantize(RandomIntMat(17, 16), 1 / 64.f, 0.8f, 16, 1);
+}
+
+static int test_requantize_2()
+{
+    return 0
+           || test_requantize(RandomIntMat(13), 1 / 100.f, 1.f, 0, 0)
+           || test_requantize(RandomIntMat(13), 1 / 100.f, 1.f, 1, 1)
+           || test_requantize(RandomIntMat(13), 1 / 100.f, 1.f, 13, 0)
+           || test_requantize(RandomIntMat(32), 1 / 64.f, 0.8f, 0, 1)
+           || test_requantize(RandomIntMat(32), 1 / 64.f, 0.8f, 1, 0)
+           || test_requantize(RandomIntMat(32), 1 / 64.f, 0.8f, 32, 1);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_requantize_0()
+           || test_requantize_1()
+           || test_requantize_2();
+}
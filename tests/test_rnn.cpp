@@ -0,0 +1,78 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "layer/rnn.h"
+#include "testutil.h"
+
+// cont is 0 at t=0 and at every reset_step-th step, 1 otherwise
+static int test_rnn(int size, int T, int outch, int reset_step)
+{
+    std::vector<ncnn::Mat> a(2);
+    a[0] = RandomMat(size, 1, T);
+    a[1] = ncnn::Mat(T);
+    for (int t = 0; t < T; t++)
+    {
+        a[1][t] = t % reset_step == 0 ? 0.f : 1.f;
+    }
+
+    ncnn::ParamDict pd;
+    pd.set(0, outch); // num_output
+    pd.set(1, size * outch * 2 + outch * outch);
+
+    std::vector<ncnn::Mat> weights(5);
+    weights[0] = RandomMat(size * outch);
+    weights[1] = RandomMat(size * outch);
+    weights[2] = RandomMat(outch * outch);
+    weights[3] = RandomMat(outch);
+    weights[4] = RandomMat(outch);
+
+    int ret = test_layer<ncnn::RNN>("RNN", pd, weights, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_rnn failed size=%d T=%d outch=%d reset_step=%d\n", size, T, outch, reset_step);
+    }
+
+    return ret;
+}
+
+static int test_rnn_0()
+{
+    // input width equal to num_output
+    return 0
+           || test_rnn(1, 1, 1, 1)
+           || test_rnn(4, 3, 4, 100)
+           || test_rnn(7, 5, 7, 2)
+           || test_rnn(8, 8, 8, 3)
+           || test_rnn(16, 11, 16, 5)
+           || test_rnn(17, 9, 17, 100)
+           || test_rnn(32, 16, 32, 7);
+}
+
+static int test_rnn_1()
+{
+    // narrower input
+    return 0
+           || test_rnn(3, 4, 8, 100)
+           || test_rnn(5, 7, 16, 3)
+           || test_rnn(13, 6, 17, 2);
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_rnn_0()
+           || test_rnn_1();
+}
@@ -0,0 +1,172 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "autotune.h"
+#include "net.h"
+#include "testutil.h"
+
+// 8 channels keep the convolution on the autotuned pack8 path of avx512 builds
+static const char param[] = "7767517\n"
+                            "2 2\n"
+                            "Input            data   0 1 data 0=16 1=16 2=8\n"
+                            "Convolution      conv0  1 1 data out 0=8 1=3 4=1 5=1 6=576 9=1\n";
+
+static const int weight_sizes[] = {576, -8};
+
+static int forward(ncnn::Extractor& ex, const ncnn::Mat& in, ncnn::Mat& out)
+{
+#if NCNN_CNNCACHE
+    // the cached path runs the reference convolution
+    ex.cache_mode = false;
+#endif // NCNN_CNNCACHE
+    ex.input("data", in);
+    return ex.extract("out", out);
+}
+
+static int forward_shape(const ncnn::Net& net, const ncnn::Mat& in, const ncnn::Mat& expect)
+{
+    ncnn::Extractor* ex = net.acquire_extractor(in);
+
+    ncnn::Mat out;
+    int ret = forward(*ex, in, out);
+
+    net.release_extractor(ex);
+
+    if (ret != 0 || CompareMat(out, expect, 0.001) != 0)
+    {
+        fprintf(stderr, "forward_shape %d %d %d output not match\n", in.w, in.h, in.c);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_shapebucket_0(const ncnn::Mat& model, const ncnn::Mat& a, const ncnn::Mat& b)
+{
+    ncnn::Net net;
+    net.opt.use_packing_layout = true;
+    net.load_param_mem(param);
+    net.load_model((const unsigned char*)model.data);
+    net.set_shape_cache_capacity(2);
+
+    ncnn::Mat out_a;
+    ncnn::Mat out_b;
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        if (forward(ex, a, out_a) != 0)
+            return -1;
+    }
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        if (forward(ex, b, out_b) != 0)
+            return -1;
+    }
+
+    // alternating shapes stay in their own buckets
+    for (int i = 0; i < 3; i++)
+    {
+        if (forward_shape(net, a, out_a) != 0 || forward_shape(net, b, out_b) != 0)
+            return -1;
+    }
+
+    // an idle extractor of the same shape is handed out again
+    ncnn::Extractor* ex0 = net.acquire_extractor(a);
+    net.release_extractor(ex0);
+    ncnn::Extractor* ex1 = net.acquire_extractor(a);
+    ncnn::Extractor* ex2 = net.acquire_extractor(b);
+    net.release_extractor(ex1);
+    net.release_extractor(ex2);
+
+    if (ex0 != ex1 || ex1 == ex2)
+    {
+        fprintf(stderr, "test_shapebucket_0 extractor not reused\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_shapebucket_1(const ncnn::Mat& model, const ncnn::Mat& a, const ncnn::Mat& b)
+{
+    ncnn::Net net;
+    net.opt.use_packing_layout = true;
+    net.opt.use_conv_autotune = true;
+    net.load_param_mem(param);
+    net.load_model((const unsigned char*)model.data);
+    net.set_shape_cache_capacity(1);
+
+    ncnn::Mat out_a;
+    ncnn::Mat out_b;
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        if (forward(ex, a, out_a) != 0)
+            return -1;
+    }
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        if (forward(ex, b, out_b) != 0)
+            return -1;
+    }
+
+    // plain extractors never measure
+    if (net.opt.autotune_cache->size() != 0)
+    {
+        fprintf(stderr, "test_shapebucket_1 plain extractor measured kernels\n");
+        return -1;
+    }
+
+    // the first forward of a shape measures into its bucket
+    if (forward_shape(net, a, out_a) != 0)
+        return -1;
+
+    if (net.opt.autotune_cache->size() != 0)
+    {
+        fprintf(stderr, "test_shapebucket_1 kernel choice left the bucket before eviction\n");
+        return -1;
+    }
+
+    // b evicts a and hands its choice to the net, then a evicts b
+    if (forward_shape(net, b, out_b) != 0)
+        return -1;
+
+    if (net.opt.autotune_cache->size() != 1)
+    {
+        fprintf(stderr, "test_shapebucket_1 evicted choices %d expect 1\n", net.opt.autotune_cache->size());
+        return -1;
+    }
+
+    if (forward_shape(net, a, out_a) != 0)
+        return -1;
+
+    if (net.opt.autotune_cache->size() != 2)
+    {
+        fprintf(stderr, "test_shapebucket_1 evicted choices %d expect 2\n", net.opt.autotune_cache->size());
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    ncnn::Mat model = RandomModelData(weight_sizes, sizeof(weight_sizes) / sizeof(int));
+    ncnn::Mat a = RandomMat(16, 16, 8);
+    ncnn::Mat b = RandomMat(12, 20, 8);
+
+    return 0
+           || test_shapebucket_0(model, a, b)
+           || test_shapebucket_1(model, a, b);
+}
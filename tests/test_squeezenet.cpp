@@ -17,6 +17,9 @@
 #include "testutil.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
@@ -199,6 +202,36 @@ static int test_squeezenet(const ncnn::Option& opt, int load_model_type, float e
         squeezenet.load_param((const unsigned char*)param_data);
         squeezenet.load_model((const unsigned char*)model_data);
     }
+    if (load_model_type == 4)
+    {
+        // load from plain model file with weight data mapped in place
+        squeezenet.load_param(MODEL_DIR "/squeezenet_v1.1.param");
+        squeezenet.load_model_mmap(MODEL_DIR "/squeezenet_v1.1.bin");
+    }
+    if (load_model_type == 5)
+    {
+        // load from plain model file with prepacked weight cache
+        const char* tmpdir = getenv("TMPDIR");
+        if (!tmpdir) tmpdir = getenv("TEMP");
+        if (!tmpdir) tmpdir = ".";
+
+        char prepacked_path[256];
+        sprintf(prepacked_path, "%s/test_squeezenet_%d.prepacked", tmpdir, (int)time(NULL));
+
+        {
+            ncnn::Net squeezenet_prepack;
+            squeezenet_prepack.opt = opt;
+            squeezenet_prepack.load_param(MODEL_DIR "/squeezenet_v1.1.param");
+            squeezenet_prepack.load_model(MODEL_DIR "/squeezenet_v1.1.bin");
+            squeezenet_prepack.save_prepacked_cache(prepacked_path);
+        }
+        squeezenet.load_param(MODEL_DIR "/squeezenet_v1.1.param");
+        squeezenet.load_prepacked_cache(prepacked_path);
+        squeezenet.load_model(MODEL_DIR "/squeezenet_v1.1.bin");
+
+        // weight data referenced from the cache stays mapped after the file is gone
+        remove(prepacked_path);
+    }
 
     ncnn::Mat in = generate_ncnn_logo(ncnn::Mat::PIXEL_BGR, 227, 227);
 
@@ -208,7 +241,7 @@ static int test_squeezenet(const ncnn::Option& opt, int load_model_type, float e
     ncnn::Extractor ex = squeezenet.create_extractor();
 
     ncnn::Mat out;
-    if (load_model_type == 0 || load_model_type == 1)
+    if (load_model_type == 0 || load_model_type == 1 || load_model_type == 4 || load_model_type == 5)
     {
         ex.input("data", in);
         ex.extract("prob", out);
@@ -226,7 +259,89 @@ static int test_squeezenet(const ncnn::Option& opt, int load_model_type, float e
         cls_scores[j] = out[j];
     }
 
-    return check_top3(cls_scores, epsilon);
+    int ret = check_top3(cls_scores, epsilon);
+    if (ret != 0)
+        return ret;
+
+    // pooled extractor gives the same result when reused
+    for (int k = 0; k < 2; k++)
+    {
+        ncnn::Extractor* pex = squeezenet.acquire_extractor();
+
+        ncnn::Mat out2;
+        if (load_model_type == 2 || load_model_type == 3)
+        {
+            pex->input(0, in);
+            pex->extract(82, out2);
+        }
+        else
+        {
+            pex->input("data", in);
+            pex->extract("prob", out2);
+        }
+
+        squeezenet.release_extractor(pex);
+
+        if (out2.w != out.w || memcmp(out2.data, out.data, out.w * sizeof(float)) != 0)
+        {
+            fprintf(stderr, "pooled extractor result mismatch\n");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int test_squeezenet_fusion(const ncnn::Option& opt)
+{
+    // every intermediate blob stays extractable unless layer fusion is asked for
+    ncnn::Net squeezenet;
+    squeezenet.opt = opt;
+    squeezenet.load_param(MODEL_DIR "/squeezenet_v1.1.param");
+    squeezenet.load_model(MODEL_DIR "/squeezenet_v1.1.bin");
+
+    ncnn::Net squeezenet_fused;
+    squeezenet_fused.opt = opt;
+    squeezenet_fused.opt.use_layer_fusion = true;
+    squeezenet_fused.load_param(MODEL_DIR "/squeezenet_v1.1.param");
+    squeezenet_fused.load_model(MODEL_DIR "/squeezenet_v1.1.bin");
+
+    ncnn::Mat in = generate_ncnn_logo(ncnn::Mat::PIXEL_BGR, 227, 227);
+
+    const float mean_vals[3] = {104.f, 117.f, 123.f};
+    in.substract_mean_normalize(mean_vals, 0);
+
+    ncnn::Mat conv1;
+    ncnn::Mat out;
+    {
+        ncnn::Extractor ex = squeezenet.create_extractor();
+        ex.input("data", in);
+
+        // conv1 is folded into the relu_conv1 chain when fused
+        int ret = ex.extract("conv1", conv1);
+        if (ret != 0 || conv1.w != 113 || conv1.h != 113 || conv1.c != 64)
+        {
+            fprintf(stderr, "extract conv1 failed ret=%d\n", ret);
+            return -1;
+        }
+
+        ex.extract("prob", out);
+    }
+
+    ncnn::Mat out_fused;
+    {
+        ncnn::Extractor ex = squeezenet_fused.create_extractor();
+        ex.input("data", in);
+        ex.extract("prob", out_fused);
+    }
+
+    if (CompareMat(out, out_fused, 0.001) != 0)
+    {
+        fprintf(stderr, "fused network result mismatch\n");
+        return -1;
+    }
+
+    return 0;
 }
 
 int main()
@@ -240,7 +355,7 @@ int main()
     ncnn::UnlockedPoolAllocator g_blob_pool_allocator;
     ncnn::PoolAllocator g_workspace_pool_allocator;
 
-    ncnn::Option opts[4];
+    ncnn::Option opts[6];
 
     opts[0].use_packing_layout = false;
     opts[0].use_fp16_packed = false;
@@ -276,9 +391,12 @@ int main()
     opts[3].blob_allocator = &g_blob_pool_allocator;
     opts[3].workspace_allocator = &g_workspace_pool_allocator;
 
-    int load_model_types[4] = {0, 1, 2, 3};
+    opts[4] = opts[1];
+    opts[5] = opts[1];
+
+    int load_model_types[6] = {0, 1, 2, 3, 4, 5};
 
-    for (int i = 0; i < 4; i++)
+    for (int i = 0; i < 6; i++)
     {
         const ncnn::Option& opt = opts[i];
 
@@ -315,5 +433,16 @@ int main()
 #endif // NCNN_VULKAN
     }
 
+    {
+        ncnn::Option opt_cpu = opts[0];
+        opt_cpu.use_vulkan_compute = false;
+        int ret = test_squeezenet_fusion(opt_cpu);
+        if (ret != 0)
+        {
+            fprintf(stderr, "test_squeezenet_fusion cpu failed\n");
+            return ret;
+        }
+    }
+
     return 0;
 }
@@ -0,0 +1,166 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "net.h"
+#include "testutil.h"
+
+static int count_cast_layers(const ncnn::Net& net)
+{
+    int count = 0;
+    for (size_t i = 0; i < net.layers.size(); i++)
+    {
+        if (net.layers[i]->type == "Cast")
+            count++;
+    }
+
+    return count;
+}
+
+static int forward(const char* param, const ncnn::Mat& model, bool use_bf16_storage, const ncnn::Mat& in, ncnn::Mat& out, int& cast_count)
+{
+    ncnn::Net net;
+    net.opt.use_packing_layout = true;
+    net.opt.use_bf16_storage = use_bf16_storage;
+
+    if (net.load_param_mem(param) != 0 || net.load_model((const unsigned char*)model.data) == 0)
+        return -1;
+
+    cast_count = count_cast_layers(net);
+
+    ncnn::Extractor ex = net.create_extractor();
+#if NCNN_CNNCACHE
+    // the cached path runs the reference convolution on packed blobs
+    ex.cache_mode = false;
+#endif // NCNN_CNNCACHE
+    ex.input("data", in);
+    return ex.extract("out", out);
+}
+
+// the bf16 planned net gives the fp32 result with expect_cast_count cast layers inserted
+static int test_storageplan(const char* param, const int* weight_sizes, int weight_count, const ncnn::Mat& in, int expect_cast_count)
+{
+    ncnn::Mat model = RandomModelData(weight_sizes, weight_count);
+
+    ncnn::Mat out0;
+    ncnn::Mat out1;
+    int cast_count0 = 0;
+    int cast_count1 = 0;
+    if (forward(param, model, false, in, out0, cast_count0) != 0 || forward(param, model, true, in, out1, cast_count1) != 0)
+    {
+        fprintf(stderr, "test_storageplan forward failed\n");
+        return -1;
+    }
+
+    if (cast_count0 != 0 || cast_count1 != expect_cast_count)
+    {
+        fprintf(stderr, "test_storageplan cast count %d %d expect 0 %d\n", cast_count0, cast_count1, expect_cast_count);
+        return -1;
+    }
+
+    if (CompareMat(out0, out1, 0.05) != 0)
+    {
+        fprintf(stderr, "test_storageplan output not match\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+// the bf16 chain outweighs one cast at each end
+static const char param_chain[] = "7767517\n"
+                                  "6 6\n"
+                                  "Input            data   0 1 data 0=32 1=32 2=8\n"
+                                  "Convolution      conv0  1 1 data conv0 0=16 1=3 4=1 5=1 6=1152\n"
+                                  "Pooling          pool   1 1 conv0 pool 0=0 1=2 2=2\n"
+                                  "Convolution      conv1  1 1 pool conv1 0=16 1=3 4=1 5=1 6=2304\n"
+                                  "Convolution      conv2  1 1 conv1 conv2 0=16 1=1 5=1 6=256\n"
+                                  "Sigmoid          sig    1 1 conv2 out\n";
+
+static const int weight_sizes_chain[] = {1152, -16, 2304, -16, 256, -16};
+
+static int test_storageplan_0()
+{
+    return test_storageplan(param_chain, weight_sizes_chain, sizeof(weight_sizes_chain) / sizeof(int), RandomMat(32, 32, 8), 2);
+}
+
+static int test_storageplan_1()
+{
+    // a lone bf16 layer between fp32 layers is not worth two casts
+    static const char param[] = "7767517\n"
+                                "4 4\n"
+                                "Input            data   0 1 data 0=32 1=32 2=8\n"
+                                "Sigmoid          sig0   1 1 data sig0\n"
+                                "Convolution      conv0  1 1 sig0 conv0 0=8 1=1 5=1 6=64\n"
+                                "Sigmoid          sig1   1 1 conv0 out\n";
+
+    static const int weight_sizes[] = {64, -8};
+
+    return test_storageplan(param, weight_sizes, sizeof(weight_sizes) / sizeof(int), RandomMat(32, 32, 8), 0);
+}
+
+static int test_storageplan_2()
+{
+    // reloading weights plans the graph again instead of stacking more casts
+    ncnn::Mat model0 = RandomModelData(weight_sizes_chain, sizeof(weight_sizes_chain) / sizeof(int));
+    ncnn::Mat model1 = RandomModelData(weight_sizes_chain, sizeof(weight_sizes_chain) / sizeof(int));
+    ncnn::Mat in = RandomMat(32, 32, 8);
+
+    ncnn::Mat out0;
+    int cast_count0 = 0;
+    if (forward(param_chain, model1, true, in, out0, cast_count0) != 0)
+        return -1;
+
+    ncnn::Net net;
+    net.opt.use_packing_layout = true;
+    net.opt.use_bf16_storage = true;
+
+    if (net.load_param_mem(param_chain) != 0 || net.load_model((const unsigned char*)model0.data) == 0 || net.load_model((const unsigned char*)model1.data) == 0)
+        return -1;
+
+    int cast_count1 = count_cast_layers(net);
+    if (cast_count1 != cast_count0)
+    {
+        fprintf(stderr, "test_storageplan_2 cast count %d after reload expect %d\n", cast_count1, cast_count0);
+        return -1;
+    }
+
+    ncnn::Mat out1;
+    {
+        ncnn::Extractor ex = net.create_extractor();
+#if NCNN_CNNCACHE
+        ex.cache_mode = false;
+#endif // NCNN_CNNCACHE
+        ex.input("data", in);
+        if (ex.extract("out", out1) != 0)
+            return -1;
+    }
+
+    if (CompareMat(out0, out1, 0.001) != 0)
+    {
+        fprintf(stderr, "test_storageplan_2 output not match after reload\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    return 0
+           || test_storageplan_0()
+           || test_storageplan_1()
+           || test_storageplan_2();
+}
@@ -0,0 +1,201 @@
+// Tencent is pleased to support the open source community by making ncnn available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "net.h"
+#include "testutil.h"
+#include "weightbudget.h"
+
+// four convolutions with the same transformed weight size
+static const char param[] = "7767517\n"
+                            "5 5\n"
+                            "Input            data   0 1 data 0=16 1=16 2=16\n"
+                            "Convolution      conv0  1 1 data conv0 0=16 1=3 4=1 5=1 6=2304 9=1\n"
+                            "Convolution      conv1  1 1 conv0 conv1 0=16 1=3 4=1 5=1 6=2304 9=1\n"
+                            "Convolution      conv2  1 1 conv1 conv2 0=16 1=3 4=1 5=1 6=2304 9=1\n"
+                            "Convolution      conv3  1 1 conv2 out 0=16 1=3 4=1 5=1 6=2304\n";
+
+static const int weight_sizes[] = {2304, -16, 2304, -16, 2304, -16, 2304, -16};
+
+static const int conv_count = 4;
+
+static int forward(const ncnn::Net& net, const ncnn::Mat& in, ncnn::Mat& out)
+{
+    ncnn::Extractor ex = net.create_extractor();
+#if NCNN_CNNCACHE
+    // the cached path runs the reference convolution
+    ex.cache_mode = false;
+#endif // NCNN_CNNCACHE
+    ex.input("data", in);
+    return ex.extract("out", out);
+}
+
+static int forward_check(const ncnn::Net& net, const ncnn::Mat& in, const ncnn::Mat& expect, const char* stage)
+{
+    ncnn::Mat out;
+    if (forward(net, in, out) != 0 || CompareMat(out, expect, 0.001) != 0)
+    {
+        fprintf(stderr, "test_weightbudget output not match after %s\n", stage);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int load(ncnn::Net& net, const ncnn::Mat& model, ncnn::WeightBudget* budget)
+{
+    net.opt.use_packing_layout = true;
+    net.opt.use_lazy_pipeline = budget != 0;
+    net.opt.weight_budget = budget;
+
+    if (net.load_param_mem(param) != 0 || net.load_model((const unsigned char*)model.data) == 0)
+        return -1;
+
+    return 0;
+}
+
+static int test_weightbudget_0(const ncnn::Mat& model, const ncnn::Mat& in)
+{
+    ncnn::Mat expect;
+    {
+        ncnn::Net net;
+        if (load(net, model, 0) != 0 || forward(net, in, expect) != 0)
+            return -1;
+    }
+
+    ncnn::WeightBudget budget;
+
+    ncnn::Net net;
+    if (load(net, model, &budget) != 0)
+        return -1;
+
+    // nothing is transformed before the first forward
+    if (budget.usage() != 0)
+    {
+        fprintf(stderr, "test_weightbudget_0 usage %lu before forward\n", (unsigned long)budget.usage());
+        return -1;
+    }
+
+    if (forward_check(net, in, expect, "first forward") != 0)
+        return -1;
+
+    const size_t total = budget.usage();
+    const size_t layer_bytes = total / conv_count;
+    if (total == 0 || total != layer_bytes * conv_count)
+    {
+        fprintf(stderr, "test_weightbudget_0 usage %lu after forward\n", (unsigned long)total);
+        return -1;
+    }
+
+    // shrinking the budget evicts idle pipelines
+    budget.set_budget(layer_bytes * 2);
+    if (budget.usage() != layer_bytes * 2)
+    {
+        fprintf(stderr, "test_weightbudget_0 usage %lu expect %lu after set_budget\n", (unsigned long)budget.usage(), (unsigned long)(layer_bytes * 2));
+        return -1;
+    }
+
+    // evicted pipelines are created again, the budget holds
+    for (int i = 0; i < 2; i++)
+    {
+        if (forward_check(net, in, expect, "eviction") != 0)
+            return -1;
+
+        if (budget.usage() > budget.budget())
+        {
+            fprintf(stderr, "test_weightbudget_0 usage %lu over budget %lu\n", (unsigned long)budget.usage(), (unsigned long)budget.budget());
+            return -1;
+        }
+    }
+
+    budget.trim();
+    if (budget.usage() != 0)
+    {
+        fprintf(stderr, "test_weightbudget_0 usage %lu after trim\n", (unsigned long)budget.usage());
+        return -1;
+    }
+
+    if (forward_check(net, in, expect, "trim") != 0)
+        return -1;
+
+    net.clear();
+    if (budget.usage() != 0)
+    {
+        fprintf(stderr, "test_weightbudget_0 usage %lu after clear\n", (unsigned long)budget.usage());
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_weightbudget_1(const ncnn::Mat& model, const ncnn::Mat& in)
+{
+    ncnn::Mat expect;
+    {
+        ncnn::Net net;
+        if (load(net, model, 0) != 0 || forward(net, in, expect) != 0)
+            return -1;
+    }
+
+    ncnn::WeightBudget budget;
+
+    ncnn::Net net0;
+    ncnn::Net net1;
+    if (load(net0, model, &budget) != 0 || load(net1, model, &budget) != 0)
+        return -1;
+
+    if (forward_check(net0, in, expect, "first net") != 0)
+        return -1;
+
+    const size_t layer_bytes = budget.usage() / conv_count;
+
+    // the second net takes the budget from the idle pipelines of the first one
+    budget.set_budget(layer_bytes * conv_count);
+
+    if (forward_check(net1, in, expect, "second net") != 0)
+        return -1;
+
+    if (budget.usage() != layer_bytes * conv_count)
+    {
+        fprintf(stderr, "test_weightbudget_1 usage %lu expect %lu\n", (unsigned long)budget.usage(), (unsigned long)(layer_bytes * conv_count));
+        return -1;
+    }
+
+    // net0 pipelines all went to net1, evicting net1 leaves nothing
+    net1.evict_pipelines();
+    if (budget.usage() != 0)
+    {
+        fprintf(stderr, "test_weightbudget_1 usage %lu after evict_pipelines\n", (unsigned long)budget.usage());
+        return -1;
+    }
+
+    if (forward_check(net0, in, expect, "first net again") != 0)
+        return -1;
+
+    net0.clear();
+    net1.clear();
+
+    return 0;
+}
+
+int main()
+{
+    SRAND(7767517);
+
+    ncnn::Mat model = RandomModelData(weight_sizes, sizeof(weight_sizes) / sizeof(int));
+    ncnn::Mat in = RandomMat(16, 16, 16);
+
+    return 0
+           || test_weightbudget_0(model, in)
+           || test_weightbudget_1(model, in);
+}
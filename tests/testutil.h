@@ -68,6 +68,74 @@ static ncnn::Mat RandomMat(int w, int h, int c)
     return m;
 }
 
+static ncnn::Mat RandomMat(int w, int h, int c, float a, float b)
+{
+    ncnn::Mat m(w, h, c);
+    Randomize(m, a, b);
+    return m;
+}
+
+static void RandomizeInt(ncnn::Mat& m, int a = -10000, int b = 10000)
+{
+    for (size_t i = 0; i < m.total(); i++)
+    {
+        ((int*)m)[i] = (int)RandomFloat((float)a, (float)b);
+    }
+}
+
+static ncnn::Mat RandomIntMat(int w)
+{
+    ncnn::Mat m(w);
+    RandomizeInt(m);
+    return m;
+}
+
+static ncnn::Mat RandomIntMat(int w, int h)
+{
+    ncnn::Mat m(w, h);
+    RandomizeInt(m);
+    return m;
+}
+
+static ncnn::Mat RandomIntMat(int w, int h, int c)
+{
+    ncnn::Mat m(w, h, c);
+    RandomizeInt(m);
+    return m;
+}
+
+// model data for Net::load_model(const unsigned char*) filled with random weights
+// sizes lists the weight blobs in load order, negative for raw blobs without the fp32 flag like bias
+// the net references the data in place, keep the mat while the net is alive
+static ncnn::Mat RandomModelData(const int* sizes, int count)
+{
+    int total = 0;
+    for (int i = 0; i < count; i++)
+    {
+        total += sizes[i] > 0 ? sizes[i] + 1 : -sizes[i];
+    }
+
+    ncnn::Mat m(total);
+
+    float* p = m;
+    for (int i = 0; i < count; i++)
+    {
+        if (sizes[i] > 0)
+        {
+            // fp32 flag
+            *p++ = 0.f;
+        }
+
+        int size = sizes[i] > 0 ? sizes[i] : -sizes[i];
+        for (int j = 0; j < size; j++)
+        {
+            *p++ = RandomFloat(-0.5f, 0.5f);
+        }
+    }
+
+    return m;
+}
+
 static bool NearlyEqual(float a, float b, float epsilon)
 {
     if (a == b)
@@ -309,7 +377,9 @@ int test_layer_cpu(int typeindex, const ncnn::ParamDict& pd, const std::vector<n
             int dst_elempack = 1;
 
 #if NCNN_AVX2
-            if (elemcount % 8 == 0)
+            if (elemcount % 16 == 0 && op->support_packing16)
+                dst_elempack = 16;
+            else if (elemcount % 8 == 0)
                 dst_elempack = 8;
 #elif NCNN_ARM82
             if (elemcount % 8 == 0 && opt.use_fp16_arithmetic)
@@ -725,7 +795,9 @@ int test_layer_cpu(int typeindex, const ncnn::ParamDict& pd, const std::vector<n
         int dst_elempack = 1;
 
 #if NCNN_AVX2
-        if (elemcount % 8 == 0)
+        if (elemcount % 16 == 0 && op->support_packing16)
+            dst_elempack = 16;
+        else if (elemcount % 8 == 0)
             dst_elempack = 8;
 #elif NCNN_ARM82
         if (elemcount % 8 == 0 && opt.use_fp16_arithmetic)